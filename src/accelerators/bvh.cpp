@@ -0,0 +1,457 @@
+#include "accelerators/bvh.h"
+#include "hash.h"
+#include "memory.h"
+#include "paramset.h"
+
+namespace pbr {
+
+	// BVHAccel Local Declarations
+	struct BVHPrimitiveInfo {
+		BVHPrimitiveInfo() {}
+		BVHPrimitiveInfo(size_t primitiveNumber, const Bounds3f& bounds)
+			: primitiveNumber(primitiveNumber), bounds(bounds), centroid(.5f * bounds.pMin + .5f * bounds.pMax) {}
+		size_t primitiveNumber;
+		Bounds3f bounds;
+		Point3f centroid;
+	};
+
+	struct BVHBuildNode {
+		void InitLeaf(int first, int n, const Bounds3f& b) {
+			firstPrimOffset = first;
+			nPrimitives = n;
+			bounds = b;
+			children[0] = children[1] = nullptr;
+		}
+		void InitInterior(int axis, BVHBuildNode* c0, BVHBuildNode* c1) {
+			children[0] = c0;
+			children[1] = c1;
+			bounds = Union(c0->bounds, c1->bounds);
+			splitAxis = axis;
+			nPrimitives = 0;
+		}
+		Bounds3f bounds;
+		BVHBuildNode* children[2];
+		int splitAxis, firstPrimOffset, nPrimitives;
+	};
+
+	// On-disk cache layout: header, primitive order (int32 per primitive),
+	// padding up to a cache line, then the LinearBVHNode array.
+	struct BVHCacheHeader {
+		char magic[8];
+		uint32_t version;
+		uint32_t nodeSize;
+		uint64_t geometryHash;
+		uint32_t nodeCount;
+		uint32_t primitiveCount;
+	};
+	static const char BVHCacheMagic[8] = { 'P', 'B', 'R', 'B', 'V', 'H', '\0', '\0' };
+	static const uint32_t BVHCacheVersion = 1;
+
+	static size_t BVHCacheNodesOffset(size_t primitiveCount) {
+		size_t offset = sizeof(BVHCacheHeader) + primitiveCount * sizeof(int32_t);
+		return (offset + PBR_L1_CACHE_LINE_SIZE - 1) & ~(size_t)(PBR_L1_CACHE_LINE_SIZE - 1);
+	}
+
+	// Bounds3f's default constructor spans all of space, so accumulation starts from an inverted box
+	static Bounds3f EmptyBounds() {
+		Bounds3f b;
+		b.pMin = Point3f(Infinity, Infinity, Infinity);
+		b.pMax = Point3f(-Infinity, -Infinity, -Infinity);
+		return b;
+	}
+
+	// BVHAccel Method Definitions
+	BVHAccel::BVHAccel(std::vector<std::shared_ptr<Primitive>> p, int maxPrimsInNode,
+		SplitMethod splitMethod, const std::string& cacheDir)
+		: maxPrimsInNode(std::min(255, maxPrimsInNode)), splitMethod(splitMethod), primitives(std::move(p)) {
+		if (primitives.empty()) return;
+		geometryHash = computeGeometryHash();
+		std::string cacheFilename = cacheDir.empty() ? "" : CacheFilename(cacheDir);
+		if (!cacheFilename.empty() && loadCache(cacheFilename)) {
+			LOG(INFO) << "Loaded BVH with " << totalNodes << " nodes from cache " << cacheFilename;
+			return;
+		}
+
+		// Build BVH from primitives
+		std::vector<BVHPrimitiveInfo> primitiveInfo(primitives.size());
+		for (size_t i = 0; i < primitives.size(); ++i)
+			primitiveInfo[i] = BVHPrimitiveInfo(i, primitives[i]->WorldBound());
+
+		MemoryArena arena(1024 * 1024);
+		std::vector<int> orderedPrimIndices;
+		orderedPrimIndices.reserve(primitives.size());
+		BVHBuildNode* root = recursiveBuild(arena, primitiveInfo, 0, (int)primitives.size(),
+			&totalNodes, orderedPrimIndices);
+
+		std::vector<std::shared_ptr<Primitive>> orderedPrims(primitives.size());
+		for (size_t i = 0; i < orderedPrimIndices.size(); ++i)
+			orderedPrims[i] = primitives[orderedPrimIndices[i]];
+		primitives.swap(orderedPrims);
+
+		// Compute representation of depth-first traversal of BVH tree
+		builtNodes = AllocAligned<LinearBVHNode>(totalNodes);
+		int offset = 0;
+		flattenBVHTree(root, &offset);
+		CHECK_EQ(totalNodes, offset);
+		nodes = builtNodes;
+
+		if (!cacheFilename.empty() && !writeCache(cacheFilename, orderedPrimIndices))
+			LOG(WARNING) << "Unable to write BVH cache " << cacheFilename;
+	}
+
+	BVHAccel::~BVHAccel() { FreeAligned(builtNodes); }
+
+	Bounds3f BVHAccel::WorldBound() const {
+		return nodes ? nodes[0].bounds : Bounds3f(Point3f(0, 0, 0));
+	}
+
+	BVHBuildNode* BVHAccel::recursiveBuild(MemoryArena& arena, std::vector<BVHPrimitiveInfo>& primitiveInfo,
+		int start, int end, int* totalNodes, std::vector<int>& orderedPrimIndices) {
+		CHECK_NE(start, end);
+		BVHBuildNode* node = arena.Alloc<BVHBuildNode>();
+		(*totalNodes)++;
+		// Compute bounds of all primitives in BVH node
+		Bounds3f bounds = EmptyBounds();
+		for (int i = start; i < end; ++i)
+			bounds = Union(bounds, primitiveInfo[i].bounds);
+		int nPrimitives = end - start;
+
+		auto createLeaf = [&]() {
+			int firstPrimOffset = (int)orderedPrimIndices.size();
+			for (int i = start; i < end; ++i)
+				orderedPrimIndices.push_back((int)primitiveInfo[i].primitiveNumber);
+			node->InitLeaf(firstPrimOffset, nPrimitives, bounds);
+			return node;
+		};
+		if (nPrimitives == 1) return createLeaf();
+
+		// Compute bound of primitive centroids, choose split dimension _dim_
+		Bounds3f centroidBounds = EmptyBounds();
+		for (int i = start; i < end; ++i)
+			centroidBounds = Union(centroidBounds, primitiveInfo[i].centroid);
+		int dim = centroidBounds.MaximumExtent();
+
+		// Partition primitives into two sets and build children
+		if (centroidBounds.pMax[dim] == centroidBounds.pMin[dim]) return createLeaf();
+		int mid = (start + end) / 2;
+		switch (splitMethod) {
+		case SplitMethod::Middle: {
+			// Partition primitives through node's midpoint
+			Float pmid = (centroidBounds.pMin[dim] + centroidBounds.pMax[dim]) / 2;
+			BVHPrimitiveInfo* midPtr = std::partition(&primitiveInfo[start], &primitiveInfo[end - 1] + 1,
+				[dim, pmid](const BVHPrimitiveInfo& pi) { return pi.centroid[dim] < pmid; });
+			mid = (int)(midPtr - &primitiveInfo[0]);
+			// For lots of prims with large overlapping bounding boxes, this
+			// may fail to partition; in that case fall through to EqualCounts
+			if (mid != start && mid != end) break;
+			PBR_FALLTHROUGH;
+		}
+		case SplitMethod::EqualCounts: {
+			// Partition primitives into equally-sized subsets
+			mid = (start + end) / 2;
+			std::nth_element(&primitiveInfo[start], &primitiveInfo[mid], &primitiveInfo[end - 1] + 1,
+				[dim](const BVHPrimitiveInfo& a, const BVHPrimitiveInfo& b) {
+					return a.centroid[dim] < b.centroid[dim];
+				});
+			break;
+		}
+		case SplitMethod::SAH:
+		default: {
+			// Partition primitives using approximate SAH
+			if (nPrimitives <= 2) {
+				// Partition primitives into equally-sized subsets
+				mid = (start + end) / 2;
+				std::nth_element(&primitiveInfo[start], &primitiveInfo[mid], &primitiveInfo[end - 1] + 1,
+					[dim](const BVHPrimitiveInfo& a, const BVHPrimitiveInfo& b) {
+						return a.centroid[dim] < b.centroid[dim];
+					});
+				break;
+			}
+
+			// Allocate _BucketInfo_ for SAH partition buckets
+			constexpr int nBuckets = 12;
+			struct BucketInfo {
+				int count = 0;
+				Bounds3f bounds = EmptyBounds();
+			};
+			BucketInfo buckets[nBuckets];
+
+			// Initialize _BucketInfo_ for SAH partition buckets
+			for (int i = start; i < end; ++i) {
+				int b = (int)(nBuckets * centroidBounds.Offset(primitiveInfo[i].centroid)[dim]);
+				if (b == nBuckets) b = nBuckets - 1;
+				CHECK_GE(b, 0);
+				CHECK_LT(b, nBuckets);
+				buckets[b].count++;
+				buckets[b].bounds = Union(buckets[b].bounds, primitiveInfo[i].bounds);
+			}
+
+			// Compute costs for splitting after each bucket
+			Float cost[nBuckets - 1];
+			for (int i = 0; i < nBuckets - 1; ++i) {
+				Bounds3f b0 = EmptyBounds(), b1 = EmptyBounds();
+				int count0 = 0, count1 = 0;
+				for (int j = 0; j <= i; ++j) {
+					b0 = Union(b0, buckets[j].bounds);
+					count0 += buckets[j].count;
+				}
+				for (int j = i + 1; j < nBuckets; ++j) {
+					b1 = Union(b1, buckets[j].bounds);
+					count1 += buckets[j].count;
+				}
+				// Empty sides contribute no cost; their inverted bounds would
+				// otherwise report a bogus positive area
+				Float area0 = count0 ? b0.SurfaceArea() : 0;
+				Float area1 = count1 ? b1.SurfaceArea() : 0;
+				cost[i] = 1 + (count0 * area0 + count1 * area1) / bounds.SurfaceArea();
+			}
+
+			// Find bucket to split at that minimizes SAH metric
+			Float minCost = cost[0];
+			int minCostSplitBucket = 0;
+			for (int i = 1; i < nBuckets - 1; ++i) {
+				if (cost[i] < minCost) {
+					minCost = cost[i];
+					minCostSplitBucket = i;
+				}
+			}
+
+			// Either create leaf or split primitives at selected SAH bucket
+			Float leafCost = (Float)nPrimitives;
+			if (nPrimitives > maxPrimsInNode || minCost < leafCost) {
+				BVHPrimitiveInfo* pmid = std::partition(&primitiveInfo[start], &primitiveInfo[end - 1] + 1,
+					[=](const BVHPrimitiveInfo& pi) {
+						int b = (int)(nBuckets * centroidBounds.Offset(pi.centroid)[dim]);
+						if (b == nBuckets) b = nBuckets - 1;
+						return b <= minCostSplitBucket;
+					});
+				mid = (int)(pmid - &primitiveInfo[0]);
+			} else {
+				return createLeaf();
+			}
+			break;
+		}
+		}
+		node->InitInterior(dim,
+			recursiveBuild(arena, primitiveInfo, start, mid, totalNodes, orderedPrimIndices),
+			recursiveBuild(arena, primitiveInfo, mid, end, totalNodes, orderedPrimIndices));
+		return node;
+	}
+
+	int BVHAccel::flattenBVHTree(BVHBuildNode* node, int* offset) {
+		LinearBVHNode* linearNode = &builtNodes[*offset];
+		*linearNode = LinearBVHNode();
+		linearNode->bounds = node->bounds;
+		int myOffset = (*offset)++;
+		if (node->nPrimitives > 0) {
+			CHECK(!node->children[0] && !node->children[1]);
+			CHECK_LT(node->nPrimitives, 65536);
+			linearNode->primitivesOffset = node->firstPrimOffset;
+			linearNode->nPrimitives = (uint16_t)node->nPrimitives;
+		} else {
+			// Create interior flattened BVH node
+			linearNode->axis = (uint8_t)node->splitAxis;
+			linearNode->nPrimitives = 0;
+			flattenBVHTree(node->children[0], offset);
+			linearNode->secondChildOffset = flattenBVHTree(node->children[1], offset);
+		}
+		return myOffset;
+	}
+
+	bool BVHAccel::Intersect(const Ray& ray, SurfaceInteraction* isect) const {
+		if (!nodes) return false;
+		bool hit = false;
+		Vector3f invDir(1 / ray.d.x, 1 / ray.d.y, 1 / ray.d.z);
+		int dirIsNeg[3] = { invDir.x < 0, invDir.y < 0, invDir.z < 0 };
+		// Follow ray through BVH nodes to find primitive intersections
+		int toVisitOffset = 0, currentNodeIndex = 0;
+		int nodesToVisit[64];
+		while (true) {
+			const LinearBVHNode* node = &nodes[currentNodeIndex];
+			// Check ray against BVH node
+			if (node->bounds.IntersectP(ray, invDir, dirIsNeg)) {
+				if (node->nPrimitives > 0) {
+					// Intersect ray with primitives in leaf BVH node
+					for (int i = 0; i < node->nPrimitives; ++i)
+						if (primitives[node->primitivesOffset + i]->Intersect(ray, isect))
+							hit = true;
+					if (toVisitOffset == 0) break;
+					currentNodeIndex = nodesToVisit[--toVisitOffset];
+				} else {
+					// Put far BVH node on _nodesToVisit_ stack, advance to near node
+					if (dirIsNeg[node->axis]) {
+						nodesToVisit[toVisitOffset++] = currentNodeIndex + 1;
+						currentNodeIndex = node->secondChildOffset;
+					} else {
+						nodesToVisit[toVisitOffset++] = node->secondChildOffset;
+						currentNodeIndex = currentNodeIndex + 1;
+					}
+				}
+			} else {
+				if (toVisitOffset == 0) break;
+				currentNodeIndex = nodesToVisit[--toVisitOffset];
+			}
+		}
+		return hit;
+	}
+
+	bool BVHAccel::IntersectP(const Ray& ray) const {
+		if (!nodes) return false;
+		Vector3f invDir(1 / ray.d.x, 1 / ray.d.y, 1 / ray.d.z);
+		int dirIsNeg[3] = { invDir.x < 0, invDir.y < 0, invDir.z < 0 };
+		int nodesToVisit[64];
+		int toVisitOffset = 0, currentNodeIndex = 0;
+		while (true) {
+			const LinearBVHNode* node = &nodes[currentNodeIndex];
+			if (node->bounds.IntersectP(ray, invDir, dirIsNeg)) {
+				// Process BVH node _node_ for traversal
+				if (node->nPrimitives > 0) {
+					for (int i = 0; i < node->nPrimitives; ++i)
+						if (primitives[node->primitivesOffset + i]->IntersectP(ray))
+							return true;
+					if (toVisitOffset == 0) break;
+					currentNodeIndex = nodesToVisit[--toVisitOffset];
+				} else {
+					if (dirIsNeg[node->axis]) {
+						// second child first
+						nodesToVisit[toVisitOffset++] = currentNodeIndex + 1;
+						currentNodeIndex = node->secondChildOffset;
+					} else {
+						nodesToVisit[toVisitOffset++] = node->secondChildOffset;
+						currentNodeIndex = currentNodeIndex + 1;
+					}
+				}
+			} else {
+				if (toVisitOffset == 0) break;
+				currentNodeIndex = nodesToVisit[--toVisitOffset];
+			}
+		}
+		return false;
+	}
+
+	uint64_t BVHAccel::computeGeometryHash() const {
+		// The tree depends only on the primitive bounds, their order and the
+		// build parameters, so that is exactly what keys the cache.
+		std::vector<Float> key;
+		key.reserve(6 * primitives.size());
+		for (const auto& prim : primitives) {
+			Bounds3f b = prim->WorldBound();
+			for (int i = 0; i < 3; ++i) key.push_back(b.pMin[i]);
+			for (int i = 0; i < 3; ++i) key.push_back(b.pMax[i]);
+		}
+		uint64_t params[4] = { BVHCacheVersion, sizeof(LinearBVHNode), (uint64_t)maxPrimsInNode,
+			(uint64_t)splitMethod };
+		return HashBuffer(key.data(), key.size() * sizeof(Float), HashBuffer(params, sizeof(params)));
+	}
+
+	std::string BVHAccel::CacheFilename(const std::string& cacheDir) const {
+		char name[64];
+		snprintf(name, sizeof(name), "bvh-%016" PRIx64 ".bin", geometryHash);
+		return JoinPath(cacheDir, name);
+	}
+
+	bool BVHAccel::loadCache(const std::string& filename) {
+		if (!cacheFile.Open(filename)) return false;
+		const char* data = cacheFile.Data();
+		BVHCacheHeader header;
+		bool valid = cacheFile.Size() >= sizeof(BVHCacheHeader);
+		if (valid) {
+			memcpy(&header, data, sizeof(BVHCacheHeader));
+			valid = memcmp(header.magic, BVHCacheMagic, sizeof(BVHCacheMagic)) == 0 &&
+				header.version == BVHCacheVersion && header.nodeSize == sizeof(LinearBVHNode) &&
+				header.geometryHash == geometryHash && header.primitiveCount == primitives.size() &&
+				header.nodeCount > 0 &&
+				cacheFile.Size() == BVHCacheNodesOffset(header.primitiveCount) +
+				(size_t)header.nodeCount * sizeof(LinearBVHNode);
+		}
+
+		// Reorder primitives to match the cached leaves, rejecting anything
+		// that isn't a permutation
+		std::vector<std::shared_ptr<Primitive>> orderedPrims;
+		if (valid) {
+			const int32_t* primOrder = (const int32_t*)(data + sizeof(BVHCacheHeader));
+			orderedPrims.resize(primitives.size());
+			std::vector<bool> seen(primitives.size(), false);
+			for (size_t i = 0; i < primitives.size() && valid; ++i) {
+				int32_t index = primOrder[i];
+				valid = index >= 0 && (size_t)index < primitives.size() && !seen[index];
+				if (valid) {
+					seen[index] = true;
+					orderedPrims[i] = primitives[index];
+				}
+			}
+		}
+
+		// Check that leaves stay within the primitives and children follow
+		// their parents, so traversal can't leave the node array; a node's
+		// depth bounds the traversal stack
+		const LinearBVHNode* cachedNodes = nullptr;
+		if (valid) {
+			cachedNodes = (const LinearBVHNode*)(data + BVHCacheNodesOffset(header.primitiveCount));
+			std::vector<uint8_t> depth(header.nodeCount, 0);
+			for (uint32_t i = 0; i < header.nodeCount && valid; ++i) {
+				const LinearBVHNode& node = cachedNodes[i];
+				if (node.nPrimitives > 0)
+					valid = node.primitivesOffset >= 0 &&
+					(size_t)node.primitivesOffset + node.nPrimitives <= primitives.size();
+				else {
+					valid = node.axis < 3 && depth[i] < 63 && node.secondChildOffset > (int)i + 1 &&
+						(uint32_t)node.secondChildOffset < header.nodeCount;
+					if (valid)
+						for (int child : { (int)i + 1, node.secondChildOffset })
+							depth[child] = std::max<uint8_t>(depth[child], depth[i] + 1);
+				}
+			}
+		}
+		if (!valid) {
+			LOG(WARNING) << "Ignoring stale or corrupt BVH cache " << filename;
+			cacheFile.Close();
+			return false;
+		}
+
+		primitives.swap(orderedPrims);
+		totalNodes = (int)header.nodeCount;
+		nodes = cachedNodes;
+		return true;
+	}
+
+	bool BVHAccel::writeCache(const std::string& filename, const std::vector<int>& primOrder) const {
+		BVHCacheHeader header;
+		memcpy(header.magic, BVHCacheMagic, sizeof(BVHCacheMagic));
+		header.version = BVHCacheVersion;
+		header.nodeSize = sizeof(LinearBVHNode);
+		header.geometryHash = geometryHash;
+		header.nodeCount = (uint32_t)totalNodes;
+		header.primitiveCount = (uint32_t)primOrder.size();
+
+		size_t nodesOffset = BVHCacheNodesOffset(primOrder.size());
+		std::vector<char> buf(nodesOffset + totalNodes * sizeof(LinearBVHNode), 0);
+		memcpy(&buf[0], &header, sizeof(header));
+		for (size_t i = 0; i < primOrder.size(); ++i) {
+			int32_t index = primOrder[i];
+			memcpy(&buf[sizeof(header) + i * sizeof(int32_t)], &index, sizeof(int32_t));
+		}
+		memcpy(&buf[nodesOffset], nodes, totalNodes * sizeof(LinearBVHNode));
+		return WriteFileAtomic(filename, buf.data(), buf.size());
+	}
+
+	std::shared_ptr<BVHAccel> CreateBVHAccelerator(std::vector<std::shared_ptr<Primitive>> prims,
+		const ParamSet& ps) {
+		std::string splitMethodName = ps.FindOneString("splitmethod", "sah");
+		BVHAccel::SplitMethod splitMethod;
+		if (splitMethodName == "sah")
+			splitMethod = BVHAccel::SplitMethod::SAH;
+		else if (splitMethodName == "middle")
+			splitMethod = BVHAccel::SplitMethod::Middle;
+		else if (splitMethodName == "equal")
+			splitMethod = BVHAccel::SplitMethod::EqualCounts;
+		else {
+			LOG(WARNING) << "BVH split method \"" << splitMethodName << "\" unknown.  Using \"sah\".";
+			splitMethod = BVHAccel::SplitMethod::SAH;
+		}
+		int maxPrimsInNode = ps.FindOneInt("maxnodeprims", 4);
+		std::string cacheDir = ps.FindOneString("cachedir", "");
+		return std::make_shared<BVHAccel>(std::move(prims), maxPrimsInNode, splitMethod, cacheDir);
+	}
+
+}  // namespace pbr
@@ -0,0 +1,73 @@
+#ifndef ACCELERATORS_BVH_H
+#define ACCELERATORS_BVH_H
+
+#include "pbr.h"
+#include "primitive.h"
+#include "fileutil.h"
+
+namespace pbr {
+
+	struct BVHBuildNode;
+	struct BVHPrimitiveInfo;
+
+	// Flattened node layout; also the on-disk layout of the BVH cache.
+	struct LinearBVHNode {
+		Bounds3f bounds;
+		union {
+			int primitivesOffset;   // leaf
+			int secondChildOffset;  // interior
+		};
+		uint16_t nPrimitives;  // 0 -> interior node
+		uint8_t axis;          // interior node: xyz
+		uint8_t pad[1];        // ensure 32 byte total size (with float)
+	};
+	static_assert(sizeof(LinearBVHNode) == 6 * sizeof(Float) + 8, "unexpected LinearBVHNode padding");
+
+	// BVHAccel Declarations
+	class BVHAccel : public Aggregate {
+	public:
+		enum class SplitMethod { SAH, Middle, EqualCounts };
+
+		// If cacheDir is non-empty, the flattened tree is looked up there by
+		// a hash of the primitive bounds and build parameters; on a hit the
+		// nodes are used straight from the mapped file, on a miss the tree
+		// is built and written back for the next run.
+		BVHAccel(std::vector<std::shared_ptr<Primitive>> p, int maxPrimsInNode = 1,
+			SplitMethod splitMethod = SplitMethod::SAH, const std::string& cacheDir = "");
+		~BVHAccel();
+
+		Bounds3f WorldBound() const;
+		bool Intersect(const Ray& ray, SurfaceInteraction* isect) const;
+		bool IntersectP(const Ray& ray) const;
+
+		int TotalNodes() const { return totalNodes; }
+		bool LoadedFromCache() const { return cacheFile.IsOpen(); }
+		uint64_t GeometryHash() const { return geometryHash; }
+		std::string CacheFilename(const std::string& cacheDir) const;
+
+	private:
+		// BVHAccel Private Methods
+		BVHBuildNode* recursiveBuild(MemoryArena& arena, std::vector<BVHPrimitiveInfo>& primitiveInfo,
+			int start, int end, int* totalNodes, std::vector<int>& orderedPrimIndices);
+		int flattenBVHTree(BVHBuildNode* node, int* offset);
+		uint64_t computeGeometryHash() const;
+		bool loadCache(const std::string& filename);
+		bool writeCache(const std::string& filename, const std::vector<int>& primOrder) const;
+
+		// BVHAccel Private Data
+		const int maxPrimsInNode;
+		const SplitMethod splitMethod;
+		std::vector<std::shared_ptr<Primitive>> primitives;
+		uint64_t geometryHash = 0;
+		int totalNodes = 0;
+		LinearBVHNode* builtNodes = nullptr;
+		const LinearBVHNode* nodes = nullptr;
+		MappedFile cacheFile;
+	};
+
+	std::shared_ptr<BVHAccel> CreateBVHAccelerator(std::vector<std::shared_ptr<Primitive>> prims,
+		const ParamSet& ps);
+
+}  // namespace pbr
+
+#endif  // ACCELERATORS_BVH_H
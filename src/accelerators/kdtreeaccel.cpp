@@ -0,0 +1,412 @@
+#include "accelerators/kdtreeaccel.h"
+#include "memory.h"
+#include "paramset.h"
+
+namespace pbr {
+
+	// KdTreeAccel Local Declarations
+
+	// 8 bytes with float: the low two bits of the second word hold the split
+	// axis (3 marks a leaf), the remaining bits the primitive count or the
+	// index of the above child. The below child always follows its parent.
+	struct KdAccelNode {
+		// KdAccelNode Methods
+		void InitLeaf(const int* primNums, int np, std::vector<int>* primitiveIndices) {
+			flags = 3;
+			nPrims |= (np << 2);
+			// Store primitive ids for leaf node
+			if (np == 0)
+				onePrimitive = 0;
+			else if (np == 1)
+				onePrimitive = primNums[0];
+			else {
+				primitiveIndicesOffset = (int)primitiveIndices->size();
+				for (int i = 0; i < np; ++i) primitiveIndices->push_back(primNums[i]);
+			}
+		}
+		void InitInterior(int axis, int ac, Float s) {
+			split = s;
+			flags = axis;
+			aboveChild |= (ac << 2);
+		}
+		Float SplitPos() const { return split; }
+		int nPrimitives() const { return nPrims >> 2; }
+		int SplitAxis() const { return flags & 3; }
+		bool IsLeaf() const { return (flags & 3) == 3; }
+		int AboveChild() const { return aboveChild >> 2; }
+
+		union {
+			Float split;                 // Interior
+			int onePrimitive;            // Leaf
+			int primitiveIndicesOffset;  // Leaf
+		};
+
+	private:
+		union {
+			int flags;       // Both
+			int nPrims;      // Leaf
+			int aboveChild;  // Interior
+		};
+	};
+	static_assert(sizeof(KdAccelNode) == 2 * sizeof(Float), "KdAccelNode is not compact");
+
+	// SAH sweep events. Sorting by (axis, position, type) once at the root
+	// and splitting the sorted lists in linear time at each node gives the
+	// O(N log N) build of Wald and Havran, "On building fast kd-Trees for
+	// Ray Tracing, and on doing that in O(N log N)" (2006).
+	enum class KdEventType : uint8_t { End = 0, Planar = 1, Start = 2 };
+
+	struct KdEvent {
+		KdEvent() {}
+		KdEvent(int primNum, int axis, Float pos, KdEventType type)
+			: pos(pos), primNum(primNum), axis((uint8_t)axis), type(type) {}
+		bool operator<(const KdEvent& e) const {
+			if (axis != e.axis) return axis < e.axis;
+			if (pos != e.pos) return pos < e.pos;
+			return type < e.type;
+		}
+		Float pos;
+		int primNum;
+		uint8_t axis;
+		KdEventType type;
+	};
+
+	enum KdSide : uint8_t { KdBelow = 0, KdAbove = 1, KdBoth = 2 };
+
+	struct KdToDo {
+		const KdAccelNode* node;
+		Float tMin, tMax;
+	};
+
+	static void AddEvents(int primNum, const Bounds3f& b, std::vector<KdEvent>* events) {
+		for (int axis = 0; axis < 3; ++axis) {
+			if (b.pMin[axis] == b.pMax[axis])
+				events->push_back(KdEvent(primNum, axis, b.pMin[axis], KdEventType::Planar));
+			else {
+				events->push_back(KdEvent(primNum, axis, b.pMin[axis], KdEventType::Start));
+				events->push_back(KdEvent(primNum, axis, b.pMax[axis], KdEventType::End));
+			}
+		}
+	}
+
+	// KdTreeAccel Method Definitions
+	KdTreeAccel::KdTreeAccel(std::vector<std::shared_ptr<Primitive>> p, int isectCost, int traversalCost,
+		Float emptyBonus, int maxPrims, int maxDepth)
+		: isectCost(isectCost), traversalCost(traversalCost), maxPrims(maxPrims), emptyBonus(emptyBonus),
+		primitives(std::move(p)), bounds(Point3f(0, 0, 0)) {
+		if (primitives.empty()) return;
+		// Build kd-tree for accelerator
+		nextFreeNode = nAllocedNodes = 0;
+		if (maxDepth <= 0)
+			maxDepth = (int)std::round(8 + 1.3f * std::log2((Float)primitives.size()));
+
+		// Compute bounds for kd-tree construction
+		primBounds.reserve(primitives.size());
+		for (size_t i = 0; i < primitives.size(); ++i) {
+			Bounds3f b = primitives[i]->WorldBound();
+			bounds = i == 0 ? b : Union(bounds, b);
+			primBounds.push_back(b);
+		}
+
+		// Create and sort the root event list
+		std::vector<KdEvent> events;
+		events.reserve(6 * primitives.size());
+		for (size_t i = 0; i < primitives.size(); ++i) AddEvents((int)i, primBounds[i], &events);
+		std::sort(events.begin(), events.end());
+
+		// Start recursive construction of kd-tree
+		primSide.assign(primitives.size(), KdBoth);
+		buildTree(0, bounds, events, maxDepth, 0);
+		std::vector<Bounds3f>().swap(primBounds);
+		std::vector<uint8_t>().swap(primSide);
+	}
+
+	KdTreeAccel::~KdTreeAccel() { FreeAligned(nodes); }
+
+	void KdTreeAccel::buildTree(int nodeNum, const Bounds3f& nodeBounds, std::vector<KdEvent>& events,
+		int depth, int badRefines) {
+		CHECK_EQ(nodeNum, nextFreeNode);
+		// Get next free node from _nodes_ array
+		if (nextFreeNode == nAllocedNodes) {
+			int nNewAllocNodes = std::max(2 * nAllocedNodes, 512);
+			KdAccelNode* n = AllocAligned<KdAccelNode>(nNewAllocNodes);
+			if (nAllocedNodes > 0) {
+				memcpy(n, nodes, nAllocedNodes * sizeof(KdAccelNode));
+				FreeAligned(nodes);
+			}
+			nodes = n;
+			nAllocedNodes = nNewAllocNodes;
+		}
+		++nextFreeNode;
+
+		// Every primitive in the node has exactly one start or planar event on x
+		std::vector<int> primNums;
+		for (const KdEvent& e : events) {
+			if (e.axis != 0) break;
+			if (e.type != KdEventType::End) primNums.push_back(e.primNum);
+		}
+		int nPrimitives = (int)primNums.size();
+
+		// Initialize leaf node if termination criteria met
+		if (nPrimitives <= maxPrims || depth == 0) {
+			nodes[nodeNum].InitLeaf(primNums.data(), nPrimitives, &primitiveIndices);
+			return;
+		}
+
+		// Sweep the sorted events of each axis, tracking how many primitives
+		// lie below, on and above each candidate plane
+		int bestAxis = -1;
+		Float bestCost = Infinity, bestPos = 0;
+		bool bestPlanarBelow = true;
+		Float oldCost = (Float)isectCost * nPrimitives;
+		Float totalSA = nodeBounds.SurfaceArea();
+		Float invTotalSA = 1 / totalSA;
+		Vector3f d = nodeBounds.Diagonal();
+		size_t i = 0;
+		while (i < events.size()) {
+			int axis = events[i].axis;
+			int otherAxis0 = (axis + 1) % 3, otherAxis1 = (axis + 2) % 3;
+			int nBelow = 0, nAbove = nPrimitives;
+			while (i < events.size() && events[i].axis == axis) {
+				Float pos = events[i].pos;
+				int pEnd = 0, pPlanar = 0, pStart = 0;
+				while (i < events.size() && events[i].axis == axis && events[i].pos == pos &&
+					events[i].type == KdEventType::End) { ++pEnd; ++i; }
+				while (i < events.size() && events[i].axis == axis && events[i].pos == pos &&
+					events[i].type == KdEventType::Planar) { ++pPlanar; ++i; }
+				while (i < events.size() && events[i].axis == axis && events[i].pos == pos &&
+					events[i].type == KdEventType::Start) { ++pStart; ++i; }
+
+				nAbove -= pPlanar + pEnd;
+				if (pos > nodeBounds.pMin[axis] && pos < nodeBounds.pMax[axis]) {
+					// Compute cost for split at this position, trying planar primitives on each side
+					Float belowSA = 2 * (d[otherAxis0] * d[otherAxis1] +
+						(pos - nodeBounds.pMin[axis]) * (d[otherAxis0] + d[otherAxis1]));
+					Float aboveSA = 2 * (d[otherAxis0] * d[otherAxis1] +
+						(nodeBounds.pMax[axis] - pos) * (d[otherAxis0] + d[otherAxis1]));
+					Float pBelow = belowSA * invTotalSA, pAbove = aboveSA * invTotalSA;
+					for (int planarBelow = 1; planarBelow >= 0; --planarBelow) {
+						int nb = nBelow + (planarBelow ? pPlanar : 0);
+						int na = nAbove + (planarBelow ? 0 : pPlanar);
+						Float eb = (na == 0 || nb == 0) ? emptyBonus : 0;
+						Float cost = traversalCost + isectCost * (1 - eb) * (pBelow * nb + pAbove * na);
+						if (cost < bestCost) {
+							bestCost = cost;
+							bestAxis = axis;
+							bestPos = pos;
+							bestPlanarBelow = planarBelow != 0;
+						}
+					}
+				}
+				nBelow += pStart + pPlanar;
+			}
+		}
+
+		// Create leaf if no good splits were found
+		if (bestCost > oldCost) ++badRefines;
+		if ((bestCost > 4 * oldCost && nPrimitives < 16) || bestAxis == -1 || badRefines == 3) {
+			nodes[nodeNum].InitLeaf(primNums.data(), nPrimitives, &primitiveIndices);
+			return;
+		}
+
+		// Classify primitives with respect to split
+		for (int prim : primNums) primSide[prim] = KdBoth;
+		for (const KdEvent& e : events) {
+			if (e.axis != bestAxis) continue;
+			if (e.type == KdEventType::End && e.pos <= bestPos)
+				primSide[e.primNum] = KdBelow;
+			else if (e.type == KdEventType::Start && e.pos >= bestPos)
+				primSide[e.primNum] = KdAbove;
+			else if (e.type == KdEventType::Planar) {
+				if (e.pos < bestPos || (e.pos == bestPos && bestPlanarBelow))
+					primSide[e.primNum] = KdBelow;
+				else
+					primSide[e.primNum] = KdAbove;
+			}
+		}
+
+		// Split the sorted event list; one-sided primitives keep their order
+		Bounds3f bounds0 = nodeBounds, bounds1 = nodeBounds;
+		bounds0.pMax[bestAxis] = bounds1.pMin[bestAxis] = bestPos;
+		std::vector<KdEvent> events0, events1, straddle0, straddle1;
+		for (const KdEvent& e : events) {
+			if (primSide[e.primNum] == KdBelow)
+				events0.push_back(e);
+			else if (primSide[e.primNum] == KdAbove)
+				events1.push_back(e);
+		}
+		// Primitives on both sides get fresh events clipped to each child
+		for (int prim : primNums) {
+			if (primSide[prim] != KdBoth) continue;
+			AddEvents(prim, pbr::Intersect(primBounds[prim], bounds0), &straddle0);
+			AddEvents(prim, pbr::Intersect(primBounds[prim], bounds1), &straddle1);
+		}
+		std::sort(straddle0.begin(), straddle0.end());
+		std::sort(straddle1.begin(), straddle1.end());
+		std::vector<KdEvent> merged0(events0.size() + straddle0.size());
+		std::merge(events0.begin(), events0.end(), straddle0.begin(), straddle0.end(), merged0.begin());
+		std::vector<KdEvent> merged1(events1.size() + straddle1.size());
+		std::merge(events1.begin(), events1.end(), straddle1.begin(), straddle1.end(), merged1.begin());
+		std::vector<KdEvent>().swap(events);
+		std::vector<KdEvent>().swap(events0);
+		std::vector<KdEvent>().swap(events1);
+
+		// Recursively initialize children nodes
+		buildTree(nodeNum + 1, bounds0, merged0, depth - 1, badRefines);
+		int aboveChild = nextFreeNode;
+		nodes[nodeNum].InitInterior(bestAxis, aboveChild, bestPos);
+		buildTree(aboveChild, bounds1, merged1, depth - 1, badRefines);
+	}
+
+	bool KdTreeAccel::Intersect(const Ray& ray, SurfaceInteraction* isect) const {
+		// Compute initial parametric range of ray inside kd-tree extent
+		Float tMin, tMax;
+		if (!nodes || !bounds.IntersectP(ray, &tMin, &tMax)) return false;
+
+		// Prepare to traverse kd-tree for ray
+		Vector3f invDir(1 / ray.d.x, 1 / ray.d.y, 1 / ray.d.z);
+		constexpr int maxTodo = 64;
+		KdToDo todo[maxTodo];
+		int todoPos = 0;
+
+		// Traverse kd-tree nodes in order for ray
+		bool hit = false;
+		const KdAccelNode* node = &nodes[0];
+		while (node != nullptr) {
+			// Bail out if we found a hit closer than the current node
+			if (ray.tMax < tMin) break;
+			if (!node->IsLeaf()) {
+				// Compute parametric distance along ray to split plane
+				int axis = node->SplitAxis();
+				Float tPlane = (node->SplitPos() - ray.o[axis]) * invDir[axis];
+
+				// Get node children pointers for ray
+				const KdAccelNode *firstChild, *secondChild;
+				int belowFirst = (ray.o[axis] < node->SplitPos()) ||
+					(ray.o[axis] == node->SplitPos() && ray.d[axis] <= 0);
+				if (belowFirst) {
+					firstChild = node + 1;
+					secondChild = &nodes[node->AboveChild()];
+				} else {
+					firstChild = &nodes[node->AboveChild()];
+					secondChild = node + 1;
+				}
+
+				// Advance to next child node, possibly enqueue other child
+				if (tPlane > tMax || tPlane <= 0)
+					node = firstChild;
+				else if (tPlane < tMin)
+					node = secondChild;
+				else {
+					// Enqueue _secondChild_ in todo list
+					CHECK_LT(todoPos, maxTodo);
+					todo[todoPos].node = secondChild;
+					todo[todoPos].tMin = tPlane;
+					todo[todoPos].tMax = tMax;
+					++todoPos;
+					node = firstChild;
+					tMax = tPlane;
+				}
+			} else {
+				// Check for intersections inside leaf node
+				int nPrimitives = node->nPrimitives();
+				if (nPrimitives == 1) {
+					if (primitives[node->onePrimitive]->Intersect(ray, isect)) hit = true;
+				} else {
+					for (int i = 0; i < nPrimitives; ++i) {
+						int index = primitiveIndices[node->primitiveIndicesOffset + i];
+						if (primitives[index]->Intersect(ray, isect)) hit = true;
+					}
+				}
+
+				// Grab next node to process from todo list
+				if (todoPos > 0) {
+					--todoPos;
+					node = todo[todoPos].node;
+					tMin = todo[todoPos].tMin;
+					tMax = todo[todoPos].tMax;
+				} else
+					break;
+			}
+		}
+		return hit;
+	}
+
+	bool KdTreeAccel::IntersectP(const Ray& ray) const {
+		// Compute initial parametric range of ray inside kd-tree extent
+		Float tMin, tMax;
+		if (!nodes || !bounds.IntersectP(ray, &tMin, &tMax)) return false;
+
+		// Prepare to traverse kd-tree for ray
+		Vector3f invDir(1 / ray.d.x, 1 / ray.d.y, 1 / ray.d.z);
+		constexpr int maxTodo = 64;
+		KdToDo todo[maxTodo];
+		int todoPos = 0;
+		const KdAccelNode* node = &nodes[0];
+		while (node != nullptr) {
+			if (node->IsLeaf()) {
+				// Check for shadow ray intersections inside leaf node
+				int nPrimitives = node->nPrimitives();
+				if (nPrimitives == 1) {
+					if (primitives[node->onePrimitive]->IntersectP(ray)) return true;
+				} else {
+					for (int i = 0; i < nPrimitives; ++i) {
+						int index = primitiveIndices[node->primitiveIndicesOffset + i];
+						if (primitives[index]->IntersectP(ray)) return true;
+					}
+				}
+
+				// Grab next node to process from todo list
+				if (todoPos > 0) {
+					--todoPos;
+					node = todo[todoPos].node;
+					tMin = todo[todoPos].tMin;
+					tMax = todo[todoPos].tMax;
+				} else
+					break;
+			} else {
+				// Process kd-tree interior node
+				int axis = node->SplitAxis();
+				Float tPlane = (node->SplitPos() - ray.o[axis]) * invDir[axis];
+
+				const KdAccelNode *firstChild, *secondChild;
+				int belowFirst = (ray.o[axis] < node->SplitPos()) ||
+					(ray.o[axis] == node->SplitPos() && ray.d[axis] <= 0);
+				if (belowFirst) {
+					firstChild = node + 1;
+					secondChild = &nodes[node->AboveChild()];
+				} else {
+					firstChild = &nodes[node->AboveChild()];
+					secondChild = node + 1;
+				}
+
+				if (tPlane > tMax || tPlane <= 0)
+					node = firstChild;
+				else if (tPlane < tMin)
+					node = secondChild;
+				else {
+					CHECK_LT(todoPos, maxTodo);
+					todo[todoPos].node = secondChild;
+					todo[todoPos].tMin = tPlane;
+					todo[todoPos].tMax = tMax;
+					++todoPos;
+					node = firstChild;
+					tMax = tPlane;
+				}
+			}
+		}
+		return false;
+	}
+
+	std::shared_ptr<KdTreeAccel> CreateKdTreeAccelerator(std::vector<std::shared_ptr<Primitive>> prims,
+		const ParamSet& ps) {
+		int isectCost = ps.FindOneInt("intersectcost", 80);
+		int travCost = ps.FindOneInt("traversalcost", 1);
+		Float emptyBonus = ps.FindOneFloat("emptybonus", 0.5f);
+		int maxPrims = ps.FindOneInt("maxprims", 1);
+		int maxDepth = ps.FindOneInt("maxdepth", -1);
+		return std::make_shared<KdTreeAccel>(std::move(prims), isectCost, travCost, emptyBonus, maxPrims,
+			maxDepth);
+	}
+
+}  // namespace pbr
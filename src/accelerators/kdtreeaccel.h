@@ -0,0 +1,47 @@
+#ifndef ACCELERATORS_KDTREEACCEL_H
+#define ACCELERATORS_KDTREEACCEL_H
+
+#include "pbr.h"
+#include "primitive.h"
+
+namespace pbr {
+
+	// KdTreeAccel Declarations
+	struct KdAccelNode;
+	struct KdEvent;
+
+	class KdTreeAccel : public Aggregate {
+	public:
+		KdTreeAccel(std::vector<std::shared_ptr<Primitive>> p, int isectCost = 80, int traversalCost = 1,
+			Float emptyBonus = 0.5, int maxPrims = 1, int maxDepth = -1);
+		~KdTreeAccel();
+
+		Bounds3f WorldBound() const { return bounds; }
+		bool Intersect(const Ray& ray, SurfaceInteraction* isect) const;
+		bool IntersectP(const Ray& ray) const;
+
+		int TotalNodes() const { return nextFreeNode; }
+
+	private:
+		// KdTreeAccel Private Methods
+		void buildTree(int nodeNum, const Bounds3f& nodeBounds, std::vector<KdEvent>& events,
+			int depth, int badRefines);
+
+		// KdTreeAccel Private Data
+		const int isectCost, traversalCost, maxPrims;
+		const Float emptyBonus;
+		std::vector<std::shared_ptr<Primitive>> primitives;
+		std::vector<int> primitiveIndices;
+		std::vector<Bounds3f> primBounds;
+		std::vector<uint8_t> primSide;  // build-time classification scratch
+		KdAccelNode* nodes = nullptr;
+		int nAllocedNodes = 0, nextFreeNode = 0;
+		Bounds3f bounds;
+	};
+
+	std::shared_ptr<KdTreeAccel> CreateKdTreeAccelerator(std::vector<std::shared_ptr<Primitive>> prims,
+		const ParamSet& ps);
+
+}  // namespace pbr
+
+#endif  // ACCELERATORS_KDTREEACCEL_H
@@ -0,0 +1,69 @@
+#include "bench/bench.h"
+#include "geometry.h"
+#include "primitive.h"
+#include "accelerators/bvh.h"
+#include "accelerators/kdtreeaccel.h"
+#include <random>
+
+using namespace pbr;
+
+// Box that reports its entry distance through ray.tMax; stands in for
+// real shapes so only traversal cost is measured.
+class BoxPrimitive : public Primitive {
+public:
+	BoxPrimitive(const Bounds3f& b) : bounds(b) {}
+	Bounds3f WorldBound() const { return bounds; }
+	bool Intersect(const Ray& r, SurfaceInteraction*) const {
+		Float t0;
+		if (!bounds.IntersectP(r, &t0) || t0 >= r.tMax) return false;
+		r.tMax = t0;
+		return true;
+	}
+	bool IntersectP(const Ray& r) const { return bounds.IntersectP(r); }
+
+private:
+	Bounds3f bounds;
+};
+
+static std::vector<std::shared_ptr<Primitive>> RandomBoxes(int n, uint32_t seed) {
+	std::mt19937 rng(seed);
+	std::uniform_real_distribution<Float> pos(-10, 10), size(0.05f, 0.5f);
+	std::vector<std::shared_ptr<Primitive>> prims;
+	for (int i = 0; i < n; ++i) {
+		Point3f p(pos(rng), pos(rng), pos(rng));
+		prims.push_back(std::make_shared<BoxPrimitive>(
+			Bounds3f(p, p + Vector3f(size(rng), size(rng), size(rng)))));
+	}
+	return prims;
+}
+
+static std::vector<Ray> RandomRays(int n, uint32_t seed) {
+	std::mt19937 rng(seed);
+	std::uniform_real_distribution<Float> pos(-12, 12), dir(-1, 1);
+	std::vector<Ray> rays;
+	for (int i = 0; i < n; ++i)
+		rays.push_back(Ray(Point3f(pos(rng), pos(rng), pos(rng)), Vector3f(dir(rng), dir(rng), dir(rng))));
+	return rays;
+}
+
+static double TraceRays(const Primitive& accel, int64_t iterations) {
+	static const std::vector<Ray> rays = RandomRays(4096, 7);
+	double sum = 0;
+	for (int64_t i = 0; i < iterations; ++i) {
+		Ray r = rays[i & 4095];
+		if (accel.Intersect(r, nullptr)) sum += r.tMax;
+	}
+	return sum;
+}
+
+static double BVHIntersect(int64_t iterations) {
+	static const BVHAccel bvh(RandomBoxes(100000, 1), 4);
+	return TraceRays(bvh, iterations);
+}
+PBR_BENCHMARK(BVHIntersect);
+
+static double KdTreeIntersect(int64_t iterations) {
+	static const KdTreeAccel kdtree(RandomBoxes(100000, 1));
+	return TraceRays(kdtree, iterations);
+}
+PBR_BENCHMARK(KdTreeIntersect);
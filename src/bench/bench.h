@@ -0,0 +1,30 @@
+#ifndef BENCH_BENCH_H
+#define BENCH_BENCH_H
+
+#include "pbr.h"
+#include <functional>
+
+namespace pbr {
+
+	// A benchmark performs the given number of iterations of its kernel and
+	// returns a value derived from the results, so that the work can't be
+	// optimized away.
+	typedef std::function<double(int64_t iterations)> BenchmarkFunc;
+
+	bool RegisterBenchmark(const char* name, BenchmarkFunc func);
+
+	// Also reports the running benchmark's throughput in GB/s, given the
+	// bytes each iteration processes; usually called from its setup
+	void SetBenchmarkBytes(int64_t bytesPerIteration);
+
+	// Runs every benchmark whose name contains filter, doubling the
+	// iteration count until a run takes at least minSeconds, and prints
+	// the throughput. Returns the number of benchmarks run.
+	int RunBenchmarks(const std::string& filter, double minSeconds);
+
+}  // namespace pbr
+
+#define PBR_BENCHMARK(func) \
+	static bool func##_registered = pbr::RegisterBenchmark(#func, func)
+
+#endif  // BENCH_BENCH_H
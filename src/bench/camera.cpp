@@ -0,0 +1,78 @@
+#include "bench/bench.h"
+#include "cameras/perspective.h"
+#include "film.h"
+#include "filters/box.h"
+#include "rng.h"
+
+using namespace pbr;
+
+// Rates are in rays per second with both differentials, 256 samples at a
+// time: one GenerateRay() per ray and differential against a single packet
+
+static const int PacketSize = 256;
+
+static std::unique_ptr<Film> MakeFilm() {
+	return std::unique_ptr<Film>(new Film(Point2i(1920, 1080), Bounds2f(Point2f(0, 0), Point2f(1, 1)),
+		std::unique_ptr<Filter>(new BoxFilter(Vector2f(0.5f, 0.5f))), "camera.pfm"));
+}
+
+static std::vector<CameraSample> MakeSamples() {
+	// A 16x16 pixel tile with one jittered sample per pixel
+	std::vector<CameraSample> samples(PacketSize);
+	RNG rng;
+	for (int i = 0; i < PacketSize; ++i) {
+		samples[i].pFilm = Point2f(i % 16 + rng.UniformFloat(), i / 16 + rng.UniformFloat());
+		samples[i].pLens = Point2f(rng.UniformFloat(), rng.UniformFloat());
+		samples[i].time = rng.UniformFloat();
+	}
+	return samples;
+}
+
+static double RayLoop(Float lensRadius, int64_t iterations) {
+	std::unique_ptr<Film> film = MakeFilm();
+	Transform cameraToWorld = Inverse(LookAt(Point3f(1, 2, 3), Point3f(0, 0, 0), Vector3f(0, 1, 0)));
+	PerspectiveCamera camera(cameraToWorld, Bounds2f(Point2f(-1.78f, -1), Point2f(1.78f, 1)), 0, 1,
+		lensRadius, 5, 60, film.get());
+	std::vector<CameraSample> samples = MakeSamples();
+	double sum = 0;
+	for (int64_t n = 0; n < iterations; n += PacketSize) {
+		for (const CameraSample& sample : samples) {
+			Ray ray, rx, ry;
+			CameraSample sx = sample, sy = sample;
+			sx.pFilm.x += 1;
+			sy.pFilm.y += 1;
+			camera.GenerateRay(sample, &ray);
+			camera.GenerateRay(sx, &rx);
+			camera.GenerateRay(sy, &ry);
+			sum += ray.d.x + rx.d.y + ry.o.z;
+		}
+	}
+	return sum;
+}
+
+static double PacketLoop(Float lensRadius, int64_t iterations) {
+	std::unique_ptr<Film> film = MakeFilm();
+	Transform cameraToWorld = Inverse(LookAt(Point3f(1, 2, 3), Point3f(0, 0, 0), Vector3f(0, 1, 0)));
+	PerspectiveCamera camera(cameraToWorld, Bounds2f(Point2f(-1.78f, -1), Point2f(1.78f, 1)), 0, 1,
+		lensRadius, 5, 60, film.get());
+	std::vector<CameraSample> samples = MakeSamples();
+	CameraRayPacket rays;
+	double sum = 0;
+	for (int64_t n = 0; n < iterations; n += PacketSize) {
+		camera.GenerateRays(&samples[0], PacketSize, &rays);
+		for (int i = 0; i < PacketSize; ++i) sum += rays.d.x[i] + rays.rxDirection.y[i] + rays.ryOrigin.z[i];
+	}
+	return sum;
+}
+
+static double CameraPinholeRays(int64_t iterations) { return RayLoop(0, iterations); }
+PBR_BENCHMARK(CameraPinholeRays);
+
+static double CameraPinholePackets(int64_t iterations) { return PacketLoop(0, iterations); }
+PBR_BENCHMARK(CameraPinholePackets);
+
+static double CameraThinLensRays(int64_t iterations) { return RayLoop(0.1f, iterations); }
+PBR_BENCHMARK(CameraThinLensRays);
+
+static double CameraThinLensPackets(int64_t iterations) { return PacketLoop(0.1f, iterations); }
+PBR_BENCHMARK(CameraThinLensPackets);
@@ -0,0 +1,107 @@
+#include "bench/bench.h"
+#include "checkpoint.h"
+#include "film.h"
+#include "filters/box.h"
+#include "filters/gaussian.h"
+#include "parallel.h"
+#include <cstdio>
+
+using namespace pbr;
+
+static Film& BenchFilm() {
+	static Film film(Point2i(1920, 1080), Bounds2f(Point2f(0, 0), Point2f(1, 1)),
+		std::unique_ptr<Filter>(new BoxFilter(Vector2f(0.5f, 0.5f))), "bench.pfm");
+	return film;
+}
+
+// Scattered splats from all cores, as from light tracing
+static double FilmAddSplatParallel(int64_t iterations) {
+	Film& film = BenchFilm();
+	ParallelFor([&](int64_t i) {
+		// Cheap hash to spread the splats over the image
+		uint64_t h = (uint64_t)i * 0x9E3779B97F4A7C15ull;
+		Point2f p(Float((h >> 20) % 1920) + 0.5f, Float((h >> 40) % 1080) + 0.5f);
+		RGBSpectrum v(1);
+		film.AddSplat(p, v);
+	}, iterations, 4096);
+	return iterations;
+}
+PBR_BENCHMARK(FilmAddSplatParallel);
+
+// Every core filling and merging 16x16 tiles at one sample per pixel, so
+// merging dominates; the rate is in pixels
+static double FilmMergeTilesParallel(int64_t iterations) {
+	Film& film = BenchFilm();
+	const int tileSize = 16;
+	Bounds2i sampleBounds = film.GetSampleBounds();
+	Point2i nTiles((sampleBounds.pMax.x - sampleBounds.pMin.x + tileSize - 1) / tileSize,
+		(sampleBounds.pMax.y - sampleBounds.pMin.y + tileSize - 1) / tileSize);
+	int64_t tilesPerImage = (int64_t)nTiles.x * nTiles.y;
+	int64_t nTileRuns = std::max<int64_t>(1, iterations / (tileSize * tileSize));
+	ParallelFor([&](int64_t i) {
+		int64_t t = i % tilesPerImage;
+		Point2i p0 = sampleBounds.pMin + Point2i(int(t % nTiles.x), int(t / nTiles.x)) * tileSize;
+		Point2i p1 = Min(p0 + Point2i(tileSize, tileSize), sampleBounds.pMax);
+		std::unique_ptr<FilmTile> tile = film.GetFilmTile(Bounds2i(p0, p1));
+		RGBSpectrum L(1);
+		for (int y = p0.y; y < p1.y; ++y)
+			for (int x = p0.x; x < p1.x; ++x) tile->AddSample(Point2f(x + 0.5f, y + 0.5f), L);
+		film.MergeFilmTile(std::move(tile));
+	}, nTileRuns);
+	return nTileRuns;
+}
+PBR_BENCHMARK(FilmMergeTilesParallel);
+
+// Single-threaded tile accumulation with a radius 2 Gaussian: 16 pixels per
+// sample, weighted through the Film's filter table
+static double FilmTileAddSampleGaussian(int64_t iterations) {
+	static Film film(Point2i(64, 64), Bounds2f(Point2f(0, 0), Point2f(1, 1)),
+		std::unique_ptr<Filter>(new GaussianFilter(Vector2f(2, 2), 2)), "bench.pfm");
+	std::unique_ptr<FilmTile> tile = film.GetFilmTile(film.GetSampleBounds());
+	RGBSpectrum L(1);
+	for (int64_t i = 0; i < iterations; ++i) {
+		uint64_t h = (uint64_t)i * 0x9E3779B97F4A7C15ull;
+		tile->AddSample(Point2f(4 + (h >> 40) % 56 + 0.37f, 4 + (h >> 20) % 56 + 0.61f), L);
+	}
+	return tile->GetPixel(Point2i(10, 10)).filterWeightSum;
+}
+PBR_BENCHMARK(FilmTileAddSampleGaussian);
+
+// The same support evaluated directly, which AddSample() used to cost
+static double GaussianFilterEvaluate16(int64_t iterations) {
+	GaussianFilter filter(Vector2f(2, 2), 2);
+	Float sum = 0;
+	for (int64_t i = 0; i < iterations; ++i) {
+		Point2f p(0.37f + Float(i & 7) * 1e-3f, 0.61f);
+		for (int y = -2; y < 2; ++y)
+			for (int x = -2; x < 2; ++x) sum += filter.Evaluate(Point2f(x + p.x, y + p.y));
+	}
+	return sum;
+}
+PBR_BENCHMARK(GaussianFilterEvaluate16);
+
+// What render threads pay per checkpoint of a 1080p film: capturing the
+// state. The rate is in pixels.
+static double FilmGetState(int64_t iterations) {
+	Film& film = BenchFilm();
+	std::vector<Float> state;
+	int64_t nPixels = film.croppedPixelBounds.SurfaceArea();
+	int64_t n = std::max<int64_t>(1, iterations / nPixels);
+	for (int64_t i = 0; i < n; ++i) film.GetState(&state);
+	return n * nPixels;
+}
+PBR_BENCHMARK(FilmGetState);
+
+// What the background thread pays to write the same checkpoint
+static double WriteFilmCheckpoint(int64_t iterations) {
+	Film& film = BenchFilm();
+	RenderCheckpoint cp;
+	cp.pixelBounds = film.croppedPixelBounds;
+	film.GetState(&cp.filmState);
+	int64_t nPixels = film.croppedPixelBounds.SurfaceArea();
+	int64_t n = std::max<int64_t>(1, iterations / nPixels);
+	for (int64_t i = 0; i < n; ++i) WriteCheckpoint("bench.ckpt", cp);
+	std::remove("bench.ckpt");
+	return n * nPixels;
+}
+PBR_BENCHMARK(WriteFilmCheckpoint);
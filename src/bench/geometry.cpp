@@ -0,0 +1,97 @@
+#include "bench/bench.h"
+#include "geometry.h"
+#include <random>
+
+using namespace pbr;
+
+static std::vector<Vector3f> RandomVectors(int n, uint32_t seed) {
+	std::mt19937 rng(seed);
+	std::uniform_real_distribution<Float> u(-1, 1);
+	std::vector<Vector3f> v(n);
+	for (Vector3f& w : v) w = Vector3f(u(rng), u(rng), u(rng) + 2);
+	return v;
+}
+
+static double NormalizeCross(int64_t iterations) {
+	static const std::vector<Vector3f> v = RandomVectors(1024, 1);
+	Vector3f sum;
+	for (int64_t i = 0; i < iterations; ++i) {
+		const Vector3f& a = v[i & 1023];
+		const Vector3f& b = v[(i + 1) & 1023];
+		sum += Normalize(Cross(a, b));
+	}
+	return sum.x + sum.y + sum.z;
+}
+PBR_BENCHMARK(NormalizeCross);
+
+static double BoundsIntersectP(int64_t iterations) {
+	static const std::vector<Vector3f> v = RandomVectors(1024, 2);
+	const Bounds3f b(Point3f(-1, -1, -1), Point3f(1, 1, 1));
+	int hits = 0;
+	for (int64_t i = 0; i < iterations; ++i) {
+		Ray r(Point3f(0, 0, -4), v[i & 1023]);
+		Vector3f invDir(1 / r.d.x, 1 / r.d.y, 1 / r.d.z);
+		int dirIsNeg[3] = { invDir.x < 0, invDir.y < 0, invDir.z < 0 };
+		hits += b.IntersectP(r, invDir, dirIsNeg);
+	}
+	return hits;
+}
+PBR_BENCHMARK(BoundsIntersectP);
+
+static std::vector<Normal3f> RandomNormals(int n, uint32_t seed) {
+	std::vector<Normal3f> normals;
+	for (const Vector3f& v : RandomVectors(n, seed)) normals.push_back(Normalize(Normal3f(v)));
+	return normals;
+}
+
+static double CompressNormalsScalar(int64_t iterations) {
+	static const std::vector<Normal3f> n = RandomNormals(1024, 3);
+	std::vector<CompressedNormal> cn(1024);
+	double sum = 0;
+	for (int64_t i = 0; i < iterations; i += 1024) {
+		for (int j = 0; j < 1024; ++j) cn[j] = CompressedNormal(n[j]);
+		sum += cn[i & 1023].x;
+	}
+	return sum;
+}
+PBR_BENCHMARK(CompressNormalsScalar);
+
+static double CompressNormalsBatch(int64_t iterations) {
+	static const std::vector<Normal3f> n = RandomNormals(1024, 3);
+	std::vector<CompressedNormal> cn(1024);
+	double sum = 0;
+	for (int64_t i = 0; i < iterations; i += 1024) {
+		EncodeNormals(n.data(), 1024, cn.data());
+		sum += cn[i & 1023].x;
+	}
+	return sum;
+}
+PBR_BENCHMARK(CompressNormalsBatch);
+
+static double DecodeNormalsScalar(int64_t iterations) {
+	static const std::vector<Normal3f> n = RandomNormals(1024, 4);
+	std::vector<CompressedNormal> cn(1024);
+	EncodeNormals(n.data(), 1024, cn.data());
+	std::vector<Normal3f> out(1024);
+	double sum = 0;
+	for (int64_t i = 0; i < iterations; i += 1024) {
+		for (int j = 0; j < 1024; ++j) out[j] = cn[j].Decode();
+		sum += out[i & 1023].z;
+	}
+	return sum;
+}
+PBR_BENCHMARK(DecodeNormalsScalar);
+
+static double DecodeNormalsBatch(int64_t iterations) {
+	static const std::vector<Normal3f> n = RandomNormals(1024, 4);
+	std::vector<CompressedNormal> cn(1024);
+	EncodeNormals(n.data(), 1024, cn.data());
+	std::vector<Normal3f> out(1024);
+	double sum = 0;
+	for (int64_t i = 0; i < iterations; i += 1024) {
+		DecodeNormals(cn.data(), 1024, out.data());
+		sum += out[i & 1023].z;
+	}
+	return sum;
+}
+PBR_BENCHMARK(DecodeNormalsBatch);
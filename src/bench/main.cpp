@@ -0,0 +1,77 @@
+#include "bench/bench.h"
+#include <chrono>
+#include <cstdio>
+
+namespace pbr {
+
+	struct BenchmarkEntry {
+		const char* name;
+		BenchmarkFunc func;
+	};
+
+	static std::vector<BenchmarkEntry>& Registry() {
+		static std::vector<BenchmarkEntry> benchmarks;
+		return benchmarks;
+	}
+
+	static int64_t benchmarkBytes;
+
+	bool RegisterBenchmark(const char* name, BenchmarkFunc func) {
+		Registry().push_back({ name, std::move(func) });
+		return true;
+	}
+
+	void SetBenchmarkBytes(int64_t bytesPerIteration) { benchmarkBytes = bytesPerIteration; }
+
+	int RunBenchmarks(const std::string& filter, double minSeconds) {
+		int nRun = 0;
+		for (const BenchmarkEntry& b : Registry()) {
+			if (!filter.empty() && std::string(b.name).find(filter) == std::string::npos) continue;
+			// Untimed first call so one-time setup (scene construction) isn't measured
+			benchmarkBytes = 0;
+			double sink = b.func(1), seconds = 0;
+			int64_t iterations = 1;
+			for (;;) {
+				auto start = std::chrono::steady_clock::now();
+				sink += b.func(iterations);
+				seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+				if (seconds >= minSeconds || iterations >= (int64_t(1) << 40)) break;
+				iterations *= 2;
+			}
+			printf("%-32s %12.2f Mops/s %10.2f ns/op", b.name, iterations / seconds * 1e-6,
+				seconds * 1e9 / iterations);
+			if (benchmarkBytes > 0) printf(" %8.2f GB/s", benchmarkBytes * (double)iterations / seconds * 1e-9);
+			printf("  (sink %g)\n", sink);
+			++nRun;
+		}
+		return nRun;
+	}
+
+}  // namespace pbr
+
+using namespace pbr;
+
+static void usage(const char* msg = nullptr) {
+	if (msg) fprintf(stderr, "pbr_bench: %s\n\n", msg);
+	fprintf(stderr, "usage: pbr_bench [--min-time <seconds>] [filter]\n");
+	exit(msg ? 1 : 0);
+}
+
+int main(int argc, char* argv[]) {
+	google::InitGoogleLogging(argv[0]);
+	std::string filter;
+	double minSeconds = 0.5;
+	for (int i = 1; i < argc; ++i) {
+		if (!strcmp(argv[i], "--min-time")) {
+			if (i + 1 == argc) usage("missing value after --min-time argument");
+			minSeconds = atof(argv[++i]);
+		} else if (!strcmp(argv[i], "--help") || !strcmp(argv[i], "-h"))
+			usage();
+		else
+			filter = argv[i];
+	}
+
+	printf("Float is %d-bit\n", (int)(8 * sizeof(Float)));
+	if (RunBenchmarks(filter, minSeconds) == 0) usage("no benchmarks match the filter");
+	return 0;
+}
@@ -0,0 +1,167 @@
+#include "bench/bench.h"
+#include "api.h"
+#include "binaryscene.h"
+#include "paramset.h"
+#include "parser.h"
+#include "primitive.h"
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+
+using namespace pbr;
+
+// Keeps only a checksum of the shapes' positions
+class ShapeSumTarget : public ParserTarget {
+public:
+	void pbrtIdentity() {}
+	void pbrtTranslate(Float, Float, Float) {}
+	void pbrtRotate(Float, Float, Float, Float) {}
+	void pbrtScale(Float, Float, Float) {}
+	void pbrtLookAt(Float, Float, Float, Float, Float, Float, Float, Float, Float) {}
+	void pbrtConcatTransform(const Float[16]) {}
+	void pbrtTransform(const Float[16]) {}
+	void pbrtCoordinateSystem(const std::string&) {}
+	void pbrtCoordSysTransform(const std::string&) {}
+	void pbrtReverseOrientation() {}
+	void pbrtPixelFilter(const std::string&, const ParamSet&) {}
+	void pbrtFilm(const std::string&, const ParamSet&) {}
+	void pbrtSampler(const std::string&, const ParamSet&) {}
+	void pbrtAccelerator(const std::string&, const ParamSet&) {}
+	void pbrtCamera(const std::string&, const ParamSet&) {}
+	void pbrtWorldBegin() {}
+	void pbrtAttributeBegin() {}
+	void pbrtAttributeEnd() {}
+	void pbrtTransformBegin() {}
+	void pbrtTransformEnd() {}
+	void pbrtMaterial(const std::string&, const ParamSet&) {}
+	void pbrtMakeNamedMaterial(const std::string&, const ParamSet&) {}
+	void pbrtNamedMaterial(const std::string&) {}
+	void pbrtShape(const std::string&, const ParamSet& params) {
+		int n;
+		const Point3f* p = params.FindPoint3f("P", &n);
+		if (p) sum += p[n - 1].x;
+	}
+	void pbrtObjectBegin(const std::string&) {}
+	void pbrtObjectEnd() {}
+	void pbrtObjectInstance(const std::string&) {}
+	void pbrtWorldEnd() {}
+
+	double sum = 0;
+};
+
+// A scene of nMeshes 256x256 vertex height fields, each in its own file
+// when split; 587k numbers per mesh
+struct HeightFieldScene {
+	HeightFieldScene(const std::string& filename, int nMeshes, bool split) : filename(filename) {
+		std::ofstream out(filename);
+		out << "WorldBegin\n";
+		for (int m = 0; m < nMeshes; ++m) {
+			std::unique_ptr<std::ofstream> meshOut;
+			if (split) {
+				meshes.push_back(filename + "." + std::to_string(m));
+				meshOut.reset(new std::ofstream(meshes.back()));
+				out << "Include \"" << meshes.back() << "\"\n";
+			}
+			std::ostream& mesh = split ? *meshOut : out;
+			const int res = 256;
+			mesh << "AttributeBegin\nTranslate " << m << " 0 0\nShape \"trianglemesh\" \"integer indices\" [\n";
+			for (int y = 0; y + 1 < res; ++y)
+				for (int x = 0; x + 1 < res; ++x) {
+					int v = y * res + x;
+					mesh << v << " " << v + 1 << " " << v + res + 1 << " " << v << " " << v + res + 1 << " " <<
+						v + res << "\n";
+				}
+			mesh << "] \"point P\" [\n";
+			char line[128];
+			for (int y = 0; y < res; ++y)
+				for (int x = 0; x < res; ++x) {
+					snprintf(line, sizeof(line), "%.6g %.6g %.6g\n", x / 255., y / 255.,
+						0.1 * std::sin(x * 0.1) * std::cos(y * 0.13));
+					mesh << line;
+				}
+			mesh << "]\nAttributeEnd\n";
+			if (split) bytes += (int64_t)meshOut->tellp();
+		}
+		out << "WorldEnd\n";
+		bytes += (int64_t)out.tellp();
+	}
+	~HeightFieldScene() {
+		std::remove(filename.c_str());
+		for (const std::string& m : meshes) std::remove(m.c_str());
+	}
+
+	std::string filename;
+	std::vector<std::string> meshes;
+	int64_t bytes = 0;
+};
+
+static double ParseScene(const HeightFieldScene& scene, int64_t iterations) {
+	SetBenchmarkBytes(scene.bytes);
+	double sum = 0;
+	for (int64_t i = 0; i < iterations; ++i) {
+		ShapeSumTarget target;
+		CHECK(ParseFile(scene.filename, &target));
+		sum += target.sum;
+	}
+	return sum;
+}
+
+// One file of 8 meshes, 4.7M numbers in all
+static double ParseSceneFile(int64_t iterations) {
+	static const HeightFieldScene scene("bench_scene.pbrt", 8, false);
+	return ParseScene(scene, iterations);
+}
+PBR_BENCHMARK(ParseSceneFile);
+
+// The same meshes, each Included from its own file
+static double ParseSceneIncludes(int64_t iterations) {
+	static const HeightFieldScene scene("bench_scene_split.pbrt", 8, true);
+	return ParseScene(scene, iterations);
+}
+PBR_BENCHMARK(ParseSceneIncludes);
+
+// A HeightFieldScene converted to a binary scene
+struct BinaryHeightFieldScene {
+	BinaryHeightFieldScene(const std::string& filename, int nMeshes)
+		: scene(filename + ".pbrt", nMeshes, false), filename(filename) {
+		BinarySceneWriter writer;
+		SceneBuilder converter(&writer);
+		CHECK(ParseFile(scene.filename, &converter) && writer.Write(filename));
+		std::ifstream file(filename, std::ios::binary | std::ios::ate);
+		bytes = (int64_t)file.tellg();
+	}
+	~BinaryHeightFieldScene() { std::remove(filename.c_str()); }
+
+	HeightFieldScene scene;
+	std::string filename;
+	int64_t bytes = 0;
+};
+
+// The meshes of ParseSceneFile loaded from a binary scene; the BVH over
+// their 1M triangles is most of the time
+static double LoadBinaryScene(int64_t iterations) {
+	static const BinaryHeightFieldScene scene("bench_scene.pbrb", 8);
+	SetBenchmarkBytes(scene.bytes);
+	double sum = 0;
+	for (int64_t i = 0; i < iterations; ++i) {
+		SceneBuilder builder(false);
+		CHECK(ReadBinaryScene(scene.filename, &builder));
+		sum += builder.GetAggregate()->WorldBound().pMax.x;
+	}
+	return sum;
+}
+PBR_BENCHMARK(LoadBinaryScene);
+
+// The same scene parsed and built
+static double BuildParsedScene(int64_t iterations) {
+	static const HeightFieldScene scene("bench_scene_build.pbrt", 8, false);
+	SetBenchmarkBytes(scene.bytes);
+	double sum = 0;
+	for (int64_t i = 0; i < iterations; ++i) {
+		SceneBuilder builder(false);
+		CHECK(ParseFile(scene.filename, &builder));
+		sum += builder.GetAggregate()->WorldBound().pMax.x;
+	}
+	return sum;
+}
+PBR_BENCHMARK(BuildParsedScene);
@@ -0,0 +1,70 @@
+#include "bench/bench.h"
+#include "film.h"
+#include "interaction.h"
+#include "primitive.h"
+#include "render.h"
+#include "accelerators/bvh.h"
+#include "filters/gaussian.h"
+#include "shapes/triangle.h"
+#include <cstdio>
+
+using namespace pbr;
+
+// Tessellated unit sphere behind a BVH, viewed orthographically along +z
+static std::shared_ptr<Primitive> SphereScene() {
+	const int nTheta = 128, nPhi = 256;
+	std::vector<Point3f> p;
+	for (int i = 0; i <= nTheta; ++i)
+		for (int j = 0; j <= nPhi; ++j) {
+			Float theta = Pi * i / nTheta, phi = 2 * Pi * j / nPhi;
+			p.push_back(Point3f(std::sin(theta) * std::cos(phi), std::sin(theta) * std::sin(phi), std::cos(theta)));
+		}
+	std::vector<int> indices;
+	for (int i = 0; i < nTheta; ++i)
+		for (int j = 0; j < nPhi; ++j) {
+			int v00 = i * (nPhi + 1) + j, v01 = v00 + 1, v10 = v00 + nPhi + 1, v11 = v10 + 1;
+			int quad[6] = { v00, v10, v11, v00, v11, v01 };
+			indices.insert(indices.end(), quad, quad + 6);
+		}
+	std::shared_ptr<TriangleMesh> mesh = std::make_shared<TriangleMesh>((int)indices.size() / 3,
+		indices.data(), (int)p.size(), p.data(), nullptr, nullptr, nullptr);
+	std::vector<std::shared_ptr<Primitive>> prims;
+	for (int i = 0; i < mesh->nTriangles; ++i)
+		prims.push_back(std::make_shared<GeometricPrimitive>(std::make_shared<Triangle>(mesh, i)));
+	return std::make_shared<BVHAccel>(std::move(prims), 4);
+}
+
+// Renders iterations samples in total at 256x256 and returns the sample count
+static double RenderSphere(int64_t iterations, int samplesPerPass, bool writeEachPass) {
+	static const std::shared_ptr<Primitive> scene = SphereScene();
+	const int res = 256;
+	int64_t spp = std::max<int64_t>(1, iterations / (res * res));
+	Film film(Point2i(res, res), Bounds2f(Point2f(0, 0), Point2f(1, 1)),
+		std::unique_ptr<Filter>(new GaussianFilter(Vector2f(1.5f, 1.5f), 2)), "bench_render.pfm");
+	ProgressiveOptions options;
+	options.samplesPerPass = samplesPerPass > 0 ? samplesPerPass : (int)spp;
+	options.maxSamples = spp;
+	options.writeEachPass = writeEachPass;
+	RenderProgressive(film, [&](FilmTile* tile, const Point2i& pixel, int64_t s) {
+		Point2f pFilm(pixel.x + ((s * 5 + 1) % 8) / 8.f, pixel.y + ((s * 3 + 2) % 8) / 8.f);
+		Ray ray(Point3f(2.4f * pFilm.x / res - 1.2f, 2.4f * pFilm.y / res - 1.2f, -2), Vector3f(0, 0, 1));
+		SurfaceInteraction isect;
+		RGBSpectrum L(0);
+		if (scene->Intersect(ray, &isect)) L = RGBSpectrum(std::abs(isect.n.z));
+		tile->AddSample(pFilm, L);
+	}, options);
+	std::remove("bench_render.pfm");
+	return double(spp) * res * res;
+}
+
+// All samples in a single pass, image written at the end
+static double RenderBatch(int64_t iterations) { return RenderSphere(iterations, 0, false); }
+PBR_BENCHMARK(RenderBatch);
+
+// One sample per pixel per pass, image written after every pass
+static double RenderProgressive1spp(int64_t iterations) { return RenderSphere(iterations, 1, true); }
+PBR_BENCHMARK(RenderProgressive1spp);
+
+// The default pass size, which keeps most of each pixel's coherence
+static double RenderProgressive8spp(int64_t iterations) { return RenderSphere(iterations, 8, true); }
+PBR_BENCHMARK(RenderProgressive8spp);
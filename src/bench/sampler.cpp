@@ -0,0 +1,87 @@
+#include "bench/bench.h"
+#include "samplers/halton.h"
+#include "samplers/random.h"
+#include "samplers/sobol.h"
+#include "samplers/stratified.h"
+
+using namespace pbr;
+
+// Rates are in 2D samples per second on one core: four 2D dimensions of
+// 16 samples per pixel, one pixel after another
+
+static double Get2DLoop(Sampler& sampler, int64_t iterations) {
+	double sum = 0;
+	for (int64_t n = 0, pixel = 0; n < iterations; ++pixel) {
+		sampler.StartPixel(Point2i(int(pixel % 1920), int(pixel / 1920 % 1080)));
+		do {
+			for (int d = 0; d < 4; ++d) {
+				Point2f u = sampler.Get2D();
+				sum += u.x + u.y;
+			}
+			n += 4;
+		} while (sampler.StartNextSample());
+	}
+	return sum;
+}
+
+static double BatchLoop(Sampler& sampler, int64_t iterations) {
+	double sum = 0;
+	Point2f samples[16];
+	for (int64_t n = 0, pixel = 0; n < iterations; ++pixel) {
+		sampler.StartPixel(Point2i(int(pixel % 1920), int(pixel / 1920 % 1080)));
+		for (int d = 0; d < 4; ++d) {
+			sampler.Get2DBatch(d, 0, 16, samples);
+			for (const Point2f& u : samples) sum += u.x + u.y;
+		}
+		n += 64;
+	}
+	return sum;
+}
+
+static double SamplerStratifiedGet2D(int64_t iterations) {
+	StratifiedSampler sampler(4, 4, true, 4);
+	return Get2DLoop(sampler, iterations);
+}
+PBR_BENCHMARK(SamplerStratifiedGet2D);
+
+static double SamplerStratifiedBatch(int64_t iterations) {
+	StratifiedSampler sampler(4, 4, true, 4);
+	return BatchLoop(sampler, iterations);
+}
+PBR_BENCHMARK(SamplerStratifiedBatch);
+
+static double SamplerHaltonGet2D(int64_t iterations) {
+	HaltonSampler sampler(16, Bounds2i(Point2i(0, 0), Point2i(1920, 1080)));
+	return Get2DLoop(sampler, iterations);
+}
+PBR_BENCHMARK(SamplerHaltonGet2D);
+
+static double SamplerHaltonBatch(int64_t iterations) {
+	HaltonSampler sampler(16, Bounds2i(Point2i(0, 0), Point2i(1920, 1080)));
+	return BatchLoop(sampler, iterations);
+}
+PBR_BENCHMARK(SamplerHaltonBatch);
+
+static double SamplerSobolGet2D(int64_t iterations) {
+	SobolSampler sampler(16);
+	return Get2DLoop(sampler, iterations);
+}
+PBR_BENCHMARK(SamplerSobolGet2D);
+
+static double SamplerSobolBatch(int64_t iterations) {
+	SobolSampler sampler(16);
+	return BatchLoop(sampler, iterations);
+}
+PBR_BENCHMARK(SamplerSobolBatch);
+
+static double SamplerRandomGet2D(int64_t iterations) {
+	RandomSampler sampler(16);
+	return Get2DLoop(sampler, iterations);
+}
+PBR_BENCHMARK(SamplerRandomGet2D);
+
+static double SamplerRandomBatch(int64_t iterations) {
+	RandomSampler sampler(16);
+	return BatchLoop(sampler, iterations);
+}
+PBR_BENCHMARK(SamplerRandomBatch);
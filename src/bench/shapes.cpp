@@ -0,0 +1,213 @@
+#include "bench/bench.h"
+#include "geometry.h"
+#include "geometrycache.h"
+#include "interaction.h"
+#include "primitive.h"
+#include "shapes/objmesh.h"
+#include "shapes/plymesh.h"
+#include "shapes/triangle.h"
+#include "accelerators/bvh.h"
+#include <cstdio>
+#include <fstream>
+#include <random>
+
+using namespace pbr;
+
+// Tessellated unit sphere with normals, tangents and uvs
+struct SphereMesh {
+	SphereMesh() {
+		const int nTheta = 256, nPhi = 512;
+		const Float Pi = 3.14159265358979f;
+		for (int i = 0; i <= nTheta; ++i)
+			for (int j = 0; j <= nPhi; ++j) {
+				Float theta = Pi * i / nTheta, phi = 2 * Pi * j / nPhi;
+				p.push_back(Point3f(std::sin(theta) * std::cos(phi), std::sin(theta) * std::sin(phi), std::cos(theta)));
+				n.push_back(Normal3f(Vector3f(p.back())));
+				s.push_back(Vector3f(-std::sin(phi), std::cos(phi), 0));
+				uv.push_back(Point2f(Float(j) / nPhi, Float(i) / nTheta));
+			}
+		for (int i = 0; i < nTheta; ++i)
+			for (int j = 0; j < nPhi; ++j) {
+				int v00 = i * (nPhi + 1) + j, v01 = v00 + 1, v10 = v00 + nPhi + 1, v11 = v10 + 1;
+				int quad[6] = { v00, v10, v11, v00, v11, v01 };
+				indices.insert(indices.end(), quad, quad + 6);
+			}
+	}
+	int nTriangles() const { return (int)indices.size() / 3; }
+
+	std::vector<Point3f> p;
+	std::vector<Normal3f> n;
+	std::vector<Vector3f> s;
+	std::vector<Point2f> uv;
+	std::vector<int> indices;
+};
+
+// The sphere behind a BVH
+static std::shared_ptr<Primitive> SphereBVH(const TriangleMeshStorage& storage) {
+	SphereMesh sphere;
+	std::shared_ptr<TriangleMesh> mesh = std::make_shared<TriangleMesh>(sphere.nTriangles(),
+		sphere.indices.data(), (int)sphere.p.size(), sphere.p.data(), sphere.s.data(), sphere.n.data(),
+		sphere.uv.data(), storage);
+	std::vector<std::shared_ptr<Primitive>> prims;
+	for (int i = 0; i < mesh->nTriangles; ++i)
+		prims.push_back(std::make_shared<GeometricPrimitive>(std::make_shared<Triangle>(mesh, i)));
+	return std::make_shared<BVHAccel>(std::move(prims), 4);
+}
+
+static double TraceSphere(const Primitive& sphere, int64_t iterations) {
+	static std::vector<Vector3f> dirs;
+	if (dirs.empty()) {
+		std::mt19937 rng(1);
+		std::normal_distribution<Float> g;
+		for (int i = 0; i < 4096; ++i) dirs.push_back(Vector3f(g(rng), g(rng), g(rng)));
+	}
+	double sum = 0;
+	for (int64_t i = 0; i < iterations; ++i) {
+		Ray r(Point3f(0, 0, 0), dirs[i & 4095]);
+		SurfaceInteraction isect;
+		if (sphere.Intersect(r, &isect)) sum += isect.uv.x + isect.shading.n.z;
+	}
+	return sum;
+}
+
+static double TriangleMeshFull(int64_t iterations) {
+	static const std::shared_ptr<Primitive> sphere = SphereBVH(TriangleMeshStorage());
+	return TraceSphere(*sphere, iterations);
+}
+PBR_BENCHMARK(TriangleMeshFull);
+
+static double TriangleMeshQuantized(int64_t iterations) {
+	static std::shared_ptr<Primitive> sphere;
+	if (!sphere) {
+		TriangleMeshStorage storage;
+		storage.compressNormals = storage.compressTangents = true;
+		storage.uvEncoding = UVEncoding::Unorm16;
+		sphere = SphereBVH(storage);
+	}
+	return TraceSphere(*sphere, iterations);
+}
+PBR_BENCHMARK(TriangleMeshQuantized);
+
+// The sphere paged in from a mesh file, once resident in the cache: the
+// overhead of the bounds test and micro-cache lookup per ray
+static double TriangleMeshPaged(int64_t iterations) {
+	static GeometryCache cache(1 << 30);
+	static std::shared_ptr<Primitive> sphere;
+	if (!sphere) {
+		SphereMesh mesh;
+		CHECK(WriteTriangleMeshFile("bench.mesh", mesh.nTriangles(), mesh.indices.data(), (int)mesh.p.size(),
+			mesh.p.data(), mesh.s.data(), mesh.n.data(), mesh.uv.data()));
+		sphere = PagedTriangleMesh::Open("bench.mesh", &cache);
+		// Page the mesh in before its file goes
+		sphere->IntersectP(Ray(Point3f(0, 0, 0), Vector3f(0, 0, 1)));
+		std::remove("bench.mesh");
+	}
+	return TraceSphere(*sphere, iterations);
+}
+PBR_BENCHMARK(TriangleMeshPaged);
+
+// The sphere as a PLY file of float positions, normals and uvs and int
+// triangles, removed when the benchmarks exit
+struct SpherePLYFile {
+	SpherePLYFile(const std::string& filename, bool binary) : filename(filename) {
+		SphereMesh sphere;
+		std::ofstream out(filename, std::ios::binary);
+		out << "ply\nformat " << (binary ? "binary_little_endian" : "ascii") << " 1.0\nelement vertex " <<
+			sphere.p.size() << "\nproperty float x\nproperty float y\nproperty float z\nproperty float nx\n"
+			"property float ny\nproperty float nz\nproperty float u\nproperty float v\nelement face " <<
+			sphere.nTriangles() << "\nproperty list uchar int vertex_indices\nend_header\n";
+		for (size_t i = 0; i < sphere.p.size(); ++i) {
+			float v[8] = { (float)sphere.p[i].x, (float)sphere.p[i].y, (float)sphere.p[i].z, (float)sphere.n[i].x,
+				(float)sphere.n[i].y, (float)sphere.n[i].z, (float)sphere.uv[i].x, (float)sphere.uv[i].y };
+			if (binary)
+				out.write((const char*)v, sizeof(v));
+			else {
+				char line[256];
+				sprintf(line, "%.9g %.9g %.9g %.9g %.9g %.9g %.9g %.9g\n", v[0], v[1], v[2], v[3], v[4], v[5], v[6],
+					v[7]);
+				out << line;
+			}
+		}
+		for (int t = 0; t < sphere.nTriangles(); ++t) {
+			const int* v = &sphere.indices[3 * t];
+			if (binary) {
+				out.put(3);
+				out.write((const char*)v, 3 * sizeof(int));
+			} else
+				out << "3 " << v[0] << " " << v[1] << " " << v[2] << "\n";
+		}
+	}
+	~SpherePLYFile() { std::remove(filename.c_str()); }
+
+	std::string filename;
+};
+
+// Reads of the 131k vertex, 262k triangle file, its pages already cached
+static double ReadPLY(const SpherePLYFile& file, int64_t iterations) {
+	double sum = 0;
+	for (int64_t i = 0; i < iterations; ++i) {
+		std::unique_ptr<PLYMesh> mesh = PLYMesh::Read(file.filename);
+		CHECK(mesh);
+		SetBenchmarkBytes(mesh->FileSize());
+		sum += mesh->p[mesh->nVertices / 2].x + mesh->vertexIndices[3 * mesh->nTriangles - 1];
+	}
+	return sum;
+}
+
+static double PLYReadBinary(int64_t iterations) {
+	static const SpherePLYFile file("bench_binary.ply", true);
+	return ReadPLY(file, iterations);
+}
+PBR_BENCHMARK(PLYReadBinary);
+
+static double PLYReadASCII(int64_t iterations) {
+	static const SpherePLYFile file("bench_ascii.ply", false);
+	return ReadPLY(file, iterations);
+}
+PBR_BENCHMARK(PLYReadASCII);
+
+// The sphere as an OBJ file of quads whose corners index positions, uvs
+// and normals separately
+struct SphereOBJFile {
+	SphereOBJFile(const std::string& filename) : filename(filename) {
+		SphereMesh sphere;
+		std::ofstream out(filename, std::ios::binary);
+		char line[256];
+		for (const Point3f& p : sphere.p) {
+			sprintf(line, "v %.9g %.9g %.9g\n", (float)p.x, (float)p.y, (float)p.z);
+			out << line;
+		}
+		for (const Point2f& uv : sphere.uv) {
+			sprintf(line, "vt %.9g %.9g\n", (float)uv.x, (float)uv.y);
+			out << line;
+		}
+		for (const Normal3f& n : sphere.n) {
+			sprintf(line, "vn %.9g %.9g %.9g\n", (float)n.x, (float)n.y, (float)n.z);
+			out << line;
+		}
+		for (int t = 0; t < sphere.nTriangles(); t += 2) {
+			const int* v = &sphere.indices[3 * t];
+			sprintf(line, "f %d/%d/%d %d/%d/%d %d/%d/%d %d/%d/%d\n", v[0] + 1, v[0] + 1, v[0] + 1, v[1] + 1,
+				v[1] + 1, v[1] + 1, v[2] + 1, v[2] + 1, v[2] + 1, v[5] + 1, v[5] + 1, v[5] + 1);
+			out << line;
+		}
+	}
+	~SphereOBJFile() { std::remove(filename.c_str()); }
+
+	std::string filename;
+};
+
+// Parse, triangulation and deduplication of the 131k vertex, 262k
+// triangle file
+static double OBJRead(int64_t iterations) {
+	static const SphereOBJFile file("bench_sphere.obj");
+	double sum = 0;
+	for (int64_t i = 0; i < iterations; ++i) {
+		std::unique_ptr<OBJMesh> mesh = OBJMesh::Read(file.filename);
+		CHECK(mesh);
+		SetBenchmarkBytes(mesh->FileSize());
+		sum += mesh->p[mesh->nVertices / 2].x + mesh->vertexIndices[3 * mesh->nTriangles - 1];
+	}
+	return sum;
+}
+PBR_BENCHMARK(OBJRead);
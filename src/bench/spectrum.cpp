@@ -0,0 +1,108 @@
+#include "bench/bench.h"
+#include "spectrum.h"
+#include <random>
+
+using namespace pbr;
+
+static const int NumSpectra = 1024;
+
+static std::vector<Float> RandomFloats(int n, uint32_t seed) {
+	std::mt19937 rng(seed);
+	std::uniform_real_distribution<Float> u(0, 1);
+	std::vector<Float> v(n);
+	for (Float& f : v) f = u(rng);
+	return v;
+}
+
+// Throughput weighting as along a path, beta *= f / pdf and L += beta * Le,
+// on the Float[3] triples the Film used to take
+static double SpectrumFloat3Path(int64_t iterations) {
+	static const std::vector<Float> f = RandomFloats(3 * NumSpectra, 1), le = RandomFloats(3 * NumSpectra, 2);
+	Float beta[3] = { 1, 1, 1 }, L[3] = { 0, 0, 0 };
+	for (int64_t i = 0; i < iterations; ++i) {
+		int j = 3 * (i & (NumSpectra - 1));
+		Float invPdf = 1 / (f[j] + 0.5f);
+		for (int c = 0; c < 3; ++c) {
+			beta[c] *= (f[j + c] + 0.5f) * invPdf;
+			L[c] += beta[c] * le[j + c];
+		}
+		if ((i & 15) == 15) beta[0] = beta[1] = beta[2] = 1;
+	}
+	return L[0] + L[1] + L[2];
+}
+PBR_BENCHMARK(SpectrumFloat3Path);
+
+static double SpectrumRGBPath(int64_t iterations) {
+	static std::vector<RGBSpectrum> f, le;
+	if (f.empty()) {
+		std::vector<Float> rf = RandomFloats(3 * NumSpectra, 1), rle = RandomFloats(3 * NumSpectra, 2);
+		for (int i = 0; i < NumSpectra; ++i) {
+			f.push_back(RGBSpectrum::FromRGB(&rf[3 * i]) + RGBSpectrum(0.5f));
+			le.push_back(RGBSpectrum::FromRGB(&rle[3 * i]));
+		}
+	}
+	RGBSpectrum beta(1), L(0);
+	for (int64_t i = 0; i < iterations; ++i) {
+		int j = i & (NumSpectra - 1);
+		beta *= f[j] / f[j][0];
+		L += beta * le[j];
+		if ((i & 15) == 15) beta = RGBSpectrum(1);
+	}
+	return L[0] + L[1] + L[2];
+}
+PBR_BENCHMARK(SpectrumRGBPath);
+
+// The same with NSpectrumSamples wavelengths
+static double SpectrumSampledPath(int64_t iterations) {
+	static std::vector<SampledSpectrum> f, le;
+	if (f.empty()) {
+		std::vector<Float> rf = RandomFloats(NSpectrumSamples * NumSpectra, 1);
+		std::vector<Float> rle = RandomFloats(NSpectrumSamples * NumSpectra, 2);
+		for (int i = 0; i < NumSpectra; ++i) {
+			SampledSpectrum a, b;
+			for (int k = 0; k < NSpectrumSamples; ++k) {
+				a[k] = rf[NSpectrumSamples * i + k] + 0.5f;
+				b[k] = rle[NSpectrumSamples * i + k];
+			}
+			f.push_back(a);
+			le.push_back(b);
+		}
+	}
+	SampledSpectrum beta(1), L(0);
+	for (int64_t i = 0; i < iterations; ++i) {
+		int j = i & (NumSpectra - 1);
+		beta *= f[j] / f[j][0];
+		L += beta * le[j];
+		if ((i & 15) == 15) beta = SampledSpectrum(1);
+	}
+	return L.Average();
+}
+PBR_BENCHMARK(SpectrumSampledPath);
+
+// Texture RGB to the path's wavelengths, as for every reflectance lookup
+static double SpectrumFromRGB(int64_t iterations) {
+	static const std::vector<Float> rgb = RandomFloats(3 * NumSpectra, 3);
+	SampledSpectrum sum;
+	for (int64_t i = 0; i < iterations; ++i) {
+		int j = i & (NumSpectra - 1);
+		SampledWavelengths lambda = SampledWavelengths::SampleVisible(Float(j) / NumSpectra);
+		sum += SampledSpectrum::FromRGB(RGBSpectrum::FromRGB(&rgb[3 * j]), lambda);
+	}
+	return sum.Average();
+}
+PBR_BENCHMARK(SpectrumFromRGB);
+
+// A path's radiance back to RGB for the Film
+static double SpectrumToRGB(int64_t iterations) {
+	static const std::vector<Float> v = RandomFloats(NSpectrumSamples * NumSpectra, 4);
+	RGBSpectrum sum;
+	for (int64_t i = 0; i < iterations; ++i) {
+		int j = i & (NumSpectra - 1);
+		SampledWavelengths lambda = SampledWavelengths::SampleVisible(Float(j) / NumSpectra);
+		SampledSpectrum L;
+		for (int k = 0; k < NSpectrumSamples; ++k) L[k] = v[NSpectrumSamples * j + k];
+		sum += L.ToRGB(lambda);
+	}
+	return sum.Average();
+}
+PBR_BENCHMARK(SpectrumToRGB);
@@ -0,0 +1,137 @@
+#include "bench/bench.h"
+#include "memory.h"
+#include "mipmap.h"
+#include "rng.h"
+#include <cstdio>
+
+using namespace pbr;
+
+// Rates are in bilinear lookups per second in a 4096x4096 single-channel
+// image, far larger than the caches: row-major storage against 4x4 blocks.
+// Lookups are either at independent random points, or walk 256 texels at a
+// time in a random direction as a rotated texture would.
+
+static const int ImageRes = 4096;
+static const int NumPoints = 1 << 16;
+
+static std::vector<Point2f> MakePoints(bool walk) {
+	std::vector<Point2f> points(NumPoints);
+	RNG rng;
+	for (int i = 0; i < NumPoints; i += 256) {
+		Point2f p0(rng.UniformFloat() * (ImageRes - 1), rng.UniformFloat() * (ImageRes - 1));
+		Float phi = 2 * Pi * rng.UniformFloat();
+		for (int j = 0; j < 256; ++j) {
+			if (!walk)
+				points[i + j] = Point2f(rng.UniformFloat() * (ImageRes - 1), rng.UniformFloat() * (ImageRes - 1));
+			else
+				points[i + j] = Point2f(Clamp(p0.x + j * std::cos(phi), 0, ImageRes - 1.01f),
+					Clamp(p0.y + j * std::sin(phi), 0, ImageRes - 1.01f));
+		}
+	}
+	return points;
+}
+
+static std::vector<Float> MakeImage() {
+	std::vector<Float> image((size_t)ImageRes * ImageRes);
+	for (size_t i = 0; i < image.size(); ++i) image[i] = Float(i & 1023);
+	return image;
+}
+
+template <typename Fetch>
+static double BilerpLoop(const Fetch& texel, bool walk, int64_t iterations) {
+	static const std::vector<Point2f> randomPoints = MakePoints(false), walkPoints = MakePoints(true);
+	const std::vector<Point2f>& points = walk ? walkPoints : randomPoints;
+	double sum = 0;
+	for (int64_t n = 0; n < iterations; ++n) {
+		const Point2f& p = points[n & (NumPoints - 1)];
+		int s0 = (int)p.x, t0 = (int)p.y;
+		Float ds = p.x - s0, dt = p.y - t0;
+		sum += (1 - ds) * (1 - dt) * texel(s0, t0) + (1 - ds) * dt * texel(s0, t0 + 1) +
+			ds * (1 - dt) * texel(s0 + 1, t0) + ds * dt * texel(s0 + 1, t0 + 1);
+	}
+	return sum;
+}
+
+static const std::vector<Float>& FlatImage() {
+	static const std::vector<Float> image = MakeImage();
+	return image;
+}
+
+static const BlockedArray<Float>& BlockedImage() {
+	static const BlockedArray<Float> image(ImageRes, ImageRes, FlatImage().data());
+	return image;
+}
+
+static double TextureFlatRandom(int64_t iterations) {
+	const std::vector<Float>& image = FlatImage();
+	return BilerpLoop([&](int s, int t) { return image[(size_t)t * ImageRes + s]; }, false, iterations);
+}
+PBR_BENCHMARK(TextureFlatRandom);
+
+static double TextureBlockedRandom(int64_t iterations) {
+	const BlockedArray<Float>& image = BlockedImage();
+	return BilerpLoop([&](int s, int t) { return image(s, t); }, false, iterations);
+}
+PBR_BENCHMARK(TextureBlockedRandom);
+
+static double TextureFlatWalk(int64_t iterations) {
+	const std::vector<Float>& image = FlatImage();
+	return BilerpLoop([&](int s, int t) { return image[(size_t)t * ImageRes + s]; }, true, iterations);
+}
+PBR_BENCHMARK(TextureFlatWalk);
+
+static double TextureBlockedWalk(int64_t iterations) {
+	const BlockedArray<Float>& image = BlockedImage();
+	return BilerpLoop([&](int s, int t) { return image(s, t); }, true, iterations);
+}
+PBR_BENCHMARK(TextureBlockedWalk);
+
+// A MIPMap of the image paged from a tiled file, with the whole image
+// resident in its tile cache
+static const MIPMap<Float>& BenchMIPMap() {
+	static TileCache cache((size_t)ImageRes * ImageRes * sizeof(Float) * 2);
+	static std::unique_ptr<MIPMap<Float>> mipmap;
+	if (!mipmap) {
+		CHECK(WriteTiledMIPMap("bench.tiles", Point2i(ImageRes, ImageRes), FlatImage().data()));
+		mipmap = MIPMap<Float>::Open("bench.tiles", &cache);
+		std::remove("bench.tiles");
+	}
+	return *mipmap;
+}
+
+// The same walks through the MIPMap
+static double TextureMIPMapWalk(int64_t iterations) {
+	const MIPMap<Float>& mipmap = BenchMIPMap();
+	static const std::vector<Point2f> points = MakePoints(true);
+	double sum = 0;
+	for (int64_t n = 0; n < iterations; ++n) {
+		const Point2f& p = points[n & (NumPoints - 1)];
+		sum += mipmap.Bilerp(0, Point2f((p.x + 0.5f) / ImageRes, (p.y + 0.5f) / ImageRes));
+	}
+	return sum;
+}
+PBR_BENCHMARK(TextureMIPMapWalk);
+
+// EWA lookups at random points with footprints 8x as long as they are
+// wide, 2 to 16 texels across, in random orientations
+static double TextureMIPMapEWA(int64_t iterations) {
+	const MIPMap<Float>& mipmap = BenchMIPMap();
+	static std::vector<Vector2f> axes;
+	if (axes.empty()) {
+		RNG rng;
+		for (int i = 0; i < NumPoints; ++i) {
+			Float phi = 2 * Pi * rng.UniformFloat(), width = (2 + 14 * rng.UniformFloat()) / ImageRes;
+			axes.push_back(Vector2f(std::cos(phi), std::sin(phi)) * width);
+		}
+	}
+	static const std::vector<Point2f> points = MakePoints(false);
+	double sum = 0;
+	for (int64_t n = 0; n < iterations; ++n) {
+		int i = n & (NumPoints - 1);
+		const Vector2f& axis = axes[i];
+		sum += mipmap.Lookup(Point2f(points[i].x / ImageRes, points[i].y / ImageRes), 8 * axis,
+			Vector2f(-axis.y, axis.x));
+	}
+	return sum;
+}
+PBR_BENCHMARK(TextureMIPMapEWA);
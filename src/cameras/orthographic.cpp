@@ -0,0 +1,116 @@
+#include "cameras/orthographic.h"
+#include "paramset.h"
+#include "sampling.h"
+
+namespace pbr {
+
+	// OrthographicCamera Method Definitions
+	Float OrthographicCamera::GenerateRay(const CameraSample& sample, Ray* ray) const {
+		// Compute raster and camera sample positions
+		Point3f pFilm = Point3f(sample.pFilm.x, sample.pFilm.y, 0);
+		Point3f pCamera = RasterToCamera(pFilm);
+		*ray = Ray(pCamera, Vector3f(0, 0, 1));
+
+		// Modify ray for depth of field
+		if (lensRadius > 0) {
+			// Sample point on lens
+			Point2f pLens = lensRadius * ConcentricSampleDisk(sample.pLens);
+
+			// Compute point on plane of focus
+			Float ft = focalDistance / ray->d.z;
+			Point3f pFocus = (*ray)(ft);
+
+			// Update ray for effect of lens; the lens is centered on the ray
+			ray->o = Point3f(pCamera.x + pLens.x, pCamera.y + pLens.y, pCamera.z);
+			ray->d = Normalize(pFocus - ray->o);
+		}
+		ray->time = Lerp(sample.time, shutterOpen, shutterClose);
+		*ray = CameraToWorld(*ray);
+		return 1;
+	}
+
+	Float OrthographicCamera::GenerateRayDifferential(const CameraSample& sample, RayDifferential* rd) const {
+		// Compute raster and camera sample positions
+		Point3f pFilm = Point3f(sample.pFilm.x, sample.pFilm.y, 0);
+		Point3f pCamera = RasterToCamera(pFilm);
+		*rd = RayDifferential(pCamera, Vector3f(0, 0, 1));
+
+		// Modify ray for depth of field
+		if (lensRadius > 0) {
+			// Sample point on lens
+			Point2f pLens = lensRadius * ConcentricSampleDisk(sample.pLens);
+
+			// Compute point on plane of focus
+			Float ft = focalDistance / rd->d.z;
+			Point3f pFocus = (*rd)(ft);
+
+			// Update ray for effect of lens
+			rd->o = Point3f(pCamera.x + pLens.x, pCamera.y + pLens.y, pCamera.z);
+			rd->d = Normalize(pFocus - rd->o);
+		}
+
+		// Shifting by a pixel moves the ray, lens point and focus point alike,
+		// so the differentials only differ in origin
+		rd->rxOrigin = rd->o + dxCamera;
+		rd->ryOrigin = rd->o + dyCamera;
+		rd->rxDirection = rd->ryDirection = rd->d;
+		rd->time = Lerp(sample.time, shutterOpen, shutterClose);
+		rd->hasDifferentials = true;
+		*rd = CameraToWorld(*rd);
+		return 1;
+	}
+
+	void OrthographicCamera::GenerateRays(const CameraSample* samples, int count, CameraRayPacket* rays) const {
+		rays->Resize(count);
+		if (count == 0) return;
+		// Origins on the near plane, and one pixel over
+		Float* ox = &rays->o.x[0];
+		Float* oy = &rays->o.y[0];
+		Float* oz = &rays->o.z[0];
+		for (int i = 0; i < count; ++i) {
+			Float fx = samples[i].pFilm.x, fy = samples[i].pFilm.y;
+			ox[i] = pCameraOrigin.x + fx * dxCamera.x + fy * dyCamera.x;
+			oy[i] = pCameraOrigin.y + fx * dxCamera.y + fy * dyCamera.y;
+			oz[i] = pCameraOrigin.z + fx * dxCamera.z + fy * dyCamera.z;
+		}
+		for (int i = 0; i < count; ++i) {
+			rays->rxOrigin.x[i] = ox[i] + dxCamera.x;
+			rays->rxOrigin.y[i] = oy[i] + dxCamera.y;
+			rays->rxOrigin.z[i] = oz[i] + dxCamera.z;
+			rays->ryOrigin.x[i] = ox[i] + dyCamera.x;
+			rays->ryOrigin.y[i] = oy[i] + dyCamera.y;
+			rays->ryOrigin.z[i] = oz[i] + dyCamera.z;
+		}
+		for (SoA3f* d : { &rays->d, &rays->rxDirection, &rays->ryDirection }) {
+			std::fill(d->x.begin(), d->x.end(), 0);
+			std::fill(d->y.begin(), d->y.end(), 0);
+			std::fill(d->z.begin(), d->z.end(), 1);
+		}
+
+		// Modify rays for depth of field
+		if (lensRadius > 0) {
+			std::vector<Point2f> pLens(count);
+			for (int i = 0; i < count; ++i) pLens[i] = lensRadius * ConcentricSampleDisk(samples[i].pLens);
+			FocusThinLens(&pLens[0], focalDistance, &rays->o, &rays->d, count);
+			FocusThinLens(&pLens[0], focalDistance, &rays->rxOrigin, &rays->rxDirection, count);
+			FocusThinLens(&pLens[0], focalDistance, &rays->ryOrigin, &rays->ryDirection, count);
+		}
+		PacketToWorld(samples, rays);
+	}
+
+	OrthographicCamera* CreateOrthographicCamera(const ParamSet& params, const Transform& cam2world, Film* film) {
+		// Extract common camera parameters from _ParamSet_
+		Float shutteropen = params.FindOneFloat("shutteropen", 0.f);
+		Float shutterclose = params.FindOneFloat("shutterclose", 1.f);
+		if (shutterclose < shutteropen) {
+			LOG(WARNING) << "Shutter close time [" << shutterclose << "] < shutter open [" << shutteropen
+				<< "].  Swapping them.";
+			std::swap(shutterclose, shutteropen);
+		}
+		Float lensradius = params.FindOneFloat("lensradius", 0.f);
+		Float focaldistance = params.FindOneFloat("focaldistance", 1e6);
+		Bounds2f screen = ScreenWindowParameter(params, film);
+		return new OrthographicCamera(cam2world, screen, shutteropen, shutterclose, lensradius, focaldistance, film);
+	}
+
+}  // namespace pbr
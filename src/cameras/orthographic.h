@@ -0,0 +1,30 @@
+#ifndef CAMERAS_ORTHOGRAPHIC_H
+#define CAMERAS_ORTHOGRAPHIC_H
+
+#include "camera.h"
+
+namespace pbr {
+
+	// OrthographicCamera Declarations
+
+	// Parallel projection of the screen window along camera-space +z, or a
+	// thin lens when lensRadius > 0
+	class OrthographicCamera : public ProjectiveCamera {
+	public:
+		// OrthographicCamera Public Methods
+		OrthographicCamera(const Transform& CameraToWorld, const Bounds2f& screenWindow, Float shutterOpen,
+			Float shutterClose, Float lensRadius, Float focalDistance, Film* film)
+			: ProjectiveCamera(CameraToWorld, Orthographic(0, 1), screenWindow, shutterOpen, shutterClose,
+				lensRadius, focalDistance, film) {}
+		Float GenerateRay(const CameraSample& sample, Ray* ray) const;
+		Float GenerateRayDifferential(const CameraSample& sample, RayDifferential* rd) const;
+		void GenerateRays(const CameraSample* samples, int count, CameraRayPacket* rays) const;
+	};
+
+	// Supported parameters: as for CreatePerspectiveCamera(), without the
+	// field of view
+	OrthographicCamera* CreateOrthographicCamera(const ParamSet& params, const Transform& cam2world, Film* film);
+
+}  // namespace pbr
+
+#endif  // CAMERAS_ORTHOGRAPHIC_H
@@ -0,0 +1,143 @@
+#include "cameras/perspective.h"
+#include "paramset.h"
+#include "sampling.h"
+
+namespace pbr {
+
+	// PerspectiveCamera Method Definitions
+	PerspectiveCamera::PerspectiveCamera(const Transform& CameraToWorld, const Bounds2f& screenWindow,
+		Float shutterOpen, Float shutterClose, Float lensRadius, Float focalDistance, Float fov, Film* film)
+		: ProjectiveCamera(CameraToWorld, Perspective(fov, 1e-2f, 1000.f), screenWindow, shutterOpen,
+			shutterClose, lensRadius, focalDistance, film) {}
+
+	Float PerspectiveCamera::GenerateRay(const CameraSample& sample, Ray* ray) const {
+		// Compute raster and camera sample positions
+		Point3f pFilm = Point3f(sample.pFilm.x, sample.pFilm.y, 0);
+		Point3f pCamera = RasterToCamera(pFilm);
+		*ray = Ray(Point3f(0, 0, 0), Normalize(Vector3f(pCamera)));
+
+		// Modify ray for depth of field
+		if (lensRadius > 0) {
+			// Sample point on lens
+			Point2f pLens = lensRadius * ConcentricSampleDisk(sample.pLens);
+
+			// Compute point on plane of focus
+			Float ft = focalDistance / ray->d.z;
+			Point3f pFocus = (*ray)(ft);
+
+			// Update ray for effect of lens
+			ray->o = Point3f(pLens.x, pLens.y, 0);
+			ray->d = Normalize(pFocus - ray->o);
+		}
+		ray->time = Lerp(sample.time, shutterOpen, shutterClose);
+		*ray = CameraToWorld(*ray);
+		return 1;
+	}
+
+	Float PerspectiveCamera::GenerateRayDifferential(const CameraSample& sample, RayDifferential* rd) const {
+		// Compute raster and camera sample positions
+		Point3f pFilm = Point3f(sample.pFilm.x, sample.pFilm.y, 0);
+		Point3f pCamera = RasterToCamera(pFilm);
+		Vector3f dir = Normalize(Vector3f(pCamera));
+		*rd = RayDifferential(Point3f(0, 0, 0), dir);
+
+		// Modify ray for depth of field
+		if (lensRadius > 0) {
+			// Sample point on lens
+			Point2f pLens = lensRadius * ConcentricSampleDisk(sample.pLens);
+
+			// Compute point on plane of focus
+			Float ft = focalDistance / rd->d.z;
+			Point3f pFocus = (*rd)(ft);
+
+			// Update ray for effect of lens
+			rd->o = Point3f(pLens.x, pLens.y, 0);
+			rd->d = Normalize(pFocus - rd->o);
+
+			// Compute _PerspectiveCamera_ ray differentials accounting for lens
+			Vector3f dx = Normalize(Vector3f(pCamera + dxCamera));
+			ft = focalDistance / dx.z;
+			pFocus = Point3f(0, 0, 0) + (ft * dx);
+			rd->rxOrigin = Point3f(pLens.x, pLens.y, 0);
+			rd->rxDirection = Normalize(pFocus - rd->rxOrigin);
+
+			Vector3f dy = Normalize(Vector3f(pCamera + dyCamera));
+			ft = focalDistance / dy.z;
+			pFocus = Point3f(0, 0, 0) + (ft * dy);
+			rd->ryOrigin = Point3f(pLens.x, pLens.y, 0);
+			rd->ryDirection = Normalize(pFocus - rd->ryOrigin);
+		} else {
+			rd->rxOrigin = rd->ryOrigin = rd->o;
+			rd->rxDirection = Normalize(Vector3f(pCamera) + dxCamera);
+			rd->ryDirection = Normalize(Vector3f(pCamera) + dyCamera);
+		}
+		rd->time = Lerp(sample.time, shutterOpen, shutterClose);
+		rd->hasDifferentials = true;
+		*rd = CameraToWorld(*rd);
+		return 1;
+	}
+
+	void PerspectiveCamera::GenerateRays(const CameraSample* samples, int count, CameraRayPacket* rays) const {
+		rays->Resize(count);
+		if (count == 0) return;
+		// Directions to the near plane from the pinhole, and to the points
+		// one pixel over
+		Float* dx = &rays->d.x[0];
+		Float* dy = &rays->d.y[0];
+		Float* dz = &rays->d.z[0];
+		for (int i = 0; i < count; ++i) {
+			Float fx = samples[i].pFilm.x, fy = samples[i].pFilm.y;
+			dx[i] = pCameraOrigin.x + fx * dxCamera.x + fy * dyCamera.x;
+			dy[i] = pCameraOrigin.y + fx * dxCamera.y + fy * dyCamera.y;
+			dz[i] = pCameraOrigin.z + fx * dxCamera.z + fy * dyCamera.z;
+		}
+		for (int i = 0; i < count; ++i) {
+			rays->rxDirection.x[i] = dx[i] + dxCamera.x;
+			rays->rxDirection.y[i] = dy[i] + dxCamera.y;
+			rays->rxDirection.z[i] = dz[i] + dxCamera.z;
+			rays->ryDirection.x[i] = dx[i] + dyCamera.x;
+			rays->ryDirection.y[i] = dy[i] + dyCamera.y;
+			rays->ryDirection.z[i] = dz[i] + dyCamera.z;
+		}
+		NormalizeVectors(&rays->d, count);
+		NormalizeVectors(&rays->rxDirection, count);
+		NormalizeVectors(&rays->ryDirection, count);
+		for (SoA3f* o : { &rays->o, &rays->rxOrigin, &rays->ryOrigin }) {
+			std::fill(o->x.begin(), o->x.end(), 0);
+			std::fill(o->y.begin(), o->y.end(), 0);
+			std::fill(o->z.begin(), o->z.end(), 0);
+		}
+
+		// Modify rays for depth of field
+		if (lensRadius > 0) {
+			std::vector<Point2f> pLens(count);
+			for (int i = 0; i < count; ++i) pLens[i] = lensRadius * ConcentricSampleDisk(samples[i].pLens);
+			FocusThinLens(&pLens[0], focalDistance, &rays->o, &rays->d, count);
+			FocusThinLens(&pLens[0], focalDistance, &rays->rxOrigin, &rays->rxDirection, count);
+			FocusThinLens(&pLens[0], focalDistance, &rays->ryOrigin, &rays->ryDirection, count);
+		}
+		PacketToWorld(samples, rays);
+	}
+
+	PerspectiveCamera* CreatePerspectiveCamera(const ParamSet& params, const Transform& cam2world, Film* film) {
+		// Extract common camera parameters from _ParamSet_
+		Float shutteropen = params.FindOneFloat("shutteropen", 0.f);
+		Float shutterclose = params.FindOneFloat("shutterclose", 1.f);
+		if (shutterclose < shutteropen) {
+			LOG(WARNING) << "Shutter close time [" << shutterclose << "] < shutter open [" << shutteropen
+				<< "].  Swapping them.";
+			std::swap(shutterclose, shutteropen);
+		}
+		Float lensradius = params.FindOneFloat("lensradius", 0.f);
+		Float focaldistance = params.FindOneFloat("focaldistance", 1e6);
+		Bounds2f screen = ScreenWindowParameter(params, film);
+		Float fov = params.FindOneFloat("fov", 90.);
+		Float halffov = params.FindOneFloat("halffov", -1.f);
+		if (halffov > 0.f)
+			// hack for structure synth, which exports half of the full fov
+			fov = 2.f * halffov;
+		return new PerspectiveCamera(cam2world, screen, shutteropen, shutterclose, lensradius, focaldistance, fov,
+			film);
+	}
+
+}  // namespace pbr
@@ -0,0 +1,30 @@
+#ifndef CAMERAS_PERSPECTIVE_H
+#define CAMERAS_PERSPECTIVE_H
+
+#include "camera.h"
+
+namespace pbr {
+
+	// PerspectiveCamera Declarations
+
+	// Pinhole projection with a field of view of fov degrees across the
+	// shorter screen axis, or a thin lens when lensRadius > 0
+	class PerspectiveCamera : public ProjectiveCamera {
+	public:
+		// PerspectiveCamera Public Methods
+		PerspectiveCamera(const Transform& CameraToWorld, const Bounds2f& screenWindow, Float shutterOpen,
+			Float shutterClose, Float lensRadius, Float focalDistance, Float fov, Film* film);
+		Float GenerateRay(const CameraSample& sample, Ray* ray) const;
+		Float GenerateRayDifferential(const CameraSample& sample, RayDifferential* rd) const;
+		void GenerateRays(const CameraSample* samples, int count, CameraRayPacket* rays) const;
+	};
+
+	// Supported parameters: "shutteropen", "shutterclose" (float, default 0
+	// and 1), "lensradius" (float, default 0), "focaldistance" (float,
+	// default 1e6), "frameaspectratio" (float), "screenwindow" (4 floats),
+	// "fov" (float degrees, default 90), "halffov" (float degrees)
+	PerspectiveCamera* CreatePerspectiveCamera(const ParamSet& params, const Transform& cam2world, Film* film);
+
+}  // namespace pbr
+
+#endif  // CAMERAS_PERSPECTIVE_H
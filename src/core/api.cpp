@@ -0,0 +1,461 @@
+#include "api.h"
+#include "binaryscene.h"
+#include "camera.h"
+#include "checkpoint.h"
+#include "film.h"
+#include "geometrycache.h"
+#include "interaction.h"
+#include "paramset.h"
+#include "primitive.h"
+#include "render.h"
+#include "sampler.h"
+#include "accelerators/bvh.h"
+#include "accelerators/kdtreeaccel.h"
+#include "cameras/orthographic.h"
+#include "cameras/perspective.h"
+#include "filters/box.h"
+#include "filters/gaussian.h"
+#include "filters/mitchell.h"
+#include "filters/sinc.h"
+#include "filters/triangle.h"
+#include "samplers/halton.h"
+#include "samplers/random.h"
+#include "samplers/sobol.h"
+#include "samplers/stratified.h"
+#include "shapes/objmesh.h"
+#include "shapes/plymesh.h"
+#include "shapes/triangle.h"
+#include <atomic>
+#include <mutex>
+
+namespace pbr {
+
+	Options PbrOptions;
+
+	// API Local Definitions
+
+	// A thread's clone of the sampler of the render with the given id, and
+	// its buffers for a tile row's camera samples and rays
+	struct ThreadSampler {
+		uint64_t render = 0;
+		std::unique_ptr<Sampler> sampler;
+		std::vector<CameraSample> cameraSamples;
+		CameraRayPacket rays;
+	};
+	static thread_local ThreadSampler threadSampler;
+	static std::atomic<uint64_t> nextRenderId{ 1 };
+
+	// Renders the scene with each hit lit by a light at the eye
+	static ProgressiveResult RenderEyeLight(Film& film, const Camera& camera, Sampler& sampler,
+		const Primitive& aggregate) {
+		uint64_t render = nextRenderId++;
+		std::mutex cloneMutex;
+		ProgressiveOptions options;
+		options.maxSamples = sampler.samplesPerPixel;
+		options.samplesPerPass = (int)std::min<int64_t>(options.samplesPerPass, sampler.samplesPerPixel);
+		options.timeLimit = PbrOptions.timeLimit;
+		options.targetNoise = PbrOptions.targetNoise;
+		options.adaptive = PbrOptions.adaptive;
+		options.minSamples = PbrOptions.minSamples;
+		std::unique_ptr<CheckpointWriter> checkpointWriter;
+		RenderCheckpoint checkpoint;
+		if (!PbrOptions.checkpointFile.empty()) {
+			if (PbrOptions.resume && ReadCheckpoint(PbrOptions.checkpointFile, &checkpoint))
+				options.resumeFrom = &checkpoint;
+			checkpointWriter.reset(new CheckpointWriter(PbrOptions.checkpointFile, PbrOptions.checkpointInterval));
+			options.checkpointWriter = checkpointWriter.get();
+		}
+		return RenderProgressiveRows(film, [&](FilmTile* tile, const Bounds2i& pixels, int64_t firstSample,
+			int64_t nSamples) {
+			ThreadSampler& ts = threadSampler;
+			if (ts.render != render) {
+				std::lock_guard<std::mutex> lock(cloneMutex);
+				ts.sampler = sampler.Clone();
+				ts.render = render;
+			}
+			// Draw the row's camera samples, then generate their rays at once
+			ts.cameraSamples.clear();
+			for (int y = pixels.pMin.y; y < pixels.pMax.y; ++y)
+				for (int x = pixels.pMin.x; x < pixels.pMax.x; ++x) {
+					Point2i pixel(x, y);
+					ts.sampler->StartPixel(pixel);
+					for (int64_t s = firstSample; s < firstSample + nSamples; ++s) {
+						ts.sampler->SetSampleNumber(s);
+						CameraSample cs;
+						cs.pFilm = Point2f(pixel) + ts.sampler->Get2D();
+						cs.time = ts.sampler->Get1D();
+						cs.pLens = ts.sampler->Get2D();
+						ts.cameraSamples.push_back(cs);
+					}
+				}
+			int count = (int)ts.cameraSamples.size();
+			camera.GenerateRays(ts.cameraSamples.data(), count, &ts.rays);
+			for (int i = 0; i < count; ++i) {
+				Ray ray = ts.rays.GetRay(i);
+				RGBSpectrum L(0);
+				SurfaceInteraction isect;
+				if (aggregate.Intersect(ray, &isect)) L = RGBSpectrum(std::abs(Dot(isect.n, Normalize(ray.d))));
+				tile->AddSample(ts.cameraSamples[i].pFilm, L);
+			}
+		}, options);
+	}
+
+	std::shared_ptr<Primitive> MakeAccelerator(const std::string& name,
+		std::vector<std::shared_ptr<Primitive>> prims, const ParamSet& paramSet) {
+		std::shared_ptr<Primitive> accel;
+		if (name == "bvh")
+			accel = CreateBVHAccelerator(std::move(prims), paramSet);
+		else if (name == "kdtree")
+			accel = CreateKdTreeAccelerator(std::move(prims), paramSet);
+		else {
+			LOG(WARNING) << "Accelerator \"" << name << "\" unknown.  Using \"bvh\".";
+			accel = CreateBVHAccelerator(std::move(prims), paramSet);
+		}
+		paramSet.ReportUnused();
+		return accel;
+	}
+
+	std::unique_ptr<Filter> MakeFilter(const std::string& name, const ParamSet& paramSet) {
+		Filter* filter = nullptr;
+		if (name == "box")
+			filter = CreateBoxFilter(paramSet);
+		else if (name == "gaussian")
+			filter = CreateGaussianFilter(paramSet);
+		else if (name == "mitchell")
+			filter = CreateMitchellFilter(paramSet);
+		else if (name == "sinc")
+			filter = CreateSincFilter(paramSet);
+		else if (name == "triangle")
+			filter = CreateTriangleFilter(paramSet);
+		else {
+			LOG(ERROR) << "Filter \"" << name << "\" unknown.";
+			return nullptr;
+		}
+		paramSet.ReportUnused();
+		return std::unique_ptr<Filter>(filter);
+	}
+
+	std::unique_ptr<Film> MakeFilm(const std::string& name, const ParamSet& paramSet,
+		std::unique_ptr<Filter> filter) {
+		if (name != "image") {
+			LOG(ERROR) << "Film \"" << name << "\" unknown.";
+			return nullptr;
+		}
+		std::unique_ptr<Film> film = CreateFilm(paramSet, std::move(filter));
+		paramSet.ReportUnused();
+		return film;
+	}
+
+	std::unique_ptr<Sampler> MakeSampler(const std::string& name, const ParamSet& paramSet, const Film* film) {
+		Sampler* sampler = nullptr;
+		if (name == "halton")
+			sampler = CreateHaltonSampler(paramSet, film->GetSampleBounds());
+		else if (name == "sobol")
+			sampler = CreateSobolSampler(paramSet);
+		else if (name == "random")
+			sampler = CreateRandomSampler(paramSet);
+		else if (name == "stratified")
+			sampler = CreateStratifiedSampler(paramSet);
+		else {
+			LOG(ERROR) << "Sampler \"" << name << "\" unknown.";
+			return nullptr;
+		}
+		paramSet.ReportUnused();
+		return std::unique_ptr<Sampler>(sampler);
+	}
+
+	std::unique_ptr<Camera> MakeCamera(const std::string& name, const ParamSet& paramSet,
+		const Transform& cam2world, Film* film) {
+		Camera* camera = nullptr;
+		if (name == "perspective")
+			camera = CreatePerspectiveCamera(paramSet, cam2world, film);
+		else if (name == "orthographic")
+			camera = CreateOrthographicCamera(paramSet, cam2world, film);
+		else {
+			LOG(ERROR) << "Camera \"" << name << "\" unknown.";
+			return nullptr;
+		}
+		paramSet.ReportUnused();
+		return std::unique_ptr<Camera>(camera);
+	}
+
+	GeometryCache* MeshGeometryCache() {
+		static std::once_flag created;
+		static std::unique_ptr<GeometryCache> cache;
+		std::call_once(created, []() { cache.reset(new GeometryCache((size_t)PbrOptions.geometryCacheSize << 20)); });
+		return cache.get();
+	}
+
+	// SceneBuilder Method Definitions
+	SceneBuilder::SceneBuilder(bool render) : render(render) {}
+
+	SceneBuilder::SceneBuilder(BinarySceneWriter* writer) : render(false), writer(writer) {}
+
+	SceneBuilder::~SceneBuilder() {}
+
+	bool SceneBuilder::VerifyOptions(const char* statement) const {
+		if (inWorld) LOG(ERROR) << "Options cannot be set inside world block; \"" << statement << "\" not allowed.  Ignoring.";
+		return !inWorld;
+	}
+
+	bool SceneBuilder::VerifyWorld(const char* statement) const {
+		if (!inWorld)
+			LOG(ERROR) << "Scene description must be inside world block; \"" << statement << "\" not allowed.  Ignoring.";
+		return inWorld;
+	}
+
+	void SceneBuilder::pbrtIdentity() { graphicsState.ctm = Transform(); }
+
+	void SceneBuilder::pbrtTranslate(Float dx, Float dy, Float dz) {
+		graphicsState.ctm = graphicsState.ctm * Translate(Vector3f(dx, dy, dz));
+	}
+
+	void SceneBuilder::pbrtRotate(Float angle, Float ax, Float ay, Float az) {
+		graphicsState.ctm = graphicsState.ctm * Rotate(angle, Vector3f(ax, ay, az));
+	}
+
+	void SceneBuilder::pbrtScale(Float sx, Float sy, Float sz) {
+		graphicsState.ctm = graphicsState.ctm * Scale(sx, sy, sz);
+	}
+
+	void SceneBuilder::pbrtLookAt(Float ex, Float ey, Float ez, Float lx, Float ly, Float lz, Float ux, Float uy,
+		Float uz) {
+		graphicsState.ctm = graphicsState.ctm * LookAt(Point3f(ex, ey, ez), Point3f(lx, ly, lz), Vector3f(ux, uy, uz));
+	}
+
+	void SceneBuilder::pbrtConcatTransform(const Float tr[16]) {
+		graphicsState.ctm = graphicsState.ctm * Transpose(Transform(Matrix4x4(tr[0], tr[1], tr[2], tr[3], tr[4],
+			tr[5], tr[6], tr[7], tr[8], tr[9], tr[10], tr[11], tr[12], tr[13], tr[14], tr[15])));
+	}
+
+	void SceneBuilder::pbrtTransform(const Float tr[16]) {
+		graphicsState.ctm = Transpose(Transform(Matrix4x4(tr[0], tr[1], tr[2], tr[3], tr[4], tr[5], tr[6], tr[7],
+			tr[8], tr[9], tr[10], tr[11], tr[12], tr[13], tr[14], tr[15])));
+	}
+
+	void SceneBuilder::pbrtCoordinateSystem(const std::string& name) {
+		namedCoordinateSystems[name] = graphicsState.ctm;
+	}
+
+	void SceneBuilder::pbrtCoordSysTransform(const std::string& name) {
+		auto iter = namedCoordinateSystems.find(name);
+		if (iter != namedCoordinateSystems.end())
+			graphicsState.ctm = iter->second;
+		else
+			LOG(WARNING) << "Couldn't find named coordinate system \"" << name << "\"";
+	}
+
+	void SceneBuilder::pbrtReverseOrientation() { graphicsState.reverseOrientation = !graphicsState.reverseOrientation; }
+
+	void SceneBuilder::pbrtPixelFilter(const std::string& name, const ParamSet& params) {
+		if (!VerifyOptions("PixelFilter")) return;
+		filterName = name;
+		filterParams = params;
+	}
+
+	void SceneBuilder::pbrtFilm(const std::string& type, const ParamSet& params) {
+		if (!VerifyOptions("Film")) return;
+		filmName = type;
+		filmParams = params;
+	}
+
+	void SceneBuilder::pbrtSampler(const std::string& name, const ParamSet& params) {
+		if (!VerifyOptions("Sampler")) return;
+		samplerName = name;
+		samplerParams = params;
+	}
+
+	void SceneBuilder::pbrtAccelerator(const std::string& name, const ParamSet& params) {
+		if (!VerifyOptions("Accelerator")) return;
+		acceleratorName = name;
+		acceleratorParams = params;
+	}
+
+	void SceneBuilder::pbrtCamera(const std::string& name, const ParamSet& params) {
+		if (!VerifyOptions("Camera")) return;
+		cameraName = name;
+		cameraParams = params;
+		cameraToWorld = Inverse(graphicsState.ctm);
+		namedCoordinateSystems["camera"] = cameraToWorld;
+	}
+
+	void SceneBuilder::pbrtWorldBegin() {
+		if (!VerifyOptions("WorldBegin")) return;
+		inWorld = true;
+		graphicsState.ctm = Transform();
+		namedCoordinateSystems["world"] = graphicsState.ctm;
+	}
+
+	void SceneBuilder::pbrtAttributeBegin() {
+		if (!VerifyWorld("AttributeBegin")) return;
+		pushedGraphicsStates.push_back(graphicsState);
+	}
+
+	void SceneBuilder::pbrtAttributeEnd() {
+		if (!VerifyWorld("AttributeEnd")) return;
+		if (pushedGraphicsStates.empty()) {
+			LOG(ERROR) << "Unmatched AttributeEnd encountered. Ignoring it.";
+			return;
+		}
+		graphicsState = pushedGraphicsStates.back();
+		pushedGraphicsStates.pop_back();
+	}
+
+	void SceneBuilder::pbrtTransformBegin() {
+		if (!VerifyWorld("TransformBegin")) return;
+		pushedTransforms.push_back(graphicsState.ctm);
+	}
+
+	void SceneBuilder::pbrtTransformEnd() {
+		if (!VerifyWorld("TransformEnd")) return;
+		if (pushedTransforms.empty()) {
+			LOG(ERROR) << "Unmatched TransformEnd encountered. Ignoring it.";
+			return;
+		}
+		graphicsState.ctm = pushedTransforms.back();
+		pushedTransforms.pop_back();
+	}
+
+	void SceneBuilder::pbrtMaterial(const std::string& name, const ParamSet& params) {
+		if (!VerifyWorld("Material")) return;
+		materials.push_back({ "", name, params });
+		graphicsState.material = (int)materials.size() - 1;
+	}
+
+	void SceneBuilder::pbrtMakeNamedMaterial(const std::string& name, const ParamSet& params) {
+		if (!VerifyWorld("MakeNamedMaterial")) return;
+		std::string type = params.FindOneString("type", "");
+		if (type.empty()) {
+			LOG(ERROR) << "No parameter string \"type\" found in MakeNamedMaterial";
+			return;
+		}
+		if (namedMaterials.count(name)) LOG(WARNING) << "Named material \"" << name << "\" redefined.";
+		materials.push_back({ name, type, params });
+		namedMaterials[name] = (int)materials.size() - 1;
+	}
+
+	void SceneBuilder::pbrtNamedMaterial(const std::string& name) {
+		if (!VerifyWorld("NamedMaterial")) return;
+		auto iter = namedMaterials.find(name);
+		if (iter == namedMaterials.end()) {
+			LOG(ERROR) << "NamedMaterial \"" << name << "\" unknown.";
+			return;
+		}
+		graphicsState.material = iter->second;
+	}
+
+	void SceneBuilder::pbrtShape(const std::string& name, const ParamSet& params) {
+		if (!VerifyWorld("Shape")) return;
+		const Transform& objectToWorld = graphicsState.ctm;
+		bool reverseOrientation = graphicsState.reverseOrientation;
+		if (writer) {
+			writer->AddShape(name, params, objectToWorld, reverseOrientation, graphicsState.material);
+			return;
+		}
+		std::vector<std::shared_ptr<Primitive>>& prims = currentInstance ? *currentInstance : primitives;
+		std::vector<std::shared_ptr<Shape>> shapes;
+		if (name == "trianglemesh")
+			shapes = CreateTriangleMeshShape(objectToWorld, reverseOrientation, params);
+		else if (name == "plymesh")
+			shapes = CreatePLYMesh(objectToWorld, reverseOrientation, params);
+		else if (name == "objmesh")
+			shapes = CreateOBJMesh(objectToWorld, reverseOrientation, params);
+		else if (name == "pagedtrianglemesh") {
+			// Paged meshes are stored in world space, so they are placed by a
+			// transformed primitive
+			if (reverseOrientation) LOG(WARNING) << "ReverseOrientation not supported for paged triangle meshes";
+			std::shared_ptr<Primitive> mesh = CreatePagedTriangleMesh(params, MeshGeometryCache());
+			if (mesh && !objectToWorld.IsIdentity())
+				mesh = std::make_shared<TransformedPrimitive>(mesh, objectToWorld);
+			if (mesh) prims.push_back(mesh);
+		} else
+			LOG(WARNING) << "Shape \"" << name << "\" unknown.";
+		params.ReportUnused();
+		AddShapes(shapes);
+	}
+
+	void SceneBuilder::AddShapes(const std::vector<std::shared_ptr<Shape>>& shapes) {
+		if (!VerifyWorld("Shape")) return;
+		std::vector<std::shared_ptr<Primitive>>& prims = currentInstance ? *currentInstance : primitives;
+		for (const std::shared_ptr<Shape>& shape : shapes) prims.push_back(std::make_shared<GeometricPrimitive>(shape));
+	}
+
+	void SceneBuilder::pbrtObjectBegin(const std::string& name) {
+		pbrtAttributeBegin();
+		if (currentInstance) LOG(ERROR) << "ObjectBegin called inside of instance definition";
+		if (instances.count(name)) LOG(ERROR) << "ObjectBegin trying to redefine object instance \"" << name << "\"";
+		instances[name].clear();
+		currentInstance = &instances[name];
+		if (writer) writer->BeginObject(name);
+	}
+
+	void SceneBuilder::pbrtObjectEnd() {
+		if (!VerifyWorld("ObjectEnd")) return;
+		if (!currentInstance) LOG(ERROR) << "ObjectEnd called outside of instance definition";
+		if (writer && currentInstance) writer->EndObject();
+		currentInstance = nullptr;
+		pbrtAttributeEnd();
+	}
+
+	void SceneBuilder::pbrtObjectInstance(const std::string& name) {
+		if (!VerifyWorld("ObjectInstance")) return;
+		if (currentInstance) {
+			LOG(ERROR) << "ObjectInstance can't be called inside instance definition";
+			return;
+		}
+		auto iter = instances.find(name);
+		if (iter == instances.end()) {
+			LOG(ERROR) << "Unable to find instance named \"" << name << "\"";
+			return;
+		}
+		if (writer) {
+			writer->AddInstance(name, graphicsState.ctm);
+			return;
+		}
+		std::vector<std::shared_ptr<Primitive>>& in = iter->second;
+		if (in.empty()) return;
+		// Instances are put behind their own aggregate when first used
+		if (in.size() > 1) {
+			std::shared_ptr<Primitive> accel = MakeAccelerator(acceleratorName, std::move(in), acceleratorParams);
+			in.clear();
+			in.push_back(accel);
+		}
+		primitives.push_back(std::make_shared<TransformedPrimitive>(in[0], graphicsState.ctm));
+	}
+
+	void SceneBuilder::pbrtWorldEnd() {
+		if (!VerifyWorld("WorldEnd")) return;
+		if (!pushedGraphicsStates.empty()) LOG(ERROR) << "Missing end to AttributeBegin";
+		if (!pushedTransforms.empty()) LOG(ERROR) << "Missing end to TransformBegin";
+		pushedGraphicsStates.clear();
+		pushedTransforms.clear();
+		inWorld = false;
+
+		if (writer) {
+			writer->AddOption(BinarySceneOption::PixelFilter, filterName, filterParams);
+			writer->AddOption(BinarySceneOption::Film, filmName, filmParams);
+			writer->AddOption(BinarySceneOption::Sampler, samplerName, samplerParams);
+			writer->AddOption(BinarySceneOption::Accelerator, acceleratorName, acceleratorParams);
+			writer->AddOption(BinarySceneOption::Camera, cameraName, cameraParams, Inverse(cameraToWorld));
+			for (const SceneMaterial& m : materials) writer->AddMaterial(m.type, m.params, m.name);
+			return;
+		}
+		std::unique_ptr<Filter> filter = MakeFilter(filterName, filterParams);
+		film = filter ? MakeFilm(filmName, filmParams, std::move(filter)) : nullptr;
+		camera = film ? MakeCamera(cameraName, cameraParams, cameraToWorld, film.get()) : nullptr;
+		sampler = film ? MakeSampler(samplerName, samplerParams, film.get()) : nullptr;
+		aggregate = MakeAccelerator(acceleratorName, std::move(primitives), acceleratorParams);
+		primitives.clear();
+		instances.clear();
+		if (!film || !camera || !sampler) {
+			LOG(ERROR) << "Unable to create filter, film, camera and sampler; not rendering";
+			camera.reset();
+			return;
+		}
+		if (!render) return;
+		ProgressiveResult result = RenderEyeLight(*film, *camera, *sampler, *aggregate);
+		LOG(INFO) << "Rendered " << result.samplesCompleted << " samples per pixel in " << result.passes <<
+			" passes, " << result.seconds << " s";
+	}
+
+}  // namespace pbr
@@ -0,0 +1,136 @@
+#ifndef CORE_API_H
+#define CORE_API_H
+
+#include "pbr.h"
+#include "parser.h"
+#include "transform.h"
+#include <map>
+
+namespace pbr {
+
+	// Creates the aggregate named by an "Accelerator" statement ("bvh" or
+	// "kdtree"); unknown names fall back to the BVH.
+	std::shared_ptr<Primitive> MakeAccelerator(const std::string& name,
+		std::vector<std::shared_ptr<Primitive>> prims, const ParamSet& paramSet);
+
+	// Creates the filter named by a "PixelFilter" statement ("box",
+	// "triangle", "gaussian", "mitchell" or "sinc"); unknown names yield nullptr.
+	std::unique_ptr<Filter> MakeFilter(const std::string& name, const ParamSet& paramSet);
+
+	// Creates the film named by a "Film" statement ("image"); unknown names
+	// yield nullptr.
+	std::unique_ptr<Film> MakeFilm(const std::string& name, const ParamSet& paramSet,
+		std::unique_ptr<Filter> filter);
+
+	// Creates the sampler named by a "Sampler" statement ("halton", "sobol",
+	// "stratified" or "random") for the film's sample bounds; unknown names
+	// yield nullptr.
+	std::unique_ptr<Sampler> MakeSampler(const std::string& name, const ParamSet& paramSet, const Film* film);
+
+	// Creates the camera named by a "Camera" statement ("perspective" or
+	// "orthographic") rendering to film; unknown names yield nullptr.
+	std::unique_ptr<Camera> MakeCamera(const std::string& name, const ParamSet& paramSet,
+		const Transform& cam2world, Film* film);
+
+	// The cache that paged triangle meshes load their geometry into, created
+	// with PbrOptions.geometryCacheSize on first use
+	GeometryCache* MeshGeometryCache();
+
+	// A Material or MakeNamedMaterial statement; name is "" for the former
+	struct SceneMaterial {
+		std::string name, type;
+		ParamSet params;
+	};
+
+	// Builds the scene that parsed statements describe, following pbrt-v3's
+	// rules for the transform and attribute stacks, and renders it at
+	// WorldEnd. Until there are materials and lights, surfaces are lit from
+	// the eye; materials are only recorded. Misplaced statements are logged
+	// and ignored.
+	class SceneBuilder : public ParserTarget {
+	public:
+		// SceneBuilder Public Methods
+		// Without render, WorldEnd only builds the scene
+		SceneBuilder(bool render = true);
+		// Hands the scene to writer instead of building it; meshes are
+		// stored there in world or object space
+		SceneBuilder(BinarySceneWriter* writer);
+		~SceneBuilder();
+		void pbrtIdentity();
+		void pbrtTranslate(Float dx, Float dy, Float dz);
+		void pbrtRotate(Float angle, Float ax, Float ay, Float az);
+		void pbrtScale(Float sx, Float sy, Float sz);
+		void pbrtLookAt(Float ex, Float ey, Float ez, Float lx, Float ly, Float lz, Float ux, Float uy, Float uz);
+		void pbrtConcatTransform(const Float tr[16]);
+		void pbrtTransform(const Float tr[16]);
+		void pbrtCoordinateSystem(const std::string& name);
+		void pbrtCoordSysTransform(const std::string& name);
+		void pbrtReverseOrientation();
+		void pbrtPixelFilter(const std::string& name, const ParamSet& params);
+		void pbrtFilm(const std::string& type, const ParamSet& params);
+		void pbrtSampler(const std::string& name, const ParamSet& params);
+		void pbrtAccelerator(const std::string& name, const ParamSet& params);
+		void pbrtCamera(const std::string& name, const ParamSet& params);
+		void pbrtWorldBegin();
+		void pbrtAttributeBegin();
+		void pbrtAttributeEnd();
+		void pbrtTransformBegin();
+		void pbrtTransformEnd();
+		void pbrtMaterial(const std::string& name, const ParamSet& params);
+		void pbrtMakeNamedMaterial(const std::string& name, const ParamSet& params);
+		void pbrtNamedMaterial(const std::string& name);
+		void pbrtShape(const std::string& name, const ParamSet& params);
+		void pbrtObjectBegin(const std::string& name);
+		void pbrtObjectEnd();
+		void pbrtObjectInstance(const std::string& name);
+		void pbrtWorldEnd();
+		// Adds shapes already in world space, or in the space of the object
+		// being defined, with the current material
+		void AddShapes(const std::vector<std::shared_ptr<Shape>>& shapes);
+
+		// The scene built by the last WorldEnd; nullptr before, or if it
+		// couldn't be built
+		const Primitive* GetAggregate() const { return aggregate.get(); }
+		const Camera* GetCamera() const { return camera.get(); }
+		Film* GetFilm() const { return film.get(); }
+		// Every material given, in order
+		const std::vector<SceneMaterial>& GetMaterials() const { return materials; }
+
+	private:
+		// SceneBuilder Private Methods
+		bool VerifyOptions(const char* statement) const;
+		bool VerifyWorld(const char* statement) const;
+
+		// SceneBuilder Private Data
+		struct GraphicsState {
+			Transform ctm;
+			bool reverseOrientation = false;
+			// Index into materials, or -1 for none
+			int material = -1;
+		};
+		const bool render;
+		BinarySceneWriter* const writer = nullptr;
+		bool inWorld = false;
+		GraphicsState graphicsState;
+		std::vector<GraphicsState> pushedGraphicsStates;
+		std::vector<Transform> pushedTransforms;
+		std::map<std::string, Transform> namedCoordinateSystems;
+		std::string filterName = "box", filmName = "image", samplerName = "halton";
+		std::string acceleratorName = "bvh", cameraName = "perspective";
+		ParamSet filterParams, filmParams, samplerParams, acceleratorParams, cameraParams;
+		std::vector<SceneMaterial> materials;
+		std::map<std::string, int> namedMaterials;
+		Transform cameraToWorld;
+		std::vector<std::shared_ptr<Primitive>> primitives;
+		// Primitives of each named object, and of the one being defined
+		std::map<std::string, std::vector<std::shared_ptr<Primitive>>> instances;
+		std::vector<std::shared_ptr<Primitive>>* currentInstance = nullptr;
+		std::shared_ptr<Primitive> aggregate;
+		std::unique_ptr<Film> film;
+		std::unique_ptr<Camera> camera;
+		std::unique_ptr<Sampler> sampler;
+	};
+
+}  // namespace pbr
+
+#endif  // CORE_API_H
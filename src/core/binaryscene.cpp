@@ -0,0 +1,621 @@
+#include "binaryscene.h"
+#include "api.h"
+#include "fileutil.h"
+#include "parallel.h"
+#include "shapes/objmesh.h"
+#include "shapes/plymesh.h"
+#include "shapes/triangle.h"
+#include <atomic>
+
+namespace pbr {
+
+	// BinaryScene Local Definitions
+	static const char BinarySceneMagic[8] = { 'P', 'B', 'R', 'S', 'C', 'E', 'N', 'E' };
+	static const uint32_t BinarySceneVersion = 1;
+	static const size_t SectionAlignment = 64, DataAlignment = 16;
+
+	static size_t RoundUp(size_t n, size_t alignment) { return (n + alignment - 1) / alignment * alignment; }
+
+	// Checks offsets of a mapped file against its sections before they are
+	// used as pointers
+	class BinarySceneReader {
+	public:
+		BinarySceneReader(const char* file, const BinarySceneHeader& header) : file(file), header(header) {}
+
+		template <typename T> bool Records(BinarySceneSection s, const T** records, uint32_t* count) const {
+			const BinarySceneSectionEntry& e = header.sections[(int)s];
+			if (e.size % sizeof(T) != 0 || e.size / sizeof(T) > ~0u) return false;
+			*records = (const T*)(file + e.offset);
+			*count = (uint32_t)(e.size / sizeof(T));
+			return true;
+		}
+		// nullptr for offset 0; false if the array isn't within the Data
+		// section or is misaligned
+		template <typename T> bool Array(uint64_t offset, uint64_t count, const T** ptr) const {
+			*ptr = nullptr;
+			if (offset == 0) return true;
+			const BinarySceneSectionEntry& e = header.sections[(int)BinarySceneSection::Data];
+			if (offset < e.offset || offset > e.offset + e.size || offset % alignof(T) != 0 ||
+				(e.offset + e.size - offset) / sizeof(T) < count)
+				return false;
+			*ptr = (const T*)(file + offset);
+			return true;
+		}
+		// The string at offset, "" for 0; false if it isn't terminated
+		// within the Strings section
+		bool String(uint64_t offset, const char** s) const {
+			const BinarySceneSectionEntry& e = header.sections[(int)BinarySceneSection::Strings];
+			*s = "";
+			if (offset == 0) return true;
+			if (offset < e.offset || offset >= e.offset + e.size) return false;
+			*s = file + offset;
+			return memchr(*s, '\0', e.offset + e.size - offset) != nullptr;
+		}
+		bool Params(const BinaryParamList& list, ParamSet* ps) const;
+
+	private:
+		const char* const file;
+		const BinarySceneHeader& header;
+	};
+
+	bool BinarySceneReader::Params(const BinaryParamList& list, ParamSet* ps) const {
+		const BinaryParamRecord* records;
+		uint32_t count;
+		if (!Records(BinarySceneSection::Params, &records, &count) || list.first > count ||
+			list.count > count - list.first)
+			return false;
+		for (uint32_t i = list.first; i < list.first + list.count; ++i) {
+			const BinaryParamRecord& r = records[i];
+			const char* name;
+			if (!String(r.name, &name)) return false;
+			int n = (int)r.nValues;
+			if (n < 0) return false;
+			switch ((BinaryParamType)r.type) {
+			case BinaryParamType::Float:
+			case BinaryParamType::RGB: {
+				int nFloats = (BinaryParamType)r.type == BinaryParamType::RGB ? 3 * n : n;
+				const Float* v;
+				if (!Array(r.data, nFloats, &v) || !v) return false;
+				std::unique_ptr<Float[]> floats(new Float[nFloats]);
+				std::copy(v, v + nFloats, floats.get());
+				if ((BinaryParamType)r.type == BinaryParamType::Float) {
+					ps->AddFloat(name, std::move(floats), n);
+					break;
+				}
+				std::unique_ptr<RGBSpectrum[]> s(new RGBSpectrum[n]);
+				for (int j = 0; j < n; ++j) s[j] = RGBSpectrum::FromRGB(&floats[3 * j]);
+				ps->AddRGBSpectrum(name, std::move(s), n);
+				break;
+			}
+			case BinaryParamType::Int: {
+				const int32_t* v;
+				if (!Array(r.data, n, &v) || !v) return false;
+				std::unique_ptr<int[]> values(new int[n]);
+				std::copy(v, v + n, values.get());
+				ps->AddInt(name, std::move(values), n);
+				break;
+			}
+			case BinaryParamType::Bool: {
+				const uint8_t* v;
+				if (!Array(r.data, n, &v) || !v) return false;
+				std::unique_ptr<bool[]> values(new bool[n]);
+				for (int j = 0; j < n; ++j) values[j] = v[j] != 0;
+				ps->AddBool(name, std::move(values), n);
+				break;
+			}
+			case BinaryParamType::String:
+			case BinaryParamType::Texture: {
+				std::unique_ptr<std::string[]> values(new std::string[n]);
+				uint64_t offset = r.data;
+				for (int j = 0; j < n; ++j) {
+					const char* s;
+					if (!String(offset, &s) || offset == 0) return false;
+					values[j] = s;
+					offset += values[j].size() + 1;
+				}
+				if ((BinaryParamType)r.type == BinaryParamType::Texture) {
+					if (n != 1) return false;
+					ps->AddTexture(name, values[0]);
+				} else
+					ps->AddString(name, std::move(values), n);
+				break;
+			}
+			case BinaryParamType::Point2f: {
+				const Point2f* v;
+				if (!Array(r.data, n, &v) || !v) return false;
+				std::unique_ptr<Point2f[]> values(new Point2f[n]);
+				std::copy(v, v + n, values.get());
+				ps->AddPoint2f(name, std::move(values), n);
+				break;
+			}
+			case BinaryParamType::Point3f: {
+				const Point3f* v;
+				if (!Array(r.data, n, &v) || !v) return false;
+				std::unique_ptr<Point3f[]> values(new Point3f[n]);
+				std::copy(v, v + n, values.get());
+				ps->AddPoint3f(name, std::move(values), n);
+				break;
+			}
+			case BinaryParamType::Vector3f: {
+				const Vector3f* v;
+				if (!Array(r.data, n, &v) || !v) return false;
+				std::unique_ptr<Vector3f[]> values(new Vector3f[n]);
+				std::copy(v, v + n, values.get());
+				ps->AddVector3f(name, std::move(values), n);
+				break;
+			}
+			case BinaryParamType::Normal3f: {
+				const Normal3f* v;
+				if (!Array(r.data, n, &v) || !v) return false;
+				std::unique_ptr<Normal3f[]> values(new Normal3f[n]);
+				std::copy(v, v + n, values.get());
+				ps->AddNormal3f(name, std::move(values), n);
+				break;
+			}
+			default:
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// BinarySceneWriter Method Definitions
+	uint64_t BinarySceneWriter::AddString(const std::string& s) {
+		uint64_t offset = strings.size();
+		strings.append(s.c_str(), s.size() + 1);
+		return offset;
+	}
+
+	template <typename T> uint64_t BinarySceneWriter::AddData(size_t count, T** ptr) {
+		uint64_t offset = RoundUp(data.size(), DataAlignment);
+		data.resize(offset + count * sizeof(T));
+		*ptr = (T*)&data[offset];
+		return offset;
+	}
+
+	uint32_t BinarySceneWriter::AddTransform(const Transform& t) {
+		BinaryTransformRecord r;
+		const Matrix4x4& m = t.GetMatrix();
+		for (int i = 0; i < 4; ++i)
+			for (int j = 0; j < 4; ++j) r.m[4 * j + i] = m.m[i][j];
+		transforms.push_back(r);
+		return (uint32_t)transforms.size() - 1;
+	}
+
+	template <typename T> static void CopyParamValues(const T* values, int n, T* dst) {
+		std::copy(values, values + n, dst);
+	}
+
+	static void CopyParamValues(const bool* values, int n, uint8_t* dst) {
+		for (int i = 0; i < n; ++i) dst[i] = values[i];
+	}
+
+	static void CopyParamValues(const RGBSpectrum* values, int n, Float* dst) {
+		for (int i = 0; i < n; ++i) values[i].ToRGB(&dst[3 * i]);
+	}
+
+	template <typename T, typename V> void BinarySceneWriter::AddParamItems(
+		const std::vector<std::shared_ptr<ParamSetItem<T>>>& items, BinaryParamType type, int valuesPerItem) {
+		for (const std::shared_ptr<ParamSetItem<T>>& item : items) {
+			BinaryParamRecord r;
+			r.name = AddString(item->name);
+			V* dst;
+			r.data = AddData(valuesPerItem * (size_t)item->nValues, &dst);
+			CopyParamValues(item->values.get(), item->nValues, dst);
+			r.type = (uint32_t)type;
+			r.nValues = (uint32_t)item->nValues;
+			params.push_back(r);
+		}
+	}
+
+	void BinarySceneWriter::AddStringParamItems(const std::vector<std::shared_ptr<ParamSetItem<std::string>>>& items,
+		BinaryParamType type) {
+		for (const std::shared_ptr<ParamSetItem<std::string>>& item : items) {
+			BinaryParamRecord r;
+			r.name = AddString(item->name);
+			r.data = strings.size();
+			for (int i = 0; i < item->nValues; ++i) AddString(item->values[i]);
+			r.type = (uint32_t)type;
+			r.nValues = (uint32_t)item->nValues;
+			params.push_back(r);
+		}
+	}
+
+	BinaryParamList BinarySceneWriter::AddParams(const ParamSet& ps) {
+		BinaryParamList list;
+		list.first = (uint32_t)params.size();
+		AddParamItems<Float, Float>(ps.floats, BinaryParamType::Float);
+		AddParamItems<int, int32_t>(ps.ints, BinaryParamType::Int);
+		AddParamItems<bool, uint8_t>(ps.bools, BinaryParamType::Bool);
+		AddStringParamItems(ps.strings, BinaryParamType::String);
+		AddParamItems<Point2f, Point2f>(ps.point2fs, BinaryParamType::Point2f);
+		AddParamItems<Point3f, Point3f>(ps.point3fs, BinaryParamType::Point3f);
+		AddParamItems<Vector3f, Vector3f>(ps.vector3fs, BinaryParamType::Vector3f);
+		AddParamItems<Normal3f, Normal3f>(ps.normals, BinaryParamType::Normal3f);
+		AddParamItems<RGBSpectrum, Float>(ps.spectra, BinaryParamType::RGB, 3);
+		AddStringParamItems(ps.textures, BinaryParamType::Texture);
+		list.count = (uint32_t)params.size() - list.first;
+		return list;
+	}
+
+	void BinarySceneWriter::AddOption(BinarySceneOption option, const std::string& name, const ParamSet& ps,
+		const Transform& ctm) {
+		BinaryOptionRecord r;
+		r.name = AddString(name);
+		r.params = AddParams(ps);
+		r.option = (uint32_t)option;
+		r.transform = AddTransform(ctm);
+		options.push_back(r);
+	}
+
+	void BinarySceneWriter::AddMaterial(const std::string& type, const ParamSet& ps, const std::string& name) {
+		BinaryMaterialRecord r;
+		r.type = AddString(type);
+		r.name = name.empty() ? 0 : AddString(name);
+		r.params = AddParams(ps);
+		materials.push_back(r);
+	}
+
+	void BinarySceneWriter::BeginObject(const std::string& name) {
+		CHECK_EQ(currentObject, ~0u);
+		BinaryObjectRecord r;
+		r.name = AddString(name);
+		r.firstMesh = (uint32_t)meshes.size();
+		r.firstShape = (uint32_t)shapes.size();
+		r.nMeshes = r.nShapes = 0;
+		currentObject = (uint32_t)objects.size();
+		objectIndices[name] = currentObject;
+		objects.push_back(r);
+	}
+
+	void BinarySceneWriter::EndObject() {
+		CHECK_NE(currentObject, ~0u);
+		BinaryObjectRecord& r = objects[currentObject];
+		r.nMeshes = (uint32_t)meshes.size() - r.firstMesh;
+		r.nShapes = (uint32_t)shapes.size() - r.firstShape;
+		currentObject = ~0u;
+	}
+
+	void BinarySceneWriter::AddMesh(int nTriangles, const int* vertexIndices, int nVertices, const Point3f* p,
+		const Vector3f* s, const Normal3f* n, const Point2f* uv, const Transform& objectToWorld,
+		bool reverseOrientation, const ParamSet& ps, int material) {
+		BinaryMeshRecord r;
+		r.nTriangles = nTriangles;
+		r.nVertices = nVertices;
+		r.object = currentObject;
+		r.material = material < 0 ? ~0u : (uint32_t)material;
+		TriangleMeshStorage storage = TriangleMeshStorageParams(ps);
+		reverseOrientation ^= ps.FindOneBool("reverseorientation", false) ^ objectToWorld.SwapsHandedness();
+		r.flags = (reverseOrientation ? (uint32_t)BinaryMeshReverseOrientation : 0u) |
+			(storage.compressNormals ? (uint32_t)BinaryMeshCompressNormals : 0u) |
+			(storage.compressTangents ? (uint32_t)BinaryMeshCompressTangents : 0u);
+		r.uvEncoding = (uint32_t)storage.uvEncoding;
+
+		int32_t* indices;
+		r.vertexIndices = AddData(3 * (size_t)nTriangles, &indices);
+		std::copy(vertexIndices, vertexIndices + 3 * (size_t)nTriangles, indices);
+		// Pointers into data are taken once it has grown to its final size
+		Point3f* pDst;
+		Vector3f* sDst = nullptr;
+		Normal3f* nDst = nullptr;
+		Point2f* uvDst = nullptr;
+		r.p = AddData(nVertices, &pDst);
+		r.s = s ? AddData(nVertices, &sDst) : 0;
+		r.n = n ? AddData(nVertices, &nDst) : 0;
+		r.uv = uv ? AddData(nVertices, &uvDst) : 0;
+		pDst = (Point3f*)&data[r.p];
+		if (s) sDst = (Vector3f*)&data[r.s];
+		if (n) nDst = (Normal3f*)&data[r.n];
+		if (uv) {
+			uvDst = (Point2f*)&data[r.uv];
+			std::copy(uv, uv + nVertices, uvDst);
+		}
+		ParallelFor([&](int64_t i) {
+			pDst[i] = objectToWorld(p[i]);
+			if (s) sDst[i] = objectToWorld(s[i]);
+			if (n) nDst[i] = objectToWorld(n[i]);
+		}, nVertices, 4096);
+		meshes.push_back(r);
+	}
+
+	void BinarySceneWriter::AddShape(const std::string& name, const ParamSet& ps, const Transform& objectToWorld,
+		bool reverseOrientation, int material) {
+		if (name == "trianglemesh") {
+			TriangleMeshArrays mesh;
+			if (TriangleMeshShapeArrays(ps, &mesh))
+				AddMesh(mesh.nTriangles, mesh.vertexIndices, mesh.nVertices, mesh.p, mesh.s, mesh.n, mesh.uv,
+					objectToWorld, reverseOrientation, ps, material);
+			ps.ReportUnused();
+		} else if (name == "plymesh") {
+			std::unique_ptr<PLYMesh> mesh = PLYMesh::Read(ps.FindOneString("filename", ""));
+			if (mesh)
+				AddMesh(mesh->nTriangles, mesh->vertexIndices, mesh->nVertices, mesh->p, nullptr, mesh->n,
+					mesh->uv, objectToWorld, reverseOrientation, ps, material);
+			ps.ReportUnused();
+		} else if (name == "objmesh") {
+			std::unique_ptr<OBJMesh> mesh = OBJMesh::Read(ps.FindOneString("filename", ""));
+			if (mesh)
+				AddMesh(mesh->nTriangles, mesh->vertexIndices, mesh->nVertices, mesh->p, nullptr, mesh->n,
+					mesh->uv, objectToWorld, reverseOrientation, ps, material);
+			ps.ReportUnused();
+		} else {
+			BinaryShapeRecord r;
+			r.name = AddString(name);
+			r.params = AddParams(ps);
+			r.transform = AddTransform(objectToWorld);
+			r.object = currentObject;
+			r.material = material < 0 ? ~0u : (uint32_t)material;
+			r.reverseOrientation = reverseOrientation;
+			shapes.push_back(r);
+		}
+	}
+
+	void BinarySceneWriter::AddInstance(const std::string& object, const Transform& instanceToWorld) {
+		auto iter = objectIndices.find(object);
+		if (iter == objectIndices.end()) {
+			LOG(ERROR) << "Unable to find instance named \"" << object << "\"";
+			return;
+		}
+		BinaryInstanceRecord r;
+		r.object = iter->second;
+		r.transform = AddTransform(instanceToWorld);
+		instances.push_back(r);
+	}
+
+	template <typename T> static void AppendSection(std::vector<char>& buf, const BinarySceneHeader& header,
+		BinarySceneSection s, const std::vector<T>& records) {
+		buf.resize(header.sections[(int)s].offset);
+		buf.insert(buf.end(), (const char*)records.data(), (const char*)(records.data() + records.size()));
+	}
+
+	bool BinarySceneWriter::Write(const std::string& filename) const {
+		// Sections are placed first so that string and data offsets can be
+		// patched into copies of the records
+		BinarySceneHeader header;
+		memset(&header, 0, sizeof(header));
+		memcpy(header.magic, BinarySceneMagic, sizeof(header.magic));
+		header.version = BinarySceneVersion;
+		header.floatSize = sizeof(Float);
+		size_t offset = sizeof(header);
+		auto place = [&](BinarySceneSection s, size_t size) {
+			offset = RoundUp(offset, SectionAlignment);
+			header.sections[(int)s].offset = offset;
+			header.sections[(int)s].size = size;
+			offset += size;
+		};
+		place(BinarySceneSection::Options, options.size() * sizeof(BinaryOptionRecord));
+		place(BinarySceneSection::Transforms, transforms.size() * sizeof(BinaryTransformRecord));
+		place(BinarySceneSection::Params, params.size() * sizeof(BinaryParamRecord));
+		place(BinarySceneSection::Materials, materials.size() * sizeof(BinaryMaterialRecord));
+		place(BinarySceneSection::Meshes, meshes.size() * sizeof(BinaryMeshRecord));
+		place(BinarySceneSection::Shapes, shapes.size() * sizeof(BinaryShapeRecord));
+		place(BinarySceneSection::Objects, objects.size() * sizeof(BinaryObjectRecord));
+		place(BinarySceneSection::Instances, instances.size() * sizeof(BinaryInstanceRecord));
+		place(BinarySceneSection::Strings, strings.size());
+		place(BinarySceneSection::Data, data.size());
+		header.fileSize = offset;
+
+		uint64_t stringBase = header.sections[(int)BinarySceneSection::Strings].offset;
+		uint64_t dataBase = header.sections[(int)BinarySceneSection::Data].offset;
+		auto str = [&](uint64_t& o) { if (o) o += stringBase; };
+		auto dat = [&](uint64_t& o) { if (o) o += dataBase; };
+		std::vector<BinaryOptionRecord> options = this->options;
+		std::vector<BinaryParamRecord> params = this->params;
+		std::vector<BinaryMaterialRecord> materials = this->materials;
+		std::vector<BinaryMeshRecord> meshes = this->meshes;
+		std::vector<BinaryShapeRecord> shapes = this->shapes;
+		std::vector<BinaryObjectRecord> objects = this->objects;
+		for (BinaryOptionRecord& r : options) str(r.name);
+		for (BinaryParamRecord& r : params) {
+			str(r.name);
+			if (r.type == (uint32_t)BinaryParamType::String || r.type == (uint32_t)BinaryParamType::Texture)
+				str(r.data);
+			else
+				dat(r.data);
+		}
+		for (BinaryMaterialRecord& r : materials) {
+			str(r.type);
+			str(r.name);
+		}
+		for (BinaryMeshRecord& r : meshes) {
+			dat(r.vertexIndices);
+			dat(r.p);
+			dat(r.s);
+			dat(r.n);
+			dat(r.uv);
+		}
+		for (BinaryShapeRecord& r : shapes) str(r.name);
+		for (BinaryObjectRecord& r : objects) str(r.name);
+
+		std::vector<char> buf;
+		buf.reserve(header.fileSize);
+		buf.insert(buf.end(), (const char*)&header, (const char*)&header + sizeof(header));
+		AppendSection(buf, header, BinarySceneSection::Options, options);
+		AppendSection(buf, header, BinarySceneSection::Transforms, transforms);
+		AppendSection(buf, header, BinarySceneSection::Params, params);
+		AppendSection(buf, header, BinarySceneSection::Materials, materials);
+		AppendSection(buf, header, BinarySceneSection::Meshes, meshes);
+		AppendSection(buf, header, BinarySceneSection::Shapes, shapes);
+		AppendSection(buf, header, BinarySceneSection::Objects, objects);
+		AppendSection(buf, header, BinarySceneSection::Instances, instances);
+		AppendSection(buf, header, BinarySceneSection::Strings, std::vector<char>(strings.begin(), strings.end()));
+		AppendSection(buf, header, BinarySceneSection::Data, data);
+		CHECK_EQ(buf.size(), header.fileSize);
+		if (!WriteFileAtomic(filename, buf.data(), buf.size())) {
+			LOG(ERROR) << "Error writing binary scene \"" << filename << "\"";
+			return false;
+		}
+		return true;
+	}
+
+	// BinaryScene Function Definitions
+	bool ReadBinaryScene(const std::string& filename, SceneBuilder* builder) {
+		MappedFile file;
+		if (!file.Open(filename)) {
+			LOG(ERROR) << "Unable to open binary scene \"" << filename << "\"";
+			return false;
+		}
+		if (file.Size() < sizeof(BinarySceneHeader) ||
+			memcmp(file.Data(), BinarySceneMagic, sizeof(BinarySceneMagic)) != 0 ||
+			((const BinarySceneHeader*)file.Data())->version != BinarySceneVersion) {
+			LOG(ERROR) << "\"" << filename << "\" isn't a version " << BinarySceneVersion << " binary scene";
+			return false;
+		}
+		const BinarySceneHeader& header = *(const BinarySceneHeader*)file.Data();
+		if (header.floatSize != sizeof(Float)) {
+			LOG(ERROR) << "Binary scene \"" << filename << "\" was written with " << 8 * header.floatSize <<
+				"-bit Floats; this build uses " << 8 * sizeof(Float);
+			return false;
+		}
+		auto corrupt = [&]() {
+			LOG(ERROR) << "Binary scene \"" << filename << "\" is truncated or corrupt";
+			return false;
+		};
+		if (header.fileSize != file.Size()) return corrupt();
+		for (const BinarySceneSectionEntry& e : header.sections)
+			if (e.offset % SectionAlignment != 0 || e.offset < sizeof(header) || e.offset > file.Size() ||
+				e.size > file.Size() - e.offset)
+				return corrupt();
+
+		BinarySceneReader reader(file.Data(), header);
+		const BinaryOptionRecord* options;
+		const BinaryTransformRecord* transforms;
+		const BinaryMaterialRecord* materials;
+		const BinaryMeshRecord* meshes;
+		const BinaryShapeRecord* shapes;
+		const BinaryObjectRecord* objects;
+		const BinaryInstanceRecord* instances;
+		uint32_t nOptions, nTransforms, nMaterials, nMeshes, nShapes, nObjects, nInstances;
+		if (!reader.Records(BinarySceneSection::Options, &options, &nOptions) ||
+			!reader.Records(BinarySceneSection::Transforms, &transforms, &nTransforms) ||
+			!reader.Records(BinarySceneSection::Materials, &materials, &nMaterials) ||
+			!reader.Records(BinarySceneSection::Meshes, &meshes, &nMeshes) ||
+			!reader.Records(BinarySceneSection::Shapes, &shapes, &nShapes) ||
+			!reader.Records(BinarySceneSection::Objects, &objects, &nObjects) ||
+			!reader.Records(BinarySceneSection::Instances, &instances, &nInstances))
+			return corrupt();
+
+		// Everything is checked and converted before builder sees any of it
+		struct Statement {
+			const char* name;
+			ParamSet params;
+		};
+		std::vector<Statement> optionStatements(nOptions), materialStatements(nMaterials);
+		std::vector<Statement> shapeStatements(nShapes);
+		std::vector<const char*> materialNames(nMaterials), objectNames(nObjects);
+		for (uint32_t i = 0; i < nOptions; ++i)
+			if (!reader.String(options[i].name, &optionStatements[i].name) ||
+				!reader.Params(options[i].params, &optionStatements[i].params) ||
+				options[i].option > (uint32_t)BinarySceneOption::Camera || options[i].transform >= nTransforms)
+				return corrupt();
+		for (uint32_t i = 0; i < nMaterials; ++i)
+			if (!reader.String(materials[i].type, &materialStatements[i].name) ||
+				!reader.String(materials[i].name, &materialNames[i]) ||
+				!reader.Params(materials[i].params, &materialStatements[i].params))
+				return corrupt();
+		for (uint32_t i = 0; i < nShapes; ++i)
+			if (!reader.String(shapes[i].name, &shapeStatements[i].name) ||
+				!reader.Params(shapes[i].params, &shapeStatements[i].params) || shapes[i].transform >= nTransforms ||
+				(shapes[i].object != ~0u && shapes[i].object >= nObjects) ||
+				(shapes[i].material != ~0u && shapes[i].material >= nMaterials))
+				return corrupt();
+		for (uint32_t i = 0; i < nObjects; ++i)
+			if (!reader.String(objects[i].name, &objectNames[i]) || objects[i].firstMesh > nMeshes ||
+				objects[i].nMeshes > nMeshes - objects[i].firstMesh || objects[i].firstShape > nShapes ||
+				objects[i].nShapes > nShapes - objects[i].firstShape)
+				return corrupt();
+		for (uint32_t i = 0; i < nInstances; ++i)
+			if (instances[i].object >= nObjects || instances[i].transform >= nTransforms) return corrupt();
+
+		// Offsets become pointers into the mapping; the meshes copy from it
+		std::vector<std::vector<std::shared_ptr<Shape>>> meshShapes(nMeshes);
+		std::atomic<bool> meshesOk(true);
+		ParallelFor([&](int64_t i) {
+			const BinaryMeshRecord& r = meshes[i];
+			const int32_t* vertexIndices;
+			const Point3f* p;
+			const Vector3f* s;
+			const Normal3f* n;
+			const Point2f* uv;
+			if (r.nTriangles < 0 || r.nVertices < 0 || r.uvEncoding > (uint32_t)UVEncoding::Unorm16 ||
+				(r.object != ~0u && r.object >= nObjects) || (r.material != ~0u && r.material >= nMaterials) ||
+				!reader.Array(r.vertexIndices, 3 * (uint64_t)r.nTriangles, &vertexIndices) ||
+				!reader.Array(r.p, r.nVertices, &p) || !p || !reader.Array(r.s, r.nVertices, &s) ||
+				!reader.Array(r.n, r.nVertices, &n) || !reader.Array(r.uv, r.nVertices, &uv)) {
+				meshesOk = false;
+				return;
+			}
+			TriangleMeshStorage storage;
+			storage.compressNormals = (r.flags & BinaryMeshCompressNormals) != 0;
+			storage.compressTangents = (r.flags & BinaryMeshCompressTangents) != 0;
+			storage.uvEncoding = (UVEncoding)r.uvEncoding;
+			meshShapes[i] = CreateTriangleMesh(r.nTriangles, vertexIndices, r.nVertices, p, s, n, uv, storage,
+				(r.flags & BinaryMeshReverseOrientation) != 0);
+		}, nMeshes, 1);
+		if (!meshesOk) return corrupt();
+
+		// Replay
+		for (uint32_t i = 0; i < nOptions; ++i) {
+			const Statement& st = optionStatements[i];
+			switch ((BinarySceneOption)options[i].option) {
+			case BinarySceneOption::PixelFilter: builder->pbrtPixelFilter(st.name, st.params); break;
+			case BinarySceneOption::Film: builder->pbrtFilm(st.name, st.params); break;
+			case BinarySceneOption::Sampler: builder->pbrtSampler(st.name, st.params); break;
+			case BinarySceneOption::Accelerator: builder->pbrtAccelerator(st.name, st.params); break;
+			case BinarySceneOption::Camera:
+				builder->pbrtTransform(transforms[options[i].transform].m);
+				builder->pbrtCamera(st.name, st.params);
+				break;
+			}
+		}
+		builder->pbrtWorldBegin();
+		for (uint32_t i = 0; i < nMaterials; ++i)
+			if (*materialNames[i]) builder->pbrtMakeNamedMaterial(materialNames[i], materialStatements[i].params);
+		uint32_t currentMaterial = ~0u;
+		auto setMaterial = [&](uint32_t m) {
+			if (m == currentMaterial || m == ~0u) return;
+			if (*materialNames[m])
+				builder->pbrtNamedMaterial(materialNames[m]);
+			else
+				builder->pbrtMaterial(materialStatements[m].name, materialStatements[m].params);
+			currentMaterial = m;
+		};
+		// There is no statement that unsets the material, so shapes without
+		// one go first
+		auto addShapes = [&](uint32_t object, uint32_t firstMesh, uint32_t endMesh, uint32_t firstShape,
+			uint32_t endShape) {
+			for (int pass = 0; pass < 2; ++pass) {
+				for (uint32_t i = firstMesh; i < endMesh; ++i) {
+					if (meshes[i].object != object || (meshes[i].material != ~0u) != (pass == 1)) continue;
+					setMaterial(meshes[i].material);
+					builder->AddShapes(meshShapes[i]);
+				}
+				for (uint32_t i = firstShape; i < endShape; ++i) {
+					if (shapes[i].object != object || (shapes[i].material != ~0u) != (pass == 1)) continue;
+					setMaterial(shapes[i].material);
+					builder->pbrtAttributeBegin();
+					builder->pbrtTransform(transforms[shapes[i].transform].m);
+					if (shapes[i].reverseOrientation) builder->pbrtReverseOrientation();
+					builder->pbrtShape(shapeStatements[i].name, shapeStatements[i].params);
+					builder->pbrtAttributeEnd();
+				}
+			}
+		};
+		for (uint32_t o = 0; o < nObjects; ++o) {
+			const BinaryObjectRecord& r = objects[o];
+			builder->pbrtObjectBegin(objectNames[o]);
+			addShapes(o, r.firstMesh, r.firstMesh + r.nMeshes, r.firstShape, r.firstShape + r.nShapes);
+			// ObjectEnd restores the material
+			builder->pbrtObjectEnd();
+			currentMaterial = ~0u;
+		}
+		addShapes(~0u, 0, nMeshes, 0, nShapes);
+		for (uint32_t i = 0; i < nInstances; ++i) {
+			builder->pbrtTransform(transforms[instances[i].transform].m);
+			builder->pbrtObjectInstance(objectNames[instances[i].object]);
+		}
+		builder->pbrtWorldEnd();
+		return true;
+	}
+
+}  // namespace pbr
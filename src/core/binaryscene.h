@@ -0,0 +1,164 @@
+#ifndef CORE_BINARYSCENE_H
+#define CORE_BINARYSCENE_H
+
+#include "pbr.h"
+#include "paramset.h"
+#include "transform.h"
+#include <map>
+
+namespace pbr {
+
+	class SceneBuilder;
+
+	// BinaryScene Declarations
+
+	// A .pbrb file is a header followed by the sections below, each aligned
+	// to 64 bytes and holding an array of the records that follow. Records
+	// refer to each other by index and to strings and arrays by file
+	// offset; 0 means none. Strings are NUL terminated and the arrays of
+	// the Data section are aligned to 16 bytes, so once the file is mapped
+	// and an offset checked, it is used as a pointer. Files are in native
+	// byte order and Float width.
+	enum class BinarySceneSection : uint32_t {
+		Options, Transforms, Params, Materials, Meshes, Shapes, Objects, Instances, Strings, Data, Count
+	};
+
+	struct BinarySceneSectionEntry {
+		uint64_t offset, size;
+	};
+
+	struct BinarySceneHeader {
+		char magic[8];
+		uint32_t version, floatSize;
+		uint64_t fileSize;
+		BinarySceneSectionEntry sections[(int)BinarySceneSection::Count];
+	};
+
+	// A range of the Params section
+	struct BinaryParamList {
+		uint32_t first, count;
+	};
+
+	enum class BinarySceneOption : uint32_t { PixelFilter, Film, Sampler, Accelerator, Camera };
+
+	// A statement before WorldBegin; transform is the CTM it was given at
+	struct BinaryOptionRecord {
+		uint64_t name;
+		BinaryParamList params;
+		uint32_t option, transform;
+	};
+
+	// A pbrt matrix, as pbrtTransform() takes it
+	struct BinaryTransformRecord {
+		Float m[16];
+	};
+
+	enum class BinaryParamType : uint32_t {
+		Float, Int, Bool, String, Point2f, Point3f, Vector3f, Normal3f, RGB, Texture
+	};
+
+	// data is the offset of nValues values: one byte per Bool, 3 Floats per
+	// RGB and consecutive strings for String and Texture
+	struct BinaryParamRecord {
+		uint64_t name, data;
+		uint32_t type, nValues;
+	};
+
+	// A Material, or a MakeNamedMaterial when name isn't 0
+	struct BinaryMaterialRecord {
+		uint64_t type, name;
+		BinaryParamList params;
+	};
+
+	enum BinaryMeshFlags : uint32_t {
+		BinaryMeshReverseOrientation = 1, BinaryMeshCompressNormals = 2, BinaryMeshCompressTangents = 4
+	};
+
+	// A triangle mesh in world space, or in the space of its object
+	struct BinaryMeshRecord {
+		uint64_t vertexIndices, p, s, n, uv;
+		int32_t nTriangles, nVertices;
+		// Indices, or ~0u for the world and no material
+		uint32_t object, material;
+		uint32_t flags, uvEncoding;
+	};
+
+	// A shape that isn't a triangle mesh, replayed as a Shape statement
+	struct BinaryShapeRecord {
+		uint64_t name;
+		BinaryParamList params;
+		uint32_t transform, object, material, reverseOrientation;
+	};
+
+	// The meshes and shapes of an object are consecutive
+	struct BinaryObjectRecord {
+		uint64_t name;
+		uint32_t firstMesh, nMeshes, firstShape, nShapes;
+	};
+
+	struct BinaryInstanceRecord {
+		uint32_t object, transform;
+	};
+
+	// Collects a scene as SceneBuilder hands it over and writes it as a
+	// .pbrb file. Triangle meshes are transformed when they are added, so
+	// loading the file only copies them out of the mapping.
+	class BinarySceneWriter {
+	public:
+		// BinarySceneWriter Public Methods
+		void AddOption(BinarySceneOption option, const std::string& name, const ParamSet& params,
+			const Transform& ctm = Transform());
+		// Materials are numbered in the order they are added
+		void AddMaterial(const std::string& type, const ParamSet& params, const std::string& name = "");
+		// Shapes between BeginObject() and EndObject() belong to the object
+		void BeginObject(const std::string& name);
+		void EndObject();
+		// "trianglemesh", "plymesh" and "objmesh" shapes are stored as
+		// meshes, others with their parameters; material is an index, or -1
+		// for none
+		void AddShape(const std::string& name, const ParamSet& params, const Transform& objectToWorld,
+			bool reverseOrientation, int material);
+		void AddInstance(const std::string& object, const Transform& instanceToWorld);
+		bool Write(const std::string& filename) const;
+
+	private:
+		// BinarySceneWriter Private Methods
+		uint64_t AddString(const std::string& s);
+		// Reserves 16-byte aligned space for count Ts in the Data section
+		template <typename T> uint64_t AddData(size_t count, T** ptr);
+		uint32_t AddTransform(const Transform& t);
+		BinaryParamList AddParams(const ParamSet& params);
+		// Values of type T are stored as valuesPerItem Vs each
+		template <typename T, typename V> void AddParamItems(
+			const std::vector<std::shared_ptr<ParamSetItem<T>>>& items, BinaryParamType type, int valuesPerItem = 1);
+		void AddStringParamItems(const std::vector<std::shared_ptr<ParamSetItem<std::string>>>& items,
+			BinaryParamType type);
+		void AddMesh(int nTriangles, const int* vertexIndices, int nVertices, const Point3f* p, const Vector3f* s,
+			const Normal3f* n, const Point2f* uv, const Transform& objectToWorld, bool reverseOrientation,
+			const ParamSet& params, int material);
+
+		// BinarySceneWriter Private Data
+		// Offsets are relative to the Strings and Data sections until Write()
+		std::vector<BinaryOptionRecord> options;
+		std::vector<BinaryTransformRecord> transforms;
+		std::vector<BinaryParamRecord> params;
+		std::vector<BinaryMaterialRecord> materials;
+		std::vector<BinaryMeshRecord> meshes;
+		std::vector<BinaryShapeRecord> shapes;
+		std::vector<BinaryObjectRecord> objects;
+		std::vector<BinaryInstanceRecord> instances;
+		std::string strings = std::string(1, '\0');
+		std::vector<char> data = std::vector<char>(16, 0);
+		std::map<std::string, uint32_t> objectIndices;
+		uint32_t currentObject = ~0u;
+	};
+
+	// Maps a .pbrb file and replays it into builder, from the options to
+	// WorldEnd. Meshes are created in parallel from the mapped arrays.
+	// False, with the reason logged, if the file is malformed; builder is
+	// left untouched then.
+	bool ReadBinaryScene(const std::string& filename, SceneBuilder* builder);
+
+}  // namespace pbr
+
+#endif  // CORE_BINARYSCENE_H
@@ -0,0 +1,181 @@
+#include "camera.h"
+#include "film.h"
+#include "paramset.h"
+
+namespace pbr {
+
+	// Camera Local Functions
+
+	// The loops below run over plain component arrays so the compiler can
+	// vectorize them
+	static void TransformPoints(const Matrix4x4& m, SoA3f* p, int count) {
+		Float* x = &p->x[0];
+		Float* y = &p->y[0];
+		Float* z = &p->z[0];
+		for (int i = 0; i < count; ++i) {
+			Float px = x[i], py = y[i], pz = z[i];
+			x[i] = m.m[0][0] * px + m.m[0][1] * py + m.m[0][2] * pz + m.m[0][3];
+			y[i] = m.m[1][0] * px + m.m[1][1] * py + m.m[1][2] * pz + m.m[1][3];
+			z[i] = m.m[2][0] * px + m.m[2][1] * py + m.m[2][2] * pz + m.m[2][3];
+		}
+	}
+
+	static void TransformVectors(const Matrix4x4& m, SoA3f* v, int count) {
+		Float* x = &v->x[0];
+		Float* y = &v->y[0];
+		Float* z = &v->z[0];
+		for (int i = 0; i < count; ++i) {
+			Float vx = x[i], vy = y[i], vz = z[i];
+			x[i] = m.m[0][0] * vx + m.m[0][1] * vy + m.m[0][2] * vz;
+			y[i] = m.m[1][0] * vx + m.m[1][1] * vy + m.m[1][2] * vz;
+			z[i] = m.m[2][0] * vx + m.m[2][1] * vy + m.m[2][2] * vz;
+		}
+	}
+
+	// Camera Utility Function Definitions
+	void NormalizeVectors(SoA3f* v, int count) {
+		Float* x = &v->x[0];
+		Float* y = &v->y[0];
+		Float* z = &v->z[0];
+		for (int i = 0; i < count; ++i) {
+			Float invLength = 1 / std::sqrt(x[i] * x[i] + y[i] * y[i] + z[i] * z[i]);
+			x[i] *= invLength;
+			y[i] *= invLength;
+			z[i] *= invLength;
+		}
+	}
+
+	void FocusThinLens(const Point2f* pLens, Float focalDistance, SoA3f* o, SoA3f* d, int count) {
+		for (int i = 0; i < count; ++i) {
+			// Compute point on plane of focus
+			Float ft = focalDistance / d->z[i];
+			Float fx = o->x[i] + d->x[i] * ft, fy = o->y[i] + d->y[i] * ft, fz = o->z[i] + d->z[i] * ft;
+
+			// Update ray for effect of lens
+			o->x[i] += pLens[i].x;
+			o->y[i] += pLens[i].y;
+			d->x[i] = fx - o->x[i];
+			d->y[i] = fy - o->y[i];
+			d->z[i] = fz - o->z[i];
+		}
+		NormalizeVectors(d, count);
+	}
+
+	Bounds2f ScreenWindowParameter(const ParamSet& params, const Film* film) {
+		Float frame = params.FindOneFloat("frameaspectratio",
+			Float(film->fullResolution.x) / Float(film->fullResolution.y));
+		Bounds2f screen;
+		if (frame > 1.f) {
+			screen.pMin.x = -frame;
+			screen.pMax.x = frame;
+			screen.pMin.y = -1.f;
+			screen.pMax.y = 1.f;
+		} else {
+			screen.pMin.x = -1.f;
+			screen.pMax.x = 1.f;
+			screen.pMin.y = -1.f / frame;
+			screen.pMax.y = 1.f / frame;
+		}
+		int swi;
+		const Float* sw = params.FindFloat("screenwindow", &swi);
+		if (sw) {
+			if (swi == 4) {
+				screen.pMin.x = sw[0];
+				screen.pMax.x = sw[1];
+				screen.pMin.y = sw[2];
+				screen.pMax.y = sw[3];
+			} else
+				LOG(ERROR) << "\"screenwindow\" should have four values";
+		}
+		return screen;
+	}
+
+	// CameraRayPacket Method Definitions
+	void CameraRayPacket::Resize(int n) {
+		o.Resize(n);
+		d.Resize(n);
+		rxOrigin.Resize(n);
+		rxDirection.Resize(n);
+		ryOrigin.Resize(n);
+		ryDirection.Resize(n);
+		time.resize(n);
+	}
+
+	RayDifferential CameraRayPacket::GetRayDifferential(int i) const {
+		RayDifferential rd(Point3f(o[i]), d[i], Infinity, time[i]);
+		rd.rxOrigin = Point3f(rxOrigin[i]);
+		rd.ryOrigin = Point3f(ryOrigin[i]);
+		rd.rxDirection = rxDirection[i];
+		rd.ryDirection = ryDirection[i];
+		rd.hasDifferentials = true;
+		return rd;
+	}
+
+	// Camera Method Definitions
+	Camera::Camera(const Transform& CameraToWorld, Float shutterOpen, Float shutterClose, Film* film)
+		: CameraToWorld(CameraToWorld), shutterOpen(shutterOpen), shutterClose(shutterClose), film(film) {
+		const Matrix4x4& m = CameraToWorld.GetMatrix();
+		if (m.m[3][0] != 0 || m.m[3][1] != 0 || m.m[3][2] != 0 || m.m[3][3] != 1)
+			LOG(FATAL) << "Camera-to-world transform must be affine";
+	}
+
+	Camera::~Camera() {}
+
+	Float Camera::GenerateRayDifferential(const CameraSample& sample, RayDifferential* rd) const {
+		Float wt = GenerateRay(sample, rd);
+		if (wt == 0) return 0;
+
+		// Find camera ray after shifting one pixel in the x and y directions
+		for (int axis = 0; axis < 2; ++axis) {
+			CameraSample sshift = sample;
+			sshift.pFilm[axis] += 1;
+			Ray r;
+			if (GenerateRay(sshift, &r) == 0) return 0;
+			if (axis == 0) {
+				rd->rxOrigin = r.o;
+				rd->rxDirection = r.d;
+			} else {
+				rd->ryOrigin = r.o;
+				rd->ryDirection = r.d;
+			}
+		}
+		rd->hasDifferentials = true;
+		return wt;
+	}
+
+	void Camera::PacketToWorld(const CameraSample* samples, CameraRayPacket* rays) const {
+		int count = rays->Size();
+		const Matrix4x4& m = CameraToWorld.GetMatrix();
+		TransformPoints(m, &rays->o, count);
+		TransformVectors(m, &rays->d, count);
+		TransformPoints(m, &rays->rxOrigin, count);
+		TransformVectors(m, &rays->rxDirection, count);
+		TransformPoints(m, &rays->ryOrigin, count);
+		TransformVectors(m, &rays->ryDirection, count);
+		for (int i = 0; i < count; ++i) rays->time[i] = Lerp(samples[i].time, shutterOpen, shutterClose);
+	}
+
+	// ProjectiveCamera Method Definitions
+	ProjectiveCamera::ProjectiveCamera(const Transform& CameraToWorld, const Transform& CameraToScreen,
+		const Bounds2f& screenWindow, Float shutterOpen, Float shutterClose, Float lensr, Float focald,
+		Film* film)
+		: Camera(CameraToWorld, shutterOpen, shutterClose, film), CameraToScreen(CameraToScreen) {
+		// Initialize depth of field parameters
+		lensRadius = lensr;
+		focalDistance = focald;
+
+		// Compute projective camera screen transformations
+		ScreenToRaster = Scale(film->fullResolution.x, film->fullResolution.y, 1) *
+			Scale(1 / (screenWindow.pMax.x - screenWindow.pMin.x), 1 / (screenWindow.pMin.y - screenWindow.pMax.y), 1) *
+			Translate(Vector3f(-screenWindow.pMin.x, -screenWindow.pMax.y, 0));
+		RasterToScreen = Inverse(ScreenToRaster);
+		RasterToCamera = Inverse(CameraToScreen) * RasterToScreen;
+
+		// The near plane is z = 0 in raster space, where both projections
+		// are affine in x and y
+		pCameraOrigin = RasterToCamera(Point3f(0, 0, 0));
+		dxCamera = RasterToCamera(Point3f(1, 0, 0)) - pCameraOrigin;
+		dyCamera = RasterToCamera(Point3f(0, 1, 0)) - pCameraOrigin;
+	}
+
+}  // namespace pbr
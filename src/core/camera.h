@@ -0,0 +1,102 @@
+#ifndef CORE_CAMERA_H
+#define CORE_CAMERA_H
+
+#include "pbr.h"
+#include "geometry.h"
+#include "transform.h"
+
+namespace pbr {
+
+	// Camera Declarations
+
+	// Where a camera ray starts: a raster position, a point on the lens in
+	// [0, 1)^2 and a time in [0, 1) within the shutter interval
+	struct CameraSample {
+		Point2f pFilm;
+		Point2f pLens;
+		Float time;
+	};
+
+	// Component arrays of a span of points or vectors
+	struct SoA3f {
+		void Resize(int n) {
+			x.resize(n);
+			y.resize(n);
+			z.resize(n);
+		}
+		Vector3f operator[](int i) const { return Vector3f(x[i], y[i], z[i]); }
+		std::vector<Float> x, y, z;
+	};
+
+	// World-space camera rays for a span of samples in structure-of-arrays
+	// layout, with the rays through the points one pixel over in x and y
+	struct CameraRayPacket {
+		void Resize(int n);
+		int Size() const { return (int)time.size(); }
+		Ray GetRay(int i) const { return Ray(Point3f(o[i]), d[i], Infinity, time[i]); }
+		RayDifferential GetRayDifferential(int i) const;
+
+		SoA3f o, d;
+		SoA3f rxOrigin, rxDirection, ryOrigin, ryDirection;
+		std::vector<Float> time;
+	};
+
+	class Camera {
+	public:
+		// Camera Interface
+		Camera(const Transform& CameraToWorld, Float shutterOpen, Float shutterClose, Film* film);
+		virtual ~Camera();
+		// Sets *ray to the world-space ray for sample and returns its weight
+		virtual Float GenerateRay(const CameraSample& sample, Ray* ray) const = 0;
+		// As GenerateRay(), with the differentials set to the rays one pixel
+		// over in x and y; by default traced through GenerateRay()
+		virtual Float GenerateRayDifferential(const CameraSample& sample, RayDifferential* rd) const;
+		// Rays for samples[0, count), with unit weight, computed a component
+		// array at a time
+		virtual void GenerateRays(const CameraSample* samples, int count, CameraRayPacket* rays) const = 0;
+
+		// Camera Public Data
+		Transform CameraToWorld;
+		const Float shutterOpen, shutterClose;
+		Film* film;
+
+	protected:
+		// Camera Protected Methods
+
+		// Applies CameraToWorld to the packet's camera-space points and
+		// vectors and fills in the times
+		void PacketToWorld(const CameraSample* samples, CameraRayPacket* rays) const;
+	};
+
+	// Camera with a projective camera-to-screen transform, optionally with a
+	// thin lens of lensRadius focused at focalDistance
+	class ProjectiveCamera : public Camera {
+	public:
+		// ProjectiveCamera Public Methods
+		ProjectiveCamera(const Transform& CameraToWorld, const Transform& CameraToScreen,
+			const Bounds2f& screenWindow, Float shutterOpen, Float shutterClose, Float lensr, Float focald,
+			Film* film);
+
+	protected:
+		// ProjectiveCamera Protected Data
+		Transform CameraToScreen, RasterToCamera;
+		Transform ScreenToRaster, RasterToScreen;
+		Float lensRadius, focalDistance;
+		// Camera-space point on the near plane for raster (0, 0), and its
+		// change per pixel in x and y
+		Point3f pCameraOrigin;
+		Vector3f dxCamera, dyCamera;
+	};
+
+	// Camera Utility Functions
+	void NormalizeVectors(SoA3f* v, int count);
+	// Moves the camera-space rays (o, d) by pLens across the lens and turns
+	// them toward the point they passed at depth focalDistance
+	void FocusThinLens(const Point2f* pLens, Float focalDistance, SoA3f* o, SoA3f* d, int count);
+	// The "screenwindow" parameter, by default [-1, 1] along the shorter
+	// axis of the "frameaspectratio" (by default the film's)
+	Bounds2f ScreenWindowParameter(const ParamSet& params, const Film* film);
+
+}  // namespace pbr
+
+#endif  // CORE_CAMERA_H
@@ -0,0 +1,150 @@
+#include "checkpoint.h"
+#include "fileutil.h"
+#include <fstream>
+
+namespace pbr {
+
+	// Checkpoint file layout: magic, version, sizeof(Float), pixel bounds,
+	// samplesCompleted, then the sizes and contents of the film state and
+	// the tile sample counts. Version 3 dropped the sampler state that
+	// followed them.
+	static const char CheckpointMagic[8] = { 'P', 'B', 'R', 'C', 'K', 'P', 'T', '\0' };
+	static const uint32_t CheckpointVersion = 3;
+
+	template <typename T> static void Append(std::vector<char>& buf, const T* v, size_t count = 1) {
+		const char* bytes = (const char*)v;
+		buf.insert(buf.end(), bytes, bytes + count * sizeof(T));
+	}
+
+	template <typename T> static bool Extract(const char*& p, const char* end, T* v, size_t count = 1) {
+		if ((size_t)(end - p) / sizeof(T) < count) return false;
+		memcpy(v, p, count * sizeof(T));
+		p += count * sizeof(T);
+		return true;
+	}
+
+	bool WriteCheckpoint(const std::string& filename, const RenderCheckpoint& checkpoint) {
+		std::vector<char> buf;
+		buf.reserve(64 + checkpoint.filmState.size() * sizeof(Float) + checkpoint.tileSamples.size() * 8);
+		uint32_t floatSize = sizeof(Float);
+		int32_t bounds[4] = { checkpoint.pixelBounds.pMin.x, checkpoint.pixelBounds.pMin.y,
+			checkpoint.pixelBounds.pMax.x, checkpoint.pixelBounds.pMax.y };
+		uint64_t filmSize = checkpoint.filmState.size(), tileCount = checkpoint.tileSamples.size();
+		Append(buf, CheckpointMagic, sizeof(CheckpointMagic));
+		Append(buf, &CheckpointVersion);
+		Append(buf, &floatSize);
+		Append(buf, bounds, 4);
+		Append(buf, &checkpoint.samplesCompleted);
+		Append(buf, &filmSize);
+		Append(buf, checkpoint.filmState.data(), filmSize);
+		Append(buf, &tileCount);
+		Append(buf, checkpoint.tileSamples.data(), tileCount);
+		if (!WriteFileAtomic(filename, buf.data(), buf.size())) {
+			LOG(ERROR) << "Error writing checkpoint \"" << filename << "\"";
+			return false;
+		}
+		return true;
+	}
+
+	bool ReadCheckpoint(const std::string& filename, RenderCheckpoint* checkpoint) {
+		std::ifstream in(filename, std::ios::binary);
+		if (!in) {
+			LOG(ERROR) << "Unable to open checkpoint \"" << filename << "\"";
+			return false;
+		}
+		std::vector<char> buf((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+		const char* p = buf.data(), * end = buf.data() + buf.size();
+
+		char magic[sizeof(CheckpointMagic)];
+		uint32_t version, floatSize;
+		int32_t bounds[4];
+		uint64_t filmSize, tileCount;
+		if (!Extract(p, end, magic, sizeof(magic)) || memcmp(magic, CheckpointMagic, sizeof(magic)) != 0 ||
+			!Extract(p, end, &version) || version != CheckpointVersion) {
+			LOG(ERROR) << "\"" << filename << "\" isn't a version " << CheckpointVersion << " checkpoint";
+			return false;
+		}
+		if (!Extract(p, end, &floatSize)) {
+			LOG(ERROR) << "Checkpoint \"" << filename << "\" is truncated";
+			return false;
+		}
+		if (floatSize != sizeof(Float)) {
+			LOG(ERROR) << "Checkpoint \"" << filename << "\" was written with " << 8 * floatSize <<
+				"-bit Floats; this build uses " << 8 * sizeof(Float);
+			return false;
+		}
+		bool ok = Extract(p, end, bounds, 4) && Extract(p, end, &checkpoint->samplesCompleted) &&
+			Extract(p, end, &filmSize) && filmSize <= (uint64_t)(end - p) / sizeof(Float);
+		if (ok) {
+			checkpoint->filmState.resize(filmSize);
+			ok = Extract(p, end, checkpoint->filmState.data(), filmSize) && Extract(p, end, &tileCount) &&
+				tileCount == (uint64_t)(end - p) / sizeof(int64_t);
+		}
+		if (ok) {
+			checkpoint->tileSamples.resize(tileCount);
+			ok = Extract(p, end, checkpoint->tileSamples.data(), tileCount) && p == end;
+		}
+		if (!ok) {
+			LOG(ERROR) << "Checkpoint \"" << filename << "\" is truncated or corrupt";
+			return false;
+		}
+		checkpoint->pixelBounds = Bounds2i(Point2i(bounds[0], bounds[1]), Point2i(bounds[2], bounds[3]));
+		return true;
+	}
+
+	// CheckpointWriter Method Definitions
+	CheckpointWriter::CheckpointWriter(const std::string& filename, Float intervalSeconds)
+		: filename(filename), interval(intervalSeconds), lastSubmit(std::chrono::steady_clock::now()) {
+		thread = std::thread(&CheckpointWriter::Run, this);
+	}
+
+	CheckpointWriter::~CheckpointWriter() {
+		Flush();
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			exit = true;
+		}
+		cv.notify_all();
+		thread.join();
+	}
+
+	bool CheckpointWriter::Due() const {
+		std::lock_guard<std::mutex> lock(mutex);
+		return std::chrono::steady_clock::now() - lastSubmit >= interval;
+	}
+
+	void CheckpointWriter::Submit(RenderCheckpoint checkpoint) {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			queued.reset(new RenderCheckpoint(std::move(checkpoint)));
+			lastSubmit = std::chrono::steady_clock::now();
+		}
+		cv.notify_all();
+	}
+
+	bool CheckpointWriter::Flush() {
+		std::unique_lock<std::mutex> lock(mutex);
+		cv.wait(lock, [this]() { return !queued && !writing; });
+		return !failed;
+	}
+
+	void CheckpointWriter::Run() {
+		std::unique_lock<std::mutex> lock(mutex);
+		while (true) {
+			cv.wait(lock, [this]() { return queued || exit; });
+			if (!queued) return;
+			std::unique_ptr<RenderCheckpoint> checkpoint = std::move(queued);
+			writing = true;
+			lock.unlock();
+			bool ok = WriteCheckpoint(filename, *checkpoint);
+			if (ok)
+				LOG(INFO) << "Checkpointed " << checkpoint->samplesCompleted << " samples per pixel to \"" <<
+					filename << "\"";
+			lock.lock();
+			writing = false;
+			failed |= !ok;
+			cv.notify_all();
+		}
+	}
+
+}  // namespace pbr
@@ -0,0 +1,68 @@
+#ifndef CORE_CHECKPOINT_H
+#define CORE_CHECKPOINT_H
+
+#include "pbr.h"
+#include "geometry.h"
+#include <condition_variable>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+namespace pbr {
+
+	// Render progress captured between sampling passes: resuming from it
+	// continues with pass samplesCompleted without redoing earlier ones.
+	// Samplers derive every sample from its pixel and index alone, so the
+	// sample counts are all the sampler state there is.
+	struct RenderCheckpoint {
+		// Samples per pixel already accumulated into the film; the average
+		// when adaptive sampling gave each tile its own count
+		int64_t samplesCompleted = 0;
+		// Samples per pixel of each tile of an adaptive render, else empty
+		std::vector<int64_t> tileSamples;
+		// Film::GetState() of the film's croppedPixelBounds
+		Bounds2i pixelBounds;
+		std::vector<Float> filmState;
+	};
+
+	// Checkpoints are stored in native byte order and Float width, with a
+	// header that rejects files from a build with a different Float.
+	bool WriteCheckpoint(const std::string& filename, const RenderCheckpoint& checkpoint);
+	bool ReadCheckpoint(const std::string& filename, RenderCheckpoint* checkpoint);
+
+	// Writes checkpoints on a background thread so that render threads only
+	// pay for capturing the state. Files are replaced atomically, so a
+	// preempted write leaves the previous checkpoint intact.
+	class CheckpointWriter {
+	public:
+		// CheckpointWriter Public Methods
+		CheckpointWriter(const std::string& filename, Float intervalSeconds);
+		~CheckpointWriter();
+		// True once intervalSeconds have passed since construction or the
+		// last Submit(). Like Submit(), safe to call from any thread.
+		bool Due() const;
+		// Queues checkpoint and returns at once; a queued checkpoint that
+		// hasn't been written yet is superseded
+		void Submit(RenderCheckpoint checkpoint);
+		// Waits for the queued checkpoint; false if any write failed
+		bool Flush();
+
+	private:
+		// CheckpointWriter Private Methods
+		void Run();
+
+		// CheckpointWriter Private Data
+		const std::string filename;
+		const std::chrono::duration<double> interval;
+		// Guarded by mutex, with the fields below
+		std::chrono::steady_clock::time_point lastSubmit;
+		mutable std::mutex mutex;
+		std::condition_variable cv;
+		std::unique_ptr<RenderCheckpoint> queued;
+		bool writing = false, failed = false, exit = false;
+		std::thread thread;
+	};
+
+}  // namespace pbr
+
+#endif  // CORE_CHECKPOINT_H
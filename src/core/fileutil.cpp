@@ -0,0 +1,198 @@
+#include "fileutil.h"
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <thread>
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace pbr {
+
+	bool MappedFile::Open(const std::string& filename) {
+		Close();
+#ifdef _WIN32
+		HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+			OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE) return false;
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+			CloseHandle(file);
+			return false;
+		}
+		HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (!mapping) {
+			CloseHandle(file);
+			return false;
+		}
+		void* ptr = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		if (!ptr) {
+			CloseHandle(mapping);
+			CloseHandle(file);
+			return false;
+		}
+		fileHandle = file;
+		mappingHandle = mapping;
+		size = (size_t)fileSize.QuadPart;
+		data = (const char*)ptr;
+#else
+		int fd = open(filename.c_str(), O_RDONLY);
+		if (fd < 0) return false;
+		struct stat st;
+		if (fstat(fd, &st) != 0 || st.st_size == 0) {
+			close(fd);
+			return false;
+		}
+		void* ptr = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		// The mapping keeps its own reference to the file
+		close(fd);
+		if (ptr == MAP_FAILED) return false;
+		size = (size_t)st.st_size;
+		data = (const char*)ptr;
+#endif
+		return true;
+	}
+
+	void MappedFile::Close() {
+		if (!data) return;
+#ifdef _WIN32
+		UnmapViewOfFile(data);
+		CloseHandle((HANDLE)mappingHandle);
+		CloseHandle((HANDLE)fileHandle);
+		mappingHandle = fileHandle = nullptr;
+#else
+		munmap((void*)data, size);
+#endif
+		data = nullptr;
+		size = 0;
+	}
+
+	bool RandomAccessFile::Open(const std::string& filename) {
+		Close();
+#ifdef _WIN32
+		HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+			OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE) return false;
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(file, &fileSize)) {
+			CloseHandle(file);
+			return false;
+		}
+		fileHandle = file;
+		size = (uint64_t)fileSize.QuadPart;
+#else
+		fd = open(filename.c_str(), O_RDONLY);
+		if (fd < 0) return false;
+		struct stat st;
+		if (fstat(fd, &st) != 0) {
+			Close();
+			return false;
+		}
+		size = (uint64_t)st.st_size;
+#endif
+		return true;
+	}
+
+	void RandomAccessFile::Close() {
+#ifdef _WIN32
+		if (fileHandle) CloseHandle((HANDLE)fileHandle);
+		fileHandle = nullptr;
+#else
+		if (fd >= 0) close(fd);
+		fd = -1;
+#endif
+		size = 0;
+	}
+
+	bool RandomAccessFile::IsOpen() const {
+#ifdef _WIN32
+		return fileHandle != nullptr;
+#else
+		return fd >= 0;
+#endif
+	}
+
+	bool RandomAccessFile::Read(uint64_t offset, size_t nBytes, void* dst) const {
+		if (!IsOpen() || offset + nBytes > size) return false;
+		char* p = (char*)dst;
+		while (nBytes > 0) {
+#ifdef _WIN32
+			// Positioned reads through OVERLAPPED don't share a file pointer
+			OVERLAPPED overlapped = {};
+			overlapped.Offset = (DWORD)offset;
+			overlapped.OffsetHigh = (DWORD)(offset >> 32);
+			DWORD chunk = (DWORD)std::min(nBytes, (size_t)1 << 30), nRead = 0;
+			if (!ReadFile((HANDLE)fileHandle, p, chunk, &nRead, &overlapped) || nRead == 0) return false;
+#else
+			ssize_t nRead = pread(fd, p, nBytes, (off_t)offset);
+			if (nRead < 0 && errno == EINTR) continue;
+			if (nRead <= 0) return false;
+#endif
+			p += nRead;
+			offset += nRead;
+			nBytes -= nRead;
+		}
+		return true;
+	}
+
+	std::string JoinPath(const std::string& dir, const std::string& filename) {
+		if (dir.empty()) return filename;
+		char last = dir[dir.size() - 1];
+		if (last == '/' || last == '\\') return dir + filename;
+		return dir + "/" + filename;
+	}
+
+	bool IsAbsolutePath(const std::string& filename) {
+		if (filename.empty()) return false;
+#ifdef _WIN32
+		if (filename.size() >= 2 && filename[1] == ':') return true;
+#endif
+		return filename[0] == '/' || filename[0] == '\\';
+	}
+
+	std::string DirectoryContaining(const std::string& filename) {
+		size_t slash = filename.find_last_of("/\\");
+		return slash == std::string::npos ? std::string() : filename.substr(0, slash + 1);
+	}
+
+	bool FileExists(const std::string& filename) {
+		std::ifstream f(filename);
+		return f.good();
+	}
+
+	bool WriteFileAtomic(const std::string& filename, const void* data, size_t size) {
+		// Unique temporary name so that concurrent writers don't interleave
+		std::string tmpName = filename + ".tmp" +
+			std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()) ^
+			(size_t)std::chrono::steady_clock::now().time_since_epoch().count());
+		{
+			std::ofstream out(tmpName, std::ios::binary | std::ios::trunc);
+			if (!out) return false;
+			out.write((const char*)data, size);
+			if (!out) {
+				out.close();
+				std::remove(tmpName.c_str());
+				return false;
+			}
+		}
+#ifdef _WIN32
+		// rename() doesn't replace existing files on Windows
+		if (!MoveFileExA(tmpName.c_str(), filename.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+#else
+		if (std::rename(tmpName.c_str(), filename.c_str()) != 0) {
+#endif
+			std::remove(tmpName.c_str());
+			return false;
+		}
+		return true;
+	}
+
+}  // namespace pbr
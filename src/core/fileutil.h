@@ -0,0 +1,70 @@
+#ifndef CORE_FILEUTIL_H
+#define CORE_FILEUTIL_H
+
+#include "pbr.h"
+
+namespace pbr {
+
+	// Read-only memory mapping of a whole file. Pages are faulted in on
+	// first touch, so opening a large file is cheap until it is read.
+	class MappedFile {
+	public:
+		MappedFile() {}
+		~MappedFile() { Close(); }
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		bool Open(const std::string& filename);
+		void Close();
+
+		bool IsOpen() const { return data != nullptr; }
+		const char* Data() const { return data; }
+		size_t Size() const { return size; }
+
+	private:
+		const char* data = nullptr;
+		size_t size = 0;
+#ifdef _WIN32
+		void* fileHandle = nullptr;
+		void* mappingHandle = nullptr;
+#endif
+	};
+
+	// File read at explicit offsets; Read() may be called concurrently
+	class RandomAccessFile {
+	public:
+		RandomAccessFile() {}
+		~RandomAccessFile() { Close(); }
+		RandomAccessFile(const RandomAccessFile&) = delete;
+		RandomAccessFile& operator=(const RandomAccessFile&) = delete;
+
+		bool Open(const std::string& filename);
+		void Close();
+
+		bool IsOpen() const;
+		uint64_t Size() const { return size; }
+		// Reads exactly size bytes at offset into dst
+		bool Read(uint64_t offset, size_t size, void* dst) const;
+
+	private:
+		uint64_t size = 0;
+#ifdef _WIN32
+		void* fileHandle = nullptr;
+#else
+		int fd = -1;
+#endif
+	};
+
+	std::string JoinPath(const std::string& dir, const std::string& filename);
+	bool IsAbsolutePath(const std::string& filename);
+	// The directory part of filename, or "" if it has none
+	std::string DirectoryContaining(const std::string& filename);
+	bool FileExists(const std::string& filename);
+
+	// Writes the file under a temporary name and renames it into place so
+	// concurrent readers never observe a partially written file.
+	bool WriteFileAtomic(const std::string& filename, const void* data, size_t size);
+
+}  // namespace pbr
+
+#endif  // CORE_FILEUTIL_H
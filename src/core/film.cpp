@@ -0,0 +1,368 @@
+#include "film.h"
+#include "imageio.h"
+#include "memory.h"
+#include "paramset.h"
+#include <new>
+
+namespace pbr {
+
+	// FilmTile Method Definitions
+	void FilmTile::AddSample(const Point2f& pFilm, const RGBSpectrum& L, Float sampleWeight) {
+		// Compute sample's raster bounds
+		Point2f pFilmDiscrete = pFilm - Vector2f(0.5f, 0.5f);
+		Point2i p0 = (Point2i)Ceil(pFilmDiscrete - filterRadius);
+		Point2i p1 = (Point2i)Floor(pFilmDiscrete + filterRadius) + Point2i(1, 1);
+		p0 = Max(p0, pixelBounds.pMin);
+		p1 = Min(p1, pixelBounds.pMax);
+
+		// Loop over filter support and add sample to pixel arrays
+
+		// Precompute $x$ and $y$ filter table offsets
+		int* ifx = ALLOCA(int, std::max(0, p1.x - p0.x));
+		for (int x = p0.x; x < p1.x; ++x) {
+			Float fx = std::abs((x - pFilmDiscrete.x) * invFilterRadius.x * filterTableSize);
+			ifx[x - p0.x] = std::min((int)std::floor(fx), filterTableSize - 1);
+		}
+		int* ify = ALLOCA(int, std::max(0, p1.y - p0.y));
+		for (int y = p0.y; y < p1.y; ++y) {
+			Float fy = std::abs((y - pFilmDiscrete.y) * invFilterRadius.y * filterTableSize);
+			ify[y - p0.y] = std::min((int)std::floor(fy), filterTableSize - 1);
+		}
+		RGBSpectrum weightedL = L * sampleWeight;
+		for (int y = p0.y; y < p1.y; ++y)
+			for (int x = p0.x; x < p1.x; ++x) {
+				// Evaluate filter value at $(x,y)$ pixel
+				int offset = ify[y - p0.y] * filterTableSize + ifx[x - p0.x];
+				Float filterWeight = filterTable[offset];
+
+				// Update pixel values with filtered sample contribution
+				FilmTilePixel& pixel = GetPixel(Point2i(x, y));
+				pixel.contribSum += weightedL * filterWeight;
+				pixel.filterWeightSum += filterWeight;
+			}
+
+		// Track the sample's luminance in the pixel that contains it
+		Point2i pi = (Point2i)Floor(pFilm);
+		if (InsideExclusive(pi, varianceBounds))
+			GetPixel(pi).varianceEstimator.Add(sampleWeight * L.y());
+	}
+
+	// Film Method Definitions
+	Film::Film(const Point2i& resolution, const Bounds2f& cropWindow, std::unique_ptr<Filter> filt,
+		const std::string& filename, Float scale, int streamTileSize)
+		: fullResolution(resolution), filter(std::move(filt)), filename(filename), scale(scale) {
+		// Compute film image bounds
+		croppedPixelBounds = Bounds2i(
+			Point2i((int)std::ceil(fullResolution.x * cropWindow.pMin.x), (int)std::ceil(fullResolution.y * cropWindow.pMin.y)),
+			Point2i((int)std::ceil(fullResolution.x * cropWindow.pMax.x), (int)std::ceil(fullResolution.y * cropWindow.pMax.y)));
+		LOG(INFO) << "Created film with full resolution " << resolution << ". Crop window of " << cropWindow <<
+			" -> croppedPixelBounds " << croppedPixelBounds;
+
+		// Precompute filter weight table
+		int offset = 0;
+		for (int y = 0; y < filterTableWidth; ++y) {
+			for (int x = 0; x < filterTableWidth; ++x, ++offset) {
+				Point2f p;
+				p.x = (x + 0.5f) * filter->radius.x / filterTableWidth;
+				p.y = (y + 0.5f) * filter->radius.y / filterTableWidth;
+				filterTable[offset] = filter->Evaluate(p);
+			}
+		}
+
+		Vector2i extent = croppedPixelBounds.Diagonal();
+		nLockBlocks = Point2i((extent.x + LockBlockSize - 1) / LockBlockSize,
+			(extent.y + LockBlockSize - 1) / LockBlockSize);
+		lockBlocks.reset(new std::mutex[std::max(1, nLockBlocks.x * nLockBlocks.y)]);
+
+		if (streamTileSize > 0) {
+			streamWriter = OpenScanlineWriter(filename, croppedPixelBounds);
+			if (!streamWriter) LOG(ERROR) << "Unable to stream \"" << filename << "\"; buffering the full image";
+		}
+		if (streamWriter) {
+			// Count the grid tiles that reach each row
+			rows.resize(extent.y);
+			rowTilesPending.resize(extent.y);
+			Point2i nTiles = GetTileCount(streamTileSize);
+			for (int ty = 0; ty < nTiles.y; ++ty)
+				for (int tx = 0; tx < nTiles.x; ++tx) {
+					Bounds2i tileBounds = GetTilePixelBounds(GetTileSampleBounds(Point2i(tx, ty), streamTileSize));
+					if (tileBounds.pMin.x == tileBounds.pMax.x) continue;
+					for (int y = tileBounds.pMin.y; y < tileBounds.pMax.y; ++y)
+						++rowTilesPending[y - croppedPixelBounds.pMin.y];
+				}
+		} else {
+			// Allocate film image storage
+			nPixels = croppedPixelBounds.SurfaceArea();
+			pixels = AllocAligned<Pixel>(nPixels);
+			for (size_t i = 0; i < nPixels; ++i) new (&pixels[i]) Pixel();
+			pixelVariance.reset(new VarianceEstimator[nPixels]);
+		}
+	}
+
+	Film::~Film() {
+		for (size_t i = 0; i < nPixels; ++i) pixels[i].~Pixel();
+		FreeAligned(pixels);
+	}
+
+	Bounds2i Film::GetSampleBounds() const {
+		Bounds2f floatBounds(Floor(Point2f(croppedPixelBounds.pMin) + Vector2f(0.5f, 0.5f) - filter->radius),
+			Ceil(Point2f(croppedPixelBounds.pMax) - Vector2f(0.5f, 0.5f) + filter->radius));
+		return (Bounds2i)floatBounds;
+	}
+
+	Point2i Film::GetTileCount(int tileSize) const {
+		Vector2i extent = GetSampleBounds().Diagonal();
+		return Point2i((extent.x + tileSize - 1) / tileSize, (extent.y + tileSize - 1) / tileSize);
+	}
+
+	Bounds2i Film::GetTileSampleBounds(const Point2i& tile, int tileSize) const {
+		Bounds2i sampleBounds = GetSampleBounds();
+		Point2i p0 = sampleBounds.pMin + tile * tileSize;
+		Point2i p1 = Min(p0 + Point2i(tileSize, tileSize), sampleBounds.pMax);
+		return Bounds2i(p0, p1);
+	}
+
+	Bounds2i Film::GetTilePixelBounds(const Bounds2i& sampleBounds) const {
+		// Bound image pixels that samples in _sampleBounds_ contribute to
+		Vector2f halfPixel = Vector2f(0.5f, 0.5f);
+		Bounds2f floatBounds = (Bounds2f)sampleBounds;
+		Point2i p0 = (Point2i)Ceil(floatBounds.pMin - halfPixel - filter->radius);
+		Point2i p1 = (Point2i)Floor(floatBounds.pMax - halfPixel + filter->radius) + Point2i(1, 1);
+		Bounds2i tilePixelBounds = Intersect(Bounds2i(p0, p1), croppedPixelBounds);
+		tilePixelBounds.pMax = Max(tilePixelBounds.pMin, tilePixelBounds.pMax);
+		return tilePixelBounds;
+	}
+
+	std::unique_ptr<FilmTile> Film::GetFilmTile(const Bounds2i& sampleBounds) {
+		return std::unique_ptr<FilmTile>(new FilmTile(GetTilePixelBounds(sampleBounds), sampleBounds,
+			filter->radius, filterTable, filterTableWidth));
+	}
+
+	void Film::MergeFilmTile(std::unique_ptr<FilmTile> tile) {
+		Bounds2i bounds = tile->GetPixelBounds();
+		if (bounds.pMin.x >= bounds.pMax.x || bounds.pMin.y >= bounds.pMax.y) return;
+		int width = croppedPixelBounds.pMax.x - croppedPixelBounds.pMin.x;
+
+		if (streamWriter) {
+			// Allocate the rows this tile is first to reach
+			std::lock_guard<std::mutex> lock(streamMutex);
+			for (int y = bounds.pMin.y; y < bounds.pMax.y; ++y) {
+				std::unique_ptr<Pixel[]>& row = rows[y - croppedPixelBounds.pMin.y];
+				CHECK_GT(rowTilesPending[y - croppedPixelBounds.pMin.y], 0) << "Tile merged into a written row";
+				if (row) continue;
+				row.reset(new Pixel[width]);
+				peakResidentRows = std::max(peakResidentRows, ++residentRows);
+			}
+		}
+
+		// Lock the blocks the tile overlaps, always in the same order
+		Point2i b0 = Point2i((bounds.pMin.x - croppedPixelBounds.pMin.x) / LockBlockSize,
+			(bounds.pMin.y - croppedPixelBounds.pMin.y) / LockBlockSize);
+		Point2i b1 = Point2i((bounds.pMax.x - 1 - croppedPixelBounds.pMin.x) / LockBlockSize,
+			(bounds.pMax.y - 1 - croppedPixelBounds.pMin.y) / LockBlockSize);
+		for (int by = b0.y; by <= b1.y; ++by)
+			for (int bx = b0.x; bx <= b1.x; ++bx) lockBlocks[by * nLockBlocks.x + bx].lock();
+
+		for (int y = bounds.pMin.y; y < bounds.pMax.y; ++y) {
+			Pixel* row = GetPixelRow(y);
+			VarianceEstimator* rowVariance = pixelVariance ?
+				&pixelVariance[(size_t)(y - croppedPixelBounds.pMin.y) * width] : nullptr;
+			for (int x = bounds.pMin.x; x < bounds.pMax.x; ++x) {
+				// Merge _pixel_ into _Film::pixels_
+				const FilmTilePixel& tilePixel = tile->GetPixel(Point2i(x, y));
+				Pixel& mergePixel = row[x - croppedPixelBounds.pMin.x];
+				mergePixel.rgb += tilePixel.contribSum;
+				mergePixel.filterWeightSum += tilePixel.filterWeightSum;
+				// Leaves estimates without new samples untouched
+				if (rowVariance) rowVariance[x - croppedPixelBounds.pMin.x].Merge(tilePixel.varianceEstimator);
+			}
+		}
+
+		for (int by = b0.y; by <= b1.y; ++by)
+			for (int bx = b0.x; bx <= b1.x; ++bx) lockBlocks[by * nLockBlocks.x + bx].unlock();
+
+		if (streamWriter) {
+			std::lock_guard<std::mutex> lock(streamMutex);
+			for (int y = bounds.pMin.y; y < bounds.pMax.y; ++y) {
+				int& pending = rowTilesPending[y - croppedPixelBounds.pMin.y];
+				CHECK_GT(pending, 0) << "Tile merged more than once, or not from the streaming tile grid";
+				--pending;
+			}
+			WriteCompletedRows(bounds.pMin.y - croppedPixelBounds.pMin.y, bounds.pMax.y - croppedPixelBounds.pMin.y,
+				false);
+		}
+	}
+
+	bool Film::WriteCompletedRows(int y0, int y1, bool all) {
+		// Write each band of completed rows, or of unwritten rows, and free it
+		int width = croppedPixelBounds.pMax.x - croppedPixelBounds.pMin.x;
+		auto ready = [&](int y) { return rowTilesPending[y] == 0 || (all && rowTilesPending[y] > 0); };
+		bool ok = true;
+		for (int bandStart = y0; bandStart < y1;) {
+			if (!ready(bandStart)) {
+				++bandStart;
+				continue;
+			}
+			int bandEnd = bandStart + 1;
+			while (bandEnd < y1 && ready(bandEnd)) ++bandEnd;
+			std::vector<Float> rgb(3 * (size_t)width * (bandEnd - bandStart), 0.f);
+			for (int y = bandStart; y < bandEnd; ++y) {
+				rowTilesPending[y] = -1;
+				if (!rows[y]) continue;
+				for (int x = 0; x < width; ++x)
+					GetPixelRGB(rows[y][x], 0, &rgb[3 * ((size_t)(y - bandStart) * width + x)]);
+				rows[y].reset();
+				--residentRows;
+			}
+			ok &= streamWriter->WriteRows(bandStart, bandEnd - bandStart, rgb.data());
+			bandStart = bandEnd;
+		}
+		return ok;
+	}
+
+	void Film::AddSplat(const Point2f& p, const RGBSpectrum& v) {
+		if (streamWriter) {
+			LOG_FIRST_N(WARNING, 1) << "Streaming film \"" << filename << "\" ignores splats";
+			return;
+		}
+		for (int c = 0; c < 3; ++c)
+			if (std::isnan(v[c]) || std::isinf(v[c])) {
+				LOG(WARNING) << "Ignoring splatted value with non-finite component at (" << p.x << ", " << p.y << ")";
+				return;
+			}
+		Point2i pi = (Point2i)Floor(p);
+		if (!InsideExclusive(pi, croppedPixelBounds)) return;
+		Pixel& pixel = GetPixel(pi);
+		for (int c = 0; c < 3; ++c) pixel.splatRGB[c].Add(v[c]);
+	}
+
+	bool Film::GetState(std::vector<Float>* state) const {
+		if (streamWriter) {
+			LOG(ERROR) << "Can't capture the state of streaming film \"" << filename << "\"";
+			return false;
+		}
+		// Take every lock block, in the same order as merges do
+		int nBlocks = std::max(1, nLockBlocks.x * nLockBlocks.y);
+		for (int b = 0; b < nBlocks; ++b) lockBlocks[b].lock();
+		state->resize(StateFloatsPerPixel * nPixels);
+		Float* s = state->data();
+		for (size_t i = 0; i < nPixels; ++i, s += StateFloatsPerPixel) {
+			const Pixel& pixel = pixels[i];
+			for (int c = 0; c < 3; ++c) {
+				s[c] = pixel.rgb[c];
+				s[4 + c] = pixel.splatRGB[c];
+			}
+			s[3] = pixel.filterWeightSum;
+			const VarianceEstimator& ve = pixelVariance[i];
+			s[7] = (Float)ve.Count();
+			s[8] = ve.Mean();
+			s[9] = ve.SumSquaredDeviations();
+		}
+		for (int b = 0; b < nBlocks; ++b) lockBlocks[b].unlock();
+		return true;
+	}
+
+	bool Film::SetState(const std::vector<Float>& state) {
+		if (streamWriter || state.size() != StateFloatsPerPixel * nPixels) {
+			LOG(ERROR) << "Film state doesn't match the " << croppedPixelBounds << " pixels of \"" << filename << "\"";
+			return false;
+		}
+		const Float* s = state.data();
+		for (size_t i = 0; i < nPixels; ++i, s += StateFloatsPerPixel) {
+			Pixel& pixel = pixels[i];
+			for (int c = 0; c < 3; ++c) {
+				pixel.rgb[c] = s[c];
+				pixel.splatRGB[c] = s[4 + c];
+			}
+			pixel.filterWeightSum = s[3];
+			pixelVariance[i] = VarianceEstimator((int32_t)s[7], s[8], s[9]);
+		}
+		return true;
+	}
+
+	Float Film::GetRelativeError(const Bounds2i& sampleBounds) const {
+		Bounds2i bounds = Intersect(sampleBounds, croppedPixelBounds);
+		if (!pixelVariance || bounds.pMin.x >= bounds.pMax.x || bounds.pMin.y >= bounds.pMax.y) return 0;
+		int width = croppedPixelBounds.pMax.x - croppedPixelBounds.pMin.x;
+		double sumVarianceOfMean = 0, sumMean = 0;
+		for (int y = bounds.pMin.y; y < bounds.pMax.y; ++y)
+			for (int x = bounds.pMin.x; x < bounds.pMax.x; ++x) {
+				const VarianceEstimator& ve =
+					pixelVariance[(size_t)(y - croppedPixelBounds.pMin.y) * width + (x - croppedPixelBounds.pMin.x)];
+				if (ve.Count() < 2) return Infinity;
+				sumVarianceOfMean += ve.Variance() / ve.Count();
+				sumMean += ve.Mean();
+			}
+		if (sumMean <= 0) return sumVarianceOfMean == 0 ? 0 : Infinity;
+		// The pixel count cancels between the RMS and the average
+		return Float(std::sqrt(sumVarianceOfMean * bounds.SurfaceArea()) / sumMean);
+	}
+
+	void Film::GetPixelRGB(const Pixel& pixel, Float splatScale, Float rgb[3]) const {
+		RGBSpectrum splat(pixel.splatRGB[0], pixel.splatRGB[1], pixel.splatRGB[2]);
+		GetPixelRGB(pixel.rgb, pixel.filterWeightSum, splat, splatScale, rgb);
+	}
+
+	void Film::GetPixelRGB(const RGBSpectrum& sum, Float weightSum, const RGBSpectrum& splat, Float splatScale,
+		Float rgb[3]) const {
+		// Normalize pixel with weight sum, then add splat value
+		Float invWt = weightSum != 0 ? 1 / weightSum : 0;
+		RGBSpectrum v = ClampZero(sum * invWt) + splatScale * splat;
+		RGBSpectrum(v * scale).ToRGB(rgb);
+	}
+
+	std::vector<Float> Film::GetImage(Float splatScale) const {
+		CHECK(!streamWriter) << "Streaming films don't keep the image";
+		std::vector<Float> rgb(3 * nPixels);
+		int offset = 0;
+		for (int y = croppedPixelBounds.pMin.y; y < croppedPixelBounds.pMax.y; ++y)
+			for (int x = croppedPixelBounds.pMin.x; x < croppedPixelBounds.pMax.x; ++x, ++offset)
+				GetPixelRGB(GetPixel(Point2i(x, y)), splatScale, &rgb[3 * offset]);
+		return rgb;
+	}
+
+	std::vector<Float> Film::GetImage(const std::vector<Float>& state, Float splatScale) const {
+		size_t n = croppedPixelBounds.SurfaceArea();
+		CHECK_EQ(state.size(), StateFloatsPerPixel * n);
+		std::vector<Float> rgb(3 * n);
+		for (size_t i = 0; i < n; ++i) {
+			const Float* s = &state[StateFloatsPerPixel * i];
+			GetPixelRGB(RGBSpectrum(s[0], s[1], s[2]), s[3], RGBSpectrum(s[4], s[5], s[6]), splatScale, &rgb[3 * i]);
+		}
+		return rgb;
+	}
+
+	bool Film::WriteImage(Float splatScale) {
+		if (streamWriter) {
+			std::lock_guard<std::mutex> lock(streamMutex);
+			LOG(INFO) << "Finishing streamed image " << filename << "; at most " << peakResidentRows <<
+				" rows were resident";
+			bool ok = WriteCompletedRows(0, croppedPixelBounds.pMax.y - croppedPixelBounds.pMin.y, true);
+			return streamWriter->Close() && ok;
+		}
+		LOG(INFO) << "Writing image " << filename << " with bounds " << croppedPixelBounds;
+		std::vector<Float> rgb = GetImage(splatScale);
+		return pbr::WriteImage(filename, rgb.data(), croppedPixelBounds);
+	}
+
+	std::unique_ptr<Film> CreateFilm(const ParamSet& params, std::unique_ptr<Filter> filter) {
+		std::string filename = params.FindOneString("filename", "pbr.pfm");
+		int xres = params.FindOneInt("xresolution", 1280);
+		int yres = params.FindOneInt("yresolution", 720);
+		Bounds2f crop(Point2f(0, 0), Point2f(1, 1));
+		int cwi;
+		const Float* cr = params.FindFloat("cropwindow", &cwi);
+		if (cr && cwi == 4) {
+			crop.pMin.x = Clamp(std::min(cr[0], cr[1]), 0.f, 1.f);
+			crop.pMax.x = Clamp(std::max(cr[0], cr[1]), 0.f, 1.f);
+			crop.pMin.y = Clamp(std::min(cr[2], cr[3]), 0.f, 1.f);
+			crop.pMax.y = Clamp(std::max(cr[2], cr[3]), 0.f, 1.f);
+		} else if (cr)
+			LOG(ERROR) << cwi << " values supplied for \"cropwindow\". Expected 4.";
+		Float scale = params.FindOneFloat("scale", 1.);
+		int streamTileSize = params.FindOneBool("streaming", false) ? params.FindOneInt("tilesize", 16) : 0;
+		return std::unique_ptr<Film>(new Film(Point2i(xres, yres), crop, std::move(filter), filename, scale,
+			streamTileSize));
+	}
+
+}  // namespace pbr
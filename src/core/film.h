@@ -0,0 +1,222 @@
+#ifndef CORE_FILM_H
+#define CORE_FILM_H
+
+#include "pbr.h"
+#include "geometry.h"
+#include "filter.h"
+#include "parallel.h"
+#include "imageio.h"
+#include "memory.h"
+#include "spectrum.h"
+#include <mutex>
+
+namespace pbr {
+
+	// Running mean and variance of a stream of values (Welford's method).
+	// Estimators of disjoint streams combine exactly with Merge().
+	class VarianceEstimator {
+	public:
+		VarianceEstimator() {}
+		VarianceEstimator(int32_t n, Float mean, Float m2) : n(n), mean(mean), m2(m2) {}
+		void Add(Float x) {
+			++n;
+			Float delta = x - mean;
+			mean += delta / n;
+			m2 += delta * (x - mean);
+		}
+		void Merge(const VarianceEstimator& ve) {
+			if (ve.n == 0) return;
+			int32_t count = n + ve.n;
+			Float delta = ve.mean - mean;
+			mean += delta * ve.n / count;
+			m2 += ve.m2 + delta * delta * ((Float)n * ve.n / count);
+			n = count;
+		}
+		int32_t Count() const { return n; }
+		Float Mean() const { return mean; }
+		Float Variance() const { return n > 1 ? m2 / (n - 1) : 0; }
+		Float SumSquaredDeviations() const { return m2; }
+
+	private:
+		int32_t n = 0;
+		Float mean = 0, m2 = 0;
+	};
+
+	// FilmTilePixel Declarations
+	struct FilmTilePixel {
+		RGBSpectrum contribSum;
+		Float filterWeightSum = 0;
+		// Luminance of the samples that fall inside this pixel
+		VarianceEstimator varianceEstimator;
+	};
+
+	// Private accumulation buffer for one worker's share of the image; it
+	// needs no synchronization until it is merged into the Film. Variance
+	// is only tracked for samples within the tile's sample bounds.
+	class FilmTile {
+	public:
+		// FilmTile Public Methods
+		FilmTile(const Bounds2i& pixelBounds, const Bounds2i& sampleBounds, const Vector2f& filterRadius,
+			const Float* filterTable, int filterTableSize)
+			: pixelBounds(pixelBounds), varianceBounds(Intersect(pixelBounds, sampleBounds)),
+			filterRadius(filterRadius),
+			invFilterRadius(1 / filterRadius.x, 1 / filterRadius.y), filterTable(filterTable),
+			filterTableSize(filterTableSize), pixels(std::max(0, pixelBounds.SurfaceArea())) {}
+		void AddSample(const Point2f& pFilm, const RGBSpectrum& L, Float sampleWeight = 1);
+		FilmTilePixel& GetPixel(const Point2i& p) {
+			DCHECK(InsideExclusive(p, pixelBounds));
+			int width = pixelBounds.pMax.x - pixelBounds.pMin.x;
+			return pixels[(p.y - pixelBounds.pMin.y) * width + (p.x - pixelBounds.pMin.x)];
+		}
+		const FilmTilePixel& GetPixel(const Point2i& p) const {
+			DCHECK(InsideExclusive(p, pixelBounds));
+			int width = pixelBounds.pMax.x - pixelBounds.pMin.x;
+			return pixels[(p.y - pixelBounds.pMin.y) * width + (p.x - pixelBounds.pMin.x)];
+		}
+		Bounds2i GetPixelBounds() const { return pixelBounds; }
+
+	private:
+		// FilmTile Private Data
+		const Bounds2i pixelBounds, varianceBounds;
+		const Vector2f filterRadius, invFilterRadius;
+		const Float* filterTable;
+		const int filterTableSize;
+		std::vector<FilmTilePixel> pixels;
+	};
+
+	// Film Declarations
+
+	// Accumulates the image either in a full-frame buffer or, when streaming,
+	// in rows that are written out and freed as soon as every tile that
+	// overlaps them has been merged.
+	class Film {
+	public:
+		// Film Public Methods
+		Film(const Point2i& resolution, const Bounds2f& cropWindow, std::unique_ptr<Filter> filter,
+			const std::string& filename, Float scale = 1, int streamTileSize = 0);
+		~Film();
+		Bounds2i GetSampleBounds() const;
+		// Tiling of GetSampleBounds() into tileSize squares from its minimum
+		// corner; streaming films expect tiles from exactly this grid
+		Point2i GetTileCount(int tileSize) const;
+		Bounds2i GetTileSampleBounds(const Point2i& tile, int tileSize) const;
+		std::unique_ptr<FilmTile> GetFilmTile(const Bounds2i& sampleBounds);
+		// Safe to call concurrently; tiles only contend where their pixel
+		// bounds share a lock block. Streaming films write completed rows
+		// before returning, and each grid tile must be merged exactly once.
+		void MergeFilmTile(std::unique_ptr<FilmTile> tile);
+		// Lock-free accumulation of a contribution at an arbitrary film
+		// position, for light tracing and BDPT connections. Streaming films
+		// can't revisit written rows, so they drop splats.
+		void AddSplat(const Point2f& p, const RGBSpectrum& v);
+		// Final RGB of the cropped pixels, top row first; splats are
+		// weighted by splatScale. Not available when streaming.
+		std::vector<Float> GetImage(Float splatScale = 1) const;
+		// Streaming films write the rows still resident and close the file;
+		// rows no tile reached are black
+		bool WriteImage(Float splatScale = 1);
+		// Copies every pixel's accumulated sums, weight and splats for a
+		// checkpoint, holding off tile merges while copying. Streaming films
+		// have written their rows away and can't be captured.
+		bool GetState(std::vector<Float>* state) const;
+		// Replaces the accumulated values with a GetState() capture of a film
+		// with the same cropped pixel bounds
+		bool SetState(const std::vector<Float>& state);
+		// Relative standard error of the pixel means over the cropped pixels
+		// of sampleBounds: the RMS standard error of the sample luminance
+		// means relative to their average. Infinity until every pixel has
+		// two samples. Only the tile that owns a pixel's samples updates its
+		// estimate, so a tile may query its sample bounds after merging
+		// while other tiles are still being merged.
+		Float GetRelativeError(const Bounds2i& sampleBounds) const;
+		// GetImage() of a GetState() capture, so that images can be made
+		// without holding up further rendering
+		std::vector<Float> GetImage(const std::vector<Float>& state, Float splatScale = 1) const;
+		bool IsStreaming() const { return (bool)streamWriter; }
+		// Most pixel rows held at once by a streaming film
+		int PeakResidentRows() const { return peakResidentRows; }
+
+		// Film Public Data
+		const Point2i fullResolution;
+		std::unique_ptr<Filter> filter;
+		const std::string filename;
+		Bounds2i croppedPixelBounds;
+
+	private:
+		// Film Private Data
+
+		// Fills a Pixel's 8 Floats, counting rgb's padding, out to a cache
+		// line; a char array can't be empty, so a full line takes none
+		template <size_t Bytes> struct PixelPadding {
+			char pad[Bytes];
+		};
+		struct NoPixelPadding {};
+
+		// A whole cache line, so with the cache-line aligned allocation
+		// threads splatting to different pixels never share a line. This
+		// doubles the float image's memory. Streaming rows are only
+		// touched under the lock blocks and aren't line aligned.
+		struct Pixel : std::conditional<PBR_L1_CACHE_LINE_SIZE == 8 * sizeof(Float), NoPixelPadding,
+			PixelPadding<PBR_L1_CACHE_LINE_SIZE - 8 * sizeof(Float)>>::type {
+			RGBSpectrum rgb;
+			Float filterWeightSum = 0;
+			AtomicFloat splatRGB[3];
+		};
+		static_assert(sizeof(Pixel) == PBR_L1_CACHE_LINE_SIZE, "Film::Pixel doesn't fill a cache line");
+
+		// Tile merges lock square blocks of this many pixels on a side
+		static const int LockBlockSize = 32;
+		// Floats per pixel in GetState(): rgb sums, weight sum, splats, and
+		// the sample count, mean and summed squared deviations of the
+		// pixel's VarianceEstimator
+		static const int StateFloatsPerPixel = 10;
+
+		// Film Private Methods
+		Pixel* GetPixelRow(int y) {
+			DCHECK(y >= croppedPixelBounds.pMin.y && y < croppedPixelBounds.pMax.y);
+			int row = y - croppedPixelBounds.pMin.y;
+			if (streamWriter) return rows[row].get();
+			return pixels + (size_t)row * (croppedPixelBounds.pMax.x - croppedPixelBounds.pMin.x);
+		}
+		Pixel& GetPixel(const Point2i& p) {
+			DCHECK(InsideExclusive(p, croppedPixelBounds));
+			return GetPixelRow(p.y)[p.x - croppedPixelBounds.pMin.x];
+		}
+		const Pixel& GetPixel(const Point2i& p) const { return const_cast<Film*>(this)->GetPixel(p); }
+		Bounds2i GetTilePixelBounds(const Bounds2i& sampleBounds) const;
+		void GetPixelRGB(const Pixel& pixel, Float splatScale, Float rgb[3]) const;
+		void GetPixelRGB(const RGBSpectrum& sum, Float weightSum, const RGBSpectrum& splat, Float splatScale,
+			Float rgb[3]) const;
+		// Rows [y0, y1) from the top of the cropped bounds
+		bool WriteCompletedRows(int y0, int y1, bool all);
+
+		Pixel* pixels = nullptr;
+		std::unique_ptr<VarianceEstimator[]> pixelVariance;
+		size_t nPixels = 0;
+		// Filter values over the positive quadrant of its support, sampled
+		// at cell centers, so that AddSample() is a table lookup
+		static PBRT_CONSTEXPR int filterTableWidth = 16;
+		Float filterTable[filterTableWidth * filterTableWidth];
+		const Float scale;
+		Point2i nLockBlocks;
+		std::unique_ptr<std::mutex[]> lockBlocks;
+
+		// Streaming state, guarded by streamMutex: rows are allocated by the
+		// first tile to reach them, and rowTilesPending counts the grid tiles
+		// each row still waits for. A row is written and freed once its count
+		// reaches zero, in any order, and its count becomes -1.
+		std::unique_ptr<ScanlineWriter> streamWriter;
+		std::mutex streamMutex;
+		std::vector<std::unique_ptr<Pixel[]>> rows;
+		std::vector<int> rowTilesPending;
+		int residentRows = 0, peakResidentRows = 0;
+	};
+
+	// Supported parameters: "xresolution", "yresolution" (int), "cropwindow"
+	// (4 floats: x0 x1 y0 y1 in NDC), "filename" (string), "scale" (float),
+	// "streaming" (bool) with "tilesize" (int, default 16)
+	std::unique_ptr<Film> CreateFilm(const ParamSet& params, std::unique_ptr<Filter> filter);
+
+}  // namespace pbr
+
+#endif  // CORE_FILM_H
@@ -0,0 +1,8 @@
+#include "filter.h"
+
+namespace pbr {
+
+	// Filter Method Definitions
+	Filter::~Filter() {}
+
+}  // namespace pbr
@@ -0,0 +1,28 @@
+#ifndef CORE_FILTER_H
+#define CORE_FILTER_H
+
+#include "pbr.h"
+#include "geometry.h"
+
+namespace pbr {
+
+	// Filter Declarations
+
+	// Pixel reconstruction filter with support [-radius, radius]. Film
+	// tabulates Evaluate() once, so implementations may be arbitrarily
+	// expensive.
+	class Filter {
+	public:
+		// Filter Interface
+		virtual ~Filter();
+		Filter(const Vector2f& radius)
+			: radius(radius), invRadius(Vector2f(1 / radius.x, 1 / radius.y)) {}
+		virtual Float Evaluate(const Point2f& p) const = 0;
+
+		// Filter Public Data
+		const Vector2f radius, invRadius;
+	};
+
+}  // namespace pbr
+
+#endif  // CORE_FILTER_H
@@ -1,5 +1,95 @@
 #include "geometry.h"
 
+#if !defined(PBR_FLOAT_AS_DOUBLE) && (defined(__SSE2__) || defined(_M_X64))
+#define PBR_HAVE_SSE2
+#include <emmintrin.h>
+#endif
+
 namespace pbr {
 
-}
\ No newline at end of file
+#pragma region CompressedNormal
+
+#ifdef PBR_HAVE_SSE2
+	static const __m128 SignMask = _mm_castsi128_ps(_mm_set1_epi32(0x80000000));
+	static const __m128 AbsMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+
+	// Encodes four normals; mirrors CompressedNormal::Encode() operation for operation
+	static inline void EncodeNormals4(const Normal3f* n, CompressedNormal* cn) {
+		const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.f);
+		__m128 x = _mm_setr_ps(n[0].x, n[1].x, n[2].x, n[3].x);
+		__m128 y = _mm_setr_ps(n[0].y, n[1].y, n[2].y, n[3].y);
+		__m128 z = _mm_setr_ps(n[0].z, n[1].z, n[2].z, n[3].z);
+
+		// Project onto the octahedron
+		__m128 invL1 = _mm_div_ps(one, _mm_add_ps(_mm_add_ps(_mm_and_ps(x, AbsMask), _mm_and_ps(y, AbsMask)),
+			_mm_and_ps(z, AbsMask)));
+		__m128 ox = _mm_mul_ps(x, invL1), oy = _mm_mul_ps(y, invL1);
+
+		// Fold the lower hemisphere where z < 0
+		__m128 sx = _mm_or_ps(one, _mm_and_ps(ox, SignMask));
+		__m128 sy = _mm_or_ps(one, _mm_and_ps(oy, SignMask));
+		__m128 fx = _mm_mul_ps(_mm_sub_ps(one, _mm_and_ps(oy, AbsMask)), sx);
+		__m128 fy = _mm_mul_ps(_mm_sub_ps(one, _mm_and_ps(ox, AbsMask)), sy);
+		__m128 lower = _mm_cmplt_ps(z, zero);
+		ox = _mm_or_ps(_mm_and_ps(lower, fx), _mm_andnot_ps(lower, ox));
+		oy = _mm_or_ps(_mm_and_ps(lower, fy), _mm_andnot_ps(lower, oy));
+
+		// Quantize to [0, 65535]; the conversion rounds to nearest even
+		const __m128 half = _mm_set1_ps(0.5f), scale = _mm_set1_ps(65535.f);
+		__m128i qx = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_add_ps(ox, one), half), zero), one), scale));
+		__m128i qy = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_add_ps(oy, one), half), zero), one), scale));
+
+		// Narrow to unsigned 16 bits through the signed saturating pack and
+		// interleave to x0 y0 x1 y1 ...
+		const __m128i bias = _mm_set1_epi32(32768);
+		__m128i packed = _mm_packs_epi32(_mm_sub_epi32(qx, bias), _mm_sub_epi32(qy, bias));
+		packed = _mm_xor_si128(packed, _mm_set1_epi16((short)0x8000));
+		_mm_storeu_si128((__m128i*)cn, _mm_unpacklo_epi16(packed, _mm_srli_si128(packed, 8)));
+	}
+
+	// Decodes four normals; mirrors CompressedNormal::Decode()
+	static inline void DecodeNormals4(const CompressedNormal* cn, Normal3f* n) {
+		const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.f);
+		__m128i v = _mm_loadu_si128((const __m128i*)cn);
+		__m128 ux = _mm_cvtepi32_ps(_mm_and_si128(v, _mm_set1_epi32(0xffff)));
+		__m128 uy = _mm_cvtepi32_ps(_mm_srli_epi32(v, 16));
+
+		const __m128 two = _mm_set1_ps(2.f), scale = _mm_set1_ps(65535.f);
+		__m128 nx = _mm_add_ps(_mm_set1_ps(-1.f), _mm_mul_ps(two, _mm_div_ps(ux, scale)));
+		__m128 ny = _mm_add_ps(_mm_set1_ps(-1.f), _mm_mul_ps(two, _mm_div_ps(uy, scale)));
+		__m128 nz = _mm_sub_ps(_mm_sub_ps(one, _mm_and_ps(nx, AbsMask)), _mm_and_ps(ny, AbsMask));
+
+		// Unfold the lower hemisphere
+		__m128 t = _mm_max_ps(_mm_xor_ps(nz, SignMask), zero);
+		nx = _mm_sub_ps(nx, _mm_xor_ps(t, _mm_and_ps(nx, SignMask)));
+		ny = _mm_sub_ps(ny, _mm_xor_ps(t, _mm_and_ps(ny, SignMask)));
+
+		__m128 len2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, nx), _mm_mul_ps(ny, ny)), _mm_mul_ps(nz, nz));
+		__m128 invLen = _mm_div_ps(one, _mm_sqrt_ps(len2));
+		alignas(16) float rx[4], ry[4], rz[4];
+		_mm_store_ps(rx, _mm_mul_ps(nx, invLen));
+		_mm_store_ps(ry, _mm_mul_ps(ny, invLen));
+		_mm_store_ps(rz, _mm_mul_ps(nz, invLen));
+		for (int i = 0; i < 4; ++i) n[i] = Normal3f(rx[i], ry[i], rz[i]);
+	}
+#endif  // PBR_HAVE_SSE2
+
+	void EncodeNormals(const Normal3f* n, size_t count, CompressedNormal* cn) {
+		size_t i = 0;
+#ifdef PBR_HAVE_SSE2
+		for (; i + 4 <= count; i += 4) EncodeNormals4(n + i, cn + i);
+#endif
+		for (; i < count; ++i) cn[i] = CompressedNormal(n[i]);
+	}
+
+	void DecodeNormals(const CompressedNormal* cn, size_t count, Normal3f* n) {
+		size_t i = 0;
+#ifdef PBR_HAVE_SSE2
+		for (; i + 4 <= count; i += 4) DecodeNormals4(cn + i, n + i);
+#endif
+		for (; i < count; ++i) n[i] = cn[i].Decode();
+	}
+
+#pragma endregion CompressedNormal
+
+}  // namespace pbr
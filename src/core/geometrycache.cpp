@@ -0,0 +1,116 @@
+#include "geometrycache.h"
+#include "primitive.h"
+#include <atomic>
+
+namespace pbr {
+
+	// GeometryCache Local Definitions
+	static std::atomic<uint64_t> nextGeometrySourceId{ 1 }, nextGeometryCacheId{ 1 };
+
+	// One slot of a thread's direct-mapped micro-cache; cache 0 marks it
+	// empty. missing records sources cached as nullptr, which a weak_ptr
+	// can't tell from evicted ones.
+	struct GeometryMicroCacheSlot {
+		uint64_t cache = 0, source = 0;
+		std::weak_ptr<Primitive> geometry;
+		bool missing = false;
+	};
+	static thread_local GeometryMicroCacheSlot geometryMicroCache[GeometryCache::MicroCacheSize];
+
+	// GeometrySource Method Definitions
+	GeometrySource::GeometrySource() : id(nextGeometrySourceId++) {}
+
+	GeometrySource::~GeometrySource() {}
+
+	// GeometryCache Method Definitions
+	GeometryCache::GeometryCache(size_t capacityBytes) : id(nextGeometryCacheId++), capacity(capacityBytes) {}
+
+	GeometryCache::~GeometryCache() {
+		Stats stats = GetStats();
+		if (stats.misses > 0)
+			LOG(INFO) << "Geometry cache: " << stats.misses << " loads, " << stats.hits << " shared hits, " <<
+				stats.evictions << " evicted, " << stats.rejections << " too large, peak " << stats.peakResidentBytes / (1024 * 1024) << " of " <<
+				capacity / (1024 * 1024) << " MB resident";
+	}
+
+	std::shared_ptr<Primitive> GeometryCache::Get(const GeometrySource& source) {
+		GeometryMicroCacheSlot& slot = geometryMicroCache[source.id & (MicroCacheSize - 1)];
+		if (slot.cache == id && slot.source == source.id) {
+			if (slot.missing) return nullptr;
+			std::shared_ptr<Primitive> geometry = slot.geometry.lock();
+			if (geometry) return geometry;
+		}
+		std::shared_ptr<Primitive> geometry = getShared(source);
+		slot.cache = id;
+		slot.source = source.id;
+		slot.geometry = geometry;
+		slot.missing = !geometry;
+		return geometry;
+	}
+
+	std::shared_ptr<Primitive> GeometryCache::getShared(const GeometrySource& source) {
+		std::unique_lock<std::mutex> lock(mutex);
+		while (true) {
+			auto iter = index.find(source.id);
+			if (iter != index.end()) {
+				lru.splice(lru.begin(), lru, iter->second);
+				++hits;
+				return iter->second->geometry;
+			}
+			if (!loading.count(source.id)) break;
+			loaded.wait(lock);
+		}
+		++misses;
+		loading.insert(source.id);
+		lock.unlock();
+
+		// Load outside the lock
+		size_t bytes = 0;
+		std::shared_ptr<Primitive> geometry = source.Load(&bytes);
+		bool rejected = geometry && bytes > capacity;
+		if (!geometry)
+			LOG(ERROR) << "Unable to load geometry source " << source.id << "; ignoring it";
+		else if (rejected) {
+			LOG(ERROR) << "Geometry source " << source.id << " needs " << bytes <<
+				" bytes, more than the cache's " << capacity << "; ignoring it";
+			geometry.reset();
+			bytes = 0;
+		}
+
+		lock.lock();
+		loading.erase(source.id);
+		loaded.notify_all();
+		if (rejected) ++rejections;
+		// Evict least recently used geometry to keep within the capacity
+		while (residentBytes + bytes > capacity) {
+			const Entry& last = lru.back();
+			residentBytes -= last.bytes;
+			index.erase(last.source);
+			lru.pop_back();
+			++evictions;
+		}
+
+		Entry entry;
+		entry.source = source.id;
+		entry.geometry = geometry;
+		entry.bytes = bytes;
+		lru.push_front(entry);
+		index[source.id] = lru.begin();
+		residentBytes += bytes;
+		peakResidentBytes = std::max(peakResidentBytes, residentBytes);
+		return geometry;
+	}
+
+	GeometryCache::Stats GeometryCache::GetStats() const {
+		std::lock_guard<std::mutex> lock(mutex);
+		Stats stats;
+		stats.hits = hits;
+		stats.misses = misses;
+		stats.evictions = evictions;
+		stats.rejections = rejections;
+		stats.residentBytes = residentBytes;
+		stats.peakResidentBytes = peakResidentBytes;
+		return stats;
+	}
+
+}  // namespace pbr
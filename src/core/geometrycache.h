@@ -0,0 +1,84 @@
+#ifndef CORE_GEOMETRYCACHE_H
+#define CORE_GEOMETRYCACHE_H
+
+#include "pbr.h"
+#include <condition_variable>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace pbr {
+
+	// GeometryCache Declarations
+
+	// Geometry kept on disk until a ray needs it. Load() builds the
+	// geometry and reports the bytes it holds; it may run concurrently.
+	class GeometrySource {
+	public:
+		GeometrySource();
+		virtual ~GeometrySource();
+		virtual std::shared_ptr<Primitive> Load(size_t* bytes) const = 0;
+
+		// Identifies the source's geometry in every cache; never reused
+		const uint64_t id;
+	};
+
+	// Budgeted cache of loaded geometry shared by all threads: one LRU list
+	// behind a mutex, since its entries are few and large, with a per-thread
+	// micro-cache in front as in TileCache. Micro-cache slots don't own
+	// their geometry, so evicted geometry is freed once no caller or
+	// interaction holds it. A source is loaded by one thread at a time;
+	// others that miss on it wait for the load. Geometry larger than the
+	// capacity is rejected and reads as nullptr.
+	class GeometryCache {
+	public:
+		static const int MicroCacheSize = 4;
+
+		// Micro-cache hits aren't counted, so as to keep them free of shared
+		// writes
+		struct Stats {
+			int64_t hits = 0, misses = 0;
+			int64_t evictions = 0, rejections = 0;
+			size_t residentBytes = 0, peakResidentBytes = 0;
+		};
+
+		GeometryCache(size_t capacityBytes);
+		~GeometryCache();
+		GeometryCache(const GeometryCache&) = delete;
+		GeometryCache& operator=(const GeometryCache&) = delete;
+
+		// The source's geometry, loaded on a miss; it stays loaded while the
+		// returned pointer is held. Geometry that can't be loaded or is too
+		// large is logged and cached as nullptr.
+		std::shared_ptr<Primitive> Get(const GeometrySource& source);
+		Stats GetStats() const;
+		size_t Capacity() const { return capacity; }
+
+	private:
+		// GeometryCache Private Data
+		struct Entry {
+			uint64_t source;
+			std::shared_ptr<Primitive> geometry;
+			size_t bytes;
+		};
+
+		// GeometryCache Private Methods
+		std::shared_ptr<Primitive> getShared(const GeometrySource& source);
+
+		const uint64_t id;
+		const size_t capacity;
+		// Guarded by mutex; most recently used first
+		mutable std::mutex mutex;
+		std::list<Entry> lru;
+		std::unordered_map<uint64_t, std::list<Entry>::iterator> index;
+		// Sources being loaded, and signalled when a load finishes
+		std::unordered_set<uint64_t> loading;
+		std::condition_variable loaded;
+		size_t residentBytes = 0, peakResidentBytes = 0;
+		int64_t hits = 0, misses = 0, evictions = 0, rejections = 0;
+	};
+
+}  // namespace pbr
+
+#endif  // CORE_GEOMETRYCACHE_H
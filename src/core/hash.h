@@ -0,0 +1,70 @@
+#ifndef CORE_HASH_H
+#define CORE_HASH_H
+
+#include "pbr.h"
+
+namespace pbr {
+
+	// MurmurHash64A by Austin Appleby; used for content keys, not for security.
+	inline uint64_t MurmurHash64A(const unsigned char* key, size_t len, uint64_t seed) {
+		const uint64_t m = 0xc6a4a7935bd1e995ull;
+		const int r = 47;
+
+		uint64_t h = seed ^ (len * m);
+
+		const unsigned char* end = key + 8 * (len / 8);
+		while (key != end) {
+			uint64_t k;
+			memcpy(&k, key, sizeof(uint64_t));
+			key += 8;
+
+			k *= m;
+			k ^= k >> r;
+			k *= m;
+
+			h ^= k;
+			h *= m;
+		}
+
+		switch (len & 7) {
+		case 7: h ^= uint64_t(key[6]) << 48;
+			PBR_FALLTHROUGH;
+		case 6: h ^= uint64_t(key[5]) << 40;
+			PBR_FALLTHROUGH;
+		case 5: h ^= uint64_t(key[4]) << 32;
+			PBR_FALLTHROUGH;
+		case 4: h ^= uint64_t(key[3]) << 24;
+			PBR_FALLTHROUGH;
+		case 3: h ^= uint64_t(key[2]) << 16;
+			PBR_FALLTHROUGH;
+		case 2: h ^= uint64_t(key[1]) << 8;
+			PBR_FALLTHROUGH;
+		case 1:
+			h ^= uint64_t(key[0]);
+			h *= m;
+		};
+
+		h ^= h >> r;
+		h *= m;
+		h ^= h >> r;
+
+		return h;
+	}
+
+	// 64-bit finalizer with full avalanche (Stafford's variant 13)
+	inline uint64_t MixBits(uint64_t v) {
+		v ^= (v >> 31);
+		v *= 0x7fb5d329728ea185ull;
+		v ^= (v >> 27);
+		v *= 0x81dadef4bc2dd44dull;
+		v ^= (v >> 33);
+		return v;
+	}
+
+	template <typename T> inline uint64_t HashBuffer(const T* ptr, size_t size, uint64_t seed = 0) {
+		return MurmurHash64A((const unsigned char*)ptr, size, seed);
+	}
+
+}  // namespace pbr
+
+#endif  // CORE_HASH_H
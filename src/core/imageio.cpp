@@ -0,0 +1,149 @@
+#include "imageio.h"
+#include <cstdio>
+
+namespace pbr {
+
+	static bool HasExtension(const std::string& value, const std::string& ending) {
+		if (ending.size() > value.size()) return false;
+		return std::equal(ending.rbegin(), ending.rend(), value.rbegin(),
+			[](char a, char b) { return std::tolower(a) == std::tolower(b); });
+	}
+
+	static bool HostLittleEndian() {
+		uint32_t one = 1;
+		uint8_t first;
+		memcpy(&first, &one, 1);
+		return first == 1;
+	}
+
+	static bool Seek(FILE* fp, int64_t offset) {
+#ifdef _MSC_VER
+		return _fseeki64(fp, offset, SEEK_SET) == 0;
+#else
+		return fseeko(fp, (off_t)offset, SEEK_SET) == 0;
+#endif
+	}
+
+	ScanlineWriter::~ScanlineWriter() {}
+
+	// PFM stores 32-bit floats bottom row first; a negative scale in the
+	// header marks little-endian data. Every row has a fixed offset, so
+	// bands are written in place.
+	class PFMScanlineWriter : public ScanlineWriter {
+	public:
+		PFMScanlineWriter(const std::string& filename, FILE* fp, int width, int height)
+			: filename(filename), fp(fp), width(width), height(height), scanline(3 * width) {
+			ok = fprintf(fp, "PF\n%d %d\n%f\n", width, height, HostLittleEndian() ? -1.f : 1.f) > 0;
+			headerSize = fileSize = ftell(fp);
+		}
+		~PFMScanlineWriter() { Close(); }
+		bool WriteRows(int y, int nRows, const Float* rgb) {
+			CHECK(fp);
+			CHECK(y >= 0 && y + nRows <= height);
+			// Bottom-most row first, so that the file is written sequentially
+			for (int r = nRows - 1; ok && r >= 0; --r) {
+				for (int i = 0; i < 3 * width; ++i) scanline[i] = (float)rgb[3 * (size_t)r * width + i];
+				int64_t offset = headerSize + (int64_t)(height - 1 - (y + r)) * 3 * width * sizeof(float);
+				ok = Seek(fp, offset) && fwrite(scanline.data(), sizeof(float), 3 * width, fp) == (size_t)(3 * width);
+				fileSize = std::max(fileSize, offset + (int64_t)(3 * width * sizeof(float)));
+			}
+			if (!ok) LOG(ERROR) << "Error writing PFM file \"" << filename << "\"";
+			return ok;
+		}
+		bool Close() {
+			if (!fp) return ok;
+			// Extend the file over trailing rows that were never written; the
+			// gap reads back as zeros
+			int64_t size = headerSize + (int64_t)height * 3 * width * sizeof(float);
+			if (ok && fileSize < size) ok = Seek(fp, size - 1) && fputc(0, fp) != EOF;
+			if (fclose(fp) != 0) ok = false;
+			fp = nullptr;
+			if (!ok) LOG(ERROR) << "Error writing PFM file \"" << filename << "\"";
+			return ok;
+		}
+
+	private:
+		const std::string filename;
+		FILE* fp;
+		const int width, height;
+		int64_t headerSize, fileSize;
+		std::vector<float> scanline;
+		bool ok;
+	};
+
+	std::unique_ptr<ScanlineWriter> OpenScanlineWriter(const std::string& name, const Bounds2i& outputBounds) {
+		Vector2i resolution = outputBounds.Diagonal();
+		if (!HasExtension(name, ".pfm")) {
+			LOG(ERROR) << "Can't write \"" << name << "\" incrementally; only PFM files are supported";
+			return nullptr;
+		}
+		FILE* fp = fopen(name.c_str(), "wb");
+		if (!fp) {
+			LOG(ERROR) << "Error opening PFM file \"" << name << "\"";
+			return nullptr;
+		}
+		return std::unique_ptr<ScanlineWriter>(new PFMScanlineWriter(name, fp, resolution.x, resolution.y));
+	}
+
+	static std::unique_ptr<Float[]> ReadPFM(const std::string& filename, Point2i* resolution) {
+		FILE* fp = fopen(filename.c_str(), "rb");
+		if (!fp) {
+			LOG(ERROR) << "Error opening PFM file \"" << filename << "\"";
+			return nullptr;
+		}
+		char magic[3] = {};
+		int width, height;
+		float scale;
+		int nChannels = 0;
+		if (fscanf(fp, "%2s %d %d %f", magic, &width, &height, &scale) == 4 && fgetc(fp) != EOF)
+			nChannels = !strcmp(magic, "PF") ? 3 : !strcmp(magic, "Pf") ? 1 : 0;
+		if (nChannels == 0 || width <= 0 || height <= 0) {
+			LOG(ERROR) << "Invalid PFM header in \"" << filename << "\"";
+			fclose(fp);
+			return nullptr;
+		}
+
+		std::vector<float> data((size_t)nChannels * width * height);
+		bool ok = fread(data.data(), sizeof(float), data.size(), fp) == data.size();
+		fclose(fp);
+		if (!ok) {
+			LOG(ERROR) << "Premature end of PFM file \"" << filename << "\"";
+			return nullptr;
+		}
+		if ((scale < 0) != HostLittleEndian())
+			for (float& f : data) {
+				uint32_t bits = FloatToBits(f);
+				bits = (bits >> 24) | ((bits >> 8) & 0xff00) | ((bits << 8) & 0xff0000) | (bits << 24);
+				f = BitsToFloat(bits);
+			}
+
+		std::unique_ptr<Float[]> rgb(new Float[3 * width * height]);
+		for (int y = 0; y < height; ++y)
+			for (int x = 0; x < width; ++x)
+				for (int c = 0; c < 3; ++c) {
+					size_t src = ((size_t)(height - 1 - y) * width + x) * nChannels + (nChannels == 3 ? c : 0);
+					rgb[3 * (y * width + x) + c] = data[src];
+				}
+		*resolution = Point2i(width, height);
+		return rgb;
+	}
+
+	bool WriteImage(const std::string& name, const Float* rgb, const Bounds2i& outputBounds) {
+		Vector2i resolution = outputBounds.Diagonal();
+		if (!HasExtension(name, ".pfm")) {
+			LOG(ERROR) << "Can't determine image file type from suffix of filename \"" << name << "\"";
+			return false;
+		}
+		std::unique_ptr<ScanlineWriter> writer = OpenScanlineWriter(name, outputBounds);
+		if (!writer) return false;
+		bool ok = writer->WriteRows(0, resolution.y, rgb);
+		return writer->Close() && ok;
+	}
+
+	std::unique_ptr<Float[]> ReadImage(const std::string& name, Point2i* resolution) {
+		if (HasExtension(name, ".pfm")) return ReadPFM(name, resolution);
+		LOG(ERROR) << "Unable to load image stored in format \"" << name << "\"";
+		return nullptr;
+	}
+
+}  // namespace pbr
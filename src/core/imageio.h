@@ -0,0 +1,34 @@
+#ifndef CORE_IMAGEIO_H
+#define CORE_IMAGEIO_H
+
+#include "pbr.h"
+#include "geometry.h"
+
+namespace pbr {
+
+	// Writes the RGB pixels of outputBounds (row-major, top row first) to
+	// name; the format follows the extension. Only .pfm is supported.
+	bool WriteImage(const std::string& name, const Float* rgb, const Bounds2i& outputBounds);
+
+	// Writes an image a band of rows at a time so that callers need not hold
+	// the whole image. Rows are indexed from the top of outputBounds and may
+	// arrive in any order; rows never written read back as zero.
+	class ScanlineWriter {
+	public:
+		virtual ~ScanlineWriter();
+		// Writes nRows rows of RGB pixels starting at row y
+		virtual bool WriteRows(int y, int nRows, const Float* rgb) = 0;
+		virtual bool Close() = 0;
+	};
+
+	// Creates the file and returns its writer, or nullptr if it can't be
+	// created or its format can't be written incrementally (only .pfm can).
+	std::unique_ptr<ScanlineWriter> OpenScanlineWriter(const std::string& name, const Bounds2i& outputBounds);
+
+	// Reads a .pfm image into top-row-first RGB; grayscale files are
+	// expanded to RGB. Returns nullptr on failure.
+	std::unique_ptr<Float[]> ReadImage(const std::string& name, Point2i* resolution);
+
+}  // namespace pbr
+
+#endif  // CORE_IMAGEIO_H
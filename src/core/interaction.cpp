@@ -0,0 +1,142 @@
+#include "interaction.h"
+#include "transform.h"
+
+namespace pbr {
+
+	// SurfaceInteraction Method Definitions
+	SurfaceInteraction::SurfaceInteraction(const Point3f& p, const Vector3f& pError, const Point2f& uv,
+		const Vector3f& wo, const Vector3f& dpdu, const Vector3f& dpdv, const Normal3f& dndu,
+		const Normal3f& dndv, Float time, bool flipNormal)
+		: Interaction(p, Normal3f(Normalize(Cross(dpdu, dpdv))), pError, wo, time),
+		uv(uv), dpdu(dpdu), dpdv(dpdv), dndu(dndu), dndv(dndv) {
+		// Initialize shading geometry from true geometry
+		shading.n = n;
+		shading.dpdu = dpdu;
+		shading.dpdv = dpdv;
+		shading.dndu = dndu;
+		shading.dndv = dndv;
+
+		// Adjust normal based on orientation and handedness
+		if (flipNormal) {
+			n *= -1;
+			shading.n *= -1;
+		}
+	}
+
+	void SurfaceInteraction::SetShadingGeometry(const Vector3f& dpdus, const Vector3f& dpdvs,
+		const Normal3f& dndus, const Normal3f& dndvs, bool orientationIsAuthoritative) {
+		// Compute _shading.n_ for _SurfaceInteraction_
+		shading.n = Normalize((Normal3f)Cross(dpdus, dpdvs));
+		if (orientationIsAuthoritative)
+			n = Faceforward(n, shading.n);
+		else
+			shading.n = Faceforward(shading.n, n);
+
+		// Initialize _shading_ partial derivative values
+		shading.dpdu = dpdus;
+		shading.dpdv = dpdvs;
+		shading.dndu = dndus;
+		shading.dndv = dndvs;
+	}
+
+	void SurfaceInteraction::ComputeDifferentials(const RayDifferential& ray) const {
+		if (ray.hasDifferentials) {
+			// Estimate screen space change in p and (u, v)
+
+			// Compute auxiliary intersection points with plane
+			Float d = Dot(n, Vector3f(p.x, p.y, p.z));
+			Float tx = -(Dot(n, Vector3f(ray.rxOrigin)) - d) / Dot(n, ray.rxDirection);
+			Float ty = -(Dot(n, Vector3f(ray.ryOrigin)) - d) / Dot(n, ray.ryDirection);
+			if (std::isfinite(tx) && std::isfinite(ty)) {
+				Point3f px = ray.rxOrigin + tx * ray.rxDirection;
+				Point3f py = ray.ryOrigin + ty * ray.ryDirection;
+				dpdx = px - p;
+				dpdy = py - p;
+
+				// Compute (u, v) offsets at auxiliary points
+
+				// Choose two dimensions to use for ray offset computation
+				int dim[2];
+				if (std::abs(n.x) > std::abs(n.y) && std::abs(n.x) > std::abs(n.z)) {
+					dim[0] = 1;
+					dim[1] = 2;
+				} else if (std::abs(n.y) > std::abs(n.z)) {
+					dim[0] = 0;
+					dim[1] = 2;
+				} else {
+					dim[0] = 0;
+					dim[1] = 1;
+				}
+
+				// Initialize A, Bx, and By matrices for offset computation
+				Float A[2][2] = { { dpdu[dim[0]], dpdv[dim[0]] }, { dpdu[dim[1]], dpdv[dim[1]] } };
+				Float Bx[2] = { px[dim[0]] - p[dim[0]], px[dim[1]] - p[dim[1]] };
+				Float By[2] = { py[dim[0]] - p[dim[0]], py[dim[1]] - p[dim[1]] };
+				if (!SolveLinearSystem2x2(A, Bx, &dudx, &dvdx)) dudx = dvdx = 0;
+				if (!SolveLinearSystem2x2(A, By, &dudy, &dvdy)) dudy = dvdy = 0;
+				return;
+			}
+		}
+		dudx = dvdx = 0;
+		dudy = dvdy = 0;
+		dpdx = dpdy = Vector3f(0, 0, 0);
+	}
+
+	RayDifferential SurfaceInteraction::SpawnReflectedRay(const RayDifferential& ray) const {
+		Vector3f wo = Normalize(-ray.d);
+		Vector3f ns(shading.n);
+		Vector3f wi = Reflect(wo, ns);
+		RayDifferential rd(SpawnRay(wi));
+		if (ray.hasDifferentials) {
+			// Compute ray differential rd for specular reflection
+			rd.hasDifferentials = true;
+			rd.rxOrigin = p + dpdx;
+			rd.ryOrigin = p + dpdy;
+			Vector3f dndx(shading.dndu * dudx + shading.dndv * dvdx);
+			Vector3f dndy(shading.dndu * dudy + shading.dndv * dvdy);
+			Vector3f dwodx = -ray.rxDirection - wo, dwody = -ray.ryDirection - wo;
+			Float dDNdx = Dot(dwodx, ns) + Dot(wo, dndx);
+			Float dDNdy = Dot(dwody, ns) + Dot(wo, dndy);
+			rd.rxDirection = wi - dwodx + 2.f * (Dot(wo, ns) * dndx + dDNdx * ns);
+			rd.ryDirection = wi - dwody + 2.f * (Dot(wo, ns) * dndy + dDNdy * ns);
+		}
+		return rd;
+	}
+
+	bool SurfaceInteraction::SpawnRefractedRay(const RayDifferential& ray, Float eta,
+		RayDifferential* rd) const {
+		Vector3f wo = Normalize(-ray.d);
+		Normal3f ns = shading.n;
+		Vector3f dndx(shading.dndu * dudx + shading.dndv * dvdx);
+		Vector3f dndy(shading.dndu * dudy + shading.dndv * dvdy);
+
+		// Flip to the side wo is on; the relative index goes incident over
+		// transmitted
+		Float etaRel = 1 / eta;
+		if (Dot(wo, ns) < 0) {
+			etaRel = eta;
+			ns = -ns;
+			dndx = -dndx;
+			dndy = -dndy;
+		}
+		Vector3f wi;
+		if (!Refract(wo, ns, etaRel, &wi)) return false;
+		*rd = RayDifferential(SpawnRay(wi));
+		if (ray.hasDifferentials) {
+			// Compute ray differential rd for specular transmission
+			rd->hasDifferentials = true;
+			rd->rxOrigin = p + dpdx;
+			rd->ryOrigin = p + dpdy;
+			Vector3f dwodx = -ray.rxDirection - wo, dwody = -ray.ryDirection - wo;
+			Float dDNdx = Dot(dwodx, ns) + Dot(wo, dndx);
+			Float dDNdy = Dot(dwody, ns) + Dot(wo, dndy);
+			Float mu = etaRel * Dot(wo, ns) - AbsDot(wi, ns);
+			Float dmudx = (etaRel - (etaRel * etaRel * Dot(wo, ns)) / AbsDot(wi, ns)) * dDNdx;
+			Float dmudy = (etaRel - (etaRel * etaRel * Dot(wo, ns)) / AbsDot(wi, ns)) * dDNdy;
+			rd->rxDirection = wi - etaRel * dwodx + (mu * dndx + dmudx * Vector3f(ns));
+			rd->ryDirection = wi - etaRel * dwody + (mu * dndy + dmudy * Vector3f(ns));
+		}
+		return true;
+	}
+
+}  // namespace pbr
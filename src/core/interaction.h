@@ -0,0 +1,102 @@
+#ifndef CORE_INTERACTION_H
+#define CORE_INTERACTION_H
+
+#include "pbr.h"
+#include "geometry.h"
+
+namespace pbr {
+
+	// Specular Direction Functions
+
+	// Mirror direction of wo about n
+	inline Vector3f Reflect(const Vector3f& wo, const Vector3f& n) { return -wo + 2 * Dot(wo, n) * n; }
+
+	// Direction of wi refracted through a boundary with normal n on its side
+	// and relative index of refraction eta (incident over transmitted);
+	// false on total internal reflection
+	inline bool Refract(const Vector3f& wi, const Normal3f& n, Float eta, Vector3f* wt) {
+		Float cosThetaI = Dot(n, wi);
+		Float sin2ThetaI = std::max(Float(0), Float(1 - cosThetaI * cosThetaI));
+		Float sin2ThetaT = eta * eta * sin2ThetaI;
+		if (sin2ThetaT >= 1) return false;
+		Float cosThetaT = std::sqrt(1 - sin2ThetaT);
+		*wt = eta * -wi + (eta * cosThetaI - cosThetaT) * Vector3f(n);
+		return true;
+	}
+
+	// Interaction Declarations
+	class Interaction {
+	public:
+		Interaction() : time(0) {}
+		Interaction(const Point3f& p, const Normal3f& n, const Vector3f& pError, const Vector3f& wo, Float time)
+			: p(p), time(time), pError(pError), wo(wo), n(n) {}
+
+		bool IsSurfaceInteraction() const { return n != Normal3f(); }
+
+		// Spawned rays start at p offset by its error bounds, so they never
+		// re-intersect the surface they leave and need no epsilon or retry.
+		Ray SpawnRay(const Vector3f& d) const {
+			Point3f o = OffsetRayOrigin(p, pError, n, d);
+			return Ray(o, d, Infinity, time);
+		}
+		Ray SpawnRayTo(const Point3f& p2) const {
+			Point3f origin = OffsetRayOrigin(p, pError, n, p2 - p);
+			Vector3f d = p2 - origin;
+			return Ray(origin, d, 1 - ShadowEpsilon, time);
+		}
+		Ray SpawnRayTo(const Interaction& it) const {
+			Point3f pOrigin = OffsetRayOrigin(p, pError, n, it.p - p);
+			Point3f pTarget = OffsetRayOrigin(it.p, it.pError, it.n, pOrigin - it.p);
+			Vector3f d = pTarget - pOrigin;
+			return Ray(pOrigin, d, 1 - ShadowEpsilon, time);
+		}
+
+		// Interaction Public Data
+		Point3f p;
+		Float time;
+		Vector3f pError;
+		Vector3f wo;
+		Normal3f n;
+	};
+
+	// SurfaceInteraction Declarations
+	class SurfaceInteraction : public Interaction {
+	public:
+		SurfaceInteraction() {}
+		SurfaceInteraction(const Point3f& p, const Vector3f& pError, const Point2f& uv, const Vector3f& wo,
+			const Vector3f& dpdu, const Vector3f& dpdv, const Normal3f& dndu, const Normal3f& dndv,
+			Float time, bool flipNormal = false);
+
+		void SetShadingGeometry(const Vector3f& dpdus, const Vector3f& dpdvs, const Normal3f& dndus,
+			const Normal3f& dndvs, bool orientationIsAuthoritative);
+		// Sets dpdx, dpdy and the (u, v) derivatives from where the
+		// differential rays meet the tangent plane; zero without differentials
+		void ComputeDifferentials(const RayDifferential& ray) const;
+		// Perfect specular reflection and refraction of ray about the shading
+		// normal. Their differentials follow from ComputeDifferentials() and
+		// the change of the normal across the footprint, with no further rays
+		// traced. eta is the index of refraction inside the surface over
+		// outside; SpawnRefractedRay() is false on total internal reflection.
+		RayDifferential SpawnReflectedRay(const RayDifferential& ray) const;
+		bool SpawnRefractedRay(const RayDifferential& ray, Float eta, RayDifferential* rd) const;
+
+		// SurfaceInteraction Public Data
+		Point2f uv;
+		Vector3f dpdu, dpdv;
+		Normal3f dndu, dndv;
+		struct {
+			Normal3f n;
+			Vector3f dpdu, dpdv;
+			Normal3f dndu, dndv;
+		} shading;
+		const Primitive* primitive = nullptr;
+		// Keeps paged geometry that primitive points into loaded
+		std::shared_ptr<const Primitive> geometry;
+		int faceIndex = 0;
+		mutable Vector3f dpdx, dpdy;
+		mutable Float dudx = 0, dvdx = 0, dudy = 0, dvdy = 0;
+	};
+
+}  // namespace pbr
+
+#endif  // CORE_INTERACTION_H
@@ -0,0 +1,710 @@
+#include "lowdiscrepancy.h"
+#include "sampling.h"
+
+namespace pbr {
+
+	// Low Discrepancy Data Definitions
+	const int Primes[PrimeTableSize] = {
+		2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53,
+		59, 61, 67, 71, 73, 79, 83, 89, 97, 101, 103, 107, 109, 113, 127, 131,
+		137, 139, 149, 151, 157, 163, 167, 173, 179, 181, 191, 193, 197, 199, 211, 223,
+		227, 229, 233, 239, 241, 251, 257, 263, 269, 271, 277, 281, 283, 293, 307, 311,
+		313, 317, 331, 337, 347, 349, 353, 359, 367, 373, 379, 383, 389, 397, 401, 409,
+		419, 421, 431, 433, 439, 443, 449, 457, 461, 463, 467, 479, 487, 491, 499, 503,
+		509, 521, 523, 541, 547, 557, 563, 569, 571, 577, 587, 593, 599, 601, 607, 613,
+		617, 619, 631, 641, 643, 647, 653, 659, 661, 673, 677, 683, 691, 701, 709, 719,
+		727, 733, 739, 743, 751, 757, 761, 769, 773, 787, 797, 809, 811, 821, 823, 827,
+		829, 839, 853, 857, 859, 863, 877, 881, 883, 887, 907, 911, 919, 929, 937, 941,
+		947, 953, 967, 971, 977, 983, 991, 997, 1009, 1013, 1019, 1021, 1031, 1033, 1039, 1049,
+		1051, 1061, 1063, 1069, 1087, 1091, 1093, 1097, 1103, 1109, 1117, 1123, 1129, 1151, 1153, 1163,
+		1171, 1181, 1187, 1193, 1201, 1213, 1217, 1223, 1229, 1231, 1237, 1249, 1259, 1277, 1279, 1283,
+		1289, 1291, 1297, 1301, 1303, 1307, 1319, 1321, 1327, 1361, 1367, 1373, 1381, 1399, 1409, 1423,
+		1427, 1429, 1433, 1439, 1447, 1451, 1453, 1459, 1471, 1481, 1483, 1487, 1489, 1493, 1499, 1511,
+		1523, 1531, 1543, 1549, 1553, 1559, 1567, 1571, 1579, 1583, 1597, 1601, 1607, 1609, 1613, 1619,
+	};
+
+	const int PrimeSums[PrimeTableSize] = {
+		0, 2, 5, 10, 17, 28, 41, 58, 77, 100, 129, 160, 197, 238, 281, 328,
+		381, 440, 501, 568, 639, 712, 791, 874, 963, 1060, 1161, 1264, 1371, 1480, 1593, 1720,
+		1851, 1988, 2127, 2276, 2427, 2584, 2747, 2914, 3087, 3266, 3447, 3638, 3831, 4028, 4227, 4438,
+		4661, 4888, 5117, 5350, 5589, 5830, 6081, 6338, 6601, 6870, 7141, 7418, 7699, 7982, 8275, 8582,
+		8893, 9206, 9523, 9854, 10191, 10538, 10887, 11240, 11599, 11966, 12339, 12718, 13101, 13490, 13887, 14288,
+		14697, 15116, 15537, 15968, 16401, 16840, 17283, 17732, 18189, 18650, 19113, 19580, 20059, 20546, 21037, 21536,
+		22039, 22548, 23069, 23592, 24133, 24680, 25237, 25800, 26369, 26940, 27517, 28104, 28697, 29296, 29897, 30504,
+		31117, 31734, 32353, 32984, 33625, 34268, 34915, 35568, 36227, 36888, 37561, 38238, 38921, 39612, 40313, 41022,
+		41741, 42468, 43201, 43940, 44683, 45434, 46191, 46952, 47721, 48494, 49281, 50078, 50887, 51698, 52519, 53342,
+		54169, 54998, 55837, 56690, 57547, 58406, 59269, 60146, 61027, 61910, 62797, 63704, 64615, 65534, 66463, 67400,
+		68341, 69288, 70241, 71208, 72179, 73156, 74139, 75130, 76127, 77136, 78149, 79168, 80189, 81220, 82253, 83292,
+		84341, 85392, 86453, 87516, 88585, 89672, 90763, 91856, 92953, 94056, 95165, 96282, 97405, 98534, 99685, 100838,
+		102001, 103172, 104353, 105540, 106733, 107934, 109147, 110364, 111587, 112816, 114047, 115284, 116533, 117792, 119069, 120348,
+		121631, 122920, 124211, 125508, 126809, 128112, 129419, 130738, 132059, 133386, 134747, 136114, 137487, 138868, 140267, 141676,
+		143099, 144526, 145955, 147388, 148827, 150274, 151725, 153178, 154637, 156108, 157589, 159072, 160559, 162048, 163541, 165040,
+		166551, 168074, 169605, 171148, 172697, 174250, 175809, 177376, 178947, 180526, 182109, 183706, 185307, 186914, 188523, 190136,
+	};
+
+	const uint32_t SobolMatrices32[NSobolDimensions * SobolMatrixSize] = {
+		// Dimension 0
+		0x80000000, 0x40000000, 0x20000000, 0x10000000, 0x08000000, 0x04000000, 0x02000000, 0x01000000,
+		0x00800000, 0x00400000, 0x00200000, 0x00100000, 0x00080000, 0x00040000, 0x00020000, 0x00010000,
+		0x00008000, 0x00004000, 0x00002000, 0x00001000, 0x00000800, 0x00000400, 0x00000200, 0x00000100,
+		0x00000080, 0x00000040, 0x00000020, 0x00000010, 0x00000008, 0x00000004, 0x00000002, 0x00000001,
+		// Dimension 1
+		0x80000000, 0xc0000000, 0xa0000000, 0xf0000000, 0x88000000, 0xcc000000, 0xaa000000, 0xff000000,
+		0x80800000, 0xc0c00000, 0xa0a00000, 0xf0f00000, 0x88880000, 0xcccc0000, 0xaaaa0000, 0xffff0000,
+		0x80008000, 0xc000c000, 0xa000a000, 0xf000f000, 0x88008800, 0xcc00cc00, 0xaa00aa00, 0xff00ff00,
+		0x80808080, 0xc0c0c0c0, 0xa0a0a0a0, 0xf0f0f0f0, 0x88888888, 0xcccccccc, 0xaaaaaaaa, 0xffffffff,
+		// Dimension 2
+		0x80000000, 0xc0000000, 0x60000000, 0x90000000, 0xe8000000, 0x5c000000, 0x8e000000, 0xc5000000,
+		0x68800000, 0x9cc00000, 0xee600000, 0x55900000, 0x80680000, 0xc09c0000, 0x60ee0000, 0x90550000,
+		0xe8808000, 0x5cc0c000, 0x8e606000, 0xc5909000, 0x6868e800, 0x9c9c5c00, 0xeeee8e00, 0x5555c500,
+		0x8000e880, 0xc0005cc0, 0x60008e60, 0x9000c590, 0xe8006868, 0x5c009c9c, 0x8e00eeee, 0xc5005555,
+		// Dimension 3
+		0x80000000, 0xc0000000, 0x20000000, 0x50000000, 0xf8000000, 0x74000000, 0xa2000000, 0x93000000,
+		0xd8800000, 0x25400000, 0x59e00000, 0xe6d00000, 0x78080000, 0xb40c0000, 0x82020000, 0xc3050000,
+		0x208f8000, 0x51474000, 0xfbea2000, 0x75d93000, 0xa0858800, 0x914e5400, 0xdbe79e00, 0x25db6d00,
+		0x58800080, 0xe54000c0, 0x79e00020, 0xb6d00050, 0x800800f8, 0xc00c0074, 0x200200a2, 0x50050093,
+		// Dimension 4
+		0x80000000, 0x40000000, 0x20000000, 0xb0000000, 0xf8000000, 0xdc000000, 0x7a000000, 0x9d000000,
+		0x5a800000, 0x2fc00000, 0xa1600000, 0xf0b00000, 0xda880000, 0x6fc40000, 0x81620000, 0x40bb0000,
+		0x22878000, 0xb3c9c000, 0xfb65a000, 0xddb2d000, 0x78022800, 0x9c0b3c00, 0x5a0fb600, 0x2d0ddb00,
+		0xa2878080, 0xf3c9c040, 0xdb65a020, 0x6db2d0b0, 0x800228f8, 0x400b3cdc, 0x200fb67a, 0xb00ddb9d,
+		// Dimension 5
+		0x80000000, 0x40000000, 0x60000000, 0x30000000, 0xc8000000, 0x24000000, 0x56000000, 0xfb000000,
+		0xe0800000, 0x70400000, 0xa8600000, 0x14300000, 0x9ec80000, 0xdf240000, 0xb6d60000, 0x8bbb0000,
+		0x48008000, 0x64004000, 0x36006000, 0xcb003000, 0x2880c800, 0x54402400, 0xfe605600, 0xef30fb00,
+		0x7e48e080, 0xaf647040, 0x1eb6a860, 0x9f8b1430, 0xd6c81ec8, 0xbb249f24, 0x80d6d6d6, 0x40bbbbbb,
+		// Dimension 6
+		0x80000000, 0xc0000000, 0xa0000000, 0xd0000000, 0x58000000, 0x94000000, 0x3e000000, 0xe3000000,
+		0xbe800000, 0x23c00000, 0x1e200000, 0xf3100000, 0x46780000, 0x67840000, 0x78460000, 0x84670000,
+		0xc6788000, 0xa784c000, 0xd846a000, 0x5467d000, 0x9e78d800, 0x33845400, 0xe6469e00, 0xb7673300,
+		0x20f86680, 0x104477c0, 0xf8668020, 0x4477c010, 0x668020f8, 0x77c01044, 0x8020f866, 0xc0104477,
+		// Dimension 7
+		0x80000000, 0x40000000, 0xa0000000, 0x50000000, 0x88000000, 0x24000000, 0x12000000, 0x2d000000,
+		0x76800000, 0x9e400000, 0x08200000, 0x64100000, 0xb2280000, 0x7d140000, 0xfea20000, 0xba490000,
+		0x1a248000, 0x491b4000, 0xc4b5a000, 0xe3739000, 0xf6800800, 0xde400400, 0xa8200a00, 0x34100500,
+		0x3a280880, 0x59140240, 0xeca20120, 0x974902d0, 0x6ca48768, 0xd75b49e4, 0xcc95a082, 0x87639641,
+		// Dimension 8
+		0x80000000, 0x40000000, 0xa0000000, 0x50000000, 0x28000000, 0xd4000000, 0x6a000000, 0x71000000,
+		0x38800000, 0x58400000, 0xea200000, 0x31100000, 0x98a80000, 0x08540000, 0xc22a0000, 0xe5250000,
+		0xf2b28000, 0x79484000, 0xfaa42000, 0xbd731000, 0x18a80800, 0x48540400, 0x622a0a00, 0xb5250500,
+		0xdab28280, 0xad484d40, 0x90a426a0, 0xcc731710, 0x20280b88, 0x10140184, 0x880a04a2, 0x84350611,
+		// Dimension 9
+		0x80000000, 0x40000000, 0xe0000000, 0xb0000000, 0x98000000, 0x94000000, 0x8a000000, 0x5b000000,
+		0x33800000, 0xd9c00000, 0x72200000, 0x3f100000, 0xc1b80000, 0xa6ec0000, 0x53860000, 0x29f50000,
+		0x0a3a8000, 0x1b2ac000, 0xd392e000, 0x69ff7000, 0xea380800, 0xab2c0400, 0x4ba60e00, 0xfde50b00,
+		0x60028980, 0xf006c940, 0x7834e8a0, 0x241a75b0, 0x123a8b38, 0xcf2ac99c, 0xb992e922, 0x82ff78f1,
+		// Dimension 10
+		0x80000000, 0x40000000, 0xa0000000, 0x10000000, 0x08000000, 0x6c000000, 0x9e000000, 0x23000000,
+		0x57800000, 0xadc00000, 0x7fa00000, 0x91d00000, 0x49880000, 0xced40000, 0x880a0000, 0x2c0f0000,
+		0x3e0d8000, 0x3317c000, 0x5fb06000, 0xc1f8b000, 0xe18d8800, 0xb2d7c400, 0x1e106a00, 0x6328b100,
+		0xf7858880, 0xbdc3c2c0, 0x77ba63e0, 0xfdf7b330, 0xd7800df8, 0xedc0081c, 0xdfa0041a, 0x81d00a2d,
+		// Dimension 11
+		0x80000000, 0x40000000, 0x20000000, 0x30000000, 0x58000000, 0xac000000, 0x96000000, 0x2b000000,
+		0xd4800000, 0x09400000, 0xe2a00000, 0x52500000, 0x4e280000, 0xc71c0000, 0x629e0000, 0x12670000,
+		0x6e138000, 0xf731c000, 0x3a98a000, 0xbe449000, 0xf83b8800, 0xdc2dc400, 0xee06a200, 0xb7239300,
+		0x1aa80d80, 0x8e5c0ec0, 0xa03e0b60, 0x703701b0, 0x783b88c8, 0x9c2dca54, 0xce06a74a, 0x87239795,
+		// Dimension 12
+		0x80000000, 0xc0000000, 0xa0000000, 0x50000000, 0xf8000000, 0x8c000000, 0xe2000000, 0x33000000,
+		0x0f800000, 0x21400000, 0x95a00000, 0x5e700000, 0xd8080000, 0x1c240000, 0xba160000, 0xef370000,
+		0x15868000, 0x9e6fc000, 0x781b6000, 0x4c349000, 0x420e8800, 0x630bcc00, 0xf7ad6a00, 0xad739500,
+		0x77800780, 0x6d4004c0, 0xd7a00420, 0x3d700630, 0x2f880f78, 0xb1640ad4, 0xcdb6077a, 0x824706d7,
+		// Dimension 13
+		0x80000000, 0xc0000000, 0x60000000, 0x90000000, 0x38000000, 0xc4000000, 0x42000000, 0xa3000000,
+		0xf1800000, 0xaa400000, 0xfce00000, 0x85100000, 0xe0080000, 0x500c0000, 0x58060000, 0x54090000,
+		0x7a038000, 0x670c4000, 0xb3842000, 0x094a3000, 0x0d6f1800, 0x2f5aa400, 0x1ce7ce00, 0xd5145100,
+		0xb8000080, 0x040000c0, 0x22000060, 0x33000090, 0xc9800038, 0x6e4000c4, 0xbee00042, 0x261000a3,
+		// Dimension 14
+		0x80000000, 0x40000000, 0x20000000, 0xf0000000, 0xa8000000, 0x54000000, 0x9a000000, 0x9d000000,
+		0x1e800000, 0x5cc00000, 0x7d200000, 0x8d100000, 0x24880000, 0x71c40000, 0xeba20000, 0x75df0000,
+		0x6ba28000, 0x35d14000, 0x4ba3a000, 0xc5d2d000, 0xe3a16800, 0x91db8c00, 0x79aef200, 0x0cdf4100,
+		0x672a8080, 0x50154040, 0x1a01a020, 0xdd0dd0f0, 0x3e83e8a8, 0xaccacc54, 0xd52d529a, 0xd91d919d,
+		// Dimension 15
+		0x80000000, 0xc0000000, 0x20000000, 0xd0000000, 0xd8000000, 0xc4000000, 0x46000000, 0x85000000,
+		0xa5800000, 0x76c00000, 0xada00000, 0x6ab00000, 0x2da80000, 0xaabc0000, 0x0daa0000, 0x7ab10000,
+		0xd5a78000, 0xbebd4000, 0x93a3e000, 0x3bb51000, 0x3629b800, 0x4d727c00, 0x9b836200, 0x27c4d700,
+		0xb629b880, 0x8d727cc0, 0xbb836220, 0xf7c4d7d0, 0x6e29b858, 0x49727c04, 0xfd836266, 0x72c4d755,
+	};
+
+	// Low Discrepancy Static Functions
+
+	// Constant bases let the compiler replace the divisions by multiplications
+	template <int base>
+	static Float RadicalInverseSpecialized(uint64_t a) {
+		const Float invBase = (Float)1 / (Float)base;
+		uint64_t reversedDigits = 0;
+		Float invBaseN = 1;
+		while (a) {
+			uint64_t next = a / base;
+			uint64_t digit = a - next * base;
+			reversedDigits = reversedDigits * base + digit;
+			invBaseN *= invBase;
+			a = next;
+		}
+		DCHECK_LT(reversedDigits * invBaseN, 1.00001);
+		return std::min(reversedDigits * invBaseN, OneMinusEpsilon);
+	}
+
+	template <int base>
+	static Float ScrambledRadicalInverseSpecialized(const uint16_t* perm, uint64_t a) {
+		const Float invBase = (Float)1 / (Float)base;
+		uint64_t reversedDigits = 0;
+		Float invBaseN = 1;
+		while (a) {
+			uint64_t next = a / base;
+			uint64_t digit = a - next * base;
+			reversedDigits = reversedDigits * base + perm[digit];
+			invBaseN *= invBase;
+			a = next;
+		}
+		// The trailing zeros map to perm[0] each, a geometric series
+		DCHECK_LT(invBaseN * (reversedDigits + invBase * perm[0] / (1 - invBase)), 1.00001);
+		return std::min(invBaseN * (reversedDigits + invBase * perm[0] / (1 - invBase)), OneMinusEpsilon);
+	}
+
+	// Low Discrepancy Function Definitions
+	Float RadicalInverse(int baseIndex, uint64_t a) {
+		switch (baseIndex) {
+		case 0:
+			// Base 2 is a bit reversal
+#ifdef PBR_FLOAT_AS_DOUBLE
+			return std::min(ReverseBits64(a) * 5.4210108624275222e-20, OneMinusEpsilon);
+#else
+			return std::min(ReverseBits64(a) * 5.4210108624275222e-20f, OneMinusEpsilon);
+#endif
+		case 1: return RadicalInverseSpecialized<3>(a);
+		case 2: return RadicalInverseSpecialized<5>(a);
+		case 3: return RadicalInverseSpecialized<7>(a);
+		case 4: return RadicalInverseSpecialized<11>(a);
+		case 5: return RadicalInverseSpecialized<13>(a);
+		case 6: return RadicalInverseSpecialized<17>(a);
+		case 7: return RadicalInverseSpecialized<19>(a);
+		case 8: return RadicalInverseSpecialized<23>(a);
+		case 9: return RadicalInverseSpecialized<29>(a);
+		case 10: return RadicalInverseSpecialized<31>(a);
+		case 11: return RadicalInverseSpecialized<37>(a);
+		case 12: return RadicalInverseSpecialized<41>(a);
+		case 13: return RadicalInverseSpecialized<43>(a);
+		case 14: return RadicalInverseSpecialized<47>(a);
+		case 15: return RadicalInverseSpecialized<53>(a);
+		case 16: return RadicalInverseSpecialized<59>(a);
+		case 17: return RadicalInverseSpecialized<61>(a);
+		case 18: return RadicalInverseSpecialized<67>(a);
+		case 19: return RadicalInverseSpecialized<71>(a);
+		case 20: return RadicalInverseSpecialized<73>(a);
+		case 21: return RadicalInverseSpecialized<79>(a);
+		case 22: return RadicalInverseSpecialized<83>(a);
+		case 23: return RadicalInverseSpecialized<89>(a);
+		case 24: return RadicalInverseSpecialized<97>(a);
+		case 25: return RadicalInverseSpecialized<101>(a);
+		case 26: return RadicalInverseSpecialized<103>(a);
+		case 27: return RadicalInverseSpecialized<107>(a);
+		case 28: return RadicalInverseSpecialized<109>(a);
+		case 29: return RadicalInverseSpecialized<113>(a);
+		case 30: return RadicalInverseSpecialized<127>(a);
+		case 31: return RadicalInverseSpecialized<131>(a);
+		case 32: return RadicalInverseSpecialized<137>(a);
+		case 33: return RadicalInverseSpecialized<139>(a);
+		case 34: return RadicalInverseSpecialized<149>(a);
+		case 35: return RadicalInverseSpecialized<151>(a);
+		case 36: return RadicalInverseSpecialized<157>(a);
+		case 37: return RadicalInverseSpecialized<163>(a);
+		case 38: return RadicalInverseSpecialized<167>(a);
+		case 39: return RadicalInverseSpecialized<173>(a);
+		case 40: return RadicalInverseSpecialized<179>(a);
+		case 41: return RadicalInverseSpecialized<181>(a);
+		case 42: return RadicalInverseSpecialized<191>(a);
+		case 43: return RadicalInverseSpecialized<193>(a);
+		case 44: return RadicalInverseSpecialized<197>(a);
+		case 45: return RadicalInverseSpecialized<199>(a);
+		case 46: return RadicalInverseSpecialized<211>(a);
+		case 47: return RadicalInverseSpecialized<223>(a);
+		case 48: return RadicalInverseSpecialized<227>(a);
+		case 49: return RadicalInverseSpecialized<229>(a);
+		case 50: return RadicalInverseSpecialized<233>(a);
+		case 51: return RadicalInverseSpecialized<239>(a);
+		case 52: return RadicalInverseSpecialized<241>(a);
+		case 53: return RadicalInverseSpecialized<251>(a);
+		case 54: return RadicalInverseSpecialized<257>(a);
+		case 55: return RadicalInverseSpecialized<263>(a);
+		case 56: return RadicalInverseSpecialized<269>(a);
+		case 57: return RadicalInverseSpecialized<271>(a);
+		case 58: return RadicalInverseSpecialized<277>(a);
+		case 59: return RadicalInverseSpecialized<281>(a);
+		case 60: return RadicalInverseSpecialized<283>(a);
+		case 61: return RadicalInverseSpecialized<293>(a);
+		case 62: return RadicalInverseSpecialized<307>(a);
+		case 63: return RadicalInverseSpecialized<311>(a);
+		case 64: return RadicalInverseSpecialized<313>(a);
+		case 65: return RadicalInverseSpecialized<317>(a);
+		case 66: return RadicalInverseSpecialized<331>(a);
+		case 67: return RadicalInverseSpecialized<337>(a);
+		case 68: return RadicalInverseSpecialized<347>(a);
+		case 69: return RadicalInverseSpecialized<349>(a);
+		case 70: return RadicalInverseSpecialized<353>(a);
+		case 71: return RadicalInverseSpecialized<359>(a);
+		case 72: return RadicalInverseSpecialized<367>(a);
+		case 73: return RadicalInverseSpecialized<373>(a);
+		case 74: return RadicalInverseSpecialized<379>(a);
+		case 75: return RadicalInverseSpecialized<383>(a);
+		case 76: return RadicalInverseSpecialized<389>(a);
+		case 77: return RadicalInverseSpecialized<397>(a);
+		case 78: return RadicalInverseSpecialized<401>(a);
+		case 79: return RadicalInverseSpecialized<409>(a);
+		case 80: return RadicalInverseSpecialized<419>(a);
+		case 81: return RadicalInverseSpecialized<421>(a);
+		case 82: return RadicalInverseSpecialized<431>(a);
+		case 83: return RadicalInverseSpecialized<433>(a);
+		case 84: return RadicalInverseSpecialized<439>(a);
+		case 85: return RadicalInverseSpecialized<443>(a);
+		case 86: return RadicalInverseSpecialized<449>(a);
+		case 87: return RadicalInverseSpecialized<457>(a);
+		case 88: return RadicalInverseSpecialized<461>(a);
+		case 89: return RadicalInverseSpecialized<463>(a);
+		case 90: return RadicalInverseSpecialized<467>(a);
+		case 91: return RadicalInverseSpecialized<479>(a);
+		case 92: return RadicalInverseSpecialized<487>(a);
+		case 93: return RadicalInverseSpecialized<491>(a);
+		case 94: return RadicalInverseSpecialized<499>(a);
+		case 95: return RadicalInverseSpecialized<503>(a);
+		case 96: return RadicalInverseSpecialized<509>(a);
+		case 97: return RadicalInverseSpecialized<521>(a);
+		case 98: return RadicalInverseSpecialized<523>(a);
+		case 99: return RadicalInverseSpecialized<541>(a);
+		case 100: return RadicalInverseSpecialized<547>(a);
+		case 101: return RadicalInverseSpecialized<557>(a);
+		case 102: return RadicalInverseSpecialized<563>(a);
+		case 103: return RadicalInverseSpecialized<569>(a);
+		case 104: return RadicalInverseSpecialized<571>(a);
+		case 105: return RadicalInverseSpecialized<577>(a);
+		case 106: return RadicalInverseSpecialized<587>(a);
+		case 107: return RadicalInverseSpecialized<593>(a);
+		case 108: return RadicalInverseSpecialized<599>(a);
+		case 109: return RadicalInverseSpecialized<601>(a);
+		case 110: return RadicalInverseSpecialized<607>(a);
+		case 111: return RadicalInverseSpecialized<613>(a);
+		case 112: return RadicalInverseSpecialized<617>(a);
+		case 113: return RadicalInverseSpecialized<619>(a);
+		case 114: return RadicalInverseSpecialized<631>(a);
+		case 115: return RadicalInverseSpecialized<641>(a);
+		case 116: return RadicalInverseSpecialized<643>(a);
+		case 117: return RadicalInverseSpecialized<647>(a);
+		case 118: return RadicalInverseSpecialized<653>(a);
+		case 119: return RadicalInverseSpecialized<659>(a);
+		case 120: return RadicalInverseSpecialized<661>(a);
+		case 121: return RadicalInverseSpecialized<673>(a);
+		case 122: return RadicalInverseSpecialized<677>(a);
+		case 123: return RadicalInverseSpecialized<683>(a);
+		case 124: return RadicalInverseSpecialized<691>(a);
+		case 125: return RadicalInverseSpecialized<701>(a);
+		case 126: return RadicalInverseSpecialized<709>(a);
+		case 127: return RadicalInverseSpecialized<719>(a);
+		case 128: return RadicalInverseSpecialized<727>(a);
+		case 129: return RadicalInverseSpecialized<733>(a);
+		case 130: return RadicalInverseSpecialized<739>(a);
+		case 131: return RadicalInverseSpecialized<743>(a);
+		case 132: return RadicalInverseSpecialized<751>(a);
+		case 133: return RadicalInverseSpecialized<757>(a);
+		case 134: return RadicalInverseSpecialized<761>(a);
+		case 135: return RadicalInverseSpecialized<769>(a);
+		case 136: return RadicalInverseSpecialized<773>(a);
+		case 137: return RadicalInverseSpecialized<787>(a);
+		case 138: return RadicalInverseSpecialized<797>(a);
+		case 139: return RadicalInverseSpecialized<809>(a);
+		case 140: return RadicalInverseSpecialized<811>(a);
+		case 141: return RadicalInverseSpecialized<821>(a);
+		case 142: return RadicalInverseSpecialized<823>(a);
+		case 143: return RadicalInverseSpecialized<827>(a);
+		case 144: return RadicalInverseSpecialized<829>(a);
+		case 145: return RadicalInverseSpecialized<839>(a);
+		case 146: return RadicalInverseSpecialized<853>(a);
+		case 147: return RadicalInverseSpecialized<857>(a);
+		case 148: return RadicalInverseSpecialized<859>(a);
+		case 149: return RadicalInverseSpecialized<863>(a);
+		case 150: return RadicalInverseSpecialized<877>(a);
+		case 151: return RadicalInverseSpecialized<881>(a);
+		case 152: return RadicalInverseSpecialized<883>(a);
+		case 153: return RadicalInverseSpecialized<887>(a);
+		case 154: return RadicalInverseSpecialized<907>(a);
+		case 155: return RadicalInverseSpecialized<911>(a);
+		case 156: return RadicalInverseSpecialized<919>(a);
+		case 157: return RadicalInverseSpecialized<929>(a);
+		case 158: return RadicalInverseSpecialized<937>(a);
+		case 159: return RadicalInverseSpecialized<941>(a);
+		case 160: return RadicalInverseSpecialized<947>(a);
+		case 161: return RadicalInverseSpecialized<953>(a);
+		case 162: return RadicalInverseSpecialized<967>(a);
+		case 163: return RadicalInverseSpecialized<971>(a);
+		case 164: return RadicalInverseSpecialized<977>(a);
+		case 165: return RadicalInverseSpecialized<983>(a);
+		case 166: return RadicalInverseSpecialized<991>(a);
+		case 167: return RadicalInverseSpecialized<997>(a);
+		case 168: return RadicalInverseSpecialized<1009>(a);
+		case 169: return RadicalInverseSpecialized<1013>(a);
+		case 170: return RadicalInverseSpecialized<1019>(a);
+		case 171: return RadicalInverseSpecialized<1021>(a);
+		case 172: return RadicalInverseSpecialized<1031>(a);
+		case 173: return RadicalInverseSpecialized<1033>(a);
+		case 174: return RadicalInverseSpecialized<1039>(a);
+		case 175: return RadicalInverseSpecialized<1049>(a);
+		case 176: return RadicalInverseSpecialized<1051>(a);
+		case 177: return RadicalInverseSpecialized<1061>(a);
+		case 178: return RadicalInverseSpecialized<1063>(a);
+		case 179: return RadicalInverseSpecialized<1069>(a);
+		case 180: return RadicalInverseSpecialized<1087>(a);
+		case 181: return RadicalInverseSpecialized<1091>(a);
+		case 182: return RadicalInverseSpecialized<1093>(a);
+		case 183: return RadicalInverseSpecialized<1097>(a);
+		case 184: return RadicalInverseSpecialized<1103>(a);
+		case 185: return RadicalInverseSpecialized<1109>(a);
+		case 186: return RadicalInverseSpecialized<1117>(a);
+		case 187: return RadicalInverseSpecialized<1123>(a);
+		case 188: return RadicalInverseSpecialized<1129>(a);
+		case 189: return RadicalInverseSpecialized<1151>(a);
+		case 190: return RadicalInverseSpecialized<1153>(a);
+		case 191: return RadicalInverseSpecialized<1163>(a);
+		case 192: return RadicalInverseSpecialized<1171>(a);
+		case 193: return RadicalInverseSpecialized<1181>(a);
+		case 194: return RadicalInverseSpecialized<1187>(a);
+		case 195: return RadicalInverseSpecialized<1193>(a);
+		case 196: return RadicalInverseSpecialized<1201>(a);
+		case 197: return RadicalInverseSpecialized<1213>(a);
+		case 198: return RadicalInverseSpecialized<1217>(a);
+		case 199: return RadicalInverseSpecialized<1223>(a);
+		case 200: return RadicalInverseSpecialized<1229>(a);
+		case 201: return RadicalInverseSpecialized<1231>(a);
+		case 202: return RadicalInverseSpecialized<1237>(a);
+		case 203: return RadicalInverseSpecialized<1249>(a);
+		case 204: return RadicalInverseSpecialized<1259>(a);
+		case 205: return RadicalInverseSpecialized<1277>(a);
+		case 206: return RadicalInverseSpecialized<1279>(a);
+		case 207: return RadicalInverseSpecialized<1283>(a);
+		case 208: return RadicalInverseSpecialized<1289>(a);
+		case 209: return RadicalInverseSpecialized<1291>(a);
+		case 210: return RadicalInverseSpecialized<1297>(a);
+		case 211: return RadicalInverseSpecialized<1301>(a);
+		case 212: return RadicalInverseSpecialized<1303>(a);
+		case 213: return RadicalInverseSpecialized<1307>(a);
+		case 214: return RadicalInverseSpecialized<1319>(a);
+		case 215: return RadicalInverseSpecialized<1321>(a);
+		case 216: return RadicalInverseSpecialized<1327>(a);
+		case 217: return RadicalInverseSpecialized<1361>(a);
+		case 218: return RadicalInverseSpecialized<1367>(a);
+		case 219: return RadicalInverseSpecialized<1373>(a);
+		case 220: return RadicalInverseSpecialized<1381>(a);
+		case 221: return RadicalInverseSpecialized<1399>(a);
+		case 222: return RadicalInverseSpecialized<1409>(a);
+		case 223: return RadicalInverseSpecialized<1423>(a);
+		case 224: return RadicalInverseSpecialized<1427>(a);
+		case 225: return RadicalInverseSpecialized<1429>(a);
+		case 226: return RadicalInverseSpecialized<1433>(a);
+		case 227: return RadicalInverseSpecialized<1439>(a);
+		case 228: return RadicalInverseSpecialized<1447>(a);
+		case 229: return RadicalInverseSpecialized<1451>(a);
+		case 230: return RadicalInverseSpecialized<1453>(a);
+		case 231: return RadicalInverseSpecialized<1459>(a);
+		case 232: return RadicalInverseSpecialized<1471>(a);
+		case 233: return RadicalInverseSpecialized<1481>(a);
+		case 234: return RadicalInverseSpecialized<1483>(a);
+		case 235: return RadicalInverseSpecialized<1487>(a);
+		case 236: return RadicalInverseSpecialized<1489>(a);
+		case 237: return RadicalInverseSpecialized<1493>(a);
+		case 238: return RadicalInverseSpecialized<1499>(a);
+		case 239: return RadicalInverseSpecialized<1511>(a);
+		case 240: return RadicalInverseSpecialized<1523>(a);
+		case 241: return RadicalInverseSpecialized<1531>(a);
+		case 242: return RadicalInverseSpecialized<1543>(a);
+		case 243: return RadicalInverseSpecialized<1549>(a);
+		case 244: return RadicalInverseSpecialized<1553>(a);
+		case 245: return RadicalInverseSpecialized<1559>(a);
+		case 246: return RadicalInverseSpecialized<1567>(a);
+		case 247: return RadicalInverseSpecialized<1571>(a);
+		case 248: return RadicalInverseSpecialized<1579>(a);
+		case 249: return RadicalInverseSpecialized<1583>(a);
+		case 250: return RadicalInverseSpecialized<1597>(a);
+		case 251: return RadicalInverseSpecialized<1601>(a);
+		case 252: return RadicalInverseSpecialized<1607>(a);
+		case 253: return RadicalInverseSpecialized<1609>(a);
+		case 254: return RadicalInverseSpecialized<1613>(a);
+		case 255: return RadicalInverseSpecialized<1619>(a);
+		default:
+			LOG(FATAL) << "Base index " << baseIndex << " exceeds the prime table";
+			return 0;
+		}
+	}
+
+	Float ScrambledRadicalInverse(int baseIndex, uint64_t a, const uint16_t* perm) {
+		switch (baseIndex) {
+		case 0: return ScrambledRadicalInverseSpecialized<2>(perm, a);
+		case 1: return ScrambledRadicalInverseSpecialized<3>(perm, a);
+		case 2: return ScrambledRadicalInverseSpecialized<5>(perm, a);
+		case 3: return ScrambledRadicalInverseSpecialized<7>(perm, a);
+		case 4: return ScrambledRadicalInverseSpecialized<11>(perm, a);
+		case 5: return ScrambledRadicalInverseSpecialized<13>(perm, a);
+		case 6: return ScrambledRadicalInverseSpecialized<17>(perm, a);
+		case 7: return ScrambledRadicalInverseSpecialized<19>(perm, a);
+		case 8: return ScrambledRadicalInverseSpecialized<23>(perm, a);
+		case 9: return ScrambledRadicalInverseSpecialized<29>(perm, a);
+		case 10: return ScrambledRadicalInverseSpecialized<31>(perm, a);
+		case 11: return ScrambledRadicalInverseSpecialized<37>(perm, a);
+		case 12: return ScrambledRadicalInverseSpecialized<41>(perm, a);
+		case 13: return ScrambledRadicalInverseSpecialized<43>(perm, a);
+		case 14: return ScrambledRadicalInverseSpecialized<47>(perm, a);
+		case 15: return ScrambledRadicalInverseSpecialized<53>(perm, a);
+		case 16: return ScrambledRadicalInverseSpecialized<59>(perm, a);
+		case 17: return ScrambledRadicalInverseSpecialized<61>(perm, a);
+		case 18: return ScrambledRadicalInverseSpecialized<67>(perm, a);
+		case 19: return ScrambledRadicalInverseSpecialized<71>(perm, a);
+		case 20: return ScrambledRadicalInverseSpecialized<73>(perm, a);
+		case 21: return ScrambledRadicalInverseSpecialized<79>(perm, a);
+		case 22: return ScrambledRadicalInverseSpecialized<83>(perm, a);
+		case 23: return ScrambledRadicalInverseSpecialized<89>(perm, a);
+		case 24: return ScrambledRadicalInverseSpecialized<97>(perm, a);
+		case 25: return ScrambledRadicalInverseSpecialized<101>(perm, a);
+		case 26: return ScrambledRadicalInverseSpecialized<103>(perm, a);
+		case 27: return ScrambledRadicalInverseSpecialized<107>(perm, a);
+		case 28: return ScrambledRadicalInverseSpecialized<109>(perm, a);
+		case 29: return ScrambledRadicalInverseSpecialized<113>(perm, a);
+		case 30: return ScrambledRadicalInverseSpecialized<127>(perm, a);
+		case 31: return ScrambledRadicalInverseSpecialized<131>(perm, a);
+		case 32: return ScrambledRadicalInverseSpecialized<137>(perm, a);
+		case 33: return ScrambledRadicalInverseSpecialized<139>(perm, a);
+		case 34: return ScrambledRadicalInverseSpecialized<149>(perm, a);
+		case 35: return ScrambledRadicalInverseSpecialized<151>(perm, a);
+		case 36: return ScrambledRadicalInverseSpecialized<157>(perm, a);
+		case 37: return ScrambledRadicalInverseSpecialized<163>(perm, a);
+		case 38: return ScrambledRadicalInverseSpecialized<167>(perm, a);
+		case 39: return ScrambledRadicalInverseSpecialized<173>(perm, a);
+		case 40: return ScrambledRadicalInverseSpecialized<179>(perm, a);
+		case 41: return ScrambledRadicalInverseSpecialized<181>(perm, a);
+		case 42: return ScrambledRadicalInverseSpecialized<191>(perm, a);
+		case 43: return ScrambledRadicalInverseSpecialized<193>(perm, a);
+		case 44: return ScrambledRadicalInverseSpecialized<197>(perm, a);
+		case 45: return ScrambledRadicalInverseSpecialized<199>(perm, a);
+		case 46: return ScrambledRadicalInverseSpecialized<211>(perm, a);
+		case 47: return ScrambledRadicalInverseSpecialized<223>(perm, a);
+		case 48: return ScrambledRadicalInverseSpecialized<227>(perm, a);
+		case 49: return ScrambledRadicalInverseSpecialized<229>(perm, a);
+		case 50: return ScrambledRadicalInverseSpecialized<233>(perm, a);
+		case 51: return ScrambledRadicalInverseSpecialized<239>(perm, a);
+		case 52: return ScrambledRadicalInverseSpecialized<241>(perm, a);
+		case 53: return ScrambledRadicalInverseSpecialized<251>(perm, a);
+		case 54: return ScrambledRadicalInverseSpecialized<257>(perm, a);
+		case 55: return ScrambledRadicalInverseSpecialized<263>(perm, a);
+		case 56: return ScrambledRadicalInverseSpecialized<269>(perm, a);
+		case 57: return ScrambledRadicalInverseSpecialized<271>(perm, a);
+		case 58: return ScrambledRadicalInverseSpecialized<277>(perm, a);
+		case 59: return ScrambledRadicalInverseSpecialized<281>(perm, a);
+		case 60: return ScrambledRadicalInverseSpecialized<283>(perm, a);
+		case 61: return ScrambledRadicalInverseSpecialized<293>(perm, a);
+		case 62: return ScrambledRadicalInverseSpecialized<307>(perm, a);
+		case 63: return ScrambledRadicalInverseSpecialized<311>(perm, a);
+		case 64: return ScrambledRadicalInverseSpecialized<313>(perm, a);
+		case 65: return ScrambledRadicalInverseSpecialized<317>(perm, a);
+		case 66: return ScrambledRadicalInverseSpecialized<331>(perm, a);
+		case 67: return ScrambledRadicalInverseSpecialized<337>(perm, a);
+		case 68: return ScrambledRadicalInverseSpecialized<347>(perm, a);
+		case 69: return ScrambledRadicalInverseSpecialized<349>(perm, a);
+		case 70: return ScrambledRadicalInverseSpecialized<353>(perm, a);
+		case 71: return ScrambledRadicalInverseSpecialized<359>(perm, a);
+		case 72: return ScrambledRadicalInverseSpecialized<367>(perm, a);
+		case 73: return ScrambledRadicalInverseSpecialized<373>(perm, a);
+		case 74: return ScrambledRadicalInverseSpecialized<379>(perm, a);
+		case 75: return ScrambledRadicalInverseSpecialized<383>(perm, a);
+		case 76: return ScrambledRadicalInverseSpecialized<389>(perm, a);
+		case 77: return ScrambledRadicalInverseSpecialized<397>(perm, a);
+		case 78: return ScrambledRadicalInverseSpecialized<401>(perm, a);
+		case 79: return ScrambledRadicalInverseSpecialized<409>(perm, a);
+		case 80: return ScrambledRadicalInverseSpecialized<419>(perm, a);
+		case 81: return ScrambledRadicalInverseSpecialized<421>(perm, a);
+		case 82: return ScrambledRadicalInverseSpecialized<431>(perm, a);
+		case 83: return ScrambledRadicalInverseSpecialized<433>(perm, a);
+		case 84: return ScrambledRadicalInverseSpecialized<439>(perm, a);
+		case 85: return ScrambledRadicalInverseSpecialized<443>(perm, a);
+		case 86: return ScrambledRadicalInverseSpecialized<449>(perm, a);
+		case 87: return ScrambledRadicalInverseSpecialized<457>(perm, a);
+		case 88: return ScrambledRadicalInverseSpecialized<461>(perm, a);
+		case 89: return ScrambledRadicalInverseSpecialized<463>(perm, a);
+		case 90: return ScrambledRadicalInverseSpecialized<467>(perm, a);
+		case 91: return ScrambledRadicalInverseSpecialized<479>(perm, a);
+		case 92: return ScrambledRadicalInverseSpecialized<487>(perm, a);
+		case 93: return ScrambledRadicalInverseSpecialized<491>(perm, a);
+		case 94: return ScrambledRadicalInverseSpecialized<499>(perm, a);
+		case 95: return ScrambledRadicalInverseSpecialized<503>(perm, a);
+		case 96: return ScrambledRadicalInverseSpecialized<509>(perm, a);
+		case 97: return ScrambledRadicalInverseSpecialized<521>(perm, a);
+		case 98: return ScrambledRadicalInverseSpecialized<523>(perm, a);
+		case 99: return ScrambledRadicalInverseSpecialized<541>(perm, a);
+		case 100: return ScrambledRadicalInverseSpecialized<547>(perm, a);
+		case 101: return ScrambledRadicalInverseSpecialized<557>(perm, a);
+		case 102: return ScrambledRadicalInverseSpecialized<563>(perm, a);
+		case 103: return ScrambledRadicalInverseSpecialized<569>(perm, a);
+		case 104: return ScrambledRadicalInverseSpecialized<571>(perm, a);
+		case 105: return ScrambledRadicalInverseSpecialized<577>(perm, a);
+		case 106: return ScrambledRadicalInverseSpecialized<587>(perm, a);
+		case 107: return ScrambledRadicalInverseSpecialized<593>(perm, a);
+		case 108: return ScrambledRadicalInverseSpecialized<599>(perm, a);
+		case 109: return ScrambledRadicalInverseSpecialized<601>(perm, a);
+		case 110: return ScrambledRadicalInverseSpecialized<607>(perm, a);
+		case 111: return ScrambledRadicalInverseSpecialized<613>(perm, a);
+		case 112: return ScrambledRadicalInverseSpecialized<617>(perm, a);
+		case 113: return ScrambledRadicalInverseSpecialized<619>(perm, a);
+		case 114: return ScrambledRadicalInverseSpecialized<631>(perm, a);
+		case 115: return ScrambledRadicalInverseSpecialized<641>(perm, a);
+		case 116: return ScrambledRadicalInverseSpecialized<643>(perm, a);
+		case 117: return ScrambledRadicalInverseSpecialized<647>(perm, a);
+		case 118: return ScrambledRadicalInverseSpecialized<653>(perm, a);
+		case 119: return ScrambledRadicalInverseSpecialized<659>(perm, a);
+		case 120: return ScrambledRadicalInverseSpecialized<661>(perm, a);
+		case 121: return ScrambledRadicalInverseSpecialized<673>(perm, a);
+		case 122: return ScrambledRadicalInverseSpecialized<677>(perm, a);
+		case 123: return ScrambledRadicalInverseSpecialized<683>(perm, a);
+		case 124: return ScrambledRadicalInverseSpecialized<691>(perm, a);
+		case 125: return ScrambledRadicalInverseSpecialized<701>(perm, a);
+		case 126: return ScrambledRadicalInverseSpecialized<709>(perm, a);
+		case 127: return ScrambledRadicalInverseSpecialized<719>(perm, a);
+		case 128: return ScrambledRadicalInverseSpecialized<727>(perm, a);
+		case 129: return ScrambledRadicalInverseSpecialized<733>(perm, a);
+		case 130: return ScrambledRadicalInverseSpecialized<739>(perm, a);
+		case 131: return ScrambledRadicalInverseSpecialized<743>(perm, a);
+		case 132: return ScrambledRadicalInverseSpecialized<751>(perm, a);
+		case 133: return ScrambledRadicalInverseSpecialized<757>(perm, a);
+		case 134: return ScrambledRadicalInverseSpecialized<761>(perm, a);
+		case 135: return ScrambledRadicalInverseSpecialized<769>(perm, a);
+		case 136: return ScrambledRadicalInverseSpecialized<773>(perm, a);
+		case 137: return ScrambledRadicalInverseSpecialized<787>(perm, a);
+		case 138: return ScrambledRadicalInverseSpecialized<797>(perm, a);
+		case 139: return ScrambledRadicalInverseSpecialized<809>(perm, a);
+		case 140: return ScrambledRadicalInverseSpecialized<811>(perm, a);
+		case 141: return ScrambledRadicalInverseSpecialized<821>(perm, a);
+		case 142: return ScrambledRadicalInverseSpecialized<823>(perm, a);
+		case 143: return ScrambledRadicalInverseSpecialized<827>(perm, a);
+		case 144: return ScrambledRadicalInverseSpecialized<829>(perm, a);
+		case 145: return ScrambledRadicalInverseSpecialized<839>(perm, a);
+		case 146: return ScrambledRadicalInverseSpecialized<853>(perm, a);
+		case 147: return ScrambledRadicalInverseSpecialized<857>(perm, a);
+		case 148: return ScrambledRadicalInverseSpecialized<859>(perm, a);
+		case 149: return ScrambledRadicalInverseSpecialized<863>(perm, a);
+		case 150: return ScrambledRadicalInverseSpecialized<877>(perm, a);
+		case 151: return ScrambledRadicalInverseSpecialized<881>(perm, a);
+		case 152: return ScrambledRadicalInverseSpecialized<883>(perm, a);
+		case 153: return ScrambledRadicalInverseSpecialized<887>(perm, a);
+		case 154: return ScrambledRadicalInverseSpecialized<907>(perm, a);
+		case 155: return ScrambledRadicalInverseSpecialized<911>(perm, a);
+		case 156: return ScrambledRadicalInverseSpecialized<919>(perm, a);
+		case 157: return ScrambledRadicalInverseSpecialized<929>(perm, a);
+		case 158: return ScrambledRadicalInverseSpecialized<937>(perm, a);
+		case 159: return ScrambledRadicalInverseSpecialized<941>(perm, a);
+		case 160: return ScrambledRadicalInverseSpecialized<947>(perm, a);
+		case 161: return ScrambledRadicalInverseSpecialized<953>(perm, a);
+		case 162: return ScrambledRadicalInverseSpecialized<967>(perm, a);
+		case 163: return ScrambledRadicalInverseSpecialized<971>(perm, a);
+		case 164: return ScrambledRadicalInverseSpecialized<977>(perm, a);
+		case 165: return ScrambledRadicalInverseSpecialized<983>(perm, a);
+		case 166: return ScrambledRadicalInverseSpecialized<991>(perm, a);
+		case 167: return ScrambledRadicalInverseSpecialized<997>(perm, a);
+		case 168: return ScrambledRadicalInverseSpecialized<1009>(perm, a);
+		case 169: return ScrambledRadicalInverseSpecialized<1013>(perm, a);
+		case 170: return ScrambledRadicalInverseSpecialized<1019>(perm, a);
+		case 171: return ScrambledRadicalInverseSpecialized<1021>(perm, a);
+		case 172: return ScrambledRadicalInverseSpecialized<1031>(perm, a);
+		case 173: return ScrambledRadicalInverseSpecialized<1033>(perm, a);
+		case 174: return ScrambledRadicalInverseSpecialized<1039>(perm, a);
+		case 175: return ScrambledRadicalInverseSpecialized<1049>(perm, a);
+		case 176: return ScrambledRadicalInverseSpecialized<1051>(perm, a);
+		case 177: return ScrambledRadicalInverseSpecialized<1061>(perm, a);
+		case 178: return ScrambledRadicalInverseSpecialized<1063>(perm, a);
+		case 179: return ScrambledRadicalInverseSpecialized<1069>(perm, a);
+		case 180: return ScrambledRadicalInverseSpecialized<1087>(perm, a);
+		case 181: return ScrambledRadicalInverseSpecialized<1091>(perm, a);
+		case 182: return ScrambledRadicalInverseSpecialized<1093>(perm, a);
+		case 183: return ScrambledRadicalInverseSpecialized<1097>(perm, a);
+		case 184: return ScrambledRadicalInverseSpecialized<1103>(perm, a);
+		case 185: return ScrambledRadicalInverseSpecialized<1109>(perm, a);
+		case 186: return ScrambledRadicalInverseSpecialized<1117>(perm, a);
+		case 187: return ScrambledRadicalInverseSpecialized<1123>(perm, a);
+		case 188: return ScrambledRadicalInverseSpecialized<1129>(perm, a);
+		case 189: return ScrambledRadicalInverseSpecialized<1151>(perm, a);
+		case 190: return ScrambledRadicalInverseSpecialized<1153>(perm, a);
+		case 191: return ScrambledRadicalInverseSpecialized<1163>(perm, a);
+		case 192: return ScrambledRadicalInverseSpecialized<1171>(perm, a);
+		case 193: return ScrambledRadicalInverseSpecialized<1181>(perm, a);
+		case 194: return ScrambledRadicalInverseSpecialized<1187>(perm, a);
+		case 195: return ScrambledRadicalInverseSpecialized<1193>(perm, a);
+		case 196: return ScrambledRadicalInverseSpecialized<1201>(perm, a);
+		case 197: return ScrambledRadicalInverseSpecialized<1213>(perm, a);
+		case 198: return ScrambledRadicalInverseSpecialized<1217>(perm, a);
+		case 199: return ScrambledRadicalInverseSpecialized<1223>(perm, a);
+		case 200: return ScrambledRadicalInverseSpecialized<1229>(perm, a);
+		case 201: return ScrambledRadicalInverseSpecialized<1231>(perm, a);
+		case 202: return ScrambledRadicalInverseSpecialized<1237>(perm, a);
+		case 203: return ScrambledRadicalInverseSpecialized<1249>(perm, a);
+		case 204: return ScrambledRadicalInverseSpecialized<1259>(perm, a);
+		case 205: return ScrambledRadicalInverseSpecialized<1277>(perm, a);
+		case 206: return ScrambledRadicalInverseSpecialized<1279>(perm, a);
+		case 207: return ScrambledRadicalInverseSpecialized<1283>(perm, a);
+		case 208: return ScrambledRadicalInverseSpecialized<1289>(perm, a);
+		case 209: return ScrambledRadicalInverseSpecialized<1291>(perm, a);
+		case 210: return ScrambledRadicalInverseSpecialized<1297>(perm, a);
+		case 211: return ScrambledRadicalInverseSpecialized<1301>(perm, a);
+		case 212: return ScrambledRadicalInverseSpecialized<1303>(perm, a);
+		case 213: return ScrambledRadicalInverseSpecialized<1307>(perm, a);
+		case 214: return ScrambledRadicalInverseSpecialized<1319>(perm, a);
+		case 215: return ScrambledRadicalInverseSpecialized<1321>(perm, a);
+		case 216: return ScrambledRadicalInverseSpecialized<1327>(perm, a);
+		case 217: return ScrambledRadicalInverseSpecialized<1361>(perm, a);
+		case 218: return ScrambledRadicalInverseSpecialized<1367>(perm, a);
+		case 219: return ScrambledRadicalInverseSpecialized<1373>(perm, a);
+		case 220: return ScrambledRadicalInverseSpecialized<1381>(perm, a);
+		case 221: return ScrambledRadicalInverseSpecialized<1399>(perm, a);
+		case 222: return ScrambledRadicalInverseSpecialized<1409>(perm, a);
+		case 223: return ScrambledRadicalInverseSpecialized<1423>(perm, a);
+		case 224: return ScrambledRadicalInverseSpecialized<1427>(perm, a);
+		case 225: return ScrambledRadicalInverseSpecialized<1429>(perm, a);
+		case 226: return ScrambledRadicalInverseSpecialized<1433>(perm, a);
+		case 227: return ScrambledRadicalInverseSpecialized<1439>(perm, a);
+		case 228: return ScrambledRadicalInverseSpecialized<1447>(perm, a);
+		case 229: return ScrambledRadicalInverseSpecialized<1451>(perm, a);
+		case 230: return ScrambledRadicalInverseSpecialized<1453>(perm, a);
+		case 231: return ScrambledRadicalInverseSpecialized<1459>(perm, a);
+		case 232: return ScrambledRadicalInverseSpecialized<1471>(perm, a);
+		case 233: return ScrambledRadicalInverseSpecialized<1481>(perm, a);
+		case 234: return ScrambledRadicalInverseSpecialized<1483>(perm, a);
+		case 235: return ScrambledRadicalInverseSpecialized<1487>(perm, a);
+		case 236: return ScrambledRadicalInverseSpecialized<1489>(perm, a);
+		case 237: return ScrambledRadicalInverseSpecialized<1493>(perm, a);
+		case 238: return ScrambledRadicalInverseSpecialized<1499>(perm, a);
+		case 239: return ScrambledRadicalInverseSpecialized<1511>(perm, a);
+		case 240: return ScrambledRadicalInverseSpecialized<1523>(perm, a);
+		case 241: return ScrambledRadicalInverseSpecialized<1531>(perm, a);
+		case 242: return ScrambledRadicalInverseSpecialized<1543>(perm, a);
+		case 243: return ScrambledRadicalInverseSpecialized<1549>(perm, a);
+		case 244: return ScrambledRadicalInverseSpecialized<1553>(perm, a);
+		case 245: return ScrambledRadicalInverseSpecialized<1559>(perm, a);
+		case 246: return ScrambledRadicalInverseSpecialized<1567>(perm, a);
+		case 247: return ScrambledRadicalInverseSpecialized<1571>(perm, a);
+		case 248: return ScrambledRadicalInverseSpecialized<1579>(perm, a);
+		case 249: return ScrambledRadicalInverseSpecialized<1583>(perm, a);
+		case 250: return ScrambledRadicalInverseSpecialized<1597>(perm, a);
+		case 251: return ScrambledRadicalInverseSpecialized<1601>(perm, a);
+		case 252: return ScrambledRadicalInverseSpecialized<1607>(perm, a);
+		case 253: return ScrambledRadicalInverseSpecialized<1609>(perm, a);
+		case 254: return ScrambledRadicalInverseSpecialized<1613>(perm, a);
+		case 255: return ScrambledRadicalInverseSpecialized<1619>(perm, a);
+		default:
+			LOG(FATAL) << "Base index " << baseIndex << " exceeds the prime table";
+			return 0;
+		}
+	}
+
+	std::vector<uint16_t> ComputeRadicalInversePermutations(RNG& rng) {
+		std::vector<uint16_t> perms(PrimeSums[PrimeTableSize - 1] + Primes[PrimeTableSize - 1]);
+		uint16_t* p = &perms[0];
+		for (int i = 0; i < PrimeTableSize; ++i) {
+			for (int j = 0; j < Primes[i]; ++j) p[j] = j;
+			Shuffle(p, Primes[i], 1, rng);
+			p += Primes[i];
+		}
+		return perms;
+	}
+
+}  // namespace pbr
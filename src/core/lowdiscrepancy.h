@@ -0,0 +1,83 @@
+#ifndef CORE_LOWDISCREPANCY_H
+#define CORE_LOWDISCREPANCY_H
+
+#include "pbr.h"
+#include "rng.h"
+
+namespace pbr {
+
+	// Low Discrepancy Declarations
+	static const int PrimeTableSize = 256;
+	extern const int Primes[PrimeTableSize];
+	// Sum of the primes before each one: the offset of its digit permutation
+	extern const int PrimeSums[PrimeTableSize];
+
+	// Radical inverse of a in the baseIndex'th prime base
+	Float RadicalInverse(int baseIndex, uint64_t a);
+	// As RadicalInverse(), with each digit mapped through perm, including
+	// the infinite trailing zeros
+	Float ScrambledRadicalInverse(int baseIndex, uint64_t a, const uint16_t* perm);
+	// A random permutation of the digits of every prime base, concatenated;
+	// the permutation for base index i starts at PrimeSums[i]
+	std::vector<uint16_t> ComputeRadicalInversePermutations(RNG& rng);
+
+	// Sobol generator matrices, 32 columns per dimension, from the Joe-Kuo
+	// direction numbers
+	static const int NSobolDimensions = 16;
+	static const int SobolMatrixSize = 32;
+	extern const uint32_t SobolMatrices32[NSobolDimensions * SobolMatrixSize];
+
+	// Low Discrepancy Inline Functions
+	inline uint32_t ReverseBits32(uint32_t n) {
+		n = (n << 16) | (n >> 16);
+		n = ((n & 0x00ff00ff) << 8) | ((n & 0xff00ff00) >> 8);
+		n = ((n & 0x0f0f0f0f) << 4) | ((n & 0xf0f0f0f0) >> 4);
+		n = ((n & 0x33333333) << 2) | ((n & 0xcccccccc) >> 2);
+		n = ((n & 0x55555555) << 1) | ((n & 0xaaaaaaaa) >> 1);
+		return n;
+	}
+
+	inline uint64_t ReverseBits64(uint64_t n) {
+		uint64_t n0 = ReverseBits32((uint32_t)n);
+		uint64_t n1 = ReverseBits32((uint32_t)(n >> 32));
+		return (n0 << 32) | n1;
+	}
+
+	// Index whose first nDigits base-b digits have radical inverse inverse
+	template <int base>
+	inline uint64_t InverseRadicalInverse(uint64_t inverse, int nDigits) {
+		uint64_t index = 0;
+		for (int i = 0; i < nDigits; ++i) {
+			uint64_t digit = inverse % base;
+			inverse /= base;
+			index = index * base + digit;
+		}
+		return index;
+	}
+
+	// Unscrambled bits of sample a of a Sobol dimension
+	inline uint32_t SobolSampleBits(uint32_t a, int dimension) {
+		DCHECK_LT(dimension, NSobolDimensions);
+		const uint32_t* C = &SobolMatrices32[dimension * SobolMatrixSize];
+		uint32_t v = 0;
+		for (int i = 0; a != 0; a >>= 1, ++i)
+			if (a & 1) v ^= C[i];
+		return v;
+	}
+
+	// Nested uniform (Owen) scrambling approximated by a hash in which each
+	// bit depends only on the bits above it (Laine and Karras), so the
+	// (t, m, s)-net structure of the input is preserved
+	inline uint32_t OwenScramble(uint32_t v, uint32_t seed) {
+		v = ReverseBits32(v);
+		v ^= v * 0x3d20adea;
+		v += seed;
+		v *= (seed >> 16) | 1;
+		v ^= v * 0x05526c56;
+		v ^= v * 0x53a22864;
+		return ReverseBits32(v);
+	}
+
+}  // namespace pbr
+
+#endif  // CORE_LOWDISCREPANCY_H
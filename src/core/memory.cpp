@@ -0,0 +1,29 @@
+#include "memory.h"
+#include <stdlib.h>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+namespace pbr {
+
+	// Memory Allocation Functions
+	void* AllocAligned(size_t size) {
+#ifdef _WIN32
+		return _aligned_malloc(size, PBR_L1_CACHE_LINE_SIZE);
+#else
+		void* ptr;
+		if (posix_memalign(&ptr, PBR_L1_CACHE_LINE_SIZE, size) != 0) ptr = nullptr;
+		return ptr;
+#endif
+	}
+
+	void FreeAligned(void* ptr) {
+		if (!ptr) return;
+#ifdef _WIN32
+		_aligned_free(ptr);
+#else
+		free(ptr);
+#endif
+	}
+
+}  // namespace pbr
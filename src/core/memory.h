@@ -0,0 +1,175 @@
+#ifndef CORE_MEMORY_H
+#define CORE_MEMORY_H
+
+#include "pbr.h"
+#include "geometry.h"
+#include <cstddef>
+#include <list>
+#include <utility>
+#ifdef _MSC_VER
+#include <malloc.h>
+#else
+#include <alloca.h>
+#endif
+
+namespace pbr {
+
+#ifndef PBR_L1_CACHE_LINE_SIZE
+#define PBR_L1_CACHE_LINE_SIZE 64
+#endif
+
+	// Stack allocation for small per-call scratch arrays
+#define ALLOCA(TYPE, COUNT) (TYPE*)alloca((COUNT) * sizeof(TYPE))
+
+	// Memory Declarations
+	void* AllocAligned(size_t size);
+	template <typename T> T* AllocAligned(size_t count) {
+		return (T*)AllocAligned(count * sizeof(T));
+	}
+	void FreeAligned(void*);
+
+	class MemoryArena {
+	public:
+		MemoryArena(size_t blockSize = 262144) : blockSize(blockSize) {}
+		~MemoryArena() {
+			FreeAligned(currentBlock);
+			for (auto& block : usedBlocks) FreeAligned(block.second);
+			for (auto& block : availableBlocks) FreeAligned(block.second);
+		}
+		MemoryArena(const MemoryArena&) = delete;
+		MemoryArena& operator=(const MemoryArena&) = delete;
+
+		void* Alloc(size_t nBytes) {
+			// Round up nBytes to minimum machine alignment
+			const int align = alignof(std::max_align_t);
+			nBytes = (nBytes + align - 1) & ~(align - 1);
+			if (currentBlockPos + nBytes > currentAllocSize) {
+				// Add current block to usedBlocks list
+				if (currentBlock) {
+					usedBlocks.push_back(std::make_pair(currentAllocSize, currentBlock));
+					currentBlock = nullptr;
+					currentAllocSize = 0;
+				}
+				// Try to get memory block from availableBlocks
+				for (auto iter = availableBlocks.begin(); iter != availableBlocks.end(); ++iter) {
+					if (iter->first >= nBytes) {
+						currentAllocSize = iter->first;
+						currentBlock = iter->second;
+						availableBlocks.erase(iter);
+						break;
+					}
+				}
+				if (!currentBlock) {
+					currentAllocSize = std::max(nBytes, blockSize);
+					currentBlock = AllocAligned<uint8_t>(currentAllocSize);
+				}
+				currentBlockPos = 0;
+			}
+			void* ret = currentBlock + currentBlockPos;
+			currentBlockPos += nBytes;
+			return ret;
+		}
+
+		template <typename T> T* Alloc(size_t n = 1, bool runConstructor = true) {
+			T* ret = (T*)Alloc(n * sizeof(T));
+			if (runConstructor)
+				for (size_t i = 0; i < n; ++i) new (&ret[i]) T();
+			return ret;
+		}
+
+		void Reset() {
+			currentBlockPos = 0;
+			availableBlocks.splice(availableBlocks.begin(), usedBlocks);
+		}
+
+		size_t TotalAllocated() const {
+			size_t total = currentAllocSize;
+			for (const auto& alloc : usedBlocks) total += alloc.first;
+			for (const auto& alloc : availableBlocks) total += alloc.first;
+			return total;
+		}
+
+	private:
+		const size_t blockSize;
+		size_t currentBlockPos = 0, currentAllocSize = 0;
+		uint8_t* currentBlock = nullptr;
+		std::list<std::pair<size_t, uint8_t*>> usedBlocks, availableBlocks;
+	};
+
+	// 2D array stored in square blocks of 2^logBlockSize elements a side,
+	// each block contiguous, so that neighbouring elements in v are usually
+	// on the same cache line as in u. The resolution is padded to whole
+	// blocks.
+	template <typename T, int logBlockSize = 2>
+	class BlockedArray {
+	public:
+		// BlockedArray Public Methods
+
+		// Initialized from the row-major d if given
+		BlockedArray(int uRes, int vRes, const T* d = nullptr)
+			: uRes(uRes), vRes(vRes), uBlocks(RoundUp(uRes) >> logBlockSize) {
+			int nAlloc = RoundUp(uRes) * RoundUp(vRes);
+			data = AllocAligned<T>(nAlloc);
+			for (int i = 0; i < nAlloc; ++i) new (&data[i]) T();
+			if (d)
+				for (int v = 0; v < vRes; ++v)
+					for (int u = 0; u < uRes; ++u) (*this)(u, v) = d[v * uRes + u];
+		}
+		BlockedArray(const Point2i& res, const T* d = nullptr) : BlockedArray(res.x, res.y, d) {}
+		~BlockedArray() {
+			for (int i = 0; i < RoundUp(uRes) * RoundUp(vRes); ++i) data[i].~T();
+			FreeAligned(data);
+		}
+		BlockedArray(const BlockedArray&) = delete;
+		BlockedArray& operator=(const BlockedArray&) = delete;
+
+		static PBRT_CONSTEXPR int BlockSize() { return 1 << logBlockSize; }
+		static int RoundUp(int x) { return (x + BlockSize() - 1) & ~(BlockSize() - 1); }
+		// Index of element (u, v) in a blocked layout uBlocks blocks wide
+		static int Index(int u, int v, int uBlocks) {
+			int bu = u >> logBlockSize, bv = v >> logBlockSize;
+			int ou = u & (BlockSize() - 1), ov = v & (BlockSize() - 1);
+			return ((uBlocks * bv + bu) << (2 * logBlockSize)) + (ov << logBlockSize) + ou;
+		}
+		// Index offsets from element (u, v) to (u + 1, v) and to (u, v + 1)
+		static int UStep(int u) {
+			return (u & (BlockSize() - 1)) == BlockSize() - 1 ? BlockSize() * BlockSize() - (BlockSize() - 1) : 1;
+		}
+		static int VStep(int v, int uBlocks) {
+			return (v & (BlockSize() - 1)) == BlockSize() - 1 ?
+				uBlocks * BlockSize() * BlockSize() - (BlockSize() - 1) * BlockSize() : BlockSize();
+		}
+		int uSize() const { return uRes; }
+		int vSize() const { return vRes; }
+		Point2i Resolution() const { return Point2i(uRes, vRes); }
+		Bounds2i Bounds() const { return Bounds2i(Point2i(0, 0), Point2i(uRes, vRes)); }
+
+		T& operator()(int u, int v) { return data[Index(u, v, uBlocks)]; }
+		const T& operator()(int u, int v) const { return data[Index(u, v, uBlocks)]; }
+		T& operator[](const Point2i& p) { return (*this)(p.x, p.y); }
+		const T& operator[](const Point2i& p) const { return (*this)(p.x, p.y); }
+
+		// Copies the elements of b, which must lie within Bounds(), to or from
+		// the row-major a
+		void GetLinearArray(const Bounds2i& b, T* a) const {
+			for (int v = b.pMin.y; v < b.pMax.y; ++v)
+				for (int u = b.pMin.x; u < b.pMax.x; ++u) *a++ = (*this)(u, v);
+		}
+		void GetLinearArray(T* a) const { GetLinearArray(Bounds(), a); }
+		void SetLinearArray(const Bounds2i& b, const T* a) {
+			for (int v = b.pMin.y; v < b.pMax.y; ++v)
+				for (int u = b.pMin.x; u < b.pMax.x; ++u) (*this)(u, v) = *a++;
+		}
+
+		// The blocked elements, RoundUp(uSize()) * RoundUp(vSize()) of them
+		const T* Data() const { return data; }
+
+	private:
+		// BlockedArray Private Data
+		T* data;
+		const int uRes, vRes, uBlocks;
+	};
+
+}  // namespace pbr
+
+#endif  // CORE_MEMORY_H
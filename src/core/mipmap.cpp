@@ -0,0 +1,111 @@
+#include "mipmap.h"
+
+namespace pbr {
+
+	// MIPMap Local Definitions
+	struct TiledMIPMapHeader {
+		char magic[8];
+		uint32_t version;
+		uint32_t texelBytes;
+		uint32_t tileSize;
+		int32_t width, height;
+		uint32_t pad;
+	};
+
+	static const char TiledMIPMapMagic[8] = { 'P', 'B', 'R', 'T', 'I', 'L', 'E', 'S' };
+	static const uint32_t TiledMIPMapVersion = 2;
+
+	static Point2i TileCount(const Point2i& res) {
+		return Point2i((res.x + MIPMapTileSize - 1) >> LogMIPMapTileSize,
+			(res.y + MIPMapTileSize - 1) >> LogMIPMapTileSize);
+	}
+
+	// Offsets of each level's tiles, with the file size as the last entry
+	static std::vector<uint64_t> LevelOffsets(const std::vector<Point2i>& res, size_t tileBytes) {
+		std::vector<uint64_t> offsets(1, sizeof(TiledMIPMapHeader));
+		for (const Point2i& r : res) {
+			Point2i nTiles = TileCount(r);
+			offsets.push_back(offsets.back() + (uint64_t)nTiles.x * nTiles.y * tileBytes);
+		}
+		return offsets;
+	}
+
+	// MIPMap Helper Definitions
+	EWAWeightLUT::EWAWeightLUT() {
+		for (int i = 0; i < Size; ++i) {
+			const Float alpha = 2;
+			Float r2 = Float(i) / Float(Size - 1);
+			weights[i] = std::exp(-alpha * r2) - std::exp(-alpha);
+		}
+	}
+
+	const EWAWeightLUT EWAWeights;
+
+	std::vector<Point2i> MIPMapLevelResolutions(const Point2i& res) {
+		std::vector<Point2i> levels(1, res);
+		while (levels.back().x > 1 || levels.back().y > 1) {
+			const Point2i& r = levels.back();
+			levels.push_back(Point2i(std::max(1, (r.x + 1) / 2), std::max(1, (r.y + 1) / 2)));
+		}
+		return levels;
+	}
+
+	bool WriteTiledMIPMapFile(const std::string& filename, const Point2i& resolution, size_t texelBytes,
+		const std::function<void(int, const Point2i&, void*)>& getTile) {
+		std::vector<Point2i> res = MIPMapLevelResolutions(resolution);
+		size_t tileBytes = texelBytes * MIPMapTileSize * MIPMapTileSize;
+		std::vector<uint64_t> offsets = LevelOffsets(res, tileBytes);
+
+		std::vector<char> buffer(offsets.back());
+		TiledMIPMapHeader header;
+		memset(&header, 0, sizeof(header));
+		memcpy(header.magic, TiledMIPMapMagic, sizeof(TiledMIPMapMagic));
+		header.version = TiledMIPMapVersion;
+		header.texelBytes = (uint32_t)texelBytes;
+		header.tileSize = MIPMapTileSize;
+		header.width = resolution.x;
+		header.height = resolution.y;
+		memcpy(&buffer[0], &header, sizeof(header));
+
+		for (size_t level = 0; level < res.size(); ++level) {
+			Point2i nTiles = TileCount(res[level]);
+			char* tile = &buffer[offsets[level]];
+			for (int ty = 0; ty < nTiles.y; ++ty)
+				for (int tx = 0; tx < nTiles.x; ++tx, tile += tileBytes) getTile((int)level, Point2i(tx, ty), tile);
+		}
+		return WriteFileAtomic(filename, buffer.data(), buffer.size());
+	}
+
+	// TiledMIPMapFile Method Definitions
+	std::unique_ptr<TiledMIPMapFile> TiledMIPMapFile::Open(const std::string& filename, size_t texelBytes) {
+		std::unique_ptr<TiledMIPMapFile> tiled(new TiledMIPMapFile(texelBytes));
+		TiledMIPMapHeader header;
+		if (!tiled->file.Open(filename) || !tiled->file.Read(0, sizeof(header), &header)) return nullptr;
+		if (memcmp(header.magic, TiledMIPMapMagic, sizeof(TiledMIPMapMagic)) != 0 ||
+			header.version != TiledMIPMapVersion || header.tileSize != MIPMapTileSize ||
+			header.width <= 0 || header.height <= 0) {
+			LOG(WARNING) << "Ignoring corrupt tiled MIP map " << filename;
+			return nullptr;
+		}
+		if (header.texelBytes != texelBytes) {
+			LOG(WARNING) << "Tiled MIP map " << filename << " has " << header.texelBytes << "-byte texels, not " <<
+				texelBytes;
+			return nullptr;
+		}
+		tiled->resolution = MIPMapLevelResolutions(Point2i(header.width, header.height));
+		tiled->levelOffset = LevelOffsets(tiled->resolution, tiled->tileBytes);
+		if (tiled->file.Size() != tiled->levelOffset.back()) {
+			LOG(WARNING) << "Ignoring truncated tiled MIP map " << filename;
+			return nullptr;
+		}
+		return tiled;
+	}
+
+	bool TiledMIPMapFile::ReadTile(int level, const Point2i& tile, void* dst) const {
+		Point2i nTiles = TileCount(resolution[level]);
+		DCHECK(tile.x >= 0 && tile.x < nTiles.x && tile.y >= 0 && tile.y < nTiles.y);
+		uint64_t offset = levelOffset[level] + ((uint64_t)tile.y * nTiles.x + tile.x) * tileBytes;
+		return file.Read(offset, tileBytes, dst);
+	}
+
+}  // namespace pbr
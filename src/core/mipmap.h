@@ -0,0 +1,318 @@
+#ifndef CORE_MIPMAP_H
+#define CORE_MIPMAP_H
+
+#include "pbr.h"
+#include "geometry.h"
+#include "fileutil.h"
+#include "memory.h"
+#include "tilecache.h"
+#include <functional>
+
+namespace pbr {
+
+	// MIPMap Helper Declarations
+	enum class ImageWrap { Repeat, Black, Clamp };
+
+	// Trilinear filtering blurs a footprint to its longest axis; EWA filters
+	// the elliptical footprint itself, so textures seen at grazing angles
+	// stay sharp along their short axis
+	enum class MIPFilter { Trilinear, EWA };
+
+	// Gaussian weights of the EWA filter over the squared radius r2 in
+	// [0, 1] of its ellipse, precomputed at r2 = i / (Size - 1)
+	struct EWAWeightLUT {
+		static const int Size = 128;
+		EWAWeightLUT();
+		Float operator()(Float r2) const { return weights[std::min((int)(r2 * Size), Size - 1)]; }
+		Float weights[Size];
+	};
+	extern const EWAWeightLUT EWAWeights;
+
+	// Levels are stored as square tiles of MIPMapTileSize texels a side.
+	// Each tile is laid out as a BlockedArray of 4x4 texel blocks, so the
+	// four texels of a bilinear lookup usually share a cache line.
+	static const int LogMIPMapTileSize = 6;
+	static const int MIPMapTileSize = 1 << LogMIPMapTileSize;
+	static const int LogMIPMapBlockSize = 2;
+
+	// Index of texel (s, t) of a level within its tile
+	inline int MIPMapTileTexelIndex(int s, int t) {
+		return BlockedArray<char, LogMIPMapBlockSize>::Index(s & (MIPMapTileSize - 1), t & (MIPMapTileSize - 1),
+			MIPMapTileSize >> LogMIPMapBlockSize);
+	}
+
+	// Resolution of each level of a pyramid over an image of resolution
+	// res: each level halves the previous one, rounding up, down to 1x1
+	std::vector<Point2i> MIPMapLevelResolutions(const Point2i& res);
+
+	// A tiled pyramid on disk: a header, then each level's tiles in
+	// row-major order. Every tile holds MIPMapTileSize^2 texels in the order
+	// of MIPMapTileTexelIndex(), with edge tiles padded by repeating their
+	// last row and column.
+	class TiledMIPMapFile : public TileSource {
+	public:
+		// nullptr if the file is missing or corrupt, or its texels aren't
+		// texelBytes in size
+		static std::unique_ptr<TiledMIPMapFile> Open(const std::string& filename, size_t texelBytes);
+		bool ReadTile(int level, const Point2i& tile, void* dst) const;
+
+		int Levels() const { return (int)resolution.size(); }
+		const Point2i& LevelResolution(int level) const { return resolution[level]; }
+
+	private:
+		TiledMIPMapFile(size_t texelBytes) : TileSource(texelBytes * MIPMapTileSize * MIPMapTileSize) {}
+
+		RandomAccessFile file;
+		std::vector<Point2i> resolution;
+		std::vector<uint64_t> levelOffset;
+	};
+
+	// Writes a tiled pyramid over an image of the given resolution;
+	// getTile(level, tile, dst) fills in the texels of each tile
+	bool WriteTiledMIPMapFile(const std::string& filename, const Point2i& resolution, size_t texelBytes,
+		const std::function<void(int, const Point2i&, void*)>& getTile);
+
+	// Builds the pyramid of the row-major image by 2x2 box filtering, the
+	// last texel of an odd row or column standing in for its missing
+	// neighbour, and writes it as a tiled pyramid
+	template <typename T>
+	bool WriteTiledMIPMap(const std::string& filename, const Point2i& resolution, const T* image) {
+		std::vector<Point2i> res = MIPMapLevelResolutions(resolution);
+		std::vector<std::unique_ptr<BlockedArray<T>>> pyramid(res.size());
+		pyramid[0].reset(new BlockedArray<T>(resolution, image));
+		for (size_t i = 1; i < res.size(); ++i) {
+			const BlockedArray<T>& prev = *pyramid[i - 1];
+			pyramid[i].reset(new BlockedArray<T>(res[i]));
+			for (int t = 0; t < res[i].y; ++t) {
+				int t0 = std::min(2 * t, prev.vSize() - 1), t1 = std::min(2 * t + 1, prev.vSize() - 1);
+				for (int s = 0; s < res[i].x; ++s) {
+					int s0 = std::min(2 * s, prev.uSize() - 1), s1 = std::min(2 * s + 1, prev.uSize() - 1);
+					(*pyramid[i])(s, t) = Float(0.25) * (prev(s0, t0) + prev(s1, t0) + prev(s0, t1) + prev(s1, t1));
+				}
+			}
+		}
+		return WriteTiledMIPMapFile(filename, resolution, sizeof(T),
+			[&](int level, const Point2i& tile, void* dst) {
+			const BlockedArray<T>& texels = *pyramid[level];
+			for (int y = 0; y < MIPMapTileSize; ++y) {
+				int t = std::min(tile.y * MIPMapTileSize + y, texels.vSize() - 1);
+				for (int x = 0; x < MIPMapTileSize; ++x) {
+					int s = std::min(tile.x * MIPMapTileSize + x, texels.uSize() - 1);
+					((T*)dst)[MIPMapTileTexelIndex(x, y)] = texels(s, t);
+				}
+			}
+		});
+	}
+
+	// MIPMap Declarations
+
+	// Image pyramid paged in from a tiled file through a TileCache, so only
+	// the tiles that lookups touch are resident. T must be trivially
+	// copyable and support addition and scaling by Float.
+	template <typename T>
+	class MIPMap {
+	public:
+		// MIPMap Public Methods
+
+		// nullptr if filename doesn't hold a tiled pyramid of T. EWA
+		// footprints are made at most maxAnisotropy times longer than wide.
+		static std::unique_ptr<MIPMap> Open(const std::string& filename, TileCache* cache,
+			ImageWrap wrapMode = ImageWrap::Repeat, MIPFilter filter = MIPFilter::EWA, Float maxAnisotropy = 8.f) {
+			std::unique_ptr<TiledMIPMapFile> file = TiledMIPMapFile::Open(filename, sizeof(T));
+			if (!file) return nullptr;
+			return std::unique_ptr<MIPMap>(new MIPMap(std::move(file), cache, wrapMode, filter, maxAnisotropy));
+		}
+		int Width() const { return file->LevelResolution(0).x; }
+		int Height() const { return file->LevelResolution(0).y; }
+		int Levels() const { return file->Levels(); }
+		T Texel(int level, int s, int t) const;
+		// Bilinear interpolation of level at st in [0, 1]^2
+		T Bilerp(int level, const Point2f& st) const;
+		// Trilinear filtering of a square footprint width wide in st space
+		T Lookup(const Point2f& st, Float width = 0.f) const;
+		// Filtering of the footprint spanned by the st differentials dst0
+		// and dst1, such as (dudx, dvdx) and (dudy, dvdy) of a
+		// SurfaceInteraction, with the MIPMap's filter
+		T Lookup(const Point2f& st, Vector2f dst0, Vector2f dst1) const;
+		// The most texels that an EWA lookup of one level reads
+		int EWATexelBound() const { return ewaTexelBound; }
+
+	private:
+		// MIPMap Private Methods
+		MIPMap(std::unique_ptr<TiledMIPMapFile> file, TileCache* cache, ImageWrap wrapMode, MIPFilter filter,
+			Float maxAnisotropy)
+			: file(std::move(file)), cache(cache), wrapMode(wrapMode), filter(filter), maxAnisotropy(maxAnisotropy),
+			// After clamping, the ellipse's minor axis spans at most 2 texels
+			// of the finer level filtered, and its major axis maxAnisotropy
+			// times that, widened by a texel of blur on each side
+			ewaTexelBound((int)std::ceil((4 * maxAnisotropy + 4) * (4 * maxAnisotropy + 4))) {
+			CHECK_GE(maxAnisotropy, 1);
+		}
+		// Maps (s, t) into the level per the wrap mode; false if it's black
+		bool Wrap(int level, int* s, int* t) const;
+		T EWA(int level, const Point2f& st, const Vector2f& dst0, const Vector2f& dst1) const;
+
+		// MIPMap Private Data
+		std::unique_ptr<TiledMIPMapFile> file;
+		TileCache* cache;
+		const ImageWrap wrapMode;
+		const MIPFilter filter;
+		const Float maxAnisotropy;
+		const int ewaTexelBound;
+	};
+
+	// MIPMap Method Definitions
+	template <typename T>
+	bool MIPMap<T>::Wrap(int level, int* s, int* t) const {
+		const Point2i& res = file->LevelResolution(level);
+		// Compute texel (s, t) accounting for boundary conditions
+		switch (wrapMode) {
+		case ImageWrap::Repeat:
+			*s = Mod(*s, res.x);
+			*t = Mod(*t, res.y);
+			break;
+		case ImageWrap::Clamp:
+			*s = Clamp(*s, 0, res.x - 1);
+			*t = Clamp(*t, 0, res.y - 1);
+			break;
+		case ImageWrap::Black:
+			if (*s < 0 || *s >= res.x || *t < 0 || *t >= res.y) return false;
+			break;
+		}
+		return true;
+	}
+
+	template <typename T>
+	T MIPMap<T>::Texel(int level, int s, int t) const {
+		CHECK_LT(level, Levels());
+		if (!Wrap(level, &s, &t)) return T(0);
+		const T* tile = (const T*)cache->GetTile(*file, level,
+			Point2i(s >> LogMIPMapTileSize, t >> LogMIPMapTileSize));
+		return tile[MIPMapTileTexelIndex(s, t)];
+	}
+
+	template <typename T>
+	T MIPMap<T>::Bilerp(int level, const Point2f& st) const {
+		level = Clamp(level, 0, Levels() - 1);
+		const Point2i& res = file->LevelResolution(level);
+		Float s = st[0] * res.x - 0.5f, t = st[1] * res.y - 0.5f;
+		int s0 = (int)std::floor(s), t0 = (int)std::floor(t);
+		Float ds = s - s0, dt = t - t0;
+		// Fetch the tile once when all four texels lie in it
+		const int last = MIPMapTileSize - 1;
+		if (s0 >= 0 && t0 >= 0 && s0 + 1 < res.x && t0 + 1 < res.y && (s0 & last) != last && (t0 & last) != last) {
+			typedef BlockedArray<T, LogMIPMapBlockSize> TileLayout;
+			const T* tile = (const T*)cache->GetTile(*file, level,
+				Point2i(s0 >> LogMIPMapTileSize, t0 >> LogMIPMapTileSize));
+			int i00 = MIPMapTileTexelIndex(s0, t0);
+			int du = TileLayout::UStep(s0), dv = TileLayout::VStep(t0, MIPMapTileSize >> LogMIPMapBlockSize);
+			return (1 - ds) * (1 - dt) * tile[i00] + (1 - ds) * dt * tile[i00 + dv] +
+				ds * (1 - dt) * tile[i00 + du] + ds * dt * tile[i00 + du + dv];
+		}
+		return (1 - ds) * (1 - dt) * Texel(level, s0, t0) + (1 - ds) * dt * Texel(level, s0, t0 + 1) +
+			ds * (1 - dt) * Texel(level, s0 + 1, t0) + ds * dt * Texel(level, s0 + 1, t0 + 1);
+	}
+
+	template <typename T>
+	T MIPMap<T>::Lookup(const Point2f& st, Float width) const {
+		// Compute MIPMap level for trilinear filtering
+		Float level = Levels() - 1 + Log2(std::max(width, (Float)1e-8));
+
+		// Perform trilinear interpolation at appropriate MIPMap level
+		if (level < 0)
+			return Bilerp(0, st);
+		else if (level >= Levels() - 1)
+			return Texel(Levels() - 1, 0, 0);
+		int iLevel = (int)std::floor(level);
+		Float delta = level - iLevel;
+		return (1 - delta) * Bilerp(iLevel, st) + delta * Bilerp(iLevel + 1, st);
+	}
+
+	template <typename T>
+	T MIPMap<T>::Lookup(const Point2f& st, Vector2f dst0, Vector2f dst1) const {
+		if (filter == MIPFilter::Trilinear) {
+			Float width = 2 * std::max(std::max(std::abs(dst0[0]), std::abs(dst0[1])),
+				std::max(std::abs(dst1[0]), std::abs(dst1[1])));
+			return Lookup(st, width);
+		}
+		// Compute ellipse minor and major axes
+		if (dst0.LengthSquared() < dst1.LengthSquared()) std::swap(dst0, dst1);
+		Float majorLength = dst0.Length();
+		Float minorLength = dst1.Length();
+
+		// Clamp ellipse eccentricity if too large
+		if (minorLength * maxAnisotropy < majorLength && minorLength > 0) {
+			Float scale = majorLength / (minorLength * maxAnisotropy);
+			dst1 *= scale;
+			minorLength *= scale;
+		}
+		if (minorLength == 0) return Bilerp(0, st);
+
+		// Choose level of detail for EWA lookup and perform EWA filtering
+		Float lod = std::max((Float)0, Levels() - 1 + Log2(minorLength));
+		int ilod = (int)std::floor(lod);
+		Float delta = lod - ilod;
+		return (1 - delta) * EWA(ilod, st, dst0, dst1) + delta * EWA(ilod + 1, st, dst0, dst1);
+	}
+
+	template <typename T>
+	T MIPMap<T>::EWA(int level, const Point2f& st, const Vector2f& dst0, const Vector2f& dst1) const {
+		if (level >= Levels()) return Texel(Levels() - 1, 0, 0);
+		// Convert EWA coordinates to appropriate scale for level
+		const Point2i& res = file->LevelResolution(level);
+		Float s = st[0] * res.x - 0.5f, t = st[1] * res.y - 0.5f;
+		Vector2f d0(dst0[0] * res.x, dst0[1] * res.y), d1(dst1[0] * res.x, dst1[1] * res.y);
+
+		// Compute ellipse coefficients to bound EWA filter region
+		Float A = d0[1] * d0[1] + d1[1] * d1[1] + 1;
+		Float B = -2 * (d0[0] * d0[1] + d1[0] * d1[1]);
+		Float C = d0[0] * d0[0] + d1[0] * d1[0] + 1;
+		Float invF = 1 / (A * C - B * B * 0.25f);
+		A *= invF;
+		B *= invF;
+		C *= invF;
+
+		// Compute the ellipse's (s, t) bounding box in texture space
+		Float det = -B * B + 4 * A * C;
+		Float invDet = 1 / det;
+		Float uSqrt = std::sqrt(det * C), vSqrt = std::sqrt(A * det);
+		int s0 = (int)std::ceil(s - 2 * invDet * uSqrt);
+		int s1 = (int)std::floor(s + 2 * invDet * uSqrt);
+		int t0 = (int)std::ceil(t - 2 * invDet * vSqrt);
+		int t1 = (int)std::floor(t + 2 * invDet * vSqrt);
+		// Footprints the clamp can't bound, such as those wider than the
+		// image, are filtered at the next coarser level instead
+		if ((int64_t)(s1 - s0 + 1) * (int64_t)(t1 - t0 + 1) > ewaTexelBound) return EWA(level + 1, st, dst0, dst1);
+
+		// Scan over ellipse bound and compute quadratic equation, fetching
+		// each tile the ellipse overlaps once per run of its texels
+		T sum(0);
+		Float sumWts = 0;
+		const T* tile = nullptr;
+		Point2i tileIndex(-1, -1);
+		for (int it = t0; it <= t1; ++it) {
+			Float tt = it - t;
+			for (int is = s0; is <= s1; ++is) {
+				Float ss = is - s;
+				// Compute squared radius and filter texel if inside ellipse
+				Float r2 = A * ss * ss + B * ss * tt + C * tt * tt;
+				if (r2 < 1) {
+					Float weight = EWAWeights(r2);
+					sumWts += weight;
+					int ws = is, wt = it;
+					if (!Wrap(level, &ws, &wt)) continue;
+					Point2i ti(ws >> LogMIPMapTileSize, wt >> LogMIPMapTileSize);
+					if (ti != tileIndex) {
+						tile = (const T*)cache->GetTile(*file, level, ti);
+						tileIndex = ti;
+					}
+					sum += weight * tile[MIPMapTileTexelIndex(ws, wt)];
+				}
+			}
+		}
+		return (1 / sumWts) * sum;
+	}
+
+}  // namespace pbr
+
+#endif  // CORE_MIPMAP_H
@@ -0,0 +1,121 @@
+#include "parallel.h"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace pbr {
+
+	// Parallel Local Definitions
+	// A ParallelFor() call in progress; guarded by the pool's mutex except
+	// for func
+	struct ParallelForLoop {
+		ParallelForLoop(const std::function<void(int64_t)>& func, int64_t count, int chunkSize)
+			: func(func), count(count), chunkSize(chunkSize) {}
+		bool Finished() const { return nextIndex >= count && activeWorkers == 0; }
+
+		const std::function<void(int64_t)>& func;
+		const int64_t count;
+		const int chunkSize;
+		int64_t nextIndex = 0;
+		int activeWorkers = 0;
+		ParallelForLoop* next = nullptr;
+	};
+
+	// MaxThreadCount() - 1 threads, started by the first parallel loop, that
+	// run chunks of the loops on workList alongside the threads that called
+	// ParallelFor(). A loop body that calls ParallelFor() adds its loop to
+	// the list and works on it too, so nesting never starts more threads.
+	// Raising PbrOptions.nThreads starts more; after lowering it, the
+	// surplus threads sit idle.
+	class ThreadPool {
+	public:
+		~ThreadPool() {
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				shutdown = true;
+			}
+			workAvailable.notify_all();
+			for (std::thread& t : threads) t.join();
+		}
+		void Run(ParallelForLoop& loop) {
+			std::unique_lock<std::mutex> lock(mutex);
+			while ((int)threads.size() < MaxThreadCount() - 1) {
+				int index = (int)threads.size();
+				threads.push_back(std::thread([this, index]() { workerLoop(index); }));
+			}
+			loop.next = workList;
+			workList = &loop;
+			workAvailable.notify_all();
+			// Help with the loop until it's done, then wait for the chunks
+			// other threads still run
+			while (!loop.Finished()) {
+				if (loop.nextIndex < loop.count)
+					runChunk(loop, lock);
+				else
+					loopFinished.wait(lock);
+			}
+		}
+
+	private:
+		void workerLoop(int index) {
+			std::unique_lock<std::mutex> lock(mutex);
+			while (!shutdown) {
+				if (workList && index < MaxThreadCount() - 1)
+					runChunk(*workList, lock);
+				else
+					workAvailable.wait(lock);
+			}
+		}
+		// Claims loop's next chunk and runs it with the mutex released;
+		// the loop leaves workList once its last chunk is claimed
+		void runChunk(ParallelForLoop& loop, std::unique_lock<std::mutex>& lock) {
+			int64_t start = loop.nextIndex, end = std::min(start + loop.chunkSize, loop.count);
+			loop.nextIndex = end;
+			if (end == loop.count) {
+				ParallelForLoop** p = &workList;
+				while (*p != &loop) p = &(*p)->next;
+				*p = loop.next;
+			}
+			++loop.activeWorkers;
+			lock.unlock();
+			for (int64_t i = start; i < end; ++i) loop.func(i);
+			lock.lock();
+			if (--loop.activeWorkers == 0 && loop.nextIndex == loop.count) loopFinished.notify_all();
+		}
+
+		std::vector<std::thread> threads;
+		std::mutex mutex;
+		std::condition_variable workAvailable, loopFinished;
+		ParallelForLoop* workList = nullptr;
+		bool shutdown = false;
+	};
+
+	static ThreadPool threadPool;
+
+	// Parallel Method Definitions
+	int NumSystemCores() {
+		return std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	int MaxThreadCount() {
+		return PbrOptions.nThreads > 0 ? PbrOptions.nThreads : NumSystemCores();
+	}
+
+	void ParallelFor(const std::function<void(int64_t)>& func, int64_t count, int chunkSize) {
+		CHECK_GT(chunkSize, 0);
+		// Run single-chunk loops serially; waking workers would dominate
+		if (count <= chunkSize || MaxThreadCount() == 1) {
+			for (int64_t i = 0; i < count; ++i) func(i);
+			return;
+		}
+		ParallelForLoop loop(func, count, chunkSize);
+		threadPool.Run(loop);
+	}
+
+	void ParallelFor2D(const std::function<void(Point2i)>& func, const Point2i& count) {
+		ParallelFor([&](int64_t i) { func(Point2i(int(i % count.x), int(i / count.x))); },
+			(int64_t)count.x * count.y);
+	}
+
+}  // namespace pbr
@@ -0,0 +1,54 @@
+#ifndef CORE_PARALLEL_H
+#define CORE_PARALLEL_H
+
+#include "pbr.h"
+#include "geometry.h"
+#include <atomic>
+#include <functional>
+
+namespace pbr {
+
+	// Float supporting lock-free atomic accumulation through a
+	// compare-and-swap loop on its bit pattern
+	class AtomicFloat {
+	public:
+		explicit AtomicFloat(Float v = 0) { bits = FloatToBits(v); }
+		operator Float() const { return BitsToFloat(bits); }
+		Float operator=(Float v) {
+			bits = FloatToBits(v);
+			return v;
+		}
+		void Add(Float v) {
+#ifdef PBR_FLOAT_AS_DOUBLE
+			uint64_t oldBits = bits, newBits;
+#else
+			uint32_t oldBits = bits, newBits;
+#endif
+			do {
+				newBits = FloatToBits(BitsToFloat(oldBits) + v);
+			} while (!bits.compare_exchange_weak(oldBits, newBits));
+		}
+
+	private:
+#ifdef PBR_FLOAT_AS_DOUBLE
+		std::atomic<uint64_t> bits;
+#else
+		std::atomic<uint32_t> bits;
+#endif
+	};
+
+	int NumSystemCores();
+	// Threads that ParallelFor() uses: PbrOptions.nThreads, or one per core
+	int MaxThreadCount();
+
+	// Calls func(i) for i in [0, count) from up to MaxThreadCount() threads,
+	// handing out chunkSize consecutive indices at a time. Returns once all
+	// calls have finished. The threads are kept for later loops, and loops
+	// nested in func share them.
+	void ParallelFor(const std::function<void(int64_t)>& func, int64_t count, int chunkSize = 1);
+	// Calls func(p) for every p in [0, count.x) x [0, count.y)
+	void ParallelFor2D(const std::function<void(Point2i)>& func, const Point2i& count);
+
+}  // namespace pbr
+
+#endif  // CORE_PARALLEL_H
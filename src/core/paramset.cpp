@@ -0,0 +1,131 @@
+#include "paramset.h"
+
+namespace pbr {
+
+	template <typename T>
+	static void AddParam(std::vector<std::shared_ptr<ParamSetItem<T>>>& items, const std::string& name,
+		std::unique_ptr<T[]> values, int nValues) {
+		// Later definitions replace earlier ones with the same name
+		for (auto& item : items) {
+			if (item->name == name) {
+				item = std::make_shared<ParamSetItem<T>>(name, std::move(values), nValues);
+				return;
+			}
+		}
+		items.push_back(std::make_shared<ParamSetItem<T>>(name, std::move(values), nValues));
+	}
+
+	template <typename T>
+	static const T* FindParam(const std::vector<std::shared_ptr<ParamSetItem<T>>>& items,
+		const std::string& name, int* nValues) {
+		for (const auto& item : items) {
+			if (item->name == name) {
+				*nValues = item->nValues;
+				item->lookedUp = true;
+				return item->values.get();
+			}
+		}
+		*nValues = 0;
+		return nullptr;
+	}
+
+	template <typename T>
+	static T FindOneParam(const std::vector<std::shared_ptr<ParamSetItem<T>>>& items,
+		const std::string& name, const T& d) {
+		for (const auto& item : items) {
+			if (item->name == name && item->nValues == 1) {
+				item->lookedUp = true;
+				return item->values[0];
+			}
+		}
+		return d;
+	}
+
+	template <typename T>
+	static void ReportUnusedParams(const std::vector<std::shared_ptr<ParamSetItem<T>>>& items) {
+		for (const auto& item : items)
+			if (!item->lookedUp)
+				LOG(WARNING) << "Parameter \"" << item->name << "\" not used";
+	}
+
+	// ParamSet Methods
+	void ParamSet::AddFloat(const std::string& name, std::unique_ptr<Float[]> values, int nValues) {
+		AddParam(floats, name, std::move(values), nValues);
+	}
+	void ParamSet::AddInt(const std::string& name, std::unique_ptr<int[]> values, int nValues) {
+		AddParam(ints, name, std::move(values), nValues);
+	}
+	void ParamSet::AddBool(const std::string& name, std::unique_ptr<bool[]> values, int nValues) {
+		AddParam(bools, name, std::move(values), nValues);
+	}
+	void ParamSet::AddString(const std::string& name, std::unique_ptr<std::string[]> values, int nValues) {
+		AddParam(strings, name, std::move(values), nValues);
+	}
+	void ParamSet::AddPoint2f(const std::string& name, std::unique_ptr<Point2f[]> values, int nValues) {
+		AddParam(point2fs, name, std::move(values), nValues);
+	}
+	void ParamSet::AddPoint3f(const std::string& name, std::unique_ptr<Point3f[]> values, int nValues) {
+		AddParam(point3fs, name, std::move(values), nValues);
+	}
+	void ParamSet::AddVector3f(const std::string& name, std::unique_ptr<Vector3f[]> values, int nValues) {
+		AddParam(vector3fs, name, std::move(values), nValues);
+	}
+	void ParamSet::AddNormal3f(const std::string& name, std::unique_ptr<Normal3f[]> values, int nValues) {
+		AddParam(normals, name, std::move(values), nValues);
+	}
+	void ParamSet::AddRGBSpectrum(const std::string& name, std::unique_ptr<RGBSpectrum[]> values, int nValues) {
+		AddParam(spectra, name, std::move(values), nValues);
+	}
+	void ParamSet::AddTexture(const std::string& name, const std::string& value) {
+		std::unique_ptr<std::string[]> values(new std::string[1]);
+		values[0] = value;
+		AddParam(textures, name, std::move(values), 1);
+	}
+
+	Float ParamSet::FindOneFloat(const std::string& name, Float d) const { return FindOneParam(floats, name, d); }
+	int ParamSet::FindOneInt(const std::string& name, int d) const { return FindOneParam(ints, name, d); }
+	bool ParamSet::FindOneBool(const std::string& name, bool d) const { return FindOneParam(bools, name, d); }
+	std::string ParamSet::FindOneString(const std::string& name, const std::string& d) const {
+		return FindOneParam(strings, name, d);
+	}
+	Point3f ParamSet::FindOnePoint3f(const std::string& name, const Point3f& d) const {
+		return FindOneParam(point3fs, name, d);
+	}
+	Vector3f ParamSet::FindOneVector3f(const std::string& name, const Vector3f& d) const {
+		return FindOneParam(vector3fs, name, d);
+	}
+	RGBSpectrum ParamSet::FindOneRGBSpectrum(const std::string& name, const RGBSpectrum& d) const {
+		return FindOneParam(spectra, name, d);
+	}
+	std::string ParamSet::FindTexture(const std::string& name) const { return FindOneParam(textures, name, std::string()); }
+
+	const Float* ParamSet::FindFloat(const std::string& name, int* n) const { return FindParam(floats, name, n); }
+	const int* ParamSet::FindInt(const std::string& name, int* n) const { return FindParam(ints, name, n); }
+	const bool* ParamSet::FindBool(const std::string& name, int* n) const { return FindParam(bools, name, n); }
+	const std::string* ParamSet::FindString(const std::string& name, int* n) const {
+		return FindParam(strings, name, n);
+	}
+	const Point2f* ParamSet::FindPoint2f(const std::string& name, int* n) const { return FindParam(point2fs, name, n); }
+	const Point3f* ParamSet::FindPoint3f(const std::string& name, int* n) const { return FindParam(point3fs, name, n); }
+	const Vector3f* ParamSet::FindVector3f(const std::string& name, int* n) const {
+		return FindParam(vector3fs, name, n);
+	}
+	const Normal3f* ParamSet::FindNormal3f(const std::string& name, int* n) const { return FindParam(normals, name, n); }
+	const RGBSpectrum* ParamSet::FindRGBSpectrum(const std::string& name, int* n) const {
+		return FindParam(spectra, name, n);
+	}
+
+	void ParamSet::ReportUnused() const {
+		ReportUnusedParams(floats);
+		ReportUnusedParams(ints);
+		ReportUnusedParams(bools);
+		ReportUnusedParams(strings);
+		ReportUnusedParams(point2fs);
+		ReportUnusedParams(point3fs);
+		ReportUnusedParams(vector3fs);
+		ReportUnusedParams(normals);
+		ReportUnusedParams(spectra);
+		ReportUnusedParams(textures);
+	}
+
+}  // namespace pbr
@@ -0,0 +1,76 @@
+#ifndef CORE_PARAMSET_H
+#define CORE_PARAMSET_H
+
+#include "pbr.h"
+#include "geometry.h"
+#include "spectrum.h"
+
+namespace pbr {
+
+	// ParamSetItem Declarations
+	template <typename T> struct ParamSetItem {
+		ParamSetItem(const std::string& name, std::unique_ptr<T[]> v, int nValues = 1)
+			: name(name), values(std::move(v)), nValues(nValues) {}
+
+		const std::string name;
+		const std::unique_ptr<T[]> values;
+		const int nValues;
+		mutable bool lookedUp = false;
+	};
+
+	// Named, typed parameter lists attached to scene description statements
+	class ParamSet {
+	public:
+		void AddFloat(const std::string& name, std::unique_ptr<Float[]> values, int nValues = 1);
+		void AddInt(const std::string& name, std::unique_ptr<int[]> values, int nValues = 1);
+		void AddBool(const std::string& name, std::unique_ptr<bool[]> values, int nValues = 1);
+		void AddString(const std::string& name, std::unique_ptr<std::string[]> values, int nValues = 1);
+		void AddPoint2f(const std::string& name, std::unique_ptr<Point2f[]> values, int nValues = 1);
+		void AddPoint3f(const std::string& name, std::unique_ptr<Point3f[]> values, int nValues = 1);
+		void AddVector3f(const std::string& name, std::unique_ptr<Vector3f[]> values, int nValues = 1);
+		void AddNormal3f(const std::string& name, std::unique_ptr<Normal3f[]> values, int nValues = 1);
+		void AddRGBSpectrum(const std::string& name, std::unique_ptr<RGBSpectrum[]> values, int nValues = 1);
+		// Binds name to the texture named value
+		void AddTexture(const std::string& name, const std::string& value);
+
+		Float FindOneFloat(const std::string& name, Float d) const;
+		int FindOneInt(const std::string& name, int d) const;
+		bool FindOneBool(const std::string& name, bool d) const;
+		std::string FindOneString(const std::string& name, const std::string& d) const;
+		Point3f FindOnePoint3f(const std::string& name, const Point3f& d) const;
+		Vector3f FindOneVector3f(const std::string& name, const Vector3f& d) const;
+		RGBSpectrum FindOneRGBSpectrum(const std::string& name, const RGBSpectrum& d) const;
+		// The name of the texture bound to name, or "" if none is
+		std::string FindTexture(const std::string& name) const;
+
+		const Float* FindFloat(const std::string& name, int* nValues) const;
+		const int* FindInt(const std::string& name, int* nValues) const;
+		const bool* FindBool(const std::string& name, int* nValues) const;
+		const std::string* FindString(const std::string& name, int* nValues) const;
+		const Point2f* FindPoint2f(const std::string& name, int* nValues) const;
+		const Point3f* FindPoint3f(const std::string& name, int* nValues) const;
+		const Vector3f* FindVector3f(const std::string& name, int* nValues) const;
+		const Normal3f* FindNormal3f(const std::string& name, int* nValues) const;
+		const RGBSpectrum* FindRGBSpectrum(const std::string& name, int* nValues) const;
+
+		// Warns about parameters that were supplied but never looked up
+		void ReportUnused() const;
+
+	private:
+		friend class BinarySceneWriter;
+
+		std::vector<std::shared_ptr<ParamSetItem<Float>>> floats;
+		std::vector<std::shared_ptr<ParamSetItem<int>>> ints;
+		std::vector<std::shared_ptr<ParamSetItem<bool>>> bools;
+		std::vector<std::shared_ptr<ParamSetItem<std::string>>> strings;
+		std::vector<std::shared_ptr<ParamSetItem<Point2f>>> point2fs;
+		std::vector<std::shared_ptr<ParamSetItem<Point3f>>> point3fs;
+		std::vector<std::shared_ptr<ParamSetItem<Vector3f>>> vector3fs;
+		std::vector<std::shared_ptr<ParamSetItem<Normal3f>>> normals;
+		std::vector<std::shared_ptr<ParamSetItem<RGBSpectrum>>> spectra;
+		std::vector<std::shared_ptr<ParamSetItem<std::string>>> textures;
+	};
+
+}  // namespace pbr
+
+#endif  // CORE_PARAMSET_H
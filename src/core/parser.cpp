@@ -0,0 +1,568 @@
+#include "parser.h"
+#include "fileutil.h"
+#include "parallel.h"
+#include "stringutil.h"
+#include <atomic>
+#include <climits>
+#include <mutex>
+#include <set>
+
+namespace pbr {
+
+	// Parser Local Definitions
+	enum class Directive {
+		Identity, Translate, Rotate, Scale, LookAt, ConcatTransform, Transform, CoordinateSystem,
+		CoordSysTransform, ReverseOrientation, PixelFilter, Film, Sampler, Accelerator, Camera, WorldBegin,
+		AttributeBegin, AttributeEnd, TransformBegin, TransformEnd, Material, MakeNamedMaterial, NamedMaterial,
+		Shape, ObjectBegin, ObjectEnd, ObjectInstance, WorldEnd, Include
+	};
+
+	// What follows a directive's keyword: nNumbers bare numbers, a bracketed
+	// 4x4 matrix, a quoted name and a parameter list, in that order
+	struct DirectiveSyntax {
+		const char* keyword;
+		Directive directive;
+		int nNumbers;
+		bool matrix, named, params;
+	};
+
+	static const DirectiveSyntax directiveSyntax[] = {
+		{ "Shape", Directive::Shape, 0, false, true, true },
+		{ "AttributeBegin", Directive::AttributeBegin, 0, false, false, false },
+		{ "AttributeEnd", Directive::AttributeEnd, 0, false, false, false },
+		{ "Translate", Directive::Translate, 3, false, false, false },
+		{ "Transform", Directive::Transform, 0, true, false, false },
+		{ "ConcatTransform", Directive::ConcatTransform, 0, true, false, false },
+		{ "ObjectInstance", Directive::ObjectInstance, 0, false, true, false },
+		{ "Rotate", Directive::Rotate, 4, false, false, false },
+		{ "Scale", Directive::Scale, 3, false, false, false },
+		{ "TransformBegin", Directive::TransformBegin, 0, false, false, false },
+		{ "TransformEnd", Directive::TransformEnd, 0, false, false, false },
+		{ "Identity", Directive::Identity, 0, false, false, false },
+		{ "LookAt", Directive::LookAt, 9, false, false, false },
+		{ "CoordinateSystem", Directive::CoordinateSystem, 0, false, true, false },
+		{ "CoordSysTransform", Directive::CoordSysTransform, 0, false, true, false },
+		{ "ReverseOrientation", Directive::ReverseOrientation, 0, false, false, false },
+		{ "Material", Directive::Material, 0, false, true, true },
+		{ "NamedMaterial", Directive::NamedMaterial, 0, false, true, false },
+		{ "MakeNamedMaterial", Directive::MakeNamedMaterial, 0, false, true, true },
+		{ "ObjectBegin", Directive::ObjectBegin, 0, false, true, false },
+		{ "ObjectEnd", Directive::ObjectEnd, 0, false, false, false },
+		{ "Include", Directive::Include, 0, false, true, false },
+		{ "PixelFilter", Directive::PixelFilter, 0, false, true, true },
+		{ "Film", Directive::Film, 0, false, true, true },
+		{ "Sampler", Directive::Sampler, 0, false, true, true },
+		{ "Accelerator", Directive::Accelerator, 0, false, true, true },
+		{ "Camera", Directive::Camera, 0, false, true, true },
+		{ "WorldBegin", Directive::WorldBegin, 0, false, false, false },
+		{ "WorldEnd", Directive::WorldEnd, 0, false, false, false },
+	};
+
+	// pbrt-v3 directives for which the renderer has nothing yet
+	static const char* unsupportedDirectives[] = { "ActiveTransform", "AreaLightSource", "LightSource",
+		"MakeNamedMedium", "MediumInterface", "Texture", "TransformTimes" };
+
+	struct SceneStatement {
+		Directive directive;
+		std::string name;
+		Float numbers[16];
+		ParamSet params;
+		// Index of an Include's file in SceneFile::includes
+		int include = -1;
+	};
+
+	// A file's statements, with those of its Includes kept apart so that
+	// they can be parsed concurrently
+	struct SceneFile {
+		std::string filename, directory;
+		std::vector<SceneStatement> statements;
+		std::vector<std::unique_ptr<SceneFile>> includes;
+	};
+
+	static const int MaxIncludeDepth = 32;
+	// Numeric arrays are counted and parsed in chunks of about this size
+	static const size_t NumberChunkBytes = 1 << 20;
+
+	static void WarnUnsupported(const std::string& what) {
+		// Large scenes repeat these, so each is reported once
+		static std::mutex mutex;
+		static std::set<std::string> reported;
+		std::lock_guard<std::mutex> lock(mutex);
+		if (reported.insert(what).second) LOG(WARNING) << what << " not supported yet; ignoring it";
+	}
+
+	static const char* ParseNumber(const char* p, const char* end, Float* v) { return ParseFloat(p, end, v); }
+
+	static const char* ParseNumber(const char* p, const char* end, int* v) {
+		int64_t i;
+		p = ParseInt(p, end, &i);
+		if (!p || i < INT_MIN || i > INT_MAX) return nullptr;
+		*v = (int)i;
+		return p;
+	}
+
+	static int64_t CountNumbers(const char* p, const char* end) {
+		int64_t n = 0;
+		bool inNumber = false;
+		for (; p < end; ++p) {
+			bool space = IsSpace(*p);
+			n += !space && !inNumber;
+			inNumber = !space;
+		}
+		return n;
+	}
+
+	// Parses the whitespace-separated numbers of [p, end) into out; false if
+	// any isn't a well-formed T
+	template <typename T> static bool ParseNumbers(const char* p, const char* end, T* out) {
+		for (;;) {
+			while (p < end && IsSpace(*p)) ++p;
+			if (p == end) return true;
+			p = ParseNumber(p, end, out++);
+			if (!p || (p < end && !IsSpace(*p))) return false;
+		}
+	}
+
+	// Whitespace-separated numbers split into chunks that can be counted and
+	// parsed independently
+	class NumberList {
+	public:
+		NumberList(const char* begin, const char* end) {
+			bounds.push_back(begin);
+			while ((size_t)(end - bounds.back()) > NumberChunkBytes) {
+				const char* p = bounds.back() + NumberChunkBytes;
+				while (p < end && !IsSpace(*p)) ++p;
+				bounds.push_back(p);
+			}
+			bounds.push_back(end);
+			int nChunks = (int)bounds.size() - 1;
+			offsets.resize(nChunks + 1, 0);
+			ParallelFor([&](int64_t i) { offsets[i + 1] = CountNumbers(bounds[i], bounds[i + 1]); }, nChunks);
+			for (int i = 0; i < nChunks; ++i) offsets[i + 1] += offsets[i];
+		}
+		int64_t Count() const { return offsets.back(); }
+		template <typename T> bool Parse(T* out) const {
+			std::atomic<bool> ok(true);
+			ParallelFor([&](int64_t i) {
+				if (!ParseNumbers(bounds[i], bounds[i + 1], out + offsets[i])) ok = false;
+			}, (int64_t)bounds.size() - 1);
+			return ok;
+		}
+
+	private:
+		std::vector<const char*> bounds;
+		std::vector<int64_t> offsets;
+	};
+
+	// Parsing of one file's statements
+	class SceneFileParser {
+	public:
+		SceneFileParser(Tokenizer& t, SceneFile* file) : t(t), file(file) {}
+		bool Parse();
+
+	private:
+		bool Error(const Token& tok, const std::string& message) {
+			LOG(ERROR) << t.Location(tok) << ": " << message;
+			return false;
+		}
+		bool ParseParams(SceneStatement* statement);
+		bool FindNumbers(const Token& tok, const char** begin, const char** end);
+		template <typename T, typename V>
+		bool ReadNumbers(const Token& tok, const Token& decl, int nComponents, std::unique_ptr<V[]>* values,
+			int* nValues);
+		bool ReadTokens(const Token& tok, std::vector<Token>* tokens);
+		void SkipArguments();
+
+		Tokenizer& t;
+		SceneFile* file;
+		// Bracketed numbers that contain comments, with those removed
+		std::string uncommented;
+	};
+
+	bool SceneFileParser::Parse() {
+		for (Token tok = t.Next(); tok.size > 0; tok = t.Next()) {
+			const DirectiveSyntax* syntax = nullptr;
+			for (const DirectiveSyntax& s : directiveSyntax)
+				if (tok == s.keyword) {
+					syntax = &s;
+					break;
+				}
+			if (!syntax) {
+				bool known = false;
+				for (const char* d : unsupportedDirectives) known |= tok == d;
+				if (!known) return Error(tok, "unknown directive \"" + std::string(tok.data, tok.size) + "\"");
+				WarnUnsupported("\"" + std::string(tok.data, tok.size) + "\"");
+				// ActiveTransform's argument is a bare word
+				if (tok == "ActiveTransform") t.Next();
+				SkipArguments();
+				continue;
+			}
+
+			SceneStatement statement;
+			statement.directive = syntax->directive;
+			for (int i = 0; i < syntax->nNumbers; ++i) {
+				Token n = t.Next();
+				const char* end = n.data + n.size;
+				if (n.size == 0 || ParseFloat(n.data, end, &statement.numbers[i]) != end)
+					return Error(n.size ? n : tok, "expected a number after " + std::string(tok.data, tok.size));
+			}
+			if (syntax->matrix) {
+				Token open = t.Next();
+				const char* begin, *end;
+				if (open != "[") return Error(open.size ? open : tok, "expected a bracketed 4x4 matrix");
+				if (!FindNumbers(open, &begin, &end)) return false;
+				NumberList numbers(begin, end);
+				if (numbers.Count() != 16 || !numbers.Parse(statement.numbers))
+					return Error(tok, "expected 16 numbers in the matrix");
+			}
+			if (syntax->named) {
+				Token name = t.Next();
+				if (!name.IsQuoted()) return Error(name.size ? name : tok, "expected a quoted name");
+				statement.name = name.ToString();
+			}
+			if (syntax->params && !ParseParams(&statement)) return false;
+			if (statement.directive == Directive::Include) {
+				std::unique_ptr<SceneFile> include(new SceneFile);
+				include->filename = IsAbsolutePath(statement.name) ? statement.name :
+					JoinPath(file->directory, statement.name);
+				include->directory = DirectoryContaining(include->filename);
+				statement.include = (int)file->includes.size();
+				file->includes.push_back(std::move(include));
+			}
+			file->statements.push_back(std::move(statement));
+		}
+		return !t.Failed();
+	}
+
+	bool SceneFileParser::ParseParams(SceneStatement* statement) {
+		for (;;) {
+			Token decl = t.Next();
+			if (!decl.IsQuoted()) {
+				// The next directive, or the end
+				if (decl.size > 0) t.Unget(decl);
+				return !t.Failed();
+			}
+
+			// "type name"
+			Token d = decl.Dequoted();
+			const char* p = d.data, *end = d.data + d.size;
+			while (p < end && IsSpace(*p)) ++p;
+			const char* typeBegin = p;
+			while (p < end && !IsSpace(*p)) ++p;
+			std::string type(typeBegin, p);
+			while (p < end && IsSpace(*p)) ++p;
+			const char* nameBegin = p;
+			while (p < end && !IsSpace(*p)) ++p;
+			std::string name(nameBegin, p);
+			while (p < end && IsSpace(*p)) ++p;
+			if (type.empty() || name.empty() || p != end)
+				return Error(decl, "expected a parameter declaration \"type name\"");
+
+			Token value = t.Next();
+			if (value.size == 0) return Error(decl, "missing value for parameter \"" + name + "\"");
+			ParamSet& params = statement->params;
+			int n;
+			bool ok = true;
+			if (type == "float") {
+				std::unique_ptr<Float[]> values;
+				if ((ok = ReadNumbers<Float>(value, decl, 1, &values, &n))) params.AddFloat(name, std::move(values), n);
+			} else if (type == "integer") {
+				std::unique_ptr<int[]> values;
+				if ((ok = ReadNumbers<int>(value, decl, 1, &values, &n))) params.AddInt(name, std::move(values), n);
+			} else if (type == "point2") {
+				std::unique_ptr<Point2f[]> values;
+				if ((ok = ReadNumbers<Float>(value, decl, 2, &values, &n)))
+					params.AddPoint2f(name, std::move(values), n);
+			} else if (type == "point" || type == "point3") {
+				std::unique_ptr<Point3f[]> values;
+				if ((ok = ReadNumbers<Float>(value, decl, 3, &values, &n)))
+					params.AddPoint3f(name, std::move(values), n);
+			} else if (type == "vector" || type == "vector3") {
+				std::unique_ptr<Vector3f[]> values;
+				if ((ok = ReadNumbers<Float>(value, decl, 3, &values, &n)))
+					params.AddVector3f(name, std::move(values), n);
+			} else if (type == "normal" || type == "normal3") {
+				std::unique_ptr<Normal3f[]> values;
+				if ((ok = ReadNumbers<Float>(value, decl, 3, &values, &n)))
+					params.AddNormal3f(name, std::move(values), n);
+			} else if (type == "rgb" || type == "color") {
+				std::unique_ptr<Float[]> rgb;
+				if ((ok = ReadNumbers<Float>(value, decl, 1, &rgb, &n) && (n % 3 == 0 ||
+					Error(decl, "expected a multiple of 3 numbers for parameter \"" + name + "\"")))) {
+					std::unique_ptr<RGBSpectrum[]> values(new RGBSpectrum[n / 3]);
+					for (int i = 0; i < n / 3; ++i) values[i] = RGBSpectrum::FromRGB(&rgb[3 * i]);
+					params.AddRGBSpectrum(name, std::move(values), n / 3);
+				}
+			} else if (type == "bool" || type == "string" || type == "texture") {
+				std::vector<Token> tokens;
+				if (!ReadTokens(value, &tokens)) return false;
+				n = (int)tokens.size();
+				if (type == "bool") {
+					std::unique_ptr<bool[]> values(new bool[n]);
+					for (int i = 0; i < n; ++i) {
+						Token b = tokens[i].Dequoted();
+						if (b != "true" && b != "false")
+							return Error(tokens[i], "expected \"true\" or \"false\" for parameter \"" + name + "\"");
+						values[i] = b == "true";
+					}
+					params.AddBool(name, std::move(values), n);
+				} else if (type == "texture") {
+					if (n != 1 || !tokens[0].IsQuoted())
+						return Error(decl, "expected one quoted texture name for parameter \"" + name + "\"");
+					params.AddTexture(name, tokens[0].ToString());
+				} else {
+					std::unique_ptr<std::string[]> values(new std::string[n]);
+					for (int i = 0; i < n; ++i) {
+						if (!tokens[i].IsQuoted())
+							return Error(tokens[i], "expected a quoted string for parameter \"" + name + "\"");
+						values[i] = tokens[i].ToString();
+						if (statement->directive == Directive::Shape && name == "filename" &&
+							!IsAbsolutePath(values[i]))
+							values[i] = JoinPath(file->directory, values[i]);
+					}
+					params.AddString(name, std::move(values), n);
+				}
+			} else {
+				std::vector<Token> tokens;
+				if (!ReadTokens(value, &tokens)) return false;
+				WarnUnsupported("Parameter type \"" + type + "\"");
+			}
+			if (!ok) return false;
+		}
+	}
+
+	// Finds the numbers of a value that starts with tok: a lone number, or
+	// "[" and the numbers up to the matching "]", after which parsing
+	// resumes
+	bool SceneFileParser::FindNumbers(const Token& tok, const char** begin, const char** end) {
+		if (tok != "[") {
+			*begin = tok.data;
+			*end = tok.data + tok.size;
+			return true;
+		}
+		const char* p = t.Position();
+		const char* close = (const char*)memchr(p, ']', t.End() - p);
+		if (close && memchr(p, '#', close - p)) {
+			// A comment, which may hold "]" itself; copy the numbers without
+			// comments
+			uncommented.clear();
+			for (close = p; close < t.End() && *close != ']'; ++close) {
+				if (*close == '#') {
+					while (close < t.End() && *close != '\n') ++close;
+					if (close == t.End()) break;
+				}
+				uncommented.push_back(*close);
+			}
+			if (close == t.End()) close = nullptr;
+			*begin = uncommented.data();
+			*end = uncommented.data() + uncommented.size();
+		} else {
+			*begin = p;
+			*end = close;
+		}
+		if (!close) return Error(tok, "unterminated \"[\"");
+		if (memchr(*begin, '"', *end - *begin)) return Error(tok, "expected numbers only between \"[\" and \"]\"");
+		t.SetPosition(close + 1);
+		return true;
+	}
+
+	// Reads the numbers of a value that starts with tok into nValues
+	// elements of V, each of nComponents T
+	template <typename T, typename V>
+	bool SceneFileParser::ReadNumbers(const Token& tok, const Token& decl, int nComponents,
+		std::unique_ptr<V[]>* values, int* nValues) {
+		static_assert(sizeof(V) % sizeof(T) == 0, "parameter values must be arrays of T");
+		DCHECK_EQ(sizeof(V), nComponents * sizeof(T));
+		const char* begin, *end;
+		if (!FindNumbers(tok, &begin, &end)) return false;
+		NumberList numbers(begin, end);
+		int64_t count = numbers.Count();
+		if (count == 0 || count % nComponents != 0 || count / nComponents > INT_MAX)
+			return Error(decl, "expected a multiple of " + std::to_string(nComponents) + " numbers, found " +
+				std::to_string(count));
+		*nValues = (int)(count / nComponents);
+		values->reset(new V[*nValues]);
+		if (!numbers.Parse((T*)values->get())) return Error(decl, "malformed number");
+		return true;
+	}
+
+	// Collects the tokens of a value that starts with tok
+	bool SceneFileParser::ReadTokens(const Token& tok, std::vector<Token>* tokens) {
+		if (tok != "[") {
+			tokens->push_back(tok);
+			return true;
+		}
+		for (Token v = t.Next(); v != "]"; v = t.Next()) {
+			if (v.size == 0 || v == "[") return Error(tok, "unterminated \"[\"");
+			tokens->push_back(v);
+		}
+		if (tokens->empty()) return Error(tok, "empty parameter value");
+		return true;
+	}
+
+	// Skips an unsupported directive's names, numbers and parameters
+	void SceneFileParser::SkipArguments() {
+		for (Token tok = t.Next(); tok.size > 0; tok = t.Next()) {
+			bool word = tok != "[" && tok != "]" && !tok.IsQuoted() && !IsDigit(tok.data[0]) &&
+				tok.data[0] != '-' && tok.data[0] != '+' && tok.data[0] != '.';
+			if (word) {
+				t.Unget(tok);
+				return;
+			}
+			// Jump over long arrays
+			if (tok == "[") {
+				const char* p = t.Position();
+				const char* close = (const char*)memchr(p, ']', t.End() - p);
+				if (close && !memchr(p, '"', close - p) && !memchr(p, '#', close - p)) t.SetPosition(close + 1);
+			}
+		}
+	}
+
+	static bool ParseSceneFile(SceneFile* file, int depth);
+
+	static bool ParseSceneText(const char* begin, const char* end, SceneFile* file, int depth) {
+		Tokenizer t(begin, end, file->filename);
+		if (!SceneFileParser(t, file).Parse()) return false;
+		std::atomic<bool> ok(true);
+		ParallelFor([&](int64_t i) {
+			if (!ParseSceneFile(file->includes[i].get(), depth + 1)) ok = false;
+		}, (int64_t)file->includes.size());
+		return ok;
+	}
+
+	static bool ParseSceneFile(SceneFile* file, int depth) {
+		if (depth > MaxIncludeDepth) {
+			LOG(ERROR) << "\"" << file->filename << "\": Includes nested more than " << MaxIncludeDepth <<
+				" deep; is a file including itself?";
+			return false;
+		}
+		MappedFile mapped;
+		if (!mapped.Open(file->filename)) {
+			// Empty files can't be mapped
+			RandomAccessFile f;
+			if (f.Open(file->filename) && f.Size() == 0) return true;
+			LOG(ERROR) << "Unable to read scene file \"" << file->filename << "\"";
+			return false;
+		}
+		return ParseSceneText(mapped.Data(), mapped.Data() + mapped.Size(), file, depth);
+	}
+
+	static void Replay(const SceneFile& file, ParserTarget* target) {
+		for (const SceneStatement& s : file.statements) {
+			const Float* v = s.numbers;
+			switch (s.directive) {
+			case Directive::Identity: target->pbrtIdentity(); break;
+			case Directive::Translate: target->pbrtTranslate(v[0], v[1], v[2]); break;
+			case Directive::Rotate: target->pbrtRotate(v[0], v[1], v[2], v[3]); break;
+			case Directive::Scale: target->pbrtScale(v[0], v[1], v[2]); break;
+			case Directive::LookAt: target->pbrtLookAt(v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7], v[8]); break;
+			case Directive::ConcatTransform: target->pbrtConcatTransform(v); break;
+			case Directive::Transform: target->pbrtTransform(v); break;
+			case Directive::CoordinateSystem: target->pbrtCoordinateSystem(s.name); break;
+			case Directive::CoordSysTransform: target->pbrtCoordSysTransform(s.name); break;
+			case Directive::ReverseOrientation: target->pbrtReverseOrientation(); break;
+			case Directive::PixelFilter: target->pbrtPixelFilter(s.name, s.params); break;
+			case Directive::Film: target->pbrtFilm(s.name, s.params); break;
+			case Directive::Sampler: target->pbrtSampler(s.name, s.params); break;
+			case Directive::Accelerator: target->pbrtAccelerator(s.name, s.params); break;
+			case Directive::Camera: target->pbrtCamera(s.name, s.params); break;
+			case Directive::WorldBegin: target->pbrtWorldBegin(); break;
+			case Directive::AttributeBegin: target->pbrtAttributeBegin(); break;
+			case Directive::AttributeEnd: target->pbrtAttributeEnd(); break;
+			case Directive::TransformBegin: target->pbrtTransformBegin(); break;
+			case Directive::TransformEnd: target->pbrtTransformEnd(); break;
+			case Directive::Material: target->pbrtMaterial(s.name, s.params); break;
+			case Directive::MakeNamedMaterial: target->pbrtMakeNamedMaterial(s.name, s.params); break;
+			case Directive::NamedMaterial: target->pbrtNamedMaterial(s.name); break;
+			case Directive::Shape: target->pbrtShape(s.name, s.params); break;
+			case Directive::ObjectBegin: target->pbrtObjectBegin(s.name); break;
+			case Directive::ObjectEnd: target->pbrtObjectEnd(); break;
+			case Directive::ObjectInstance: target->pbrtObjectInstance(s.name); break;
+			case Directive::WorldEnd: target->pbrtWorldEnd(); break;
+			case Directive::Include: Replay(*file.includes[s.include], target); break;
+			}
+		}
+	}
+
+	// Token Method Definitions
+	std::string Token::ToString() const {
+		Token s = Dequoted();
+		std::string str;
+		str.reserve(s.size);
+		for (size_t i = 0; i < s.size; ++i) {
+			char c = s.data[i];
+			if (c == '\\' && i + 1 < s.size) {
+				switch (c = s.data[++i]) {
+				case 'b': c = '\b'; break;
+				case 'f': c = '\f'; break;
+				case 'n': c = '\n'; break;
+				case 'r': c = '\r'; break;
+				case 't': c = '\t'; break;
+				}
+			}
+			str.push_back(c);
+		}
+		return str;
+	}
+
+	// Tokenizer Method Definitions
+	Token Tokenizer::Next() {
+		if (pending.data) {
+			Token tok = pending;
+			pending = Token();
+			return tok;
+		}
+		while (pos < end) {
+			const char* start = pos;
+			char c = *pos++;
+			if (IsSpace(c)) continue;
+			if (c == '#') {
+				const char* eol = (const char*)memchr(pos, '\n', end - pos);
+				pos = eol ? eol + 1 : end;
+				continue;
+			}
+			if (c == '[' || c == ']') return Token(start, 1);
+			if (c == '"') {
+				for (; pos < end && *pos != '"' && *pos != '\n'; ++pos)
+					if (*pos == '\\' && pos + 1 < end) ++pos;
+				if (pos == end || *pos == '\n') {
+					LOG(ERROR) << Location(Token(start, 1)) << ": unterminated string";
+					failed = true;
+					pos = end;
+					return Token();
+				}
+				++pos;
+				return Token(start, pos - start);
+			}
+			while (pos < end && !IsSpace(*pos) && *pos != '"' && *pos != '[' && *pos != ']' && *pos != '#') ++pos;
+			return Token(start, pos - start);
+		}
+		return Token();
+	}
+
+	std::string Tokenizer::Location(const Token& tok) const {
+		return filename + ":" + std::to_string(1 + std::count(begin, tok.data, '\n'));
+	}
+
+	// ParserTarget Method Definitions
+	ParserTarget::~ParserTarget() {}
+
+	// Parser Function Definitions
+	bool ParseFile(const std::string& filename, ParserTarget* target) {
+		SceneFile file;
+		file.filename = filename;
+		file.directory = DirectoryContaining(filename);
+		if (!ParseSceneFile(&file, 0)) return false;
+		Replay(file, target);
+		return true;
+	}
+
+	bool ParseString(const std::string& text, ParserTarget* target) {
+		SceneFile file;
+		file.filename = "<string>";
+		if (!ParseSceneText(text.data(), text.data() + text.size(), &file, 0)) return false;
+		Replay(file, target);
+		return true;
+	}
+
+}  // namespace pbr
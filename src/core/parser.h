@@ -0,0 +1,113 @@
+#ifndef CORE_PARSER_H
+#define CORE_PARSER_H
+
+#include "pbr.h"
+#include "paramset.h"
+
+namespace pbr {
+
+	// Parser Declarations
+
+	// A token of scene text: a word, a number, a bracket or a string with
+	// its quotes. It points into the text, which outlives it.
+	struct Token {
+		Token() {}
+		Token(const char* data, size_t size) : data(data), size(size) {}
+		bool operator==(const char* s) const { return strlen(s) == size && memcmp(data, s, size) == 0; }
+		bool operator!=(const char* s) const { return !(*this == s); }
+		bool IsQuoted() const { return size >= 2 && data[0] == '"' && data[size - 1] == '"'; }
+		// The characters between the quotes
+		Token Dequoted() const { return IsQuoted() ? Token(data + 1, size - 2) : *this; }
+		// The string a quoted token denotes, with escapes resolved
+		std::string ToString() const;
+
+		const char* data = nullptr;
+		size_t size = 0;
+	};
+
+	// Splits [begin, end) into tokens without copying; "#" comments run to
+	// the end of the line
+	class Tokenizer {
+	public:
+		Tokenizer(const char* begin, const char* end, const std::string& filename)
+			: begin(begin), pos(begin), end(end), filename(filename) {}
+
+		// The next token; an empty one at the end of the text or after an
+		// unterminated string, which is logged
+		Token Next();
+		// Makes tok, the last token returned, the next one again
+		void Unget(const Token& tok) { pending = tok; }
+		// Where tok is, as "filename:line", for messages
+		std::string Location(const Token& tok) const;
+		bool Failed() const { return failed; }
+
+		// Scanning resumes at pos, which must follow the last token returned
+		const char* Position() const {
+			DCHECK(!pending.data);
+			return pos;
+		}
+		const char* End() const { return end; }
+		void SetPosition(const char* p) { pos = p; }
+
+	private:
+		const char* const begin;
+		const char* pos;
+		const char* const end;
+		const std::string filename;
+		Token pending;
+		bool failed = false;
+	};
+
+	// Receives the statements of a scene description in order. Methods are
+	// named after the pbrt-v3 API calls they correspond to.
+	class ParserTarget {
+	public:
+		virtual ~ParserTarget();
+		virtual void pbrtIdentity() = 0;
+		virtual void pbrtTranslate(Float dx, Float dy, Float dz) = 0;
+		virtual void pbrtRotate(Float angle, Float ax, Float ay, Float az) = 0;
+		virtual void pbrtScale(Float sx, Float sy, Float sz) = 0;
+		virtual void pbrtLookAt(Float ex, Float ey, Float ez, Float lx, Float ly, Float lz, Float ux, Float uy,
+			Float uz) = 0;
+		// Row-major pbrt matrices, which hold the translation in tr[12..14]
+		virtual void pbrtConcatTransform(const Float tr[16]) = 0;
+		virtual void pbrtTransform(const Float tr[16]) = 0;
+		virtual void pbrtCoordinateSystem(const std::string& name) = 0;
+		virtual void pbrtCoordSysTransform(const std::string& name) = 0;
+		virtual void pbrtReverseOrientation() = 0;
+		virtual void pbrtPixelFilter(const std::string& name, const ParamSet& params) = 0;
+		virtual void pbrtFilm(const std::string& type, const ParamSet& params) = 0;
+		virtual void pbrtSampler(const std::string& name, const ParamSet& params) = 0;
+		virtual void pbrtAccelerator(const std::string& name, const ParamSet& params) = 0;
+		virtual void pbrtCamera(const std::string& name, const ParamSet& params) = 0;
+		virtual void pbrtWorldBegin() = 0;
+		virtual void pbrtAttributeBegin() = 0;
+		virtual void pbrtAttributeEnd() = 0;
+		virtual void pbrtTransformBegin() = 0;
+		virtual void pbrtTransformEnd() = 0;
+		virtual void pbrtMaterial(const std::string& name, const ParamSet& params) = 0;
+		virtual void pbrtMakeNamedMaterial(const std::string& name, const ParamSet& params) = 0;
+		virtual void pbrtNamedMaterial(const std::string& name) = 0;
+		virtual void pbrtShape(const std::string& name, const ParamSet& params) = 0;
+		virtual void pbrtObjectBegin(const std::string& name) = 0;
+		virtual void pbrtObjectEnd() = 0;
+		virtual void pbrtObjectInstance(const std::string& name) = 0;
+		virtual void pbrtWorldEnd() = 0;
+	};
+
+	// Parses a pbrt-v3 scene file and hands its statements to target. The
+	// file is tokenized in place from a mapping; numeric parameter arrays
+	// are parsed straight into their typed lists, in parallel chunks when
+	// large. Included files are parsed concurrently and their statements
+	// replayed where they are included. Relative "filename" parameters of
+	// shapes and Includes are resolved against the including file's
+	// directory. Nothing is handed to target unless every file parses;
+	// errors are logged. Directives and parameter types the renderer lacks
+	// are skipped with a warning.
+	bool ParseFile(const std::string& filename, ParserTarget* target);
+	// As above, for scene text; relative paths are taken as they are
+	bool ParseString(const std::string& text, ParserTarget* target);
+
+}  // namespace pbr
+
+#endif  // CORE_PARSER_H
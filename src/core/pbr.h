@@ -15,18 +15,214 @@
 #include <string.h>
 #include <glog/logging.h>
 
+// Platform-specific definitions
+#if defined(_MSC_VER) && _MSC_VER < 1900
+#define PBRT_CONSTEXPR const
+#else
+#define PBRT_CONSTEXPR constexpr
+#endif
+// Marks an intentional fallthrough to the next case label
+#if defined(__clang__)
+#define PBR_FALLTHROUGH [[clang::fallthrough]]
+#elif defined(__GNUC__) && __GNUC__ >= 7
+#define PBR_FALLTHROUGH [[gnu::fallthrough]]
+#else
+#define PBR_FALLTHROUGH
+#endif
+
 namespace pbr {
 
+	// Scalar type used throughout the renderer; configure with
+	// -DPBR_FLOAT_AS_DOUBLE=ON to build everything in double precision.
+#ifdef PBR_FLOAT_AS_DOUBLE
+	typedef double Float;
+#else
+	typedef float Float;
+#endif
+
+	// Global Forward Declarations
+	class Ray;
+	class Shape;
+	class Primitive;
+	class Aggregate;
+	class Interaction;
+	class SurfaceInteraction;
+	class MemoryArena;
+	class Filter;
+	class Film;
+	class Camera;
+	struct CameraSample;
+	class Transform;
+	class Sampler;
+	class ParamSet;
+	class BinarySceneWriter;
+	class TileCache;
+	class GeometryCache;
+
+	// Renderer options set from the command line
+	struct Options {
+		// Threads that parallel loops run on (0: one per core)
+		int nThreads = 0;
+		// Checkpointing: the file render progress is saved to, the seconds
+		// between saves, and whether to continue from the file's contents
+		std::string checkpointFile;
+		Float checkpointInterval = 600;
+		bool resume = false;
+		// Progressive stopping criteria: seconds of wall-clock time and the
+		// relative standard error of the image (0: unlimited)
+		Float timeLimit = 0;
+		Float targetNoise = 0;
+		// Adaptive sampling: after minSamples per pixel, only tiles noisier
+		// than targetNoise get further samples
+		bool adaptive = false;
+		int minSamples = 16;
+		// Megabytes of paged triangle meshes kept in memory
+		int geometryCacheSize = 4096;
+	};
+
+	extern Options PbrOptions;
+
 // Global Constants
 #ifdef _MSC_VER
-#define MaxFloat std::numeric_limits<float>::max()
-#define Infinity std::numeric_limits<float>::infinity()
+#define MaxFloat std::numeric_limits<Float>::max()
+#define Infinity std::numeric_limits<Float>::infinity()
 #else
 	static PBRT_CONSTEXPR Float MaxFloat = std::numeric_limits<Float>::max();
 	static PBRT_CONSTEXPR Float Infinity = std::numeric_limits<Float>::infinity();
 #endif
+#ifdef _MSC_VER
+#define MachineEpsilon (std::numeric_limits<Float>::epsilon() * 0.5)
+#else
+	static PBRT_CONSTEXPR Float MachineEpsilon = std::numeric_limits<Float>::epsilon() * 0.5;
+#endif
+	static PBRT_CONSTEXPR Float ShadowEpsilon = 0.0001f;
+	static PBRT_CONSTEXPR Float Pi = 3.14159265358979323846;
+
+	inline Float Radians(Float deg) { return (Pi / 180) * deg; }
+
+	inline Float Lerp(Float t, Float v1, Float v2) { return (1 - t) * v1 + t * v2; }
+
+	// Remainder with the sign of b
+	template <typename T> inline T Mod(T a, T b) {
+		T result = a - (a / b) * b;
+		return (T)((result < 0) ? result + b : result);
+	}
+
+	inline Float Log2(Float x) {
+		const Float invLog2 = 1.442695040888963387004650940071;
+		return std::log(x) * invLog2;
+	}
+
+	template <typename T, typename U, typename V>
+	inline T Clamp(T val, U low, V high) {
+		if (val < low) return low;
+		else if (val > high) return high;
+		else return val;
+	}
+
+	// Conservative bound on the relative error of n chained floating-point operations
+	inline PBRT_CONSTEXPR Float gamma(int n) {
+		return (n * MachineEpsilon) / (1 - n * MachineEpsilon);
+	}
+
+	inline uint32_t FloatToBits(float f) {
+		uint32_t ui;
+		memcpy(&ui, &f, sizeof(float));
+		return ui;
+	}
+
+	inline float BitsToFloat(uint32_t ui) {
+		float f;
+		memcpy(&f, &ui, sizeof(uint32_t));
+		return f;
+	}
+
+	inline uint64_t FloatToBits(double f) {
+		uint64_t ui;
+		memcpy(&ui, &f, sizeof(double));
+		return ui;
+	}
+
+	inline double BitsToFloat(uint64_t ui) {
+		double f;
+		memcpy(&f, &ui, sizeof(uint64_t));
+		return f;
+	}
+
+	// IEEE 754 half precision conversions; FloatToHalf() rounds to nearest even
+	inline uint16_t FloatToHalf(float f) {
+		uint32_t bits = FloatToBits(f);
+		uint16_t sign = (bits >> 16) & 0x8000;
+		uint32_t absBits = bits & 0x7fffffff;
+		if (absBits > 0x7f800000) return sign | 0x7e00;  // NaN
+		if (absBits >= 0x47800000) return sign | 0x7c00;  // overflows to infinity
+		if (absBits < 0x38800000)
+			// Subnormal half; scaling by 2^24 is exact, leaving only the rounding
+			return sign | (uint16_t)std::nearbyint(BitsToFloat(absBits) * 16777216.f);
+		// Rebias the exponent and round away the low 13 mantissa bits; a carry
+		// correctly propagates into the exponent
+		uint32_t h = (absBits >> 13) - (112 << 10);
+		uint32_t rem = absBits & 0x1fff;
+		if (rem > 0x1000 || (rem == 0x1000 && (h & 1))) ++h;
+		return sign | (uint16_t)h;
+	}
+
+	inline float HalfToFloat(uint16_t h) {
+		uint32_t sign = uint32_t(h & 0x8000) << 16;
+		uint32_t exponent = (h >> 10) & 0x1f, mantissa = h & 0x3ff;
+		if (exponent == 0)
+			return BitsToFloat(sign | FloatToBits(mantissa * (1.f / 16777216.f)));
+		if (exponent == 31) return BitsToFloat(sign | 0x7f800000 | (mantissa << 13));
+		return BitsToFloat(sign | ((exponent + 112) << 23) | (mantissa << 13));
+	}
+
+	inline float NextFloatUp(float v) {
+		// Handle infinity and negative zero for _NextFloatUp()_
+		if (std::isinf(v) && v > 0.) return v;
+		if (v == -0.f) v = 0.f;
+
+		// Advance _v_ to next higher float
+		uint32_t ui = FloatToBits(v);
+		if (v >= 0)
+			++ui;
+		else
+			--ui;
+		return BitsToFloat(ui);
+	}
+
+	inline float NextFloatDown(float v) {
+		// Handle infinity and positive zero for _NextFloatDown()_
+		if (std::isinf(v) && v < 0.) return v;
+		if (v == 0.f) v = -0.f;
+		uint32_t ui = FloatToBits(v);
+		if (v > 0)
+			--ui;
+		else
+			++ui;
+		return BitsToFloat(ui);
+	}
+
+	inline double NextFloatUp(double v, int delta = 1) {
+		if (std::isinf(v) && v > 0.) return v;
+		if (v == -0.f) v = 0.f;
+		uint64_t ui = FloatToBits(v);
+		if (v >= 0.)
+			ui += delta;
+		else
+			ui -= delta;
+		return BitsToFloat(ui);
+	}
 
-	inline float Lerp(float t, float v1, float v2) { return (1 - t) * v1 + t * v2; }
+	inline double NextFloatDown(double v, int delta = 1) {
+		if (std::isinf(v) && v < 0.) return v;
+		if (v == 0.f) v = -0.f;
+		uint64_t ui = FloatToBits(v);
+		if (v > 0.)
+			ui -= delta;
+		else
+			ui += delta;
+		return BitsToFloat(ui);
+	}
 
 }  // namespace pbr
 
@@ -0,0 +1,35 @@
+#include "primitive.h"
+#include "interaction.h"
+
+namespace pbr {
+
+	// Primitive Method Definitions
+	Primitive::~Primitive() {}
+
+	// GeometricPrimitive Method Definitions
+	Bounds3f GeometricPrimitive::WorldBound() const { return shape->WorldBound(); }
+
+	bool GeometricPrimitive::Intersect(const Ray& r, SurfaceInteraction* isect) const {
+		Float tHit;
+		if (!shape->Intersect(r, &tHit, isect)) return false;
+		r.tMax = tHit;
+		isect->primitive = this;
+		return true;
+	}
+
+	bool GeometricPrimitive::IntersectP(const Ray& r) const { return shape->IntersectP(r); }
+
+	// TransformedPrimitive Method Definitions
+	bool TransformedPrimitive::Intersect(const Ray& r, SurfaceInteraction* isect) const {
+		Ray ray = Inverse(primitiveToWorld)(r);
+		if (!primitive->Intersect(ray, isect)) return false;
+		r.tMax = ray.tMax;
+		if (!primitiveToWorld.IsIdentity()) *isect = primitiveToWorld(*isect);
+		return true;
+	}
+
+	bool TransformedPrimitive::IntersectP(const Ray& r) const {
+		return primitive->IntersectP(Inverse(primitiveToWorld)(r));
+	}
+
+}  // namespace pbr
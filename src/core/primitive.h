@@ -0,0 +1,55 @@
+#ifndef CORE_PRIMITIVE_H
+#define CORE_PRIMITIVE_H
+
+#include "pbr.h"
+#include "geometry.h"
+#include "shape.h"
+#include "transform.h"
+
+namespace pbr {
+
+	// Primitive Declarations
+	class Primitive {
+	public:
+		virtual ~Primitive();
+		virtual Bounds3f WorldBound() const = 0;
+		// Updates ray.tMax and fills in *isect when a closer hit is found
+		virtual bool Intersect(const Ray& r, SurfaceInteraction* isect) const = 0;
+		virtual bool IntersectP(const Ray& r) const = 0;
+	};
+
+	// GeometricPrimitive Declarations
+	class GeometricPrimitive : public Primitive {
+	public:
+		GeometricPrimitive(const std::shared_ptr<Shape>& shape) : shape(shape) {}
+		Bounds3f WorldBound() const;
+		bool Intersect(const Ray& r, SurfaceInteraction* isect) const;
+		bool IntersectP(const Ray& r) const;
+
+	private:
+		std::shared_ptr<Shape> shape;
+	};
+
+	// TransformedPrimitive Declarations
+
+	// A primitive placed in the world by a further transform, which lets
+	// object instances share one aggregate
+	class TransformedPrimitive : public Primitive {
+	public:
+		TransformedPrimitive(const std::shared_ptr<Primitive>& primitive, const Transform& primitiveToWorld)
+			: primitive(primitive), primitiveToWorld(primitiveToWorld) {}
+		Bounds3f WorldBound() const { return primitiveToWorld(primitive->WorldBound()); }
+		bool Intersect(const Ray& r, SurfaceInteraction* isect) const;
+		bool IntersectP(const Ray& r) const;
+
+	private:
+		std::shared_ptr<Primitive> primitive;
+		const Transform primitiveToWorld;
+	};
+
+	// Aggregate Declarations
+	class Aggregate : public Primitive {};
+
+}  // namespace pbr
+
+#endif  // CORE_PRIMITIVE_H
@@ -0,0 +1,283 @@
+#include "render.h"
+#include "checkpoint.h"
+#include "film.h"
+#include "imageio.h"
+#include "parallel.h"
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace pbr {
+
+	// Relative standard error of an image with b samples per pixel, from its
+	// difference to the image with a < b samples. The two are nested means,
+	// so Var(I_b - I_a) = sigma^2 (1/a - 1/b) while Var(I_b) = sigma^2 / b.
+	static Float EstimateNoise(const std::vector<Float>& imageA, int64_t a, const std::vector<Float>& imageB,
+		int64_t b) {
+		double sumSqDiff = 0, sum = 0;
+		for (size_t i = 0; i < imageB.size(); ++i) {
+			double d = imageB[i] - imageA[i];
+			sumSqDiff += d * d;
+			sum += std::abs(imageB[i]);
+		}
+		if (sum == 0) return sumSqDiff == 0 ? 0 : Infinity;
+		double rms = std::sqrt(sumSqDiff / imageB.size()), mean = sum / imageB.size();
+		return Float(rms * std::sqrt(double(a) / double(b - a)) / mean);
+	}
+
+	// Turns film captures into images, noise estimates and checkpoints on a
+	// background thread. Like CheckpointWriter, a queued capture is
+	// superseded by the next one.
+	class PassOutputThread {
+	public:
+		PassOutputThread(const Film& film, const ProgressiveOptions& options, bool estimateNoise)
+			: film(film), writeImages(options.writeEachPass), estimateNoise(estimateNoise),
+			checkpointWriter(options.checkpointWriter), noise(Infinity) {
+			thread = std::thread(&PassOutputThread::Run, this);
+		}
+		~PassOutputThread() {
+			Flush();
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				exit = true;
+			}
+			cv.notify_all();
+			thread.join();
+		}
+		// Image the next noise estimate is measured against
+		void SetBaseline(const std::vector<Float>& state, int64_t samplesCompleted) {
+			std::lock_guard<std::mutex> lock(mutex);
+			prevImage = film.GetImage(state);
+			prevSamples = samplesCompleted;
+		}
+		void Submit(std::vector<Float> state, int64_t samplesCompleted, const std::vector<int64_t>& tileSamples) {
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				queuedState = std::move(state);
+				queuedSamples = samplesCompleted;
+				queuedTileSamples = tileSamples;
+				queued = true;
+			}
+			cv.notify_all();
+		}
+		void Flush() {
+			std::unique_lock<std::mutex> lock(mutex);
+			cv.wait(lock, [this]() { return !queued && !busy; });
+		}
+		bool Idle() {
+			std::lock_guard<std::mutex> lock(mutex);
+			return !queued && !busy;
+		}
+		Float Noise() const { return noise; }
+
+	private:
+		void Run() {
+			std::unique_lock<std::mutex> lock(mutex);
+			while (true) {
+				cv.wait(lock, [this]() { return queued || exit; });
+				if (!queued) return;
+				std::vector<Float> state = std::move(queuedState);
+				std::vector<int64_t> tileSamples = std::move(queuedTileSamples);
+				int64_t samples = queuedSamples;
+				queued = false;
+				busy = true;
+				lock.unlock();
+
+				std::vector<Float> image = film.GetImage(state);
+				if (estimateNoise && !prevImage.empty() && samples > prevSamples)
+					noise = EstimateNoise(prevImage, prevSamples, image, samples);
+				if (writeImages)
+					WriteImage(film.filename, image.data(), film.croppedPixelBounds);
+				if (checkpointWriter && checkpointWriter->Due()) {
+					RenderCheckpoint checkpoint;
+					checkpoint.samplesCompleted = samples;
+					checkpoint.pixelBounds = film.croppedPixelBounds;
+					checkpoint.filmState = std::move(state);
+					checkpoint.tileSamples = std::move(tileSamples);
+					checkpointWriter->Submit(std::move(checkpoint));
+				}
+
+				lock.lock();
+				prevImage = std::move(image);
+				prevSamples = samples;
+				busy = false;
+				cv.notify_all();
+			}
+		}
+
+		const Film& film;
+		const bool writeImages, estimateNoise;
+		CheckpointWriter* checkpointWriter;
+		AtomicFloat noise;
+		std::mutex mutex;
+		std::condition_variable cv;
+		std::vector<Float> queuedState, prevImage;
+		std::vector<int64_t> queuedTileSamples;
+		int64_t queuedSamples = 0, prevSamples = 0;
+		bool queued = false, busy = false, exit = false;
+		std::thread thread;
+	};
+
+	ProgressiveResult RenderProgressive(Film& film, const SampleFunction& sampleFunc,
+		const ProgressiveOptions& options) {
+		return RenderProgressiveRows(film, [&](FilmTile* tile, const Bounds2i& pixels, int64_t firstSample,
+			int64_t nSamples) {
+			for (int y = pixels.pMin.y; y < pixels.pMax.y; ++y)
+				for (int x = pixels.pMin.x; x < pixels.pMax.x; ++x)
+					for (int64_t s = firstSample; s < firstSample + nSamples; ++s) sampleFunc(tile, Point2i(x, y), s);
+		}, options);
+	}
+
+	ProgressiveResult RenderProgressiveRows(Film& film, const SampleRowFunction& rowFunc,
+		const ProgressiveOptions& options) {
+		typedef std::chrono::steady_clock Clock;
+		Clock::time_point startTime = Clock::now();
+		ProgressiveResult result;
+		if (film.IsStreaming()) {
+			LOG(ERROR) << "Progressive rendering revisits every tile and can't use streaming film \"" <<
+				film.filename << "\"";
+			return result;
+		}
+		bool adaptive = options.adaptive;
+		if (adaptive && options.targetNoise <= 0) {
+			LOG(WARNING) << "Adaptive sampling needs a noise target; sampling uniformly";
+			adaptive = false;
+		}
+		int64_t maxSamples = options.maxSamples;
+		if (maxSamples <= 0 && options.timeLimit <= 0 && options.targetNoise <= 0) {
+			LOG(WARNING) << "No sample count, time limit or noise target given; rendering a single pass";
+			maxSamples = options.samplesPerPass;
+		}
+
+		// Initialize per-tile sample counts and error estimates
+		const int tileSize = options.tileSize;
+		Point2i nTiles = film.GetTileCount(tileSize);
+		const int nTileTotal = nTiles.x * nTiles.y;
+		std::vector<Bounds2i> tileBounds(nTileTotal);
+		int64_t totalArea = 0;
+		for (int t = 0; t < nTileTotal; ++t) {
+			tileBounds[t] = film.GetTileSampleBounds(Point2i(t % nTiles.x, t / nTiles.x), tileSize);
+			totalArea += tileBounds[t].SurfaceArea();
+		}
+		std::vector<int64_t> tileSamples(nTileTotal, 0);
+		std::vector<Float> tileError(nTileTotal, Infinity);
+
+		PassOutputThread output(film, options, !adaptive);
+		if (options.resumeFrom) {
+			const RenderCheckpoint& checkpoint = *options.resumeFrom;
+			if (checkpoint.pixelBounds == film.croppedPixelBounds && film.SetState(checkpoint.filmState)) {
+				if (checkpoint.tileSamples.size() == (size_t)nTileTotal)
+					tileSamples = checkpoint.tileSamples;
+				else
+					std::fill(tileSamples.begin(), tileSamples.end(), checkpoint.samplesCompleted);
+				if (adaptive)
+					for (int t = 0; t < nTileTotal; ++t) tileError[t] = film.GetRelativeError(tileBounds[t]);
+				output.SetBaseline(checkpoint.filmState, checkpoint.samplesCompleted);
+				LOG(INFO) << "Resuming \"" << film.filename << "\" after " << checkpoint.samplesCompleted <<
+					" samples per pixel";
+			} else
+				LOG(ERROR) << "Checkpoint doesn't match film \"" << film.filename << "\"; starting over";
+		}
+		int64_t samplesTaken = 0;
+		for (int t = 0; t < nTileTotal; ++t) samplesTaken += tileSamples[t] * tileBounds[t].SurfaceArea();
+		auto averageSamples = [&]() { return totalArea > 0 ? samplesTaken / totalArea : 0; };
+
+		// Render passes until a stopping criterion is met
+		std::chrono::duration<double> lastPass(0);
+		int64_t submittedSamples = samplesTaken;
+		std::vector<int> activeTiles;
+		while (true) {
+			// Choose the tiles for this pass and its sample count
+			activeTiles.clear();
+			int64_t activeArea = 0;
+			for (int t = 0; t < nTileTotal; ++t)
+				if (!adaptive || tileSamples[t] < options.minSamples || tileError[t] > options.targetNoise) {
+					activeTiles.push_back(t);
+					activeArea += tileBounds[t].SurfaceArea();
+				}
+			if (activeTiles.empty()) break;
+			int64_t passSamples = options.samplesPerPass;
+			if (maxSamples > 0)
+				passSamples = std::min(passSamples, (maxSamples * totalArea - samplesTaken) / activeArea);
+			if (passSamples <= 0) break;
+			std::chrono::duration<double> elapsed = Clock::now() - startTime;
+			if (result.passes > 0 && options.timeLimit > 0 && (elapsed + lastPass).count() > options.timeLimit)
+				break;
+			if (!adaptive && options.targetNoise > 0 && output.Noise() <= options.targetNoise) break;
+
+			// Tiles are merged in the order of activeTiles, whichever thread
+			// finished them, so that the sums of pixels that neighbouring
+			// tiles share don't depend on the schedule. The thread that
+			// finishes the next tile to merge merges it and any finished
+			// tiles after it.
+			Clock::time_point passStart = Clock::now();
+			std::vector<std::unique_ptr<FilmTile>> finishedTiles(activeTiles.size());
+			std::mutex mergeMutex;
+			size_t nextMerge = 0;
+			bool merging = false;
+			ParallelFor([&](int64_t i) {
+				int t = activeTiles[i];
+				const Bounds2i& sampleBounds = tileBounds[t];
+				std::unique_ptr<FilmTile> tile = film.GetFilmTile(sampleBounds);
+				for (int y = sampleBounds.pMin.y; y < sampleBounds.pMax.y; ++y)
+					rowFunc(tile.get(), Bounds2i(Point2i(sampleBounds.pMin.x, y), Point2i(sampleBounds.pMax.x, y + 1)),
+						tileSamples[t], passSamples);
+
+				std::unique_lock<std::mutex> lock(mergeMutex);
+				finishedTiles[i] = std::move(tile);
+				if (merging) return;
+				merging = true;
+				while (nextMerge < finishedTiles.size() && finishedTiles[nextMerge]) {
+					std::unique_ptr<FilmTile> next = std::move(finishedTiles[nextMerge++]);
+					lock.unlock();
+					film.MergeFilmTile(std::move(next));
+					lock.lock();
+				}
+				merging = false;
+			}, activeTiles.size());
+			if (adaptive)
+				ParallelFor([&](int64_t i) {
+					int t = activeTiles[i];
+					tileError[t] = film.GetRelativeError(tileBounds[t]);
+				}, activeTiles.size());
+			for (int t : activeTiles) tileSamples[t] += passSamples;
+			samplesTaken += passSamples * activeArea;
+			++result.passes;
+
+			// Hand the pass's result to the output thread, unless it is still
+			// busy and the capture would only be superseded
+			if (output.Idle()) {
+				std::vector<Float> state;
+				film.GetState(&state);
+				output.Submit(std::move(state), averageSamples(), adaptive ? tileSamples : std::vector<int64_t>());
+				submittedSamples = samplesTaken;
+			}
+			lastPass = Clock::now() - passStart;
+		}
+		if (submittedSamples != samplesTaken) {
+			std::vector<Float> state;
+			film.GetState(&state);
+			output.Submit(std::move(state), averageSamples(), adaptive ? tileSamples : std::vector<int64_t>());
+		}
+		output.Flush();
+
+		if (!options.writeEachPass || result.passes == 0) film.WriteImage();
+		if (options.checkpointWriter) {
+			RenderCheckpoint checkpoint;
+			checkpoint.samplesCompleted = averageSamples();
+			checkpoint.pixelBounds = film.croppedPixelBounds;
+			if (adaptive) checkpoint.tileSamples = tileSamples;
+			film.GetState(&checkpoint.filmState);
+			options.checkpointWriter->Submit(std::move(checkpoint));
+		}
+		result.samplesCompleted = averageSamples();
+		result.noise = output.Noise();
+		if (adaptive) result.noise = tileError.empty() ? 0 : *std::max_element(tileError.begin(), tileError.end());
+		result.seconds = std::chrono::duration<double>(Clock::now() - startTime).count();
+		LOG(INFO) << "Rendered " << result.passes << " passes to " << result.samplesCompleted <<
+			" samples per pixel in " << result.seconds << "s; estimated noise " << result.noise;
+		return result;
+	}
+
+}  // namespace pbr
@@ -0,0 +1,73 @@
+#ifndef CORE_RENDER_H
+#define CORE_RENDER_H
+
+#include "pbr.h"
+#include "geometry.h"
+#include <functional>
+
+namespace pbr {
+
+	class Film;
+	class FilmTile;
+	class CheckpointWriter;
+	struct RenderCheckpoint;
+
+	// Adds sample sampleIndex of pixel to tile; called concurrently for
+	// different tiles
+	typedef std::function<void(FilmTile* tile, const Point2i& pixel, int64_t sampleIndex)> SampleFunction;
+	// Adds samples [firstSample, firstSample + nSamples) of each of pixels,
+	// a row of a tile, to tile, so that their camera rays can be generated
+	// as one packet; called concurrently for different tiles
+	typedef std::function<void(FilmTile* tile, const Bounds2i& pixels, int64_t firstSample, int64_t nSamples)>
+		SampleRowFunction;
+
+	struct ProgressiveOptions {
+		// Samples per pixel added by each pass over all tiles, and the total
+		// to stop at (0: unlimited). Consecutive samples of a pixel trace
+		// coherent rays, so single-sample passes lose throughput.
+		int samplesPerPass = 8;
+		int64_t maxSamples = 0;
+		// Wall-clock budget in seconds; a pass that is predicted to overrun
+		// it isn't started (0: unlimited)
+		Float timeLimit = 0;
+		// Stop once the estimated relative standard error of the image is
+		// below this (0: never). Estimates lag by a pass.
+		Float targetNoise = 0;
+		// Adaptive sampling: once it has minSamples per pixel, a tile gets
+		// further passes only while its Film::GetRelativeError() exceeds
+		// targetNoise. maxSamples is then the average per-pixel budget,
+		// shared by the tiles that remain noisy.
+		bool adaptive = false;
+		int64_t minSamples = 16;
+		int tileSize = 16;
+		// Write the film's image after every pass rather than only at the end
+		bool writeEachPass = true;
+		// Optional periodic checkpoints, and a checkpoint to continue from
+		CheckpointWriter* checkpointWriter = nullptr;
+		const RenderCheckpoint* resumeFrom = nullptr;
+	};
+
+	struct ProgressiveResult {
+		// Average samples per pixel
+		int64_t samplesCompleted = 0;
+		int passes = 0;
+		// Estimated relative error of the image; the largest tile error when
+		// sampling adaptively
+		Float noise = Infinity;
+		double seconds = 0;
+	};
+
+	// Renders passes of samplesPerPass samples per pixel over the film's
+	// tile grid, or its noisy tiles, until a stopping criterion is met, then
+	// writes the image.
+	// Between passes, render threads only wait for Film::GetState(); the
+	// image, noise estimate and checkpoint are produced in the background.
+	ProgressiveResult RenderProgressive(Film& film, const SampleFunction& sampleFunc,
+		const ProgressiveOptions& options);
+	// RenderProgressive() handing each pass a tile row at a time
+	ProgressiveResult RenderProgressiveRows(Film& film, const SampleRowFunction& rowFunc,
+		const ProgressiveOptions& options);
+
+}  // namespace pbr
+
+#endif  // CORE_RENDER_H
@@ -0,0 +1,75 @@
+#ifndef CORE_RNG_H
+#define CORE_RNG_H
+
+#include "pbr.h"
+
+namespace pbr {
+
+	// Random Number Declarations
+#ifdef PBR_FLOAT_AS_DOUBLE
+	static PBRT_CONSTEXPR Float OneMinusEpsilon = 0.99999999999999989;
+#else
+	static PBRT_CONSTEXPR Float OneMinusEpsilon = 0.99999994f;
+#endif
+
+#define PCG32_DEFAULT_STATE 0x853c49e6748fea9bULL
+#define PCG32_DEFAULT_STREAM 0xda3e39cb94b95bdbULL
+#define PCG32_MULT 0x5851f42d4c957f2dULL
+
+	// Maps 32 uniform bits to [0, 1); the conversion to Float rounds to nearest
+	inline Float UInt32ToUnitFloat(uint32_t v) {
+		return std::min(Float(v) * Float(2.3283064365386963e-10), OneMinusEpsilon);
+	}
+
+	// PCG32 by Melissa O'Neill: 64 bits of state and a selectable stream
+	class RNG {
+	public:
+		// RNG Public Methods
+		RNG() : state(PCG32_DEFAULT_STATE), inc(PCG32_DEFAULT_STREAM) {}
+		RNG(uint64_t sequenceIndex) { SetSequence(sequenceIndex); }
+		void SetSequence(uint64_t sequenceIndex) {
+			state = 0u;
+			inc = (sequenceIndex << 1u) | 1u;
+			UniformUInt32();
+			state += PCG32_DEFAULT_STATE;
+			UniformUInt32();
+		}
+		uint32_t UniformUInt32() {
+			uint64_t oldstate = state;
+			state = oldstate * PCG32_MULT + inc;
+			uint32_t xorshifted = (uint32_t)(((oldstate >> 18u) ^ oldstate) >> 27u);
+			uint32_t rot = (uint32_t)(oldstate >> 59u);
+			return (xorshifted >> rot) | (xorshifted << ((~rot + 1u) & 31));
+		}
+		// Uniform in [0, b) without modulo bias
+		uint32_t UniformUInt32(uint32_t b) {
+			uint32_t threshold = (~b + 1u) % b;
+			while (true) {
+				uint32_t r = UniformUInt32();
+				if (r >= threshold) return r % b;
+			}
+		}
+		Float UniformFloat() { return UInt32ToUnitFloat(UniformUInt32()); }
+		// Skips delta values (backwards if negative) in O(log delta)
+		void Advance(int64_t idelta) {
+			uint64_t curMult = PCG32_MULT, curPlus = inc, accMult = 1u, accPlus = 0u, delta = (uint64_t)idelta;
+			while (delta > 0) {
+				if (delta & 1) {
+					accMult *= curMult;
+					accPlus = accPlus * curMult + curPlus;
+				}
+				curPlus = (curMult + 1) * curPlus;
+				curMult *= curMult;
+				delta /= 2;
+			}
+			state = accMult * state + accPlus;
+		}
+
+	private:
+		// RNG Private Data
+		uint64_t state, inc;
+	};
+
+}  // namespace pbr
+
+#endif  // CORE_RNG_H
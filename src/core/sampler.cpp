@@ -0,0 +1,115 @@
+#include "sampler.h"
+
+namespace pbr {
+
+	// Sampler Method Definitions
+	Sampler::~Sampler() {}
+
+	Sampler::Sampler(int64_t samplesPerPixel, int seed) : samplesPerPixel(samplesPerPixel), seed(seed) {}
+
+	void Sampler::StartPixel(const Point2i& p) {
+		currentPixel = p;
+		currentPixelSampleIndex = 0;
+		pixelSeed = MixBits(MixBits(((uint64_t)(uint32_t)p.x << 32) | (uint32_t)p.y) ^ (uint64_t)(uint32_t)seed);
+	}
+
+	bool Sampler::StartNextSample() {
+		return ++currentPixelSampleIndex < samplesPerPixel;
+	}
+
+	bool Sampler::SetSampleNumber(int64_t sampleNum) {
+		currentPixelSampleIndex = sampleNum;
+		return currentPixelSampleIndex < samplesPerPixel;
+	}
+
+	// PixelSampler Method Definitions
+	PixelSampler::PixelSampler(int64_t samplesPerPixel, int nSampledDimensions, int seed)
+		: Sampler(samplesPerPixel, seed) {
+		for (int i = 0; i < nSampledDimensions; ++i) {
+			samples1D.push_back(std::vector<Float>(samplesPerPixel));
+			samples2D.push_back(std::vector<Point2f>(samplesPerPixel));
+		}
+	}
+
+	void PixelSampler::StartPixel(const Point2i& p) {
+		current1DDimension = current2DDimension = 0;
+		Sampler::StartPixel(p);
+		rng.SetSequence(pixelSeed);
+	}
+
+	bool PixelSampler::StartNextSample() {
+		current1DDimension = current2DDimension = 0;
+		return Sampler::StartNextSample();
+	}
+
+	bool PixelSampler::SetSampleNumber(int64_t sampleNum) {
+		current1DDimension = current2DDimension = 0;
+		return Sampler::SetSampleNumber(sampleNum);
+	}
+
+	Float PixelSampler::Get1D() {
+		CHECK_LT(currentPixelSampleIndex, samplesPerPixel);
+		// Past the sampled dimensions, 1D dimension d hashes as 3d and 2D
+		// dimension d as 3d + 1 and 3d + 2
+		if (current1DDimension < (int)samples1D.size())
+			return samples1D[current1DDimension++][currentPixelSampleIndex];
+		else
+			return HashedUniform(pixelSeed, currentPixelSampleIndex, 3 * current1DDimension++);
+	}
+
+	Point2f PixelSampler::Get2D() {
+		CHECK_LT(currentPixelSampleIndex, samplesPerPixel);
+		if (current2DDimension < (int)samples2D.size())
+			return samples2D[current2DDimension++][currentPixelSampleIndex];
+		int dim = current2DDimension++;
+		return Point2f(HashedUniform(pixelSeed, currentPixelSampleIndex, 3 * dim + 1),
+			HashedUniform(pixelSeed, currentPixelSampleIndex, 3 * dim + 2));
+	}
+
+	void PixelSampler::Get2DBatch(int dim, int64_t first, int count, Point2f* samples) {
+		CHECK_LE(first + count, samplesPerPixel);
+		if (dim < (int)samples2D.size())
+			std::copy(&samples2D[dim][first], &samples2D[dim][first] + count, samples);
+		else
+			for (int i = 0; i < count; ++i)
+				samples[i] = Point2f(HashedUniform(pixelSeed, first + i, 3 * dim + 1),
+					HashedUniform(pixelSeed, first + i, 3 * dim + 2));
+	}
+
+	// GlobalSampler Method Definitions
+	void GlobalSampler::StartPixel(const Point2i& p) {
+		Sampler::StartPixel(p);
+		dimension = 0;
+		intervalSampleIndex = GetIndexForSample(0);
+	}
+
+	bool GlobalSampler::StartNextSample() {
+		dimension = 0;
+		intervalSampleIndex = GetIndexForSample(currentPixelSampleIndex + 1);
+		return Sampler::StartNextSample();
+	}
+
+	bool GlobalSampler::SetSampleNumber(int64_t sampleNum) {
+		dimension = 0;
+		intervalSampleIndex = GetIndexForSample(sampleNum);
+		return Sampler::SetSampleNumber(sampleNum);
+	}
+
+	Float GlobalSampler::Get1D() {
+		return SampleDimension(intervalSampleIndex, dimension++);
+	}
+
+	Point2f GlobalSampler::Get2D() {
+		Point2f p(SampleDimension(intervalSampleIndex, dimension), SampleDimension(intervalSampleIndex, dimension + 1));
+		dimension += 2;
+		return p;
+	}
+
+	void GlobalSampler::Get2DBatch(int dim, int64_t first, int count, Point2f* samples) {
+		for (int i = 0; i < count; ++i) {
+			int64_t index = GetIndexForSample(first + i);
+			samples[i] = Point2f(SampleDimension(index, 2 * dim), SampleDimension(index, 2 * dim + 1));
+		}
+	}
+
+}  // namespace pbr
@@ -0,0 +1,105 @@
+#ifndef CORE_SAMPLER_H
+#define CORE_SAMPLER_H
+
+#include "pbr.h"
+#include "geometry.h"
+#include "hash.h"
+#include "rng.h"
+
+namespace pbr {
+
+	// Sampler Inline Functions
+
+	// Uniform value in [0, 1) that depends only on the pixel's seed, the
+	// sample index and the dimension, so no state carries between samples
+	inline Float HashedUniform(uint64_t pixelSeed, int64_t sampleIndex, int dimension) {
+		uint64_t h = MixBits(pixelSeed ^ ((uint64_t)sampleIndex * 0x9e3779b97f4a7c15ull) ^
+			((uint64_t)dimension * 0xbf58476d1ce4e5b9ull));
+		return UInt32ToUnitFloat((uint32_t)(h >> 32));
+	}
+
+	// Sampler Declarations
+
+	// Generates the sample vectors of each pixel: StartPixel(), then for each
+	// of samplesPerPixel samples a sequence of Get1D()/Get2D() dimensions,
+	// advancing with StartNextSample(). Every value is a function of the
+	// pixel, sample index, dimension and seed alone, so renders don't depend
+	// on how pixels are scheduled across threads.
+	class Sampler {
+	public:
+		// Sampler Interface
+		virtual ~Sampler();
+		Sampler(int64_t samplesPerPixel, int seed = 0);
+		virtual void StartPixel(const Point2i& p);
+		virtual Float Get1D() = 0;
+		virtual Point2f Get2D() = 0;
+		// Fills samples[i] with the dim'th 2D sample of pixel sample first + i:
+		// what Get2D() returns there when no Get1D() calls precede it. Leaves
+		// the current sample and dimension unchanged.
+		virtual void Get2DBatch(int dim, int64_t first, int count, Point2f* samples) = 0;
+		// Copy for another thread; the copy generates the same values
+		virtual std::unique_ptr<Sampler> Clone() = 0;
+		virtual bool StartNextSample();
+		virtual bool SetSampleNumber(int64_t sampleNum);
+		int64_t CurrentSampleNumber() const { return currentPixelSampleIndex; }
+
+		// Sampler Public Data
+		const int64_t samplesPerPixel;
+
+	protected:
+		// Sampler Protected Data
+		const int seed;
+		Point2i currentPixel;
+		int64_t currentPixelSampleIndex;
+		// Hash of currentPixel and seed
+		uint64_t pixelSeed;
+	};
+
+	// Generates all of a pixel's samples in StartPixel(), for the first
+	// nSampledDimensions 1D and 2D dimensions, drawing from an RNG seeded
+	// with the pixel; later dimensions are hashed uniform values
+	class PixelSampler : public Sampler {
+	public:
+		// PixelSampler Public Methods
+		PixelSampler(int64_t samplesPerPixel, int nSampledDimensions, int seed = 0);
+		void StartPixel(const Point2i& p);
+		bool StartNextSample();
+		bool SetSampleNumber(int64_t);
+		Float Get1D();
+		Point2f Get2D();
+		void Get2DBatch(int dim, int64_t first, int count, Point2f* samples);
+
+	protected:
+		// PixelSampler Protected Data
+		std::vector<std::vector<Float>> samples1D;
+		std::vector<std::vector<Point2f>> samples2D;
+		int current1DDimension = 0, current2DDimension = 0;
+		RNG rng;
+	};
+
+	// Draws from a single sequence spanning the image: each pixel sample maps
+	// to an index into it, and each dimension of the sample is computed
+	// independently from that index
+	class GlobalSampler : public Sampler {
+	public:
+		// GlobalSampler Public Methods
+		GlobalSampler(int64_t samplesPerPixel, int seed = 0) : Sampler(samplesPerPixel, seed) {}
+		void StartPixel(const Point2i& p);
+		bool StartNextSample();
+		bool SetSampleNumber(int64_t sampleNum);
+		Float Get1D();
+		Point2f Get2D();
+		void Get2DBatch(int dim, int64_t first, int count, Point2f* samples);
+		// Index of the current pixel's sample sampleNum in the sequence
+		virtual int64_t GetIndexForSample(int64_t sampleNum) const = 0;
+		virtual Float SampleDimension(int64_t index, int dimension) const = 0;
+
+	private:
+		// GlobalSampler Private Data
+		int dimension;
+		int64_t intervalSampleIndex;
+	};
+
+}  // namespace pbr
+
+#endif  // CORE_SAMPLER_H
@@ -0,0 +1,45 @@
+#include "sampling.h"
+
+namespace pbr {
+
+	// Sampling Function Definitions
+	void StratifiedSample1D(Float* samp, int nSamples, RNG& rng, bool jitter) {
+		Float invNSamples = (Float)1 / nSamples;
+		for (int i = 0; i < nSamples; ++i) {
+			Float delta = jitter ? rng.UniformFloat() : 0.5f;
+			samp[i] = std::min((i + delta) * invNSamples, OneMinusEpsilon);
+		}
+	}
+
+	void StratifiedSample2D(Point2f* samp, int nx, int ny, RNG& rng, bool jitter) {
+		Float dx = (Float)1 / nx, dy = (Float)1 / ny;
+		for (int y = 0; y < ny; ++y)
+			for (int x = 0; x < nx; ++x) {
+				Float jx = jitter ? rng.UniformFloat() : 0.5f;
+				Float jy = jitter ? rng.UniformFloat() : 0.5f;
+				samp->x = std::min((x + jx) * dx, OneMinusEpsilon);
+				samp->y = std::min((y + jy) * dy, OneMinusEpsilon);
+				++samp;
+			}
+	}
+
+	Point2f ConcentricSampleDisk(const Point2f& u) {
+		// Map uniform random numbers to $[-1,1]^2$
+		Point2f uOffset = 2.f * u - Vector2f(1, 1);
+
+		// Handle degeneracy at the origin
+		if (uOffset.x == 0 && uOffset.y == 0) return Point2f(0, 0);
+
+		// Apply concentric mapping to point
+		Float theta, r;
+		if (std::abs(uOffset.x) > std::abs(uOffset.y)) {
+			r = uOffset.x;
+			theta = Pi / 4 * (uOffset.y / uOffset.x);
+		} else {
+			r = uOffset.y;
+			theta = Pi / 2 - Pi / 4 * (uOffset.x / uOffset.y);
+		}
+		return r * Point2f(std::cos(theta), std::sin(theta));
+	}
+
+}  // namespace pbr
@@ -0,0 +1,34 @@
+#ifndef CORE_SAMPLING_H
+#define CORE_SAMPLING_H
+
+#include "pbr.h"
+#include "geometry.h"
+#include "rng.h"
+
+namespace pbr {
+
+	// Sampling Declarations
+
+	// One sample per stratum of [0, 1) (or [0, 1)^2, in scanline order),
+	// jittered within the stratum or at its center
+	void StratifiedSample1D(Float* samples, int nSamples, RNG& rng, bool jitter = true);
+	void StratifiedSample2D(Point2f* samples, int nx, int ny, RNG& rng, bool jitter = true);
+	// Maps [0, 1)^2 to the unit disc, preserving relative areas and
+	// stratification (Shirley and Chiu)
+	Point2f ConcentricSampleDisk(const Point2f& u);
+
+	// Sampling Inline Functions
+
+	// Fisher-Yates shuffle of count blocks of nDimensions values each
+	template <typename T>
+	void Shuffle(T* samp, int count, int nDimensions, RNG& rng) {
+		for (int i = 0; i < count; ++i) {
+			int other = i + rng.UniformUInt32(count - i);
+			for (int j = 0; j < nDimensions; ++j)
+				std::swap(samp[nDimensions * i + j], samp[nDimensions * other + j]);
+		}
+	}
+
+}  // namespace pbr
+
+#endif  // CORE_SAMPLING_H
@@ -0,0 +1,15 @@
+#include "shape.h"
+#include "interaction.h"
+
+namespace pbr {
+
+	// Shape Method Definitions
+	Shape::~Shape() {}
+
+	bool Shape::IntersectP(const Ray& ray) const {
+		Float tHit = ray.tMax;
+		SurfaceInteraction isect;
+		return Intersect(ray, &tHit, &isect);
+	}
+
+}  // namespace pbr
@@ -0,0 +1,27 @@
+#ifndef CORE_SHAPE_H
+#define CORE_SHAPE_H
+
+#include "pbr.h"
+#include "geometry.h"
+
+namespace pbr {
+
+	// Shape Declarations
+	class Shape {
+	public:
+		Shape(bool reverseOrientation = false) : reverseOrientation(reverseOrientation) {}
+		virtual ~Shape();
+		virtual Bounds3f WorldBound() const = 0;
+		// Reports the closest hit in (0, ray.tMax) through *tHit and *isect;
+		// the ray itself is left unchanged
+		virtual bool Intersect(const Ray& ray, Float* tHit, SurfaceInteraction* isect) const = 0;
+		virtual bool IntersectP(const Ray& ray) const;
+		virtual Float Area() const = 0;
+
+		// Shape Public Data
+		const bool reverseOrientation;
+	};
+
+}  // namespace pbr
+
+#endif  // CORE_SHAPE_H
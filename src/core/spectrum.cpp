@@ -0,0 +1,142 @@
+#include "spectrum.h"
+
+namespace pbr {
+
+	// Spectrum Local Definitions
+
+	// Offsets of the nearest nm to each wavelength in the spectral data,
+	// or -1 outside them
+	static void TableOffsets(const SampledWavelengths& lambda, int offset[NSpectrumSamples]) {
+		for (int i = 0; i < NSpectrumSamples; ++i) {
+			Float o = lambda[i] - LambdaMin + 0.5f;
+			offset[i] = o >= 0 && o < CIESamples ? (int)o : -1;
+		}
+	}
+
+	static SampledSpectrum Lookup(const float* table, const int offset[NSpectrumSamples]) {
+		SampledSpectrum s;
+		for (int i = 0; i < NSpectrumSamples; ++i) s[i] = offset[i] >= 0 ? table[offset[i]] : 0;
+		return s;
+	}
+
+	// RGBSigmoidPolynomial Method Definitions
+	SampledSpectrum RGBSigmoidPolynomial::operator()(const SampledWavelengths& lambda) const {
+		const SampledSpectrum& l = lambda.Lambda();
+		SampledSpectrum x = (c0 * l + SampledSpectrum(c1)) * l + SampledSpectrum(c2);
+		return SampledSpectrum(0.5f) + x / (2 * Sqrt(x * x + SampledSpectrum(1)));
+	}
+
+	// RGBToSpectrumTable Method Definitions
+	RGBSigmoidPolynomial RGBToSpectrumTable::operator()(const RGBSpectrum& rgb) const {
+		DCHECK(rgb[0] >= 0 && rgb[0] <= 1 && rgb[1] >= 0 && rgb[1] <= 1 && rgb[2] >= 0 && rgb[2] <= 1);
+		// Greys are constant, which the sigmoid only reaches at infinity
+		if (rgb[0] == rgb[1] && rgb[1] == rgb[2])
+			return RGBSigmoidPolynomial(0, 0, (rgb[0] - 0.5f) / std::sqrt(rgb[0] * (1 - rgb[0])));
+
+		// Find the largest component and the cell of the other two
+		int maxc = (rgb[0] > rgb[1]) ? ((rgb[0] > rgb[2]) ? 0 : 2) : ((rgb[1] > rgb[2]) ? 1 : 2);
+		Float z = rgb[maxc], scaleXY = (res - 1) / z;
+		Float x = rgb[(maxc + 1) % 3] * scaleXY, y = rgb[(maxc + 2) % 3] * scaleXY;
+		int xi = std::min((int)x, res - 2), yi = std::min((int)y, res - 2);
+		int zi = int(std::upper_bound(scale, scale + res, (float)z) - scale) - 1;
+		zi = Clamp(zi, 0, res - 2);
+		Float dx = x - xi, dy = y - yi, dz = (z - scale[zi]) / (scale[zi + 1] - scale[zi]);
+
+		// Trilinearly interpolate the cell's coefficients
+		const size_t dxo = 3, dyo = 3 * res, dzo = 3 * res * res;
+		const float* co = &data[((((size_t)maxc * res + zi) * res + yi) * res + xi) * 3];
+		Float c[3];
+		for (int i = 0; i < 3; ++i, ++co)
+			c[i] = Lerp(dz, Lerp(dy, Lerp(dx, co[0], co[dxo]), Lerp(dx, co[dyo], co[dyo + dxo])),
+				Lerp(dy, Lerp(dx, co[dzo], co[dzo + dxo]), Lerp(dx, co[dzo + dyo], co[dzo + dyo + dxo])));
+		return RGBSigmoidPolynomial(c[0], c[1], c[2]);
+	}
+
+	// SampledSpectrum Method Definitions
+	SampledSpectrum SampledSpectrum::FromRGB(const RGBSpectrum& rgb, const SampledWavelengths& lambda,
+		SpectrumType type) {
+		RGBSpectrum c = ClampZero(rgb);
+		Float scale = 1;
+		if (type == SpectrumType::Reflectance)
+			c = Min(c, RGBSpectrum(1));
+		else {
+			// Scale into the table's range, the largest component to 1/2
+			scale = 2 * c.MaxComponentValue();
+			c = scale != 0 ? c / scale : RGBSpectrum(0);
+		}
+		SampledSpectrum s = c[0] == c[1] && c[1] == c[2] ? SampledSpectrum(c[0]) : sRGBToSpectrumTable(c)(lambda);
+		if (type == SpectrumType::Illuminant) {
+			int offset[NSpectrumSamples];
+			TableOffsets(lambda, offset);
+			return scale * s * Lookup(RGBIlluminant, offset);
+		}
+		return scale * s;
+	}
+
+	void SampledSpectrum::ToXYZ(const SampledWavelengths& lambda, Float xyz[3]) const {
+		int offset[NSpectrumSamples];
+		TableOffsets(lambda, offset);
+		SampledSpectrum weighted = SafeDiv(*this, lambda.PDF());
+		xyz[0] = (Lookup(CIE_X, offset) * weighted).Average() / CIE_Y_integral;
+		xyz[1] = (Lookup(CIE_Y, offset) * weighted).Average() / CIE_Y_integral;
+		xyz[2] = (Lookup(CIE_Z, offset) * weighted).Average() / CIE_Y_integral;
+	}
+
+	RGBSpectrum SampledSpectrum::ToRGB(const SampledWavelengths& lambda) const {
+		Float xyz[3];
+		ToXYZ(lambda, xyz);
+		Float rgb[3];
+		for (int i = 0; i < 3; ++i) rgb[i] = XYZToRGB[i][0] * xyz[0] + XYZToRGB[i][1] * xyz[1] + XYZToRGB[i][2] * xyz[2];
+		return RGBSpectrum::FromRGB(rgb);
+	}
+
+	Float SampledSpectrum::y(const SampledWavelengths& lambda) const {
+		int offset[NSpectrumSamples];
+		TableOffsets(lambda, offset);
+		return (Lookup(CIE_Y, offset) * SafeDiv(*this, lambda.PDF())).Average() / CIE_Y_integral;
+	}
+
+	// SampledWavelengths Method Definitions
+	SampledWavelengths SampledWavelengths::SampleUniform(Float u, Float lambdaMin, Float lambdaMax) {
+		SampledWavelengths swl;
+		// Sample first wavelength, then space the others evenly, wrapping
+		swl.lambda[0] = Lerp(u, lambdaMin, lambdaMax);
+		Float delta = (lambdaMax - lambdaMin) / NSpectrumSamples;
+		for (int i = 1; i < NSpectrumSamples; ++i) {
+			swl.lambda[i] = swl.lambda[i - 1] + delta;
+			if (swl.lambda[i] > lambdaMax) swl.lambda[i] = lambdaMin + (swl.lambda[i] - lambdaMax);
+		}
+		swl.pdf = SampledSpectrum(1 / (lambdaMax - lambdaMin));
+		return swl;
+	}
+
+	SampledWavelengths SampledWavelengths::SampleVisible(Float u) {
+		// Sample the density 0.0039398042 / cosh^2(0.0072 (lambda - 538)), a
+		// fit of the eye's sensitivity by Radziszewski et al. (2009). With
+		// y = 0.85691062 - 1.82750197 u, lambda = 538 - 138.888889 atanh(y)
+		// and cosh^-2 is 1 - y^2, so one log per wavelength suffices.
+		SampledWavelengths swl;
+		for (int i = 0; i < NSpectrumSamples; ++i) {
+			Float up = u + Float(i) / NSpectrumSamples;
+			if (up > 1) up -= 1;
+			Float y = 0.85691062f - 1.82750197f * up;
+			swl.lambda[i] = 538 - 138.888889f * 0.5f * std::log((1 + y) / (1 - y));
+			swl.pdf[i] = 0.0039398042f * (1 - y * y);
+		}
+		return swl;
+	}
+
+	void SampledWavelengths::TerminateSecondary() {
+		if (SecondaryTerminated()) return;
+		// The surviving wavelength now stands in for all of them
+		for (int i = 1; i < NSpectrumSamples; ++i) pdf[i] = 0;
+		pdf[0] /= NSpectrumSamples;
+	}
+
+	bool SampledWavelengths::SecondaryTerminated() const {
+		for (int i = 1; i < NSpectrumSamples; ++i)
+			if (pdf[i] != 0) return false;
+		return true;
+	}
+
+}  // namespace pbr
@@ -0,0 +1,339 @@
+#ifndef CORE_SPECTRUM_H
+#define CORE_SPECTRUM_H
+
+#include "pbr.h"
+
+#if !defined(PBR_FLOAT_AS_DOUBLE) && (defined(__SSE2__) || defined(_M_X64))
+#define PBR_HAVE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace pbr {
+
+	// Spectrum Utility Declarations
+	static PBRT_CONSTEXPR Float LambdaMin = 360, LambdaMax = 830;
+	// Samples of the spectral data below, one per nm from LambdaMin
+	static const int CIESamples = 471;
+	// Wavelengths carried by a SampledSpectrum; configure with
+	// -DPBR_SPECTRUM_SAMPLES=8 for less color noise per path
+#ifdef PBR_SPECTRUM_SAMPLES
+	static const int NSpectrumSamples = PBR_SPECTRUM_SAMPLES;
+#else
+	static const int NSpectrumSamples = 4;
+#endif
+
+	enum class SpectrumType { Reflectance, Unbounded, Illuminant };
+
+	// Four Floats operated on at once: one SSE register with float, a loop
+	// the compiler is free to vectorize with double
+	struct Float4 {
+#ifdef PBR_HAVE_SSE2
+		Float4() {}
+		Float4(__m128 v) : v(v) {}
+		explicit Float4(Float f) : v(_mm_set1_ps(f)) {}
+		static Float4 Load(const Float* p) { return _mm_load_ps(p); }
+		void Store(Float* p) const { _mm_store_ps(p, v); }
+		Float4 operator+(const Float4& b) const { return _mm_add_ps(v, b.v); }
+		Float4 operator-(const Float4& b) const { return _mm_sub_ps(v, b.v); }
+		Float4 operator*(const Float4& b) const { return _mm_mul_ps(v, b.v); }
+		Float4 operator/(const Float4& b) const { return _mm_div_ps(v, b.v); }
+		static Float4 Min(const Float4& a, const Float4& b) { return _mm_min_ps(a.v, b.v); }
+		static Float4 Max(const Float4& a, const Float4& b) { return _mm_max_ps(a.v, b.v); }
+		static Float4 Sqrt(const Float4& a) { return _mm_sqrt_ps(a.v); }
+
+		__m128 v;
+#else
+		Float4() {}
+		explicit Float4(Float f) { v[0] = v[1] = v[2] = v[3] = f; }
+		static Float4 Load(const Float* p) {
+			Float4 r;
+			for (int i = 0; i < 4; ++i) r.v[i] = p[i];
+			return r;
+		}
+		void Store(Float* p) const {
+			for (int i = 0; i < 4; ++i) p[i] = v[i];
+		}
+#define PBR_FLOAT4_OP(op, expr)                        \
+		Float4 operator op(const Float4& b) const {    \
+			Float4 r;                                  \
+			for (int i = 0; i < 4; ++i) r.v[i] = expr; \
+			return r;                                  \
+		}
+		PBR_FLOAT4_OP(+, v[i] + b.v[i])
+		PBR_FLOAT4_OP(-, v[i] - b.v[i])
+		PBR_FLOAT4_OP(*, v[i] * b.v[i])
+		PBR_FLOAT4_OP(/, v[i] / b.v[i])
+#undef PBR_FLOAT4_OP
+		static Float4 Min(const Float4& a, const Float4& b) {
+			Float4 r;
+			for (int i = 0; i < 4; ++i) r.v[i] = std::min(a.v[i], b.v[i]);
+			return r;
+		}
+		static Float4 Max(const Float4& a, const Float4& b) {
+			Float4 r;
+			for (int i = 0; i < 4; ++i) r.v[i] = std::max(a.v[i], b.v[i]);
+			return r;
+		}
+		static Float4 Sqrt(const Float4& a) {
+			Float4 r;
+			for (int i = 0; i < 4; ++i) r.v[i] = std::sqrt(a.v[i]);
+			return r;
+		}
+
+		Float v[4];
+#endif
+	};
+
+	// Spectrum Declarations
+
+	// A fixed number of spectral samples, padded to whole Float4s so that
+	// arithmetic on a spectrum of up to four samples is a single SIMD
+	// instruction. The padding holds arbitrary values that are never read.
+	template <int nSpectrumSamples>
+	class alignas(16) CoefficientSpectrum {
+	public:
+		// CoefficientSpectrum Public Methods
+		static const int nSamples = nSpectrumSamples;
+		explicit CoefficientSpectrum(Float v = 0.f) {
+			for (int i = 0; i < nLanes; ++i) Float4(v).Store(&c[4 * i]);
+		}
+		CoefficientSpectrum& operator+=(const CoefficientSpectrum& s2) {
+			for (int i = 0; i < nLanes; ++i) (lane(i) + s2.lane(i)).Store(&c[4 * i]);
+			return *this;
+		}
+		CoefficientSpectrum operator+(const CoefficientSpectrum& s2) const {
+			CoefficientSpectrum ret = *this;
+			return ret += s2;
+		}
+		CoefficientSpectrum& operator-=(const CoefficientSpectrum& s2) {
+			for (int i = 0; i < nLanes; ++i) (lane(i) - s2.lane(i)).Store(&c[4 * i]);
+			return *this;
+		}
+		CoefficientSpectrum operator-(const CoefficientSpectrum& s2) const {
+			CoefficientSpectrum ret = *this;
+			return ret -= s2;
+		}
+		CoefficientSpectrum& operator*=(const CoefficientSpectrum& s2) {
+			for (int i = 0; i < nLanes; ++i) (lane(i) * s2.lane(i)).Store(&c[4 * i]);
+			return *this;
+		}
+		CoefficientSpectrum operator*(const CoefficientSpectrum& s2) const {
+			CoefficientSpectrum ret = *this;
+			return ret *= s2;
+		}
+		CoefficientSpectrum& operator/=(const CoefficientSpectrum& s2) {
+			DCHECK(!s2.HasNaNs());
+			for (int i = 0; i < nLanes; ++i) (lane(i) / s2.lane(i)).Store(&c[4 * i]);
+			return *this;
+		}
+		CoefficientSpectrum operator/(const CoefficientSpectrum& s2) const {
+			CoefficientSpectrum ret = *this;
+			return ret /= s2;
+		}
+		CoefficientSpectrum& operator*=(Float a) {
+			Float4 fa(a);
+			for (int i = 0; i < nLanes; ++i) (lane(i) * fa).Store(&c[4 * i]);
+			return *this;
+		}
+		CoefficientSpectrum operator*(Float a) const {
+			CoefficientSpectrum ret = *this;
+			return ret *= a;
+		}
+		friend CoefficientSpectrum operator*(Float a, const CoefficientSpectrum& s) { return s * a; }
+		CoefficientSpectrum& operator/=(Float a) {
+			DCHECK_NE(a, 0);
+			DCHECK(!std::isnan(a));
+			return *this *= 1 / a;
+		}
+		CoefficientSpectrum operator/(Float a) const {
+			CoefficientSpectrum ret = *this;
+			return ret /= a;
+		}
+		CoefficientSpectrum operator-() const { return CoefficientSpectrum(0) - *this; }
+		bool operator==(const CoefficientSpectrum& sp) const {
+			for (int i = 0; i < nSamples; ++i)
+				if (c[i] != sp.c[i]) return false;
+			return true;
+		}
+		bool operator!=(const CoefficientSpectrum& sp) const { return !(*this == sp); }
+		bool IsBlack() const {
+			for (int i = 0; i < nSamples; ++i)
+				if (c[i] != 0.) return false;
+			return true;
+		}
+		bool HasNaNs() const {
+			for (int i = 0; i < nSamples; ++i)
+				if (std::isnan(c[i])) return true;
+			return false;
+		}
+		Float MaxComponentValue() const {
+			Float m = c[0];
+			for (int i = 1; i < nSamples; ++i) m = std::max(m, c[i]);
+			return m;
+		}
+		Float Average() const {
+			Float sum = c[0];
+			for (int i = 1; i < nSamples; ++i) sum += c[i];
+			return sum / nSamples;
+		}
+		friend CoefficientSpectrum Sqrt(const CoefficientSpectrum& s) {
+			CoefficientSpectrum ret;
+			for (int i = 0; i < nLanes; ++i) Float4::Sqrt(s.lane(i)).Store(&ret.c[4 * i]);
+			return ret;
+		}
+		friend CoefficientSpectrum Exp(const CoefficientSpectrum& s) {
+			CoefficientSpectrum ret;
+			for (int i = 0; i < nSamples; ++i) ret.c[i] = std::exp(s.c[i]);
+			return ret;
+		}
+		friend CoefficientSpectrum Min(const CoefficientSpectrum& s1, const CoefficientSpectrum& s2) {
+			CoefficientSpectrum ret;
+			for (int i = 0; i < nLanes; ++i) Float4::Min(s1.lane(i), s2.lane(i)).Store(&ret.c[4 * i]);
+			return ret;
+		}
+		friend CoefficientSpectrum Max(const CoefficientSpectrum& s1, const CoefficientSpectrum& s2) {
+			CoefficientSpectrum ret;
+			for (int i = 0; i < nLanes; ++i) Float4::Max(s1.lane(i), s2.lane(i)).Store(&ret.c[4 * i]);
+			return ret;
+		}
+		friend CoefficientSpectrum ClampZero(const CoefficientSpectrum& s) { return Max(s, CoefficientSpectrum(0)); }
+		friend CoefficientSpectrum Lerp(Float t, const CoefficientSpectrum& s1, const CoefficientSpectrum& s2) {
+			return (1 - t) * s1 + t * s2;
+		}
+		// Quotient with zero wherever the divisor is zero
+		friend CoefficientSpectrum SafeDiv(const CoefficientSpectrum& s1, const CoefficientSpectrum& s2) {
+			CoefficientSpectrum ret;
+			for (int i = 0; i < nSamples; ++i) ret.c[i] = s2.c[i] != 0 ? s1.c[i] / s2.c[i] : 0;
+			return ret;
+		}
+		friend std::ostream& operator<<(std::ostream& os, const CoefficientSpectrum& s) {
+			os << "[ ";
+			for (int i = 0; i < nSamples; ++i) os << s.c[i] << (i + 1 < nSamples ? ", " : " ");
+			return os << "]";
+		}
+		Float& operator[](int i) {
+			DCHECK(i >= 0 && i < nSamples);
+			return c[i];
+		}
+		Float operator[](int i) const {
+			DCHECK(i >= 0 && i < nSamples);
+			return c[i];
+		}
+
+	protected:
+		// CoefficientSpectrum Protected Data
+		static const int nLanes = (nSamples + 3) / 4;
+		Float4 lane(int i) const { return Float4::Load(&c[4 * i]); }
+		Float c[4 * nLanes];
+	};
+
+	class RGBSpectrum : public CoefficientSpectrum<3> {
+		using CoefficientSpectrum<3>::c;
+
+	public:
+		// RGBSpectrum Public Methods
+		RGBSpectrum(Float v = 0.f) : CoefficientSpectrum<3>(v) {}
+		RGBSpectrum(const CoefficientSpectrum<3>& v) : CoefficientSpectrum<3>(v) {}
+		RGBSpectrum(Float r, Float g, Float b) {
+			c[0] = r;
+			c[1] = g;
+			c[2] = b;
+			c[3] = 0;
+		}
+		static RGBSpectrum FromRGB(const Float rgb[3]) { return RGBSpectrum(rgb[0], rgb[1], rgb[2]); }
+		void ToRGB(Float* rgb) const {
+			rgb[0] = c[0];
+			rgb[1] = c[1];
+			rgb[2] = c[2];
+		}
+		// Luminance
+		Float y() const { return 0.212671f * c[0] + 0.715160f * c[1] + 0.072169f * c[2]; }
+	};
+
+	class SampledSpectrum;
+	class SampledWavelengths;
+
+	// Smooth reflectance over wavelength in nm: a sigmoid of a quadratic
+	class RGBSigmoidPolynomial {
+	public:
+		RGBSigmoidPolynomial() {}
+		RGBSigmoidPolynomial(Float c0, Float c1, Float c2) : c0(c0), c1(c1), c2(c2) {}
+		Float operator()(Float lambda) const { return S((c0 * lambda + c1) * lambda + c2); }
+		// The sigmoid at all the wavelengths at once
+		SampledSpectrum operator()(const SampledWavelengths& lambda) const;
+
+	private:
+		static Float S(Float x) {
+			if (std::isinf(x)) return x > 0 ? 1 : 0;
+			return 0.5f + x / (2 * std::sqrt(1 + x * x));
+		}
+		Float c0 = 0, c1 = 0, c2 = 0;
+	};
+
+	// Coefficients of the RGBSigmoidPolynomial of each RGB in a color space,
+	// tabulated over a res^3 grid for every choice of the largest
+	// component: the grid's axes are that component's value, at the given
+	// scale, and the other two relative to it
+	class RGBToSpectrumTable {
+	public:
+		RGBToSpectrumTable(int res, const float* scale, const float* data) : res(res), scale(scale), data(data) {}
+		// Trilinear interpolation of the coefficients; rgb must be in [0, 1]
+		RGBSigmoidPolynomial operator()(const RGBSpectrum& rgb) const;
+
+	private:
+		const int res;
+		const float* scale;
+		const float* data;
+	};
+
+	class SampledSpectrum : public CoefficientSpectrum<NSpectrumSamples> {
+	public:
+		// SampledSpectrum Public Methods
+		SampledSpectrum(Float v = 0.f) : CoefficientSpectrum<NSpectrumSamples>(v) {}
+		SampledSpectrum(const CoefficientSpectrum<NSpectrumSamples>& v) : CoefficientSpectrum<NSpectrumSamples>(v) {}
+		// Reflectances are clamped to [0, 1]. Unbounded values are scaled
+		// into the table's range, and illuminants are further lit by the
+		// color space's reference illuminant, so that they have rgb's color.
+		static SampledSpectrum FromRGB(const RGBSpectrum& rgb, const SampledWavelengths& lambda,
+			SpectrumType type = SpectrumType::Reflectance);
+		// Monte Carlo estimates over the wavelengths
+		void ToXYZ(const SampledWavelengths& lambda, Float xyz[3]) const;
+		RGBSpectrum ToRGB(const SampledWavelengths& lambda) const;
+		Float y(const SampledWavelengths& lambda) const;
+	};
+
+	// The wavelengths of a SampledSpectrum in nm, and the densities they
+	// were sampled with; a terminated wavelength has density zero
+	class SampledWavelengths {
+	public:
+		// Stratified over [lambdaMin, lambdaMax]
+		static SampledWavelengths SampleUniform(Float u, Float lambdaMin = LambdaMin, Float lambdaMax = LambdaMax);
+		// Stratified and importance sampled by the eye's sensitivity
+		static SampledWavelengths SampleVisible(Float u);
+		Float operator[](int i) const { return lambda[i]; }
+		const SampledSpectrum& Lambda() const { return lambda; }
+		const SampledSpectrum& PDF() const { return pdf; }
+		// Keeps only the first wavelength, for wavelength-dependent scattering
+		void TerminateSecondary();
+		bool SecondaryTerminated() const;
+
+	private:
+		SampledWavelengths() {}
+		SampledSpectrum lambda, pdf;
+	};
+
+	// Spectrum Data Declarations
+
+	// The CIE 1931 color matching functions at each of CIESamples
+	// wavelengths, and the integral of CIE_Y
+	extern const float CIE_X[CIESamples], CIE_Y[CIESamples], CIE_Z[CIESamples];
+	extern const float CIE_Y_integral;
+	// sRGB's reference illuminant, CIE D65, normalized to unit luminance
+	extern const float RGBIlluminant[CIESamples];
+	// The standard XYZ to linear sRGB matrix
+	extern const float XYZToRGB[3][3];
+	extern const RGBToSpectrumTable sRGBToSpectrumTable;
+
+}  // namespace pbr
+
+#endif  // CORE_SPECTRUM_H
@@ -0,0 +1,93 @@
+#ifndef CORE_STRINGUTIL_H
+#define CORE_STRINGUTIL_H
+
+#include "pbr.h"
+#include <cstdlib>
+
+namespace pbr {
+
+	// Number parsing over [p, end) buffers that need not be null-terminated.
+	// Each function returns the first character after the number, or
+	// nullptr if none starts at p; no whitespace is skipped.
+
+	inline bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+	inline bool IsSpace(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v'; }
+
+	inline const char* ParseInt(const char* p, const char* end, int64_t* v) {
+		bool negative = false;
+		if (p < end && (*p == '-' || *p == '+')) negative = *p++ == '-';
+		if (p == end || !IsDigit(*p)) return nullptr;
+		int64_t value = 0;
+		while (p < end && IsDigit(*p)) value = value * 10 + (*p++ - '0');
+		*v = negative ? -value : value;
+		return p;
+	}
+
+	// Decimals of up to 19 significant digits whose value is an exact
+	// double scaled by a power of ten up to 10^22 are converted with a
+	// single correctly rounded multiply or divide (Clinger 1990); anything
+	// else, including "inf" and "nan", goes through strtod().
+	inline const char* ParseFloat(const char* p, const char* end, double* v) {
+		static const double powersOf10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+			1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+		const char* start = p;
+		bool negative = false;
+		if (p < end && (*p == '-' || *p == '+')) negative = *p++ == '-';
+		uint64_t mantissa = 0;
+		int nDigits = 0, exponent = 0;
+		bool anyDigits = false;
+		while (p < end && IsDigit(*p)) {
+			// Leading zeros aren't significant
+			if (mantissa != 0 || *p != '0') ++nDigits;
+			mantissa = mantissa * 10 + (*p++ - '0');
+			anyDigits = true;
+		}
+		if (p < end && *p == '.') {
+			++p;
+			while (p < end && IsDigit(*p)) {
+				if (mantissa != 0 || *p != '0') ++nDigits;
+				mantissa = mantissa * 10 + (*p++ - '0');
+				--exponent;
+				anyDigits = true;
+			}
+		}
+		if (anyDigits && p < end && (*p == 'e' || *p == 'E')) {
+			int64_t e;
+			const char* expEnd = ParseInt(p + 1, end, &e);
+			if (expEnd) {
+				exponent += (int)Clamp(e, -100000, 100000);
+				p = expEnd;
+			}
+		}
+		if (anyDigits && nDigits <= 19 && mantissa <= (uint64_t(1) << 53) && exponent >= -22 && exponent <= 22) {
+			double value = (double)mantissa;
+			value = exponent < 0 ? value / powersOf10[-exponent] : value * powersOf10[exponent];
+			*v = negative ? -value : value;
+			return p;
+		}
+
+		// Slow path on a null-terminated copy
+		char buf[64];
+		size_t n = std::min<size_t>(anyDigits ? p - start : end - start, sizeof(buf) - 1);
+		if (anyDigits && (size_t)(p - start) >= sizeof(buf)) {
+			std::string s(start, p);
+			*v = strtod(s.c_str(), nullptr);
+			return p;
+		}
+		memcpy(buf, start, n);
+		buf[n] = '\0';
+		char* parsedEnd;
+		*v = strtod(buf, &parsedEnd);
+		return parsedEnd == buf ? nullptr : start + (parsedEnd - buf);
+	}
+
+	inline const char* ParseFloat(const char* p, const char* end, float* v) {
+		double d;
+		p = ParseFloat(p, end, &d);
+		if (p) *v = (float)d;
+		return p;
+	}
+
+}  // namespace pbr
+
+#endif  // CORE_STRINGUTIL_H
@@ -0,0 +1,152 @@
+#include "tilecache.h"
+#include "hash.h"
+
+namespace pbr {
+
+	// TileCache Local Definitions
+	static std::atomic<uint64_t> nextTileSourceId{ 1 }, nextTileCacheId{ 1 };
+	static std::atomic<int> nextHitCounter{ 0 };
+
+	// One slot of a thread's direct-mapped micro-cache; cache 0 marks it empty
+	struct MicroCacheSlot {
+		uint64_t cache = 0, source = 0, tile = 0;
+		std::shared_ptr<const char> data;
+	};
+	static thread_local MicroCacheSlot microCache[TileCache::MicroCacheSize];
+	static thread_local int hitCounterIndex = -1;
+
+	// TileSource Method Definitions
+	TileSource::TileSource(size_t tileBytes) : id(nextTileSourceId++), tileBytes(tileBytes) {}
+
+	TileSource::~TileSource() {}
+
+	// TileCache Method Definitions
+	size_t TileCache::KeyHash::operator()(const Key& k) const {
+		return (size_t)MixBits(k.source * 0x9e3779b97f4a7c15ull ^ k.tile);
+	}
+
+	TileCache::Key TileCache::MakeKey(const TileSource& source, int level, const Point2i& tile) {
+		// 6 bits of level and 29 bits of each tile coordinate
+		const uint64_t mask = (1ull << 29) - 1;
+		Key key;
+		key.source = source.id;
+		key.tile = ((uint64_t)level << 58) | (((uint64_t)tile.x & mask) << 29) | ((uint64_t)tile.y & mask);
+		return key;
+	}
+
+	TileCache::TileCache(size_t capacityBytes, int nShards)
+		: id(nextTileCacheId++), capacity(capacityBytes), shards(new Shard[nShards]), nShards(nShards) {
+		CHECK_GT(nShards, 0);
+	}
+
+	TileCache::~TileCache() {
+		Stats stats = GetStats();
+		int64_t lookups = stats.microHits + stats.hits + stats.misses;
+		if (lookups > 0)
+			LOG(INFO) << "Tile cache: " << lookups << " lookups, " << 100 * stats.HitRate() << "% hits (" <<
+				stats.microHits << " in thread caches), " << stats.misses << " tiles read, " << stats.evictions <<
+				" evicted, peak " << stats.peakResidentBytes / (1024 * 1024) << " of " << capacity / (1024 * 1024) <<
+				" MB resident";
+	}
+
+	const void* TileCache::GetTile(const TileSource& source, int level, const Point2i& tile) {
+		Key key = MakeKey(source, level, tile);
+		size_t hash = KeyHash()(key);
+		MicroCacheSlot& slot = microCache[hash & (MicroCacheSize - 1)];
+		if (slot.cache == id && slot.source == key.source && slot.tile == key.tile) {
+			if (hitCounterIndex < 0) hitCounterIndex = nextHitCounter++ % NumHitCounters;
+			microHits[hitCounterIndex].count.fetch_add(1, std::memory_order_relaxed);
+			return slot.data.get();
+		}
+		slot.data = getShared(source, key, level, tile);
+		slot.cache = id;
+		slot.source = key.source;
+		slot.tile = key.tile;
+		return slot.data.get();
+	}
+
+	std::shared_ptr<const char> TileCache::getShared(const TileSource& source, const Key& key, int level,
+		const Point2i& tile) {
+		Shard& shard = shards[(KeyHash()(key) >> 16) % nShards];
+		{
+			std::lock_guard<std::mutex> lock(shard.mutex);
+			auto iter = shard.index.find(key);
+			if (iter != shard.index.end()) {
+				shard.lru.splice(shard.lru.begin(), shard.lru, iter->second);
+				++shard.hits;
+				return iter->second->data;
+			}
+			++shard.misses;
+		}
+
+		// Read outside the lock so that the shard's other tiles stay
+		// available; a thread that loses the race to insert uses the winner's
+		char* buffer = new char[source.tileBytes];
+		std::shared_ptr<const char> data(buffer, std::default_delete<char[]>());
+		if (!source.ReadTile(level, tile, buffer)) {
+			LOG(ERROR) << "Unable to read tile " << tile << " of level " << level << "; using zeros";
+			memset(buffer, 0, source.tileBytes);
+		}
+
+		std::lock_guard<std::mutex> lock(shard.mutex);
+		auto iter = shard.index.find(key);
+		if (iter != shard.index.end()) {
+			shard.lru.splice(shard.lru.begin(), shard.lru, iter->second);
+			return iter->second->data;
+		}
+		// Evict least recently used tiles to keep within the shard's share of
+		// the capacity, then to make room in the capacity itself, which the
+		// other shards' tiles also count against. A tile larger than the
+		// share is cached alone if the capacity allows; one that doesn't fit
+		// once the shard is empty is left to the caller's micro-cache.
+		auto evictLast = [&]() {
+			const Entry& last = shard.lru.back();
+			shard.bytes -= last.bytes;
+			residentBytes -= last.bytes;
+			shard.index.erase(last.key);
+			shard.lru.pop_back();
+			++shard.evictions;
+		};
+		size_t shardCapacity = capacity / nShards;
+		while (!shard.lru.empty() && shard.bytes + source.tileBytes > shardCapacity) evictLast();
+		size_t resident = residentBytes;
+		while (true) {
+			if (resident + source.tileBytes <= capacity) {
+				if (residentBytes.compare_exchange_weak(resident, resident + source.tileBytes)) break;
+			} else if (shard.lru.empty())
+				return data;
+			else {
+				evictLast();
+				resident = residentBytes;
+			}
+		}
+		resident += source.tileBytes;
+
+		Entry entry;
+		entry.key = key;
+		entry.data = data;
+		entry.bytes = source.tileBytes;
+		shard.lru.push_front(entry);
+		shard.index[key] = shard.lru.begin();
+		shard.bytes += entry.bytes;
+		size_t peak = peakResidentBytes;
+		while (resident > peak && !peakResidentBytes.compare_exchange_weak(peak, resident))
+			;
+		return data;
+	}
+
+	TileCache::Stats TileCache::GetStats() const {
+		Stats stats;
+		for (int i = 0; i < nShards; ++i) {
+			std::lock_guard<std::mutex> lock(shards[i].mutex);
+			stats.hits += shards[i].hits;
+			stats.misses += shards[i].misses;
+			stats.evictions += shards[i].evictions;
+		}
+		for (const HitCounter& counter : microHits) stats.microHits += counter.count.load(std::memory_order_relaxed);
+		stats.residentBytes = residentBytes;
+		stats.peakResidentBytes = peakResidentBytes;
+		return stats;
+	}
+
+}  // namespace pbr
@@ -0,0 +1,111 @@
+#ifndef CORE_TILECACHE_H
+#define CORE_TILECACHE_H
+
+#include "pbr.h"
+#include "geometry.h"
+#include "memory.h"
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+namespace pbr {
+
+	// TileCache Declarations
+
+	// Supplies the bytes of a level's tiles on a cache miss. Sources are
+	// immutable, so a tile never needs to be reloaded once read.
+	class TileSource {
+	public:
+		TileSource(size_t tileBytes);
+		virtual ~TileSource();
+		virtual bool ReadTile(int level, const Point2i& tile, void* dst) const = 0;
+
+		// Identifies the source's tiles in every cache; never reused
+		const uint64_t id;
+		const size_t tileBytes;
+	};
+
+	// Fixed-capacity cache of immutable tiles shared by all threads. Tiles
+	// are hashed into shards, each an LRU list behind its own mutex that
+	// keeps to its share of the capacity, and every thread keeps a few
+	// recently used tiles in a lock-free micro-cache in front of them. The
+	// shards' tiles never exceed the capacity, even when a tile is larger
+	// than a shard's share; resident memory is that plus the tiles that
+	// micro-caches still reference after their eviction: at most
+	// MicroCacheSize tiles per thread.
+	class TileCache {
+	public:
+		static const int MicroCacheSize = 16;
+
+		struct Stats {
+			// Lookups served by the calling thread's micro-cache, by a shard,
+			// and read from the source
+			int64_t microHits = 0, hits = 0, misses = 0;
+			int64_t evictions = 0;
+			size_t residentBytes = 0, peakResidentBytes = 0;
+			Float HitRate() const {
+				int64_t lookups = microHits + hits + misses;
+				return lookups > 0 ? Float(microHits + hits) / Float(lookups) : 0;
+			}
+		};
+
+		TileCache(size_t capacityBytes, int nShards = 64);
+		~TileCache();
+		TileCache(const TileCache&) = delete;
+		TileCache& operator=(const TileCache&) = delete;
+
+		// The tile's bytes, read from source on a miss. The pointer remains
+		// valid until the calling thread's next GetTile(). A tile that can't
+		// be read is logged and cached as zeros.
+		const void* GetTile(const TileSource& source, int level, const Point2i& tile);
+		Stats GetStats() const;
+		size_t Capacity() const { return capacity; }
+
+	private:
+		// TileCache Private Data
+		struct Key {
+			uint64_t source, tile;
+			bool operator==(const Key& k) const { return source == k.source && tile == k.tile; }
+		};
+		struct KeyHash {
+			size_t operator()(const Key& k) const;
+		};
+		struct Entry {
+			Key key;
+			std::shared_ptr<const char> data;
+			size_t bytes;
+		};
+		struct Shard {
+			std::mutex mutex;
+			// Most recently used first
+			std::list<Entry> lru;
+			std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index;
+			size_t bytes = 0;
+			int64_t hits = 0, misses = 0, evictions = 0;
+		};
+		// Micro-cache hits are counted in per-thread stripes a cache line
+		// apart. Padded rather than aligned, since C++11 new can't place
+		// over-aligned types.
+		struct HitCounter {
+			std::atomic<int64_t> count{ 0 };
+			char pad[PBR_L1_CACHE_LINE_SIZE - sizeof(std::atomic<int64_t>)];
+		};
+		static const int NumHitCounters = 16;
+
+		// TileCache Private Methods
+		static Key MakeKey(const TileSource& source, int level, const Point2i& tile);
+		std::shared_ptr<const char> getShared(const TileSource& source, const Key& key, int level,
+			const Point2i& tile);
+
+		const uint64_t id;
+		const size_t capacity;
+		std::unique_ptr<Shard[]> shards;
+		const int nShards;
+		std::atomic<size_t> residentBytes{ 0 }, peakResidentBytes{ 0 };
+		HitCounter microHits[NumHitCounters];
+	};
+
+}  // namespace pbr
+
+#endif  // CORE_TILECACHE_H
@@ -0,0 +1,20 @@
+#ifndef FILTERS_BOX_H
+#define FILTERS_BOX_H
+
+#include "filter.h"
+
+namespace pbr {
+
+	// Box Filter Declarations
+	class BoxFilter : public Filter {
+	public:
+		BoxFilter(const Vector2f& radius) : Filter(radius) {}
+		Float Evaluate(const Point2f& p) const;
+	};
+
+	// Supported parameters: "xwidth", "ywidth" (float radii, default 0.5)
+	BoxFilter* CreateBoxFilter(const ParamSet& ps);
+
+}  // namespace pbr
+
+#endif  // FILTERS_BOX_H
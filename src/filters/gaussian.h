@@ -0,0 +1,37 @@
+#ifndef FILTERS_GAUSSIAN_H
+#define FILTERS_GAUSSIAN_H
+
+#include "filter.h"
+
+namespace pbr {
+
+	// Gaussian Filter Declarations
+
+	// Gaussian with the value at the radius subtracted, so it falls to zero
+	// at the edge of its support
+	class GaussianFilter : public Filter {
+	public:
+		// GaussianFilter Public Methods
+		GaussianFilter(const Vector2f& radius, Float alpha)
+			: Filter(radius), alpha(alpha), expX(std::exp(-alpha * radius.x * radius.x)),
+			expY(std::exp(-alpha * radius.y * radius.y)) {}
+		Float Evaluate(const Point2f& p) const;
+
+	private:
+		// GaussianFilter Private Data
+		const Float alpha;
+		const Float expX, expY;
+
+		// GaussianFilter Utility Functions
+		Float Gaussian(Float d, Float expv) const {
+			return std::max((Float)0, Float(std::exp(-alpha * d * d) - expv));
+		}
+	};
+
+	// Supported parameters: "xwidth", "ywidth" (float radii, default 2),
+	// "alpha" (float falloff, default 2)
+	GaussianFilter* CreateGaussianFilter(const ParamSet& ps);
+
+}  // namespace pbr
+
+#endif  // FILTERS_GAUSSIAN_H
@@ -0,0 +1,39 @@
+#ifndef FILTERS_SINC_H
+#define FILTERS_SINC_H
+
+#include "filter.h"
+
+namespace pbr {
+
+	// Sinc Filter Declarations
+
+	// Sinc windowed by a Lanczos lobe; tau is the number of sinc cycles
+	// before the support ends
+	class LanczosSincFilter : public Filter {
+	public:
+		// LanczosSincFilter Public Methods
+		LanczosSincFilter(const Vector2f& radius, Float tau) : Filter(radius), tau(tau) {}
+		Float Evaluate(const Point2f& p) const;
+		Float Sinc(Float x) const {
+			x = std::abs(x);
+			if (x < 1e-5) return 1;
+			return std::sin(Pi * x) / (Pi * x);
+		}
+		Float WindowedSinc(Float x, Float radius) const {
+			x = std::abs(x);
+			if (x > radius) return 0;
+			Float lanczos = Sinc(x / tau);
+			return Sinc(x) * lanczos;
+		}
+
+	private:
+		const Float tau;
+	};
+
+	// Supported parameters: "xwidth", "ywidth" (float radii, default 4),
+	// "tau" (float, default 3)
+	LanczosSincFilter* CreateSincFilter(const ParamSet& ps);
+
+}  // namespace pbr
+
+#endif  // FILTERS_SINC_H
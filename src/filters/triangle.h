@@ -0,0 +1,20 @@
+#ifndef FILTERS_TRIANGLE_H
+#define FILTERS_TRIANGLE_H
+
+#include "filter.h"
+
+namespace pbr {
+
+	// Triangle Filter Declarations
+	class TriangleFilter : public Filter {
+	public:
+		TriangleFilter(const Vector2f& radius) : Filter(radius) {}
+		Float Evaluate(const Point2f& p) const;
+	};
+
+	// Supported parameters: "xwidth", "ywidth" (float radii, default 2)
+	TriangleFilter* CreateTriangleFilter(const ParamSet& ps);
+
+}  // namespace pbr
+
+#endif  // FILTERS_TRIANGLE_H
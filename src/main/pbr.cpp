@@ -1,11 +1,106 @@
 #include <iostream>
+#include <iterator>
 #include "pbr.h"
+#include "api.h"
+#include "binaryscene.h"
+#include "parser.h"
 using namespace std;
 
 using namespace pbr;
 
+static void usage(const char *msg = nullptr) {
+  if (msg) cerr << "pbr: " << msg << endl << endl;
+  cerr << "usage: pbr [<options>] <filename.pbrt|filename.pbrb...>" << endl
+       << "       pbr --convert <filename.pbrt> <filename.pbrb>" << endl
+       << "Scene files are read in turn; with none given, the scene is read from standard input." << endl
+       << "Files ending in .pbrb are binary scenes written by --convert." << endl
+       << "Rendering options:" << endl
+       << "  --adaptive                 Spend further samples only on tiles noisier than --target-noise." << endl
+       << "  --checkpoint <file>        Periodically save render progress to <file>." << endl
+       << "  --checkpoint-interval <s>  Seconds between checkpoints (default: 600)." << endl
+       << "  --convert                  Write the scene of the first file to the second as a binary scene." << endl
+       << "  --geometry-cache <MB>      Memory for triangle meshes paged in from disk (default: 4096)." << endl
+       << "  --help                     Print this help text." << endl
+       << "  --min-samples <n>          Samples per pixel every tile gets with --adaptive (default: 16)." << endl
+       << "  --nthreads <n>             Use <n> threads for rendering (default: one per core)." << endl
+       << "  --resume                   Continue from the --checkpoint file if it exists." << endl
+       << "  --target-noise <e>         Stop once the relative noise of the image is below <e>." << endl
+       << "  --time-limit <s>           Stop rendering passes after <s> seconds." << endl;
+  exit(msg ? 1 : 0);
+}
+
 // main program
 int main(int argc, char *argv[]) {
-  cout << "Hello, PBR" << endl;
-  return 0;
-}
\ No newline at end of file
+  google::InitGoogleLogging(argv[0]);
+  FLAGS_stderrthreshold = 1; // Warning and above.
+
+  Options options;
+  bool convert = false;
+  vector<string> filenames;
+  for (int i = 1; i < argc; ++i) {
+    string arg = argv[i];
+    if (arg == "--adaptive")
+      options.adaptive = true;
+    else if (arg == "--checkpoint") {
+      if (i + 1 == argc) usage("missing value after --checkpoint argument");
+      options.checkpointFile = argv[++i];
+    } else if (arg == "--checkpoint-interval") {
+      if (i + 1 == argc) usage("missing value after --checkpoint-interval argument");
+      options.checkpointInterval = (Float)atof(argv[++i]);
+      if (options.checkpointInterval <= 0) usage("--checkpoint-interval must be positive");
+    } else if (arg == "--convert")
+      convert = true;
+    else if (arg == "--geometry-cache") {
+      if (i + 1 == argc) usage("missing value after --geometry-cache argument");
+      options.geometryCacheSize = atoi(argv[++i]);
+      if (options.geometryCacheSize <= 0) usage("--geometry-cache must be positive");
+    } else if (arg == "--min-samples") {
+      if (i + 1 == argc) usage("missing value after --min-samples argument");
+      options.minSamples = atoi(argv[++i]);
+      if (options.minSamples <= 0) usage("--min-samples must be positive");
+    } else if (arg == "--nthreads") {
+      if (i + 1 == argc) usage("missing value after --nthreads argument");
+      options.nThreads = atoi(argv[++i]);
+      if (options.nThreads <= 0) usage("--nthreads must be positive");
+    } else if (arg == "--resume")
+      options.resume = true;
+    else if (arg == "--target-noise") {
+      if (i + 1 == argc) usage("missing value after --target-noise argument");
+      options.targetNoise = (Float)atof(argv[++i]);
+      if (options.targetNoise <= 0) usage("--target-noise must be positive");
+    } else if (arg == "--time-limit") {
+      if (i + 1 == argc) usage("missing value after --time-limit argument");
+      options.timeLimit = (Float)atof(argv[++i]);
+      if (options.timeLimit <= 0) usage("--time-limit must be positive");
+    }
+    else if (arg == "--help" || arg == "-h")
+      usage();
+    else if (arg.size() > 1 && arg[0] == '-')
+      usage(("unknown argument \"" + arg + "\"").c_str());
+    else
+      filenames.push_back(arg);
+  }
+  if (options.resume && options.checkpointFile.empty()) usage("--resume requires --checkpoint");
+  if (options.adaptive && options.targetNoise <= 0) usage("--adaptive requires --target-noise");
+  if (convert && filenames.size() != 2) usage("--convert takes a scene file and the binary scene to write");
+  PbrOptions = options;
+
+  if (convert) {
+    BinarySceneWriter writer;
+    SceneBuilder builder(&writer);
+    return ParseFile(filenames[0], &builder) && writer.Write(filenames[1]) ? 0 : 1;
+  }
+
+  bool ok = true;
+  if (filenames.empty()) {
+    SceneBuilder builder;
+    string text((istreambuf_iterator<char>(cin)), istreambuf_iterator<char>());
+    ok = ParseString(text, &builder);
+  }
+  for (const string &f : filenames) {
+    SceneBuilder builder;
+    bool binary = f.size() > 5 && f.compare(f.size() - 5, 5, ".pbrb") == 0;
+    ok &= binary ? ReadBinaryScene(f, &builder) : ParseFile(f, &builder);
+  }
+  return ok ? 0 : 1;
+}
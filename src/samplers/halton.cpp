@@ -0,0 +1,112 @@
+#include "samplers/halton.h"
+#include "lowdiscrepancy.h"
+#include "paramset.h"
+
+namespace pbr {
+
+	// HaltonSampler Local Constants
+	static const int MaxResolution = 128;
+
+	// HaltonSampler Local Functions
+	static const std::vector<uint16_t>& RadicalInversePermutations() {
+		static const std::vector<uint16_t> perms = [] {
+			RNG rng;
+			return ComputeRadicalInversePermutations(rng);
+		}();
+		return perms;
+	}
+
+	static void ExtendedGCD(uint64_t a, uint64_t b, int64_t* x, int64_t* y) {
+		if (b == 0) {
+			*x = 1;
+			*y = 0;
+			return;
+		}
+		int64_t d = a / b, xp, yp;
+		ExtendedGCD(b, a % b, &xp, &yp);
+		*x = yp;
+		*y = xp - (d * yp);
+	}
+
+	static uint64_t MultiplicativeInverse(int64_t a, int64_t n) {
+		int64_t x, y;
+		ExtendedGCD(a, n, &x, &y);
+		return ((x % n) + n) % n;
+	}
+
+	// HaltonSampler Method Definitions
+	HaltonSampler::HaltonSampler(int64_t samplesPerPixel, const Bounds2i& sampleBounds, bool sampleAtPixelCenter)
+		: GlobalSampler(samplesPerPixel), radicalInversePermutations(RadicalInversePermutations()),
+		sampleAtPixelCenter(sampleAtPixelCenter) {
+		// Find radical inverse base scales and exponents that cover sampling area
+		Vector2i res = sampleBounds.pMax - sampleBounds.pMin;
+		for (int i = 0; i < 2; ++i) {
+			int base = (i == 0) ? 2 : 3;
+			int scale = 1, exp = 0;
+			while (scale < std::min(res[i], MaxResolution)) {
+				scale *= base;
+				++exp;
+			}
+			baseScales[i] = scale;
+			baseExponents[i] = exp;
+		}
+
+		// Compute stride in samples for visiting each pixel area
+		sampleStride = baseScales[0] * baseScales[1];
+
+		// Compute multiplicative inverses for baseScales
+		multInverse[0] = (int)MultiplicativeInverse(baseScales[1], baseScales[0]);
+		multInverse[1] = (int)MultiplicativeInverse(baseScales[0], baseScales[1]);
+	}
+
+	int64_t HaltonSampler::GetIndexForSample(int64_t sampleNum) const {
+		if (currentPixel != pixelForOffset) {
+			// Compute Halton sample offset for currentPixel: the index whose
+			// first two dimensions fall in the pixel, by the Chinese remainder
+			// theorem
+			offsetForCurrentPixel = 0;
+			if (sampleStride > 1) {
+				Point2i pm(currentPixel[0] % MaxResolution, currentPixel[1] % MaxResolution);
+				if (pm[0] < 0) pm[0] += MaxResolution;
+				if (pm[1] < 0) pm[1] += MaxResolution;
+				for (int i = 0; i < 2; ++i) {
+					uint64_t dimOffset = (i == 0) ? InverseRadicalInverse<2>(pm[i], baseExponents[i])
+						: InverseRadicalInverse<3>(pm[i], baseExponents[i]);
+					offsetForCurrentPixel += dimOffset * (sampleStride / baseScales[i]) * multInverse[i];
+				}
+				offsetForCurrentPixel %= sampleStride;
+			}
+			pixelForOffset = currentPixel;
+		}
+		return offsetForCurrentPixel + sampleNum * sampleStride;
+	}
+
+	Float HaltonSampler::SampleDimension(int64_t index, int dim) const {
+		if (sampleAtPixelCenter && (dim == 0 || dim == 1)) return 0.5f;
+		// The low digits of the first two dimensions select the pixel; the
+		// rest are the offset within it
+		if (dim == 0)
+			return RadicalInverse(dim, index >> baseExponents[0]);
+		else if (dim == 1)
+			return RadicalInverse(dim, index / baseScales[1]);
+		else
+			return ScrambledRadicalInverse(dim, index, PermutationForDimension(dim));
+	}
+
+	const uint16_t* HaltonSampler::PermutationForDimension(int dim) const {
+		if (dim >= PrimeTableSize)
+			LOG(FATAL) << "HaltonSampler can only sample " << PrimeTableSize << " dimensions.";
+		return &radicalInversePermutations[PrimeSums[dim]];
+	}
+
+	std::unique_ptr<Sampler> HaltonSampler::Clone() {
+		return std::unique_ptr<Sampler>(new HaltonSampler(*this));
+	}
+
+	HaltonSampler* CreateHaltonSampler(const ParamSet& ps, const Bounds2i& sampleBounds) {
+		int nsamp = ps.FindOneInt("pixelsamples", 16);
+		bool sampleAtCenter = ps.FindOneBool("samplepixelcenter", false);
+		return new HaltonSampler(nsamp, sampleBounds, sampleAtCenter);
+	}
+
+}  // namespace pbr
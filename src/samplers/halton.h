@@ -0,0 +1,42 @@
+#ifndef SAMPLERS_HALTON_H
+#define SAMPLERS_HALTON_H
+
+#include "sampler.h"
+
+namespace pbr {
+
+	// HaltonSampler Declarations
+
+	// The Halton sequence with randomly permuted digits. Its first two
+	// dimensions are scaled to cover the image, so that each pixel takes
+	// every sampleStride'th point; the other dimensions use the permutation
+	// tables, computed once and shared by all instances.
+	class HaltonSampler : public GlobalSampler {
+	public:
+		// HaltonSampler Public Methods
+		HaltonSampler(int64_t samplesPerPixel, const Bounds2i& sampleBounds, bool sampleAtPixelCenter = false);
+		int64_t GetIndexForSample(int64_t sampleNum) const;
+		Float SampleDimension(int64_t index, int dimension) const;
+		std::unique_ptr<Sampler> Clone();
+
+	private:
+		// HaltonSampler Private Data
+		const std::vector<uint16_t>& radicalInversePermutations;
+		Point2i baseScales, baseExponents;
+		int sampleStride;
+		int multInverse[2];
+		mutable Point2i pixelForOffset = Point2i(std::numeric_limits<int>::max(), std::numeric_limits<int>::max());
+		mutable int64_t offsetForCurrentPixel;
+		const bool sampleAtPixelCenter;
+
+		// HaltonSampler Private Methods
+		const uint16_t* PermutationForDimension(int dim) const;
+	};
+
+	// Supported parameters: "pixelsamples" (int, default 16), "samplepixelcenter"
+	// (bool, default false)
+	HaltonSampler* CreateHaltonSampler(const ParamSet& ps, const Bounds2i& sampleBounds);
+
+}  // namespace pbr
+
+#endif  // SAMPLERS_HALTON_H
@@ -0,0 +1,22 @@
+#include "samplers/random.h"
+#include "paramset.h"
+
+namespace pbr {
+
+	// RandomSampler Method Definitions
+	void RandomSampler::Get2DBatch(int dim, int64_t first, int count, Point2f* samples) {
+		for (int i = 0; i < count; ++i)
+			samples[i] = Point2f(HashedUniform(pixelSeed, first + i, 2 * dim), HashedUniform(pixelSeed, first + i, 2 * dim + 1));
+	}
+
+	std::unique_ptr<Sampler> RandomSampler::Clone() {
+		return std::unique_ptr<Sampler>(new RandomSampler(*this));
+	}
+
+	RandomSampler* CreateRandomSampler(const ParamSet& ps) {
+		int ns = ps.FindOneInt("pixelsamples", 4);
+		int seed = ps.FindOneInt("seed", 0);
+		return new RandomSampler(ns, seed);
+	}
+
+}  // namespace pbr
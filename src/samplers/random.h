@@ -0,0 +1,30 @@
+#ifndef SAMPLERS_RANDOM_H
+#define SAMPLERS_RANDOM_H
+
+#include "sampler.h"
+
+namespace pbr {
+
+	// RandomSampler Declarations
+
+	// Independent uniform samples, each hashed from the pixel, sample index
+	// and dimension
+	class RandomSampler : public GlobalSampler {
+	public:
+		// RandomSampler Public Methods
+		RandomSampler(int64_t samplesPerPixel, int seed = 0) : GlobalSampler(samplesPerPixel, seed) {}
+		int64_t GetIndexForSample(int64_t sampleNum) const { return sampleNum; }
+		Float SampleDimension(int64_t index, int dimension) const {
+			return HashedUniform(pixelSeed, index, dimension);
+		}
+		void Get2DBatch(int dim, int64_t first, int count, Point2f* samples);
+		std::unique_ptr<Sampler> Clone();
+	};
+
+	// Supported parameters: "pixelsamples" (int, default 4), "seed" (int,
+	// default 0)
+	RandomSampler* CreateRandomSampler(const ParamSet& ps);
+
+}  // namespace pbr
+
+#endif  // SAMPLERS_RANDOM_H
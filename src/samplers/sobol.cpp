@@ -0,0 +1,112 @@
+#include "samplers/sobol.h"
+#include "lowdiscrepancy.h"
+#include "paramset.h"
+
+#if !defined(PBR_FLOAT_AS_DOUBLE) && (defined(__SSE2__) || defined(_M_X64))
+#define PBR_HAVE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace pbr {
+
+#ifdef PBR_HAVE_SSE2
+	// Low 32 bits of the lane products; SSE2 has only the 32x32->64 multiply
+	static inline __m128i MulLo32(__m128i a, __m128i b) {
+		__m128i even = _mm_mul_epu32(a, b);
+		__m128i odd = _mm_mul_epu32(_mm_srli_si128(a, 4), _mm_srli_si128(b, 4));
+		return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+			_mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+	}
+
+	static inline __m128i ReverseBits4(__m128i n) {
+		n = _mm_or_si128(_mm_slli_epi32(n, 16), _mm_srli_epi32(n, 16));
+		n = _mm_or_si128(_mm_slli_epi32(_mm_and_si128(n, _mm_set1_epi32(0x00ff00ff)), 8),
+			_mm_srli_epi32(_mm_and_si128(n, _mm_set1_epi32(0xff00ff00)), 8));
+		n = _mm_or_si128(_mm_slli_epi32(_mm_and_si128(n, _mm_set1_epi32(0x0f0f0f0f)), 4),
+			_mm_srli_epi32(_mm_and_si128(n, _mm_set1_epi32(0xf0f0f0f0)), 4));
+		n = _mm_or_si128(_mm_slli_epi32(_mm_and_si128(n, _mm_set1_epi32(0x33333333)), 2),
+			_mm_srli_epi32(_mm_and_si128(n, _mm_set1_epi32(0xcccccccc)), 2));
+		n = _mm_or_si128(_mm_slli_epi32(_mm_and_si128(n, _mm_set1_epi32(0x55555555)), 1),
+			_mm_srli_epi32(_mm_and_si128(n, _mm_set1_epi32(0xaaaaaaaa)), 1));
+		return n;
+	}
+
+	// Scrambled samples of four indices in one dimension; mirrors
+	// UInt32ToUnitFloat(OwenScramble(SobolSampleBits(a, dimension), seed))
+	static inline __m128 SobolSamples4(__m128i a, int dimension, uint32_t seed) {
+		const uint32_t* C = &SobolMatrices32[dimension * SobolMatrixSize];
+		const __m128i one = _mm_set1_epi32(1);
+		__m128i v = _mm_setzero_si128();
+		for (int i = 0; i < SobolMatrixSize; ++i) {
+			if (_mm_movemask_epi8(_mm_cmpeq_epi32(a, _mm_setzero_si128())) == 0xffff) break;
+			__m128i mask = _mm_sub_epi32(_mm_setzero_si128(), _mm_and_si128(a, one));
+			v = _mm_xor_si128(v, _mm_and_si128(mask, _mm_set1_epi32(C[i])));
+			a = _mm_srli_epi32(a, 1);
+		}
+
+		v = ReverseBits4(v);
+		v = _mm_xor_si128(v, MulLo32(v, _mm_set1_epi32(0x3d20adea)));
+		v = _mm_add_epi32(v, _mm_set1_epi32(seed));
+		v = MulLo32(v, _mm_set1_epi32((seed >> 16) | 1));
+		v = _mm_xor_si128(v, MulLo32(v, _mm_set1_epi32(0x05526c56)));
+		v = _mm_xor_si128(v, MulLo32(v, _mm_set1_epi32(0x53a22864)));
+		v = ReverseBits4(v);
+
+		// Unsigned conversion as two exact halves and a single rounding
+		__m128 hi = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(v, 16)), _mm_set1_ps(65536.f));
+		__m128 lo = _mm_cvtepi32_ps(_mm_and_si128(v, _mm_set1_epi32(0xffff)));
+		__m128 f = _mm_mul_ps(_mm_add_ps(hi, lo), _mm_set1_ps(2.3283064365386963e-10f));
+		return _mm_min_ps(f, _mm_set1_ps(OneMinusEpsilon));
+	}
+#endif  // PBR_HAVE_SSE2
+
+	// SobolSampler Method Definitions
+	SobolSampler::SobolSampler(int64_t samplesPerPixel, int seed) : GlobalSampler(samplesPerPixel, seed) {
+		CHECK_LE(samplesPerPixel, int64_t(1) << 32);
+		if (samplesPerPixel & (samplesPerPixel - 1))
+			LOG(WARNING) << "Sobol sampler converges best with a power of two samples per pixel, not "
+				<< samplesPerPixel;
+	}
+
+	uint64_t SobolSampler::DimensionHash(int dimension) const {
+		return MixBits(pixelSeed + (uint64_t)dimension);
+	}
+
+	Float SobolSampler::SampleDimension(int64_t index, int dimension) const {
+		if (dimension >= NSobolDimensions) return HashedUniform(pixelSeed, index, dimension);
+		uint32_t scramble = (uint32_t)DimensionHash(dimension);
+		return UInt32ToUnitFloat(OwenScramble(SobolSampleBits((uint32_t)index, dimension), scramble));
+	}
+
+	void SobolSampler::Get2DBatch(int dim, int64_t first, int count, Point2f* samples) {
+		CHECK_LE(first + count, samplesPerPixel);
+		int i = 0;
+#ifdef PBR_HAVE_SSE2
+		if (2 * dim + 1 < NSobolDimensions) {
+			static_assert(sizeof(Point2f) == 2 * sizeof(float), "Point2f must be two packed floats");
+			uint32_t seedX = (uint32_t)DimensionHash(2 * dim), seedY = (uint32_t)DimensionHash(2 * dim + 1);
+			for (; i + 4 <= count; i += 4) {
+				uint32_t a = (uint32_t)(first + i);
+				__m128i index = _mm_add_epi32(_mm_set1_epi32(a), _mm_setr_epi32(0, 1, 2, 3));
+				__m128 x = SobolSamples4(index, 2 * dim, seedX), y = SobolSamples4(index, 2 * dim + 1, seedY);
+				// Interleave to x0 y0 x1 y1 ...
+				_mm_storeu_ps(&samples[i].x, _mm_unpacklo_ps(x, y));
+				_mm_storeu_ps(&samples[i + 2].x, _mm_unpackhi_ps(x, y));
+			}
+		}
+#endif
+		for (; i < count; ++i)
+			samples[i] = Point2f(SampleDimension(first + i, 2 * dim), SampleDimension(first + i, 2 * dim + 1));
+	}
+
+	std::unique_ptr<Sampler> SobolSampler::Clone() {
+		return std::unique_ptr<Sampler>(new SobolSampler(*this));
+	}
+
+	SobolSampler* CreateSobolSampler(const ParamSet& ps) {
+		int nsamp = ps.FindOneInt("pixelsamples", 16);
+		int seed = ps.FindOneInt("seed", 0);
+		return new SobolSampler(nsamp, seed);
+	}
+
+}  // namespace pbr
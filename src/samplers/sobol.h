@@ -0,0 +1,34 @@
+#ifndef SAMPLERS_SOBOL_H
+#define SAMPLERS_SOBOL_H
+
+#include "sampler.h"
+
+namespace pbr {
+
+	// SobolSampler Declarations
+
+	// Each pixel takes the first samplesPerPixel points of the Sobol
+	// sequence, Owen scrambled with seeds hashed from the pixel and
+	// dimension. Dimensions past NSobolDimensions are hashed uniform random.
+	// Get2DBatch() scrambles four samples at a time with SSE2.
+	class SobolSampler : public GlobalSampler {
+	public:
+		// SobolSampler Public Methods
+		SobolSampler(int64_t samplesPerPixel, int seed = 0);
+		int64_t GetIndexForSample(int64_t sampleNum) const { return sampleNum; }
+		Float SampleDimension(int64_t index, int dimension) const;
+		void Get2DBatch(int dim, int64_t first, int count, Point2f* samples);
+		std::unique_ptr<Sampler> Clone();
+
+	private:
+		// SobolSampler Private Methods
+		uint64_t DimensionHash(int dimension) const;
+	};
+
+	// Supported parameters: "pixelsamples" (int, default 16), "seed" (int,
+	// default 0)
+	SobolSampler* CreateSobolSampler(const ParamSet& ps);
+
+}  // namespace pbr
+
+#endif  // SAMPLERS_SOBOL_H
@@ -0,0 +1,35 @@
+#include "samplers/stratified.h"
+#include "paramset.h"
+#include "sampling.h"
+
+namespace pbr {
+
+	// StratifiedSampler Method Definitions
+	void StratifiedSampler::StartPixel(const Point2i& p) {
+		// Seed the RNG with the pixel before generating its samples
+		PixelSampler::StartPixel(p);
+		// Generate single stratified samples for the pixel
+		for (size_t i = 0; i < samples1D.size(); ++i) {
+			StratifiedSample1D(&samples1D[i][0], xPixelSamples * yPixelSamples, rng, jitterSamples);
+			Shuffle(&samples1D[i][0], xPixelSamples * yPixelSamples, 1, rng);
+		}
+		for (size_t i = 0; i < samples2D.size(); ++i) {
+			StratifiedSample2D(&samples2D[i][0], xPixelSamples, yPixelSamples, rng, jitterSamples);
+			Shuffle(&samples2D[i][0], xPixelSamples * yPixelSamples, 1, rng);
+		}
+	}
+
+	std::unique_ptr<Sampler> StratifiedSampler::Clone() {
+		return std::unique_ptr<Sampler>(new StratifiedSampler(*this));
+	}
+
+	StratifiedSampler* CreateStratifiedSampler(const ParamSet& ps) {
+		bool jitter = ps.FindOneBool("jitter", true);
+		int xsamp = ps.FindOneInt("xsamples", 4);
+		int ysamp = ps.FindOneInt("ysamples", 4);
+		int sd = ps.FindOneInt("dimensions", 4);
+		int seed = ps.FindOneInt("seed", 0);
+		return new StratifiedSampler(xsamp, ysamp, jitter, sd, seed);
+	}
+
+}  // namespace pbr
@@ -0,0 +1,36 @@
+#ifndef SAMPLERS_STRATIFIED_H
+#define SAMPLERS_STRATIFIED_H
+
+#include "sampler.h"
+
+namespace pbr {
+
+	// StratifiedSampler Declarations
+
+	// One jittered sample per cell of an xPixelSamples by yPixelSamples grid
+	// (xPixelSamples * yPixelSamples strata in 1D), shuffled independently
+	// in each dimension
+	class StratifiedSampler : public PixelSampler {
+	public:
+		// StratifiedSampler Public Methods
+		StratifiedSampler(int xPixelSamples, int yPixelSamples, bool jitterSamples, int nSampledDimensions,
+			int seed = 0)
+			: PixelSampler(xPixelSamples * yPixelSamples, nSampledDimensions, seed), xPixelSamples(xPixelSamples),
+			yPixelSamples(yPixelSamples), jitterSamples(jitterSamples) {}
+		void StartPixel(const Point2i& p);
+		std::unique_ptr<Sampler> Clone();
+
+	private:
+		// StratifiedSampler Private Data
+		const int xPixelSamples, yPixelSamples;
+		const bool jitterSamples;
+	};
+
+	// Supported parameters: "jitter" (bool, default true), "xsamples" and
+	// "ysamples" (int, default 4), "dimensions" (int, default 4), "seed" (int,
+	// default 0)
+	StratifiedSampler* CreateStratifiedSampler(const ParamSet& ps);
+
+}  // namespace pbr
+
+#endif  // SAMPLERS_STRATIFIED_H
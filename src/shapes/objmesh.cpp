@@ -0,0 +1,382 @@
+#include "shapes/objmesh.h"
+#include "shapes/triangle.h"
+#include "fileutil.h"
+#include "hash.h"
+#include "paramset.h"
+#include "parallel.h"
+#include "stringutil.h"
+#include <atomic>
+
+namespace pbr {
+
+	// OBJMesh Local Definitions
+
+	// Bytes per parallel chunk of lines, and face corners per parallel
+	// chunk of vertex deduplication
+	static const int64_t OBJChunkBytes = 1 << 20;
+	static const int64_t OBJCornerChunk = 1 << 16;
+
+	// A face corner's indices into the file's positions, uvs and normals;
+	// -1 where it has none
+	struct OBJCorner {
+		int p, uv, n;
+	};
+
+	// Statements of each kind in a chunk, or in the chunks before one
+	struct OBJCounts {
+		int64_t p = 0, uv = 0, n = 0, triangles = 0;
+	};
+
+	enum class OBJStatement { Position, UV, Normal, Face, Other };
+
+	static inline bool IsBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+	static inline const char* SkipBlanks(const char* p, const char* end) {
+		while (p < end && IsBlank(*p)) ++p;
+		return p;
+	}
+
+	// The statement of the line [p, eol), with p moved past its keyword
+	static OBJStatement ParseOBJKeyword(const char*& p, const char* eol) {
+		p = SkipBlanks(p, eol);
+		auto keyword = [&](const char* k, ptrdiff_t len) {
+			if (eol - p <= len || memcmp(p, k, len) != 0 || !IsBlank(p[len])) return false;
+			p += len;
+			return true;
+		};
+		if (keyword("v", 1)) return OBJStatement::Position;
+		if (keyword("vt", 2)) return OBJStatement::UV;
+		if (keyword("vn", 2)) return OBJStatement::Normal;
+		if (keyword("f", 1)) return OBJStatement::Face;
+		return OBJStatement::Other;
+	}
+
+	// Parses a face corner, "v", "v/vt", "v//vn" or "v/vt/vn", as written;
+	// absent indices are 0
+	static const char* ParseOBJCorner(const char* p, const char* end, int64_t index[3]) {
+		index[0] = index[1] = index[2] = 0;
+		if (!(p = ParseInt(p, end, &index[0]))) return nullptr;
+		if (p < end && *p == '/') {
+			++p;
+			if (p < end && *p != '/' && !(p = ParseInt(p, end, &index[1]))) return nullptr;
+			if (p < end && *p == '/' && !(p = ParseInt(p + 1, end, &index[2]))) return nullptr;
+		}
+		return p;
+	}
+
+	// Parses up to n Floats; false if there are fewer than nRequired
+	static bool ParseOBJFloats(const char* p, const char* eol, int nRequired, int n, Float* v) {
+		for (int i = 0; i < n; ++i) {
+			double value;
+			const char* next = ParseFloat(SkipBlanks(p, eol), eol, &value);
+			if (!next) return i >= nRequired;
+			v[i] = (Float)value;
+			p = next;
+		}
+		return true;
+	}
+
+	// Open-addressing table from face corner keys to the least index of
+	// the corners with each key; corners are inserted concurrently
+	class OBJCornerTable {
+	public:
+		// Keys leave out uvs and normals unless useUV and useN
+		OBJCornerTable(const OBJCorner* corners, int64_t nCorners, bool useUV, bool useN)
+			: corners(corners), useUV(useUV), useN(useN) {
+			uint64_t size = 1;
+			while (size < 2 * (uint64_t)nCorners) size *= 2;
+			mask = size - 1;
+			slots.reset(new std::atomic<int>[size]);
+			const int64_t nChunks = (size + OBJCornerChunk - 1) / OBJCornerChunk;
+			ParallelFor([&](int64_t chunk) {
+				uint64_t start = chunk * OBJCornerChunk, end = std::min<uint64_t>(start + OBJCornerChunk, size);
+				for (uint64_t i = start; i < end; ++i) slots[i].store(-1, std::memory_order_relaxed);
+			}, nChunks);
+		}
+		// The slot of corner i's key
+		uint32_t Insert(int i) {
+			const OBJCorner& c = corners[i];
+			uint64_t key = ((uint64_t)(uint32_t)c.p << 32) | (useUV ? (uint32_t)c.uv : 0);
+			uint64_t slot = MixBits(key ^ MixBits(useN ? (uint32_t)c.n + 1 : 0)) & mask;
+			while (true) {
+				int first = slots[slot].load();
+				if (first < 0 && slots[slot].compare_exchange_strong(first, i)) return (uint32_t)slot;
+				if (SameKey(corners[first], c)) {
+					while (i < first && !slots[slot].compare_exchange_weak(first, i)) {}
+					return (uint32_t)slot;
+				}
+				slot = (slot + 1) & mask;
+			}
+		}
+		// Once every corner is inserted, the least corner with the slot's key
+		int First(uint32_t slot) const { return slots[slot].load(std::memory_order_relaxed); }
+
+	private:
+		bool SameKey(const OBJCorner& a, const OBJCorner& b) const {
+			return a.p == b.p && (!useUV || a.uv == b.uv) && (!useN || a.n == b.n);
+		}
+
+		const OBJCorner* const corners;
+		const bool useUV, useN;
+		uint64_t mask;
+		std::unique_ptr<std::atomic<int>[]> slots;
+	};
+
+	// OBJReader Definitions
+
+	// Parsing state of one OBJ file as it fills in an OBJMesh
+	struct OBJReader {
+		// OBJReader Methods
+		// Calls func(begin, end) for each line of chunk c
+		template <typename F> void forLines(int64_t c, F func) const {
+			const char* chunkEnd = chunkStart[c + 1];
+			for (const char* p = chunkStart[c]; p < chunkEnd;) {
+				const char* eol = (const char*)memchr(p, '\n', chunkEnd - p);
+				if (!eol) eol = chunkEnd;
+				func(p, eol);
+				p = eol + (eol < chunkEnd);
+			}
+		}
+		OBJCounts countChunk(int64_t c) const;
+		bool parseChunk(int64_t c);
+		void buildMesh();
+
+		// OBJReader Data
+		OBJMesh* mesh;
+		std::vector<const char*> chunkStart;
+		// Statements before each chunk; the last entry holds the totals
+		std::vector<OBJCounts> chunkBase;
+		std::unique_ptr<Point3f[]> positions;
+		std::unique_ptr<Point2f[]> uvs;
+		std::unique_ptr<Normal3f[]> normals;
+		std::unique_ptr<OBJCorner[]> corners;
+		std::atomic<bool> missingUV{ false }, missingN{ false };
+	};
+
+	OBJCounts OBJReader::countChunk(int64_t c) const {
+		OBJCounts counts;
+		forLines(c, [&](const char* p, const char* eol) {
+			switch (ParseOBJKeyword(p, eol)) {
+			case OBJStatement::Position: ++counts.p; break;
+			case OBJStatement::UV: ++counts.uv; break;
+			case OBJStatement::Normal: ++counts.n; break;
+			case OBJStatement::Face: {
+				int64_t nCorners = 0;
+				while ((p = SkipBlanks(p, eol)) < eol) {
+					++nCorners;
+					while (p < eol && !IsBlank(*p)) ++p;
+				}
+				counts.triangles += std::max<int64_t>(nCorners - 2, 0);
+				break;
+			}
+			default: break;
+			}
+		});
+		return counts;
+	}
+
+	bool OBJReader::parseChunk(int64_t c) {
+		const OBJCounts& totals = chunkBase.back();
+		OBJCounts n = chunkBase[c];
+		bool ok = true;
+		// Indices are 1-based, or relative to the end of the list so far
+		auto resolve = [](int64_t index, int64_t before, int64_t total, int* v) {
+			if (index > 0)
+				--index;
+			else
+				index += before;
+			*v = (int)index;
+			return index >= 0 && index < total;
+		};
+		forLines(c, [&](const char* p, const char* eol) {
+			if (!ok) return;
+			Float v[3] = { 0, 0, 0 };
+			switch (ParseOBJKeyword(p, eol)) {
+			case OBJStatement::Position:
+				ok = ParseOBJFloats(p, eol, 3, 3, v);
+				positions[n.p++] = Point3f(v[0], v[1], v[2]);
+				break;
+			case OBJStatement::UV:
+				ok = ParseOBJFloats(p, eol, 1, 2, v);
+				uvs[n.uv++] = Point2f(v[0], v[1]);
+				break;
+			case OBJStatement::Normal:
+				ok = ParseOBJFloats(p, eol, 3, 3, v);
+				normals[n.n++] = Normal3f(v[0], v[1], v[2]);
+				break;
+			case OBJStatement::Face: {
+				OBJCorner first = { -1, -1, -1 }, prev = first;
+				int k = 0;
+				bool hasUV = true, hasN = true;
+				while (ok && (p = SkipBlanks(p, eol)) < eol) {
+					int64_t index[3];
+					OBJCorner corner;
+					p = ParseOBJCorner(p, eol, index);
+					corner.uv = corner.n = -1;
+					ok = p && (p == eol || IsBlank(*p)) && index[0] != 0 &&
+						resolve(index[0], n.p, totals.p, &corner.p);
+					if (ok && index[1] != 0) ok = resolve(index[1], n.uv, totals.uv, &corner.uv);
+					if (ok && index[2] != 0) ok = resolve(index[2], n.n, totals.n, &corner.n);
+					hasUV &= corner.uv >= 0;
+					hasN &= corner.n >= 0;
+					// Fan around the first corner
+					if (k == 0)
+						first = corner;
+					else if (k >= 2) {
+						OBJCorner* tri = &corners[3 * n.triangles++];
+						tri[0] = first;
+						tri[1] = prev;
+						tri[2] = corner;
+					}
+					prev = corner;
+					++k;
+				}
+				if (!hasUV) missingUV = true;
+				if (!hasN) missingN = true;
+				break;
+			}
+			default: break;
+			}
+		});
+		return ok;
+	}
+
+	void OBJReader::buildMesh() {
+		const OBJCounts& totals = chunkBase.back();
+		const int64_t nCorners = 3 * totals.triangles;
+		const bool useUV = totals.uv > 0 && !missingUV, useN = totals.n > 0 && !missingN;
+		mesh->nTriangles = (int)totals.triangles;
+		mesh->indexStorage.reset(new int[nCorners]);
+		mesh->vertexIndices = mesh->indexStorage.get();
+		int* indices = mesh->indexStorage.get();
+
+		// Without uvs or normals, positions are the vertices
+		if (!useUV && !useN) {
+			ParallelFor([&](int64_t i) { indices[i] = corners[i].p; }, nCorners, OBJCornerChunk);
+			mesh->nVertices = (int)totals.p;
+			mesh->pStorage = std::move(positions);
+			mesh->p = mesh->pStorage.get();
+			return;
+		}
+
+		// Each corner finds the first corner with its key; those are the
+		// vertices, numbered in order
+		OBJCornerTable table(corners.get(), nCorners, useUV, useN);
+		// Slots become the first corner with the same key
+		std::unique_ptr<uint32_t[]> cornerFirst(new uint32_t[nCorners]);
+		const int64_t nChunks = (nCorners + OBJCornerChunk - 1) / OBJCornerChunk;
+		ParallelFor([&](int64_t chunk) {
+			int64_t start = chunk * OBJCornerChunk, end = std::min(start + OBJCornerChunk, nCorners);
+			for (int64_t i = start; i < end; ++i) cornerFirst[i] = table.Insert((int)i);
+		}, nChunks);
+		std::vector<int64_t> chunkVertex(nChunks + 1, 0);
+		ParallelFor([&](int64_t chunk) {
+			int64_t start = chunk * OBJCornerChunk, end = std::min(start + OBJCornerChunk, nCorners);
+			for (int64_t i = start; i < end; ++i) {
+				cornerFirst[i] = table.First(cornerFirst[i]);
+				chunkVertex[chunk + 1] += cornerFirst[i] == i;
+			}
+		}, nChunks);
+		for (int64_t c = 0; c < nChunks; ++c) chunkVertex[c + 1] += chunkVertex[c];
+
+		mesh->nVertices = (int)chunkVertex[nChunks];
+		mesh->pStorage.reset(new Point3f[mesh->nVertices]);
+		mesh->p = mesh->pStorage.get();
+		if (useUV) {
+			mesh->uvStorage.reset(new Point2f[mesh->nVertices]);
+			mesh->uv = mesh->uvStorage.get();
+		}
+		if (useN) {
+			mesh->nStorage.reset(new Normal3f[mesh->nVertices]);
+			mesh->n = mesh->nStorage.get();
+		}
+		ParallelFor([&](int64_t chunk) {
+			int64_t start = chunk * OBJCornerChunk, end = std::min(start + OBJCornerChunk, nCorners);
+			int v = (int)chunkVertex[chunk];
+			for (int64_t i = start; i < end; ++i) {
+				if (cornerFirst[i] != i) continue;
+				const OBJCorner& c = corners[i];
+				mesh->pStorage[v] = positions[c.p];
+				if (useUV) mesh->uvStorage[v] = uvs[c.uv];
+				if (useN) mesh->nStorage[v] = normals[c.n];
+				indices[i] = v++;
+			}
+		}, nChunks);
+		ParallelFor([&](int64_t chunk) {
+			int64_t start = chunk * OBJCornerChunk, end = std::min(start + OBJCornerChunk, nCorners);
+			for (int64_t i = start; i < end; ++i)
+				if (cornerFirst[i] != i) indices[i] = indices[cornerFirst[i]];
+		}, nChunks);
+	}
+
+	// OBJMesh Method Definitions
+	std::unique_ptr<OBJMesh> OBJMesh::Read(const std::string& filename) {
+		MappedFile file;
+		if (!file.Open(filename)) {
+			LOG(ERROR) << "Unable to read OBJ file \"" << filename << "\"";
+			return nullptr;
+		}
+		std::unique_ptr<OBJMesh> mesh(new OBJMesh);
+		mesh->fileSize = file.Size();
+		OBJReader reader;
+		reader.mesh = mesh.get();
+
+		// Chunks of whole lines
+		const char* begin = file.Data();
+		const char* end = begin + file.Size();
+		reader.chunkStart.push_back(begin);
+		while (reader.chunkStart.back() < end) {
+			const char* next = reader.chunkStart.back() +
+				std::min<ptrdiff_t>(OBJChunkBytes, end - reader.chunkStart.back());
+			next = std::find(next, end, '\n');
+			reader.chunkStart.push_back(next == end ? end : next + 1);
+		}
+		const int64_t nChunks = (int64_t)reader.chunkStart.size() - 1;
+
+		// Statements are counted first so that each chunk knows where its
+		// values go and what relative indices refer to
+		std::vector<OBJCounts>& base = reader.chunkBase;
+		base.resize(nChunks + 1);
+		ParallelFor([&](int64_t c) { base[c + 1] = reader.countChunk(c); }, nChunks);
+		for (int64_t c = 0; c < nChunks; ++c) {
+			base[c + 1].p += base[c].p;
+			base[c + 1].uv += base[c].uv;
+			base[c + 1].n += base[c].n;
+			base[c + 1].triangles += base[c].triangles;
+		}
+		const OBJCounts& totals = base.back();
+		if (totals.p > std::numeric_limits<int>::max() || totals.uv > std::numeric_limits<int>::max() ||
+			totals.n > std::numeric_limits<int>::max() || totals.triangles > std::numeric_limits<int>::max() / 3) {
+			LOG(ERROR) << "OBJ file \"" << filename << "\" is too large";
+			return nullptr;
+		}
+		reader.positions.reset(new Point3f[totals.p]);
+		reader.uvs.reset(new Point2f[totals.uv]);
+		reader.normals.reset(new Normal3f[totals.n]);
+		reader.corners.reset(new OBJCorner[3 * totals.triangles]);
+		std::atomic<bool> ok(true);
+		ParallelFor([&](int64_t c) {
+			if (!reader.parseChunk(c)) ok = false;
+		}, nChunks);
+		if (!ok) {
+			LOG(ERROR) << "OBJ file \"" << filename << "\" is malformed";
+			return nullptr;
+		}
+		if (totals.triangles == 0) {
+			LOG(ERROR) << "OBJ file \"" << filename << "\" has no faces";
+			return nullptr;
+		}
+		reader.buildMesh();
+		return mesh;
+	}
+
+	std::vector<std::shared_ptr<Shape>> CreateOBJMesh(const Transform& objectToWorld, bool reverseOrientation,
+		const ParamSet& ps) {
+		std::string filename = ps.FindOneString("filename", "");
+		std::unique_ptr<OBJMesh> mesh = OBJMesh::Read(filename);
+		if (!mesh) return {};
+		return CreateTriangleMesh(objectToWorld, reverseOrientation, mesh->nTriangles, mesh->vertexIndices,
+			mesh->nVertices, mesh->p, nullptr, mesh->n, mesh->uv, ps);
+	}
+
+}  // namespace pbr
@@ -0,0 +1,49 @@
+#ifndef SHAPES_OBJMESH_H
+#define SHAPES_OBJMESH_H
+
+#include "pbr.h"
+#include "geometry.h"
+
+namespace pbr {
+
+	// Triangle mesh read from a Wavefront OBJ file. The file is mapped and
+	// split into chunks of whole lines that are parsed in parallel, and
+	// polygons are split into triangle fans. Face corners with the same
+	// position, normal and uv indices become one vertex, found through a
+	// concurrent hash table; vertices are numbered in order of first use.
+	// Groups, objects, materials and lines are ignored.
+	class OBJMesh {
+	public:
+		// OBJMesh Public Methods
+		// nullptr, with the reason logged, if the file can't be read
+		static std::unique_ptr<OBJMesh> Read(const std::string& filename);
+		size_t FileSize() const { return fileSize; }
+
+		// OBJMesh Public Data
+		int nTriangles = 0, nVertices = 0;
+		const int* vertexIndices = nullptr;
+		const Point3f* p = nullptr;
+		// nullptr unless every face corner has a normal, or a uv
+		const Normal3f* n = nullptr;
+		const Point2f* uv = nullptr;
+
+	private:
+		friend struct OBJReader;
+
+		// OBJMesh Private Data
+		size_t fileSize = 0;
+		std::unique_ptr<int[]> indexStorage;
+		std::unique_ptr<Point3f[]> pStorage;
+		std::unique_ptr<Normal3f[]> nStorage;
+		std::unique_ptr<Point2f[]> uvStorage;
+	};
+
+	// The "objmesh" shape. Supported parameters: "filename" (string) and
+	// those of CreateTriangleMesh(); placed in the world as
+	// CreateTriangleMesh() does
+	std::vector<std::shared_ptr<Shape>> CreateOBJMesh(const Transform& objectToWorld, bool reverseOrientation,
+		const ParamSet& ps);
+
+}  // namespace pbr
+
+#endif  // SHAPES_OBJMESH_H
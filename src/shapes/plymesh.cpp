@@ -0,0 +1,587 @@
+#include "shapes/plymesh.h"
+#include "shapes/triangle.h"
+#include "paramset.h"
+#include "parallel.h"
+#include "stringutil.h"
+#include <atomic>
+#include <sstream>
+
+namespace pbr {
+
+	// PLYMesh Local Definitions
+	enum class PLYFormat { ASCII, BinaryLittleEndian, BinaryBigEndian };
+	enum class PLYType { Int8, UInt8, Int16, UInt16, Int32, UInt32, Float32, Float64 };
+
+	struct PLYProperty {
+		std::string name;
+		PLYType type;
+		// Lists store their length as countType, then that many values of type
+		bool isList = false;
+		PLYType countType = PLYType::UInt8;
+	};
+
+	struct PLYElement {
+		std::string name;
+		int64_t count = 0;
+		std::vector<PLYProperty> properties;
+		// Bytes per binary element, or 0 if it has a list
+		int stride = 0;
+	};
+
+	// Vertices and faces per parallel chunk, and bytes per ASCII chunk
+	static const int64_t PLYChunkItems = 1 << 16;
+	static const int64_t PLYASCIIChunkBytes = 1 << 20;
+
+	// Vertex Floats in PLYMesh order: x, y, z, nx, ny, nz, u, v
+	static const int PLYVertexFloats = 8;
+
+	static bool ParsePLYType(const std::string& name, PLYType* type) {
+		static const struct {
+			const char* name;
+			PLYType type;
+		} types[] = {
+			{ "char", PLYType::Int8 }, { "int8", PLYType::Int8 }, { "uchar", PLYType::UInt8 },
+			{ "uint8", PLYType::UInt8 }, { "short", PLYType::Int16 }, { "int16", PLYType::Int16 },
+			{ "ushort", PLYType::UInt16 }, { "uint16", PLYType::UInt16 }, { "int", PLYType::Int32 },
+			{ "int32", PLYType::Int32 }, { "uint", PLYType::UInt32 }, { "uint32", PLYType::UInt32 },
+			{ "float", PLYType::Float32 }, { "float32", PLYType::Float32 }, { "double", PLYType::Float64 },
+			{ "float64", PLYType::Float64 },
+		};
+		for (const auto& t : types)
+			if (name == t.name) {
+				*type = t.type;
+				return true;
+			}
+		return false;
+	}
+
+	static int PLYTypeSize(PLYType type) {
+		switch (type) {
+		case PLYType::Int8: case PLYType::UInt8: return 1;
+		case PLYType::Int16: case PLYType::UInt16: return 2;
+		case PLYType::Float64: return 8;
+		default: return 4;
+		}
+	}
+
+	template <typename T> inline T LoadPLY(const char* p, bool swap) {
+		T v;
+		if (!swap)
+			memcpy(&v, p, sizeof(T));
+		else {
+			char bytes[sizeof(T)];
+			for (size_t i = 0; i < sizeof(T); ++i) bytes[i] = p[sizeof(T) - 1 - i];
+			memcpy(&v, bytes, sizeof(T));
+		}
+		return v;
+	}
+
+	static inline double LoadPLYValue(const char* p, PLYType type, bool swap) {
+		switch (type) {
+		case PLYType::Int8: return LoadPLY<int8_t>(p, swap);
+		case PLYType::UInt8: return LoadPLY<uint8_t>(p, swap);
+		case PLYType::Int16: return LoadPLY<int16_t>(p, swap);
+		case PLYType::UInt16: return LoadPLY<uint16_t>(p, swap);
+		case PLYType::Int32: return LoadPLY<int32_t>(p, swap);
+		case PLYType::UInt32: return LoadPLY<uint32_t>(p, swap);
+		case PLYType::Float32: return LoadPLY<float>(p, swap);
+		default: return LoadPLY<double>(p, swap);
+		}
+	}
+
+	static inline int64_t LoadPLYInt(const char* p, PLYType type, bool swap) {
+		switch (type) {
+		case PLYType::Int8: return LoadPLY<int8_t>(p, swap);
+		case PLYType::UInt8: return LoadPLY<uint8_t>(p, swap);
+		case PLYType::Int16: return LoadPLY<int16_t>(p, swap);
+		case PLYType::UInt16: return LoadPLY<uint16_t>(p, swap);
+		case PLYType::Int32: return LoadPLY<int32_t>(p, swap);
+		case PLYType::UInt32: return LoadPLY<uint32_t>(p, swap);
+		default: return (int64_t)LoadPLYValue(p, type, swap);
+		}
+	}
+
+	// Parses the header at data, returning the start of the body or nullptr
+	static const char* ParsePLYHeader(const char* data, size_t size, PLYFormat* format,
+		std::vector<PLYElement>* elements) {
+		static const char endHeader[] = "end_header";
+		const char* end = data + size;
+		const char* headerEnd = std::search(data, end, endHeader, endHeader + sizeof(endHeader) - 1);
+		if (headerEnd == end || size < 4 || memcmp(data, "ply", 3) != 0) return nullptr;
+		const char* body = std::find(headerEnd, end, '\n');
+		body = body == end ? end : body + 1;
+
+		std::istringstream header(std::string(data, headerEnd));
+		std::string line;
+		bool hasFormat = false;
+		std::getline(header, line);
+		while (std::getline(header, line)) {
+			std::istringstream tokens(line);
+			std::string keyword;
+			if (!(tokens >> keyword) || keyword == "comment" || keyword == "obj_info") continue;
+			if (keyword == "format") {
+				std::string name;
+				tokens >> name;
+				if (name == "ascii")
+					*format = PLYFormat::ASCII;
+				else if (name == "binary_little_endian")
+					*format = PLYFormat::BinaryLittleEndian;
+				else if (name == "binary_big_endian")
+					*format = PLYFormat::BinaryBigEndian;
+				else
+					return nullptr;
+				hasFormat = true;
+			} else if (keyword == "element") {
+				PLYElement element;
+				if (!(tokens >> element.name >> element.count) || element.count < 0) return nullptr;
+				elements->push_back(element);
+			} else if (keyword == "property") {
+				if (elements->empty()) return nullptr;
+				PLYProperty prop;
+				std::string type;
+				if (!(tokens >> type)) return nullptr;
+				if (type == "list") {
+					std::string countType;
+					prop.isList = true;
+					if (!(tokens >> countType >> type) || !ParsePLYType(countType, &prop.countType)) return nullptr;
+				}
+				if (!(tokens >> prop.name) || !ParsePLYType(type, &prop.type)) return nullptr;
+				elements->back().properties.push_back(prop);
+			} else
+				return nullptr;
+		}
+		if (!hasFormat) return nullptr;
+		for (PLYElement& e : *elements) {
+			e.stride = 0;
+			for (const PLYProperty& prop : e.properties) {
+				if (prop.isList) {
+					e.stride = 0;
+					break;
+				}
+				e.stride += PLYTypeSize(prop.type);
+			}
+		}
+		return body;
+	}
+
+	// The vertex property each of the vertex Floats comes from, or -1
+	static void PLYVertexProperties(const PLYElement& vertex, int prop[PLYVertexFloats]) {
+		static const char* names[][PLYVertexFloats] = {
+			{ "x", "y", "z", "nx", "ny", "nz", "u", "v" },
+			{ nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, "s", "t" },
+			{ nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, "texture_u", "texture_v" },
+			{ nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, "texture_s", "texture_t" },
+		};
+		for (int k = 0; k < PLYVertexFloats; ++k) {
+			prop[k] = -1;
+			for (size_t i = 0; i < vertex.properties.size() && prop[k] < 0; ++i)
+				for (const auto& alias : names)
+					if (alias[k] && vertex.properties[i].name == alias[k] && !vertex.properties[i].isList)
+						prop[k] = (int)i;
+		}
+		// Normals and uvs are all or nothing
+		if (prop[3] < 0 || prop[4] < 0 || prop[5] < 0) prop[3] = prop[4] = prop[5] = -1;
+		if (prop[6] < 0 || prop[7] < 0) prop[6] = prop[7] = -1;
+	}
+
+	// Parses one binary element from [p, end); its list of vertex indices,
+	// if indexProp names one, is written as a triangle fan at indices when
+	// non-null and its triangle count added to *nTriangles. Returns the end
+	// of the element or nullptr if it's malformed.
+	static const char* ParseBinaryElement(const char* p, const char* end, const PLYElement& element,
+		int indexProp, bool swap, int* indices, int64_t* nTriangles) {
+		for (size_t i = 0; i < element.properties.size(); ++i) {
+			const PLYProperty& prop = element.properties[i];
+			int size = PLYTypeSize(prop.type);
+			if (!prop.isList) {
+				if (end - p < size) return nullptr;
+				p += size;
+				continue;
+			}
+			int countSize = PLYTypeSize(prop.countType);
+			if (end - p < countSize) return nullptr;
+			int64_t count = LoadPLYInt(p, prop.countType, swap);
+			p += countSize;
+			if (count < 0 || (end - p) / size < count) return nullptr;
+			if ((int)i == indexProp && count >= 3) {
+				if (indices) {
+					int v0 = (int)LoadPLYInt(p, prop.type, swap), prev = (int)LoadPLYInt(p + size, prop.type, swap);
+					for (int64_t k = 2; k < count; ++k) {
+						int v = (int)LoadPLYInt(p + k * size, prop.type, swap);
+						*indices++ = v0;
+						*indices++ = prev;
+						*indices++ = v;
+						prev = v;
+					}
+				}
+				*nTriangles += count - 2;
+			}
+			p += count * size;
+		}
+		return p;
+	}
+
+	static inline const char* SkipBlanks(const char* p, const char* end) {
+		while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) ++p;
+		return p;
+	}
+
+	// ASCII counterpart of ParseBinaryElement() for the line at p
+	static const char* ParseASCIIElement(const char* p, const char* end, const PLYElement& element,
+		int indexProp, int* indices, int64_t* nTriangles) {
+		for (size_t i = 0; i < element.properties.size(); ++i) {
+			const PLYProperty& prop = element.properties[i];
+			double value;
+			int64_t count = 1;
+			if (prop.isList && !(p = ParseInt(SkipBlanks(p, end), end, &count))) return nullptr;
+			if ((int)i == indexProp && count >= 3) {
+				*nTriangles += count - 2;
+				// Counting needs nothing past the last property's length
+				if (!indices && i + 1 == element.properties.size()) return p;
+				int64_t v0 = 0, prev = 0, v;
+				for (int64_t k = 0; k < count; ++k) {
+					if (!(p = ParseInt(SkipBlanks(p, end), end, &v))) return nullptr;
+					if (k == 0)
+						v0 = v;
+					else if (k >= 2 && indices) {
+						*indices++ = (int)v0;
+						*indices++ = (int)prev;
+						*indices++ = (int)v;
+					}
+					prev = v;
+				}
+			} else
+				for (int64_t k = 0; k < count; ++k)
+					if (!(p = ParseFloat(SkipBlanks(p, end), end, &value))) return nullptr;
+		}
+		return p;
+	}
+
+	static int FaceIndexProperty(const PLYElement& face) {
+		for (size_t i = 0; i < face.properties.size(); ++i)
+			if (face.properties[i].isList &&
+				(face.properties[i].name == "vertex_indices" || face.properties[i].name == "vertex_index"))
+				return (int)i;
+		return -1;
+	}
+
+	// PLYReader Definitions
+
+	// Parsing state of one PLY file as it fills in a PLYMesh
+	struct PLYReader {
+		// PLYReader Methods
+		bool readBinary(const char* body);
+		bool readASCII(const char* body);
+		bool parseASCIIVertex(const char* p, const char* eol, int64_t i) const;
+		void storeVertex(int64_t i, const Float f[PLYVertexFloats]) const {
+			if (mesh->pStorage) mesh->pStorage[i] = Point3f(f[0], f[1], f[2]);
+			if (mesh->nStorage) mesh->nStorage[i] = Normal3f(f[3], f[4], f[5]);
+			if (mesh->uvStorage) mesh->uvStorage[i] = Point2f(f[6], f[7]);
+		}
+		bool allocateIndices(int64_t nTriangles) {
+			if (nTriangles > std::numeric_limits<int>::max() / 3) return false;
+			mesh->nTriangles = (int)nTriangles;
+			mesh->indexStorage.reset(new int[3 * nTriangles]);
+			mesh->vertexIndices = mesh->indexStorage.get();
+			return true;
+		}
+		void allocatePositions() {
+			mesh->pStorage.reset(new Point3f[mesh->nVertices]);
+			mesh->p = mesh->pStorage.get();
+		}
+
+		// PLYReader Data
+		PLYMesh* mesh;
+		const char* end;
+		std::vector<PLYElement> elements;
+		const PLYElement* vertex;
+		const PLYElement* face;
+		int vertexElement, faceElement;
+		// Property of each vertex Float, the vertex Float of each property
+		// (or -1), and the face's vertex index list
+		int vertexProp[PLYVertexFloats];
+		std::vector<int> propTarget;
+		int indexProp;
+		bool swap = false;
+	};
+
+	bool PLYReader::readBinary(const char* body) {
+		// Find where the vertices and faces start; elements with lists have
+		// to be walked
+		const char* vertexData = nullptr;
+		const char* faceData = nullptr;
+		const char* p = body;
+		for (size_t e = 0; e < elements.size(); ++e) {
+			if ((int)e == vertexElement) vertexData = p;
+			if ((int)e == faceElement) faceData = p;
+			if (vertexData && faceData) break;
+			const PLYElement& element = elements[e];
+			if (element.stride > 0) {
+				if ((end - p) / element.stride < element.count) return false;
+				p += element.count * element.stride;
+			} else {
+				int64_t nTriangles = 0;
+				for (int64_t i = 0; i < element.count && p; ++i)
+					p = ParseBinaryElement(p, end, element, -1, swap, nullptr, &nTriangles);
+				if (!p) return false;
+			}
+		}
+		const int64_t nVertices = mesh->nVertices, nFaces = face->count;
+		if ((end - vertexData) / vertex->stride < nVertices) return false;
+
+		// Vertices; positions alone in Float layout are used in place
+		PLYType floatType = sizeof(Float) == sizeof(float) ? PLYType::Float32 : PLYType::Float64;
+		int propOffset[PLYVertexFloats];
+		bool allFloat = !swap;
+		for (int k = 0; k < PLYVertexFloats; ++k) {
+			propOffset[k] = 0;
+			if (vertexProp[k] < 0) continue;
+			for (int i = 0; i < vertexProp[k]; ++i) propOffset[k] += PLYTypeSize(vertex->properties[i].type);
+			if (vertex->properties[vertexProp[k]].type != floatType) allFloat = false;
+		}
+		static_assert(sizeof(Point3f) == 3 * sizeof(Float), "Point3f is not tightly packed");
+		if (allFloat && vertex->properties.size() == 3 && vertexProp[0] == 0 && vertexProp[1] == 1 &&
+			vertexProp[2] == 2 && (uintptr_t)vertexData % alignof(Point3f) == 0)
+			mesh->p = (const Point3f*)vertexData;
+		else {
+			allocatePositions();
+			ParallelFor([&](int64_t chunk) {
+				int64_t start = chunk * PLYChunkItems, chunkEnd = std::min(start + PLYChunkItems, nVertices);
+				Float f[PLYVertexFloats] = {};
+				for (int64_t i = start; i < chunkEnd; ++i) {
+					const char* v = vertexData + i * vertex->stride;
+					for (int k = 0; k < PLYVertexFloats; ++k) {
+						if (vertexProp[k] < 0) continue;
+						if (allFloat)
+							memcpy(&f[k], v + propOffset[k], sizeof(Float));
+						else
+							f[k] = (Float)LoadPLYValue(v + propOffset[k], vertex->properties[vertexProp[k]].type, swap);
+					}
+					storeVertex(i, f);
+				}
+			}, (nVertices + PLYChunkItems - 1) / PLYChunkItems);
+		}
+
+		// Faces, assuming first that they're all triangles so that each
+		// chunk's start is known; if not, a serial walk finds the starts
+		const int64_t nChunks = (nFaces + PLYChunkItems - 1) / PLYChunkItems;
+		int triangleStride = 0, countOffset = 0;
+		bool oneList = true;
+		for (size_t i = 0; i < face->properties.size(); ++i) {
+			const PLYProperty& prop = face->properties[i];
+			if ((int)i < indexProp) countOffset += PLYTypeSize(prop.type);
+			if (prop.isList && (int)i != indexProp) oneList = false;
+			triangleStride += prop.isList ? PLYTypeSize(prop.countType) + 3 * PLYTypeSize(prop.type)
+				: PLYTypeSize(prop.type);
+		}
+		const PLYType countType = face->properties[indexProp].countType, indexType = face->properties[indexProp].type;
+		if (oneList && (end - faceData) / triangleStride >= nFaces) {
+			if (!allocateIndices(nFaces)) return false;
+			// 32-bit indices in host order are copied as they are
+			bool copyIndices = !swap && (indexType == PLYType::Int32 || indexType == PLYType::UInt32);
+			int indicesOffset = countOffset + PLYTypeSize(countType);
+			std::atomic<bool> allTriangles(true);
+			ParallelFor([&](int64_t chunk) {
+				int64_t start = chunk * PLYChunkItems, chunkEnd = std::min(start + PLYChunkItems, nFaces);
+				for (int64_t i = start; i < chunkEnd; ++i) {
+					const char* f = faceData + i * triangleStride;
+					int64_t n = 0;
+					if (LoadPLYInt(f + countOffset, countType, swap) != 3) {
+						allTriangles = false;
+						return;
+					}
+					if (copyIndices)
+						memcpy(&mesh->indexStorage[3 * i], f + indicesOffset, 3 * sizeof(int));
+					else
+						ParseBinaryElement(f, end, *face, indexProp, swap, &mesh->indexStorage[3 * i], &n);
+				}
+			}, nChunks);
+			if (allTriangles) return true;
+		}
+
+		std::vector<const char*> chunkStart(nChunks);
+		std::vector<int64_t> chunkTriangle(nChunks);
+		int64_t nTriangles = 0;
+		p = faceData;
+		for (int64_t i = 0; i < nFaces; ++i) {
+			if (i % PLYChunkItems == 0) {
+				chunkStart[i / PLYChunkItems] = p;
+				chunkTriangle[i / PLYChunkItems] = nTriangles;
+			}
+			if (!(p = ParseBinaryElement(p, end, *face, indexProp, swap, nullptr, &nTriangles))) return false;
+		}
+		if (!allocateIndices(nTriangles)) return false;
+		ParallelFor([&](int64_t chunk) {
+			int64_t start = chunk * PLYChunkItems, chunkEnd = std::min(start + PLYChunkItems, nFaces);
+			const char* f = chunkStart[chunk];
+			int* indices = &mesh->indexStorage[3 * chunkTriangle[chunk]];
+			int64_t n = 0;
+			for (int64_t i = start; i < chunkEnd; ++i)
+				f = ParseBinaryElement(f, end, *face, indexProp, swap, indices + 3 * n, &n);
+		}, nChunks);
+		return true;
+	}
+
+	bool PLYReader::parseASCIIVertex(const char* p, const char* eol, int64_t i) const {
+		Float f[PLYVertexFloats] = {};
+		for (size_t j = 0; j < vertex->properties.size(); ++j) {
+			double value;
+			if (!(p = ParseFloat(SkipBlanks(p, eol), eol, &value))) return false;
+			if (propTarget[j] >= 0) f[propTarget[j]] = (Float)value;
+		}
+		storeVertex(i, f);
+		return true;
+	}
+
+	bool PLYReader::readASCII(const char* body) {
+		// Chunks of whole lines and the index of each one's first line
+		std::vector<const char*> chunkStart(1, body);
+		while (chunkStart.back() < end) {
+			const char* next = chunkStart.back() + std::min<ptrdiff_t>(PLYASCIIChunkBytes, end - chunkStart.back());
+			next = std::find(next, end, '\n');
+			chunkStart.push_back(next == end ? end : next + 1);
+		}
+		const int64_t nChunks = (int64_t)chunkStart.size() - 1;
+		std::vector<int64_t> chunkLine(nChunks + 1, 0);
+		ParallelFor([&](int64_t c) { chunkLine[c + 1] = std::count(chunkStart[c], chunkStart[c + 1], '\n'); },
+			nChunks);
+		for (int64_t c = 0; c < nChunks; ++c) chunkLine[c + 1] += chunkLine[c];
+		int64_t nLines = chunkLine[nChunks] + (end > body && end[-1] != '\n');
+
+		// Elements take one line each, in order
+		int64_t line = 0, vertexLine = 0, faceLine = 0;
+		for (size_t e = 0; e < elements.size(); ++e) {
+			if ((int)e == vertexElement) vertexLine = line;
+			if ((int)e == faceElement) faceLine = line;
+			line += elements[e].count;
+		}
+		const int64_t nVertices = mesh->nVertices, nFaces = face->count;
+		if (nLines < vertexLine + nVertices || nLines < faceLine + nFaces) return false;
+
+		// Calls func(lineIndex, begin, end) for each line of the chunk within
+		// [first, first + count), stopping if it returns false
+		auto forLines = [&](int64_t c, int64_t first, int64_t count,
+			const std::function<bool(int64_t, const char*, const char*)>& func) {
+			const char* chunkEnd = chunkStart[c + 1];
+			int64_t line = chunkLine[c];
+			if (line >= first + count || chunkLine[c + 1] < first) return true;
+			for (const char* p = chunkStart[c]; p < chunkEnd && line < first + count; ++line) {
+				const char* eol = (const char*)memchr(p, '\n', chunkEnd - p);
+				if (!eol) eol = chunkEnd;
+				if (line >= first && !func(line, p, eol)) return false;
+				p = eol + (eol < chunkEnd);
+			}
+			return true;
+		};
+
+		// Vertices, and the triangles in each chunk's faces
+		allocatePositions();
+		std::atomic<bool> ok(true);
+		std::vector<int64_t> chunkTriangle(nChunks + 1, 0);
+		ParallelFor([&](int64_t c) {
+			int64_t nTriangles = 0;
+			if (!forLines(c, vertexLine, nVertices, [&](int64_t line, const char* p, const char* eol) {
+					return parseASCIIVertex(p, eol, line - vertexLine);
+				}) ||
+				!forLines(c, faceLine, nFaces, [&](int64_t, const char* p, const char* eol) {
+					return ParseASCIIElement(p, eol, *face, indexProp, nullptr, &nTriangles) != nullptr;
+				}))
+				ok = false;
+			chunkTriangle[c + 1] = nTriangles;
+		}, nChunks);
+		if (!ok) return false;
+		for (int64_t c = 0; c < nChunks; ++c) chunkTriangle[c + 1] += chunkTriangle[c];
+
+		if (!allocateIndices(chunkTriangle[nChunks])) return false;
+		ParallelFor([&](int64_t c) {
+			int* indices = &mesh->indexStorage[3 * chunkTriangle[c]];
+			int64_t n = 0;
+			forLines(c, faceLine, nFaces, [&](int64_t, const char* p, const char* eol) {
+				return ParseASCIIElement(p, eol, *face, indexProp, indices + 3 * n, &n) != nullptr;
+			});
+		}, nChunks);
+		return true;
+	}
+
+	// PLYMesh Method Definitions
+	std::unique_ptr<PLYMesh> PLYMesh::Read(const std::string& filename) {
+		std::unique_ptr<PLYMesh> mesh(new PLYMesh);
+		if (!mesh->file.Open(filename)) {
+			LOG(ERROR) << "Unable to read PLY file \"" << filename << "\"";
+			return nullptr;
+		}
+		PLYReader reader;
+		reader.mesh = mesh.get();
+		reader.end = mesh->file.Data() + mesh->file.Size();
+		PLYFormat format;
+		const char* body = ParsePLYHeader(mesh->file.Data(), mesh->file.Size(), &format, &reader.elements);
+		if (!body) {
+			LOG(ERROR) << "Invalid PLY header in \"" << filename << "\"";
+			return nullptr;
+		}
+		reader.vertexElement = reader.faceElement = -1;
+		for (size_t e = 0; e < reader.elements.size(); ++e) {
+			if (reader.elements[e].name == "vertex" && reader.vertexElement < 0) reader.vertexElement = (int)e;
+			if (reader.elements[e].name == "face" && reader.faceElement < 0) reader.faceElement = (int)e;
+		}
+		if (reader.vertexElement >= 0) PLYVertexProperties(reader.elements[reader.vertexElement], reader.vertexProp);
+		if (reader.vertexElement < 0 || reader.vertexProp[0] < 0 || reader.vertexProp[1] < 0 ||
+			reader.vertexProp[2] < 0 || reader.elements[reader.vertexElement].stride == 0 ||
+			reader.faceElement < 0 || FaceIndexProperty(reader.elements[reader.faceElement]) < 0) {
+			LOG(ERROR) << "PLY file \"" << filename << "\" lacks vertex positions or face vertex indices";
+			return nullptr;
+		}
+		reader.vertex = &reader.elements[reader.vertexElement];
+		reader.face = &reader.elements[reader.faceElement];
+		reader.indexProp = FaceIndexProperty(*reader.face);
+		reader.propTarget.assign(reader.vertex->properties.size(), -1);
+		for (int k = 0; k < PLYVertexFloats; ++k)
+			if (reader.vertexProp[k] >= 0) reader.propTarget[reader.vertexProp[k]] = k;
+		if (reader.vertex->count > std::numeric_limits<int>::max()) {
+			LOG(ERROR) << "PLY file \"" << filename << "\" has too many vertices";
+			return nullptr;
+		}
+		mesh->nVertices = (int)reader.vertex->count;
+		if (reader.vertexProp[3] >= 0) {
+			mesh->nStorage.reset(new Normal3f[mesh->nVertices]);
+			mesh->n = mesh->nStorage.get();
+		}
+		if (reader.vertexProp[6] >= 0) {
+			mesh->uvStorage.reset(new Point2f[mesh->nVertices]);
+			mesh->uv = mesh->uvStorage.get();
+		}
+
+		bool ok;
+		if (format == PLYFormat::ASCII)
+			ok = reader.readASCII(body);
+		else {
+			uint16_t one = 1;
+			bool hostLittleEndian = *(const uint8_t*)&one == 1;
+			reader.swap = (format == PLYFormat::BinaryLittleEndian) != hostLittleEndian;
+			ok = reader.readBinary(body);
+		}
+		if (!ok) {
+			LOG(ERROR) << "PLY file \"" << filename << "\" is truncated or malformed";
+			return nullptr;
+		}
+		return mesh;
+	}
+
+	std::vector<std::shared_ptr<Shape>> CreatePLYMesh(const ParamSet& ps) {
+		std::string filename = ps.FindOneString("filename", "");
+		std::unique_ptr<PLYMesh> mesh = PLYMesh::Read(filename);
+		if (!mesh) return {};
+		return CreateTriangleMesh(mesh->nTriangles, mesh->vertexIndices, mesh->nVertices, mesh->p, nullptr,
+			mesh->n, mesh->uv, ps);
+	}
+
+	std::vector<std::shared_ptr<Shape>> CreatePLYMesh(const Transform& objectToWorld, bool reverseOrientation,
+		const ParamSet& ps) {
+		std::string filename = ps.FindOneString("filename", "");
+		std::unique_ptr<PLYMesh> mesh = PLYMesh::Read(filename);
+		if (!mesh) return {};
+		return CreateTriangleMesh(objectToWorld, reverseOrientation, mesh->nTriangles, mesh->vertexIndices,
+			mesh->nVertices, mesh->p, nullptr, mesh->n, mesh->uv, ps);
+	}
+
+}  // namespace pbr
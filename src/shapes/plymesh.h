@@ -0,0 +1,50 @@
+#ifndef SHAPES_PLYMESH_H
+#define SHAPES_PLYMESH_H
+
+#include "pbr.h"
+#include "geometry.h"
+#include "fileutil.h"
+
+namespace pbr {
+
+	// Triangle mesh read from a PLY file. The file is mapped and its vertex
+	// and face blocks parsed in parallel chunks straight into the arrays
+	// below; binary positions already laid out as Point3f are used in place
+	// from the mapping. Polygons are split into triangle fans.
+	class PLYMesh {
+	public:
+		// PLYMesh Public Methods
+		// nullptr, with the reason logged, if the file can't be read
+		static std::unique_ptr<PLYMesh> Read(const std::string& filename);
+		bool PositionsMapped() const { return p && !pStorage; }
+		size_t FileSize() const { return file.Size(); }
+
+		// PLYMesh Public Data
+		int nTriangles = 0, nVertices = 0;
+		const int* vertexIndices = nullptr;
+		const Point3f* p = nullptr;
+		// nullptr unless the file has all of nx, ny and nz, or u and v
+		const Normal3f* n = nullptr;
+		const Point2f* uv = nullptr;
+
+	private:
+		friend struct PLYReader;
+
+		// PLYMesh Private Data
+		MappedFile file;
+		std::unique_ptr<int[]> indexStorage;
+		std::unique_ptr<Point3f[]> pStorage;
+		std::unique_ptr<Normal3f[]> nStorage;
+		std::unique_ptr<Point2f[]> uvStorage;
+	};
+
+	// Supported parameters: "filename" (string) and those of
+	// CreateTriangleMesh()
+	std::vector<std::shared_ptr<Shape>> CreatePLYMesh(const ParamSet& ps);
+	// As above, placed in the world as CreateTriangleMesh() does
+	std::vector<std::shared_ptr<Shape>> CreatePLYMesh(const Transform& objectToWorld, bool reverseOrientation,
+		const ParamSet& ps);
+
+}  // namespace pbr
+
+#endif  // SHAPES_PLYMESH_H
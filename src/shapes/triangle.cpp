@@ -0,0 +1,560 @@
+#include "shapes/triangle.h"
+#include "interaction.h"
+#include "paramset.h"
+#include "parallel.h"
+#include "accelerators/bvh.h"
+
+namespace pbr {
+
+	// TriangleMesh Local Definitions
+	struct TriangleMeshFileHeader {
+		char magic[8];
+		uint32_t version;
+		uint32_t floatBytes;
+		int32_t nTriangles, nVertices;
+		// TriangleMeshFileAttribute flags of the arrays present
+		uint32_t attributes;
+		uint32_t pad;
+		double bounds[6];
+	};
+
+	enum TriangleMeshFileAttribute : uint32_t { HasS = 1, HasN = 2, HasUV = 4 };
+
+	static const char TriangleMeshFileMagic[8] = { 'P', 'B', 'R', 'M', 'E', 'S', 'H', '\0' };
+	static const uint32_t TriangleMeshFileVersion = 1;
+
+	// Offsets of the index, position, tangent, normal and uv arrays, with
+	// the file size as the last entry; absent arrays are empty
+	static std::vector<uint64_t> TriangleMeshFileOffsets(int nTriangles, int nVertices, uint32_t attributes) {
+		std::vector<uint64_t> offsets(1, sizeof(TriangleMeshFileHeader));
+		offsets.push_back(offsets.back() + (uint64_t)3 * nTriangles * sizeof(int32_t));
+		offsets.push_back(offsets.back() + (uint64_t)nVertices * sizeof(Point3f));
+		offsets.push_back(offsets.back() + ((attributes & HasS) ? (uint64_t)nVertices * sizeof(Vector3f) : 0));
+		offsets.push_back(offsets.back() + ((attributes & HasN) ? (uint64_t)nVertices * sizeof(Normal3f) : 0));
+		offsets.push_back(offsets.back() + ((attributes & HasUV) ? (uint64_t)nVertices * sizeof(Point2f) : 0));
+		return offsets;
+	}
+
+	TriangleMeshStorage TriangleMeshStorageParams(const ParamSet& ps) {
+		TriangleMeshStorage storage;
+		storage.compressNormals = ps.FindOneBool("compressnormals", false);
+		storage.compressTangents = ps.FindOneBool("compresstangents", false);
+		std::string uvEncoding = ps.FindOneString("uvencoding", "float");
+		if (uvEncoding == "half")
+			storage.uvEncoding = UVEncoding::Half;
+		else if (uvEncoding == "unorm16")
+			storage.uvEncoding = UVEncoding::Unorm16;
+		else if (uvEncoding != "float")
+			LOG(WARNING) << "uvencoding \"" << uvEncoding << "\" unknown.  Using \"float\".";
+		return storage;
+	}
+
+	// TriangleMesh Method Definitions
+	TriangleMesh::TriangleMesh(int nTriangles, const int* vertexIndices, int nVertices, const Point3f* P,
+		const Vector3f* S, const Normal3f* N, const Point2f* UV, const TriangleMeshStorage& storage)
+		: nTriangles(nTriangles), nVertices(nVertices),
+		vertexIndices(vertexIndices, vertexIndices + 3 * nTriangles) {
+		p.reset(new Point3f[nVertices]);
+		std::copy(P, P + nVertices, p.get());
+		if (N) {
+			if (storage.compressNormals) {
+				cn.reset(new CompressedNormal[nVertices]);
+				EncodeNormals(N, nVertices, cn.get());
+			} else {
+				n.reset(new Normal3f[nVertices]);
+				std::copy(N, N + nVertices, n.get());
+			}
+		}
+		if (S) {
+			if (storage.compressTangents) {
+				// Tangents are stored normalized, which is exact for the usual
+				// unit-length input
+				cs.reset(new CompressedNormal[nVertices]);
+				for (int i = 0; i < nVertices; ++i) cs[i] = CompressedNormal(S[i]);
+			} else {
+				s.reset(new Vector3f[nVertices]);
+				std::copy(S, S + nVertices, s.get());
+			}
+		}
+		if (UV) {
+			uvEncoding = storage.uvEncoding;
+			if (uvEncoding == UVEncoding::Float) {
+				uv.reset(new Point2f[nVertices]);
+				std::copy(UV, UV + nVertices, uv.get());
+			} else if (uvEncoding == UVEncoding::Half) {
+				quv.reset(new uint16_t[2 * nVertices]);
+				for (int i = 0; i < nVertices; ++i) {
+					quv[2 * i] = FloatToHalf((float)UV[i].x);
+					quv[2 * i + 1] = FloatToHalf((float)UV[i].y);
+				}
+			} else {
+				uvBounds = Bounds2f(UV[0]);
+				for (int i = 1; i < nVertices; ++i) uvBounds = Union(uvBounds, UV[i]);
+				quv.reset(new uint16_t[2 * nVertices]);
+				for (int i = 0; i < nVertices; ++i) {
+					Vector2f o = uvBounds.Offset(UV[i]);
+					quv[2 * i] = (uint16_t)std::nearbyint(Clamp(o.x, 0, 1) * 65535);
+					quv[2 * i + 1] = (uint16_t)std::nearbyint(Clamp(o.y, 0, 1) * 65535);
+				}
+			}
+		}
+	}
+
+	size_t TriangleMesh::BytesUsed() const {
+		size_t bytes = vertexIndices.size() * sizeof(int) + nVertices * sizeof(Point3f);
+		if (n) bytes += nVertices * sizeof(Normal3f);
+		if (cn) bytes += nVertices * sizeof(CompressedNormal);
+		if (s) bytes += nVertices * sizeof(Vector3f);
+		if (cs) bytes += nVertices * sizeof(CompressedNormal);
+		if (uv) bytes += nVertices * sizeof(Point2f);
+		if (quv) bytes += 2 * nVertices * sizeof(uint16_t);
+		return bytes;
+	}
+
+	// Triangle Method Definitions
+	Bounds3f Triangle::WorldBound() const {
+		const Point3f& p0 = mesh->p[v[0]];
+		const Point3f& p1 = mesh->p[v[1]];
+		const Point3f& p2 = mesh->p[v[2]];
+		return Union(Bounds3f(p0, p1), p2);
+	}
+
+	// Watertight ray-triangle test of Woop et al. (2013) with the error
+	// bounds of pbrt-v3, section 3.9.
+	bool Triangle::HitTest(const Ray& ray, Float* tHit, Float b[3]) const {
+		// Get triangle vertices in _p0_, _p1_, and _p2_
+		const Point3f& p0 = mesh->p[v[0]];
+		const Point3f& p1 = mesh->p[v[1]];
+		const Point3f& p2 = mesh->p[v[2]];
+
+		// Translate vertices based on ray origin
+		Point3f p0t = p0 - Vector3f(ray.o);
+		Point3f p1t = p1 - Vector3f(ray.o);
+		Point3f p2t = p2 - Vector3f(ray.o);
+
+		// Permute components of triangle vertices and ray direction
+		int kz = MaxDimension(Abs(ray.d));
+		int kx = kz + 1;
+		if (kx == 3) kx = 0;
+		int ky = kx + 1;
+		if (ky == 3) ky = 0;
+		Vector3f d = Permute(ray.d, kx, ky, kz);
+		p0t = Permute(p0t, kx, ky, kz);
+		p1t = Permute(p1t, kx, ky, kz);
+		p2t = Permute(p2t, kx, ky, kz);
+
+		// Apply shear transformation to translated vertex positions
+		Float Sx = -d.x / d.z;
+		Float Sy = -d.y / d.z;
+		Float Sz = 1.f / d.z;
+		p0t.x += Sx * p0t.z;
+		p0t.y += Sy * p0t.z;
+		p1t.x += Sx * p1t.z;
+		p1t.y += Sy * p1t.z;
+		p2t.x += Sx * p2t.z;
+		p2t.y += Sy * p2t.z;
+
+		// Compute edge function coefficients _e0_, _e1_, and _e2_
+		Float e0 = p1t.x * p2t.y - p1t.y * p2t.x;
+		Float e1 = p2t.x * p0t.y - p2t.y * p0t.x;
+		Float e2 = p0t.x * p1t.y - p0t.y * p1t.x;
+
+		// Fall back to double precision test at triangle edges
+		if (sizeof(Float) == sizeof(float) && (e0 == 0.0f || e1 == 0.0f || e2 == 0.0f)) {
+			double p2txp1ty = (double)p2t.x * (double)p1t.y;
+			double p2typ1tx = (double)p2t.y * (double)p1t.x;
+			e0 = (float)(p2typ1tx - p2txp1ty);
+			double p0txp2ty = (double)p0t.x * (double)p2t.y;
+			double p0typ2tx = (double)p0t.y * (double)p2t.x;
+			e1 = (float)(p0typ2tx - p0txp2ty);
+			double p1txp0ty = (double)p1t.x * (double)p0t.y;
+			double p1typ0tx = (double)p1t.y * (double)p0t.x;
+			e2 = (float)(p1typ0tx - p1txp0ty);
+		}
+
+		// Perform triangle edge and determinant tests
+		if ((e0 < 0 || e1 < 0 || e2 < 0) && (e0 > 0 || e1 > 0 || e2 > 0)) return false;
+		Float det = e0 + e1 + e2;
+		if (det == 0) return false;
+
+		// Compute scaled hit distance to triangle and test against ray _t_ range
+		p0t.z *= Sz;
+		p1t.z *= Sz;
+		p2t.z *= Sz;
+		Float tScaled = e0 * p0t.z + e1 * p1t.z + e2 * p2t.z;
+		if (det < 0 && (tScaled >= 0 || tScaled < ray.tMax * det))
+			return false;
+		else if (det > 0 && (tScaled <= 0 || tScaled > ray.tMax * det))
+			return false;
+
+		// Compute _t_ value for triangle intersection
+		Float invDet = 1 / det;
+		Float t = tScaled * invDet;
+
+		// Ensure that computed triangle _t_ is conservatively greater than zero
+
+		// Compute _deltaZ_ term for triangle _t_ error bounds
+		Float maxZt = MaxComponent(Abs(Vector3f(p0t.z, p1t.z, p2t.z)));
+		Float deltaZ = gamma(3) * maxZt;
+
+		// Compute _deltaX_ and _deltaY_ terms for triangle _t_ error bounds
+		Float maxXt = MaxComponent(Abs(Vector3f(p0t.x, p1t.x, p2t.x)));
+		Float maxYt = MaxComponent(Abs(Vector3f(p0t.y, p1t.y, p2t.y)));
+		Float deltaX = gamma(5) * (maxXt + maxZt);
+		Float deltaY = gamma(5) * (maxYt + maxZt);
+
+		// Compute _deltaE_ term for triangle _t_ error bounds
+		Float deltaE = 2 * (gamma(2) * maxXt * maxYt + deltaY * maxXt + deltaX * maxYt);
+
+		// Compute _deltaT_ term for triangle _t_ error bounds and check _t_
+		Float maxE = MaxComponent(Abs(Vector3f(e0, e1, e2)));
+		Float deltaT = 3 * (gamma(3) * maxE * maxZt + deltaE * maxZt + deltaZ * maxE) * std::abs(invDet);
+		if (t <= deltaT) return false;
+
+		// Compute barycentric coordinates for triangle intersection
+		b[0] = e0 * invDet;
+		b[1] = e1 * invDet;
+		b[2] = e2 * invDet;
+		*tHit = t;
+		return true;
+	}
+
+	bool Triangle::Intersect(const Ray& ray, Float* tHit, SurfaceInteraction* isect) const {
+		Float t, b[3];
+		if (!HitTest(ray, &t, b)) return false;
+		Float b0 = b[0], b1 = b[1], b2 = b[2];
+		const Point3f& p0 = mesh->p[v[0]];
+		const Point3f& p1 = mesh->p[v[1]];
+		const Point3f& p2 = mesh->p[v[2]];
+
+		// Compute triangle partial derivatives
+		Vector3f dpdu, dpdv;
+		Point2f uv[3];
+		GetUVs(uv);
+
+		// Compute deltas for triangle partial derivatives
+		Vector2f duv02 = uv[0] - uv[2], duv12 = uv[1] - uv[2];
+		Vector3f dp02 = p0 - p2, dp12 = p1 - p2;
+		Float determinant = duv02[0] * duv12[1] - duv02[1] * duv12[0];
+		bool degenerateUV = std::abs(determinant) < 1e-8f;
+		if (!degenerateUV) {
+			Float invdet = 1 / determinant;
+			dpdu = (duv12[1] * dp02 - duv02[1] * dp12) * invdet;
+			dpdv = (-duv12[0] * dp02 + duv02[0] * dp12) * invdet;
+		}
+		if (degenerateUV || Cross(dpdu, dpdv).LengthSquared() == 0) {
+			// Handle zero determinant for triangle partial derivative matrix
+			Vector3f ng = Cross(p2 - p0, p1 - p0);
+			// The triangle is actually degenerate; the intersection is bogus.
+			if (ng.LengthSquared() == 0) return false;
+			CoordinateSystem(Normalize(ng), &dpdu, &dpdv);
+		}
+
+		// Compute error bounds for triangle intersection
+		Float xAbsSum = (std::abs(b0 * p0.x) + std::abs(b1 * p1.x) + std::abs(b2 * p2.x));
+		Float yAbsSum = (std::abs(b0 * p0.y) + std::abs(b1 * p1.y) + std::abs(b2 * p2.y));
+		Float zAbsSum = (std::abs(b0 * p0.z) + std::abs(b1 * p1.z) + std::abs(b2 * p2.z));
+		Vector3f pError = gamma(7) * Vector3f(xAbsSum, yAbsSum, zAbsSum);
+
+		// Interpolate _(u,v)_ parametric coordinates and hit point
+		Point3f pHit = b0 * p0 + b1 * p1 + b2 * p2;
+		Point2f uvHit = b0 * uv[0] + b1 * uv[1] + b2 * uv[2];
+
+		// Fill in _SurfaceInteraction_ from triangle hit
+		*isect = SurfaceInteraction(pHit, pError, uvHit, -ray.d, dpdu, dpdv, Normal3f(0, 0, 0),
+			Normal3f(0, 0, 0), ray.time, reverseOrientation);
+		isect->faceIndex = faceIndex;
+
+		// Override surface normal in _isect_ for triangle
+		isect->n = isect->shading.n = Normal3f(Normalize(Cross(dp02, dp12)));
+
+		if (mesh->HasNormals() || mesh->HasTangents()) {
+			// Initialize _Triangle_ shading geometry
+
+			// Compute shading normal _ns_ for triangle
+			Normal3f ns;
+			if (mesh->HasNormals()) {
+				ns = (b0 * mesh->Normal(v[0]) + b1 * mesh->Normal(v[1]) + b2 * mesh->Normal(v[2]));
+				if (ns.LengthSquared() > 0)
+					ns = Normalize(ns);
+				else
+					ns = isect->n;
+			} else
+				ns = isect->n;
+
+			// Compute shading tangent _ss_ for triangle
+			Vector3f ss;
+			if (mesh->HasTangents()) {
+				ss = (b0 * mesh->Tangent(v[0]) + b1 * mesh->Tangent(v[1]) + b2 * mesh->Tangent(v[2]));
+				if (ss.LengthSquared() == 0) ss = isect->dpdu;
+			} else
+				ss = isect->dpdu;
+
+			// Compute shading bitangent _ts_ for triangle and adjust _ss_
+			Vector3f ts = Cross(ns, ss);
+			if (ts.LengthSquared() > 0) {
+				ts = Normalize(ts);
+				ss = Cross(ts, ns);
+			} else
+				CoordinateSystem(Vector3f(ns), &ss, &ts);
+
+			// Compute _dndu_ and _dndv_ for triangle shading geometry
+			Normal3f dndu, dndv;
+			if (mesh->HasNormals()) {
+				// Compute deltas for triangle partial derivatives of normal
+				Normal3f dn1 = mesh->Normal(v[0]) - mesh->Normal(v[2]);
+				Normal3f dn2 = mesh->Normal(v[1]) - mesh->Normal(v[2]);
+				if (degenerateUV)
+					dndu = dndv = Normal3f(0, 0, 0);
+				else {
+					Float invDetUV = 1 / determinant;
+					dndu = (duv12[1] * dn1 - duv02[1] * dn2) * invDetUV;
+					dndv = (-duv12[0] * dn1 + duv02[0] * dn2) * invDetUV;
+				}
+			}
+			isect->SetShadingGeometry(ss, ts, dndu, dndv, true);
+		}
+
+		// Ensure correct orientation of the geometric normal
+		if (mesh->HasNormals())
+			isect->n = Faceforward(isect->n, isect->shading.n);
+		else if (reverseOrientation)
+			isect->n = isect->shading.n = -isect->n;
+		*tHit = t;
+		return true;
+	}
+
+	bool Triangle::IntersectP(const Ray& ray) const {
+		Float tHit, b[3];
+		return HitTest(ray, &tHit, b);
+	}
+
+	Float Triangle::Area() const {
+		const Point3f& p0 = mesh->p[v[0]];
+		const Point3f& p1 = mesh->p[v[1]];
+		const Point3f& p2 = mesh->p[v[2]];
+		return 0.5f * Cross(p1 - p0, p2 - p0).Length();
+	}
+
+	std::vector<std::shared_ptr<Shape>> CreateTriangleMesh(int nTriangles, const int* vertexIndices,
+		int nVertices, const Point3f* p, const Vector3f* s, const Normal3f* n, const Point2f* uv,
+		const TriangleMeshStorage& storage, bool reverseOrientation) {
+		for (int i = 0; i < 3 * nTriangles; ++i)
+			if (vertexIndices[i] < 0 || vertexIndices[i] >= nVertices) {
+				LOG(WARNING) << "trianglemesh has out-of-bounds vertex index " << vertexIndices[i] <<
+					" (" << nVertices << " vertices).  Discarding mesh.";
+				return {};
+			}
+		std::shared_ptr<TriangleMesh> mesh = std::make_shared<TriangleMesh>(
+			nTriangles, vertexIndices, nVertices, p, s, n, uv, storage);
+		std::vector<std::shared_ptr<Shape>> tris;
+		tris.reserve(nTriangles);
+		for (int i = 0; i < nTriangles; ++i)
+			tris.push_back(std::make_shared<Triangle>(mesh, i, reverseOrientation));
+		return tris;
+	}
+
+	std::vector<std::shared_ptr<Shape>> CreateTriangleMesh(int nTriangles, const int* vertexIndices,
+		int nVertices, const Point3f* p, const Vector3f* s, const Normal3f* n, const Point2f* uv,
+		const ParamSet& ps) {
+		return CreateTriangleMesh(nTriangles, vertexIndices, nVertices, p, s, n, uv, TriangleMeshStorageParams(ps),
+			ps.FindOneBool("reverseorientation", false));
+	}
+
+	std::vector<std::shared_ptr<Shape>> CreateTriangleMesh(const Transform& objectToWorld,
+		bool reverseOrientation, int nTriangles, const int* vertexIndices, int nVertices, const Point3f* p,
+		const Vector3f* s, const Normal3f* n, const Point2f* uv, const ParamSet& ps) {
+		reverseOrientation ^= ps.FindOneBool("reverseorientation", false) ^ objectToWorld.SwapsHandedness();
+		TriangleMeshStorage storage = TriangleMeshStorageParams(ps);
+		if (objectToWorld.IsIdentity())
+			return CreateTriangleMesh(nTriangles, vertexIndices, nVertices, p, s, n, uv, storage, reverseOrientation);
+		std::vector<Point3f> worldP(nVertices);
+		std::vector<Vector3f> worldS(s ? nVertices : 0);
+		std::vector<Normal3f> worldN(n ? nVertices : 0);
+		ParallelFor([&](int64_t i) {
+			worldP[i] = objectToWorld(p[i]);
+			if (s) worldS[i] = objectToWorld(s[i]);
+			if (n) worldN[i] = objectToWorld(n[i]);
+		}, nVertices, 4096);
+		return CreateTriangleMesh(nTriangles, vertexIndices, nVertices, worldP.data(), s ? worldS.data() : nullptr,
+			n ? worldN.data() : nullptr, uv, storage, reverseOrientation);
+	}
+
+	bool TriangleMeshShapeArrays(const ParamSet& ps, TriangleMeshArrays* mesh) {
+		int nIndices, nS, nN, nUV;
+		mesh->vertexIndices = ps.FindInt("indices", &nIndices);
+		mesh->p = ps.FindPoint3f("P", &mesh->nVertices);
+		mesh->s = ps.FindVector3f("S", &nS);
+		mesh->n = ps.FindNormal3f("N", &nN);
+		mesh->uv = ps.FindPoint2f("uv", &nUV);
+		if (!mesh->uv) {
+			const Float* fuv = ps.FindFloat("uv", &nUV);
+			if (!fuv) fuv = ps.FindFloat("st", &nUV);
+			if (fuv) {
+				nUV /= 2;
+				mesh->uvStorage.clear();
+				for (int i = 0; i < nUV; ++i) mesh->uvStorage.push_back(Point2f(fuv[2 * i], fuv[2 * i + 1]));
+				mesh->uv = mesh->uvStorage.data();
+			}
+		}
+		if (!mesh->p) {
+			LOG(ERROR) << "Vertex positions \"P\" not provided with triangle mesh shape";
+			return false;
+		}
+		if (!mesh->vertexIndices) {
+			// Three vertices make a triangle by themselves
+			if (mesh->nVertices != 3) {
+				LOG(ERROR) << "Vertex indices \"indices\" not provided with triangle mesh shape";
+				return false;
+			}
+			static const int defaultIndices[3] = { 0, 1, 2 };
+			mesh->vertexIndices = defaultIndices;
+			nIndices = 3;
+		}
+		if (nIndices % 3 != 0)
+			LOG(ERROR) << "Number of vertex indices " << nIndices << " not a multiple of 3.  Discarding " <<
+				nIndices % 3 << " excess.";
+		mesh->nTriangles = nIndices / 3;
+		if (mesh->uv && nUV != mesh->nVertices) {
+			LOG(ERROR) << "Number of \"uv\"s for triangle mesh must match \"P\"s.  Discarding uvs.";
+			mesh->uv = nullptr;
+		}
+		if (mesh->s && nS != mesh->nVertices) {
+			LOG(ERROR) << "Number of \"S\"s for triangle mesh must match \"P\"s.  Discarding \"S\"s.";
+			mesh->s = nullptr;
+		}
+		if (mesh->n && nN != mesh->nVertices) {
+			LOG(ERROR) << "Number of \"N\"s for triangle mesh must match \"P\"s.  Discarding \"N\"s.";
+			mesh->n = nullptr;
+		}
+		return true;
+	}
+
+	std::vector<std::shared_ptr<Shape>> CreateTriangleMeshShape(const Transform& objectToWorld,
+		bool reverseOrientation, const ParamSet& ps) {
+		TriangleMeshArrays mesh;
+		if (!TriangleMeshShapeArrays(ps, &mesh)) return {};
+		return CreateTriangleMesh(objectToWorld, reverseOrientation, mesh.nTriangles, mesh.vertexIndices,
+			mesh.nVertices, mesh.p, mesh.s, mesh.n, mesh.uv, ps);
+	}
+
+	bool WriteTriangleMeshFile(const std::string& filename, int nTriangles, const int* vertexIndices,
+		int nVertices, const Point3f* p, const Vector3f* s, const Normal3f* n, const Point2f* uv) {
+		CHECK_GT(nVertices, 0);
+		TriangleMeshFileHeader header;
+		memset(&header, 0, sizeof(header));
+		memcpy(header.magic, TriangleMeshFileMagic, sizeof(TriangleMeshFileMagic));
+		header.version = TriangleMeshFileVersion;
+		header.floatBytes = sizeof(Float);
+		header.nTriangles = nTriangles;
+		header.nVertices = nVertices;
+		header.attributes = (s ? (uint32_t)HasS : 0u) | (n ? (uint32_t)HasN : 0u) | (uv ? (uint32_t)HasUV : 0u);
+		Bounds3f bounds(p[0]);
+		for (int i = 1; i < nVertices; ++i) bounds = Union(bounds, p[i]);
+		for (int c = 0; c < 3; ++c) {
+			header.bounds[c] = bounds.pMin[c];
+			header.bounds[3 + c] = bounds.pMax[c];
+		}
+
+		std::vector<uint64_t> offsets = TriangleMeshFileOffsets(nTriangles, nVertices, header.attributes);
+		std::vector<char> buffer(offsets.back());
+		memcpy(&buffer[0], &header, sizeof(header));
+		memcpy(&buffer[offsets[0]], vertexIndices, offsets[1] - offsets[0]);
+		memcpy(&buffer[offsets[1]], p, offsets[2] - offsets[1]);
+		if (s) memcpy(&buffer[offsets[2]], s, offsets[3] - offsets[2]);
+		if (n) memcpy(&buffer[offsets[3]], n, offsets[4] - offsets[3]);
+		if (uv) memcpy(&buffer[offsets[4]], uv, offsets[5] - offsets[4]);
+		return WriteFileAtomic(filename, buffer.data(), buffer.size());
+	}
+
+	// PagedTriangleMesh Method Definitions
+	std::shared_ptr<PagedTriangleMesh> PagedTriangleMesh::Open(const std::string& filename, GeometryCache* cache,
+		bool reverseOrientation, const TriangleMeshStorage& storage, int maxPrimsInNode) {
+		std::shared_ptr<PagedTriangleMesh> mesh(
+			new PagedTriangleMesh(cache, reverseOrientation, storage, maxPrimsInNode));
+		TriangleMeshFileHeader header;
+		if (!mesh->file.Open(filename) || !mesh->file.Read(0, sizeof(header), &header)) return nullptr;
+		if (memcmp(header.magic, TriangleMeshFileMagic, sizeof(TriangleMeshFileMagic)) != 0 ||
+			header.version != TriangleMeshFileVersion || header.nTriangles < 0 || header.nVertices <= 0) {
+			LOG(WARNING) << "Ignoring corrupt triangle mesh file " << filename;
+			return nullptr;
+		}
+		if (header.floatBytes != sizeof(Float)) {
+			LOG(WARNING) << "Triangle mesh file " << filename << " has " << header.floatBytes <<
+				"-byte Floats, not " << sizeof(Float);
+			return nullptr;
+		}
+		if (mesh->file.Size() != TriangleMeshFileOffsets(header.nTriangles, header.nVertices, header.attributes).back()) {
+			LOG(WARNING) << "Ignoring truncated triangle mesh file " << filename;
+			return nullptr;
+		}
+		mesh->nTriangles = header.nTriangles;
+		mesh->nVertices = header.nVertices;
+		mesh->attributes = header.attributes;
+		mesh->bounds = Bounds3f(Point3f((Float)header.bounds[0], (Float)header.bounds[1], (Float)header.bounds[2]),
+			Point3f((Float)header.bounds[3], (Float)header.bounds[4], (Float)header.bounds[5]));
+		return mesh;
+	}
+
+	bool PagedTriangleMesh::Intersect(const Ray& r, SurfaceInteraction* isect) const {
+		if (!bounds.IntersectP(r)) return false;
+		std::shared_ptr<Primitive> geometry = cache->Get(*this);
+		if (!geometry || !geometry->Intersect(r, isect)) return false;
+		// The cache may evict the geometry isect points into
+		isect->geometry = std::move(geometry);
+		return true;
+	}
+
+	bool PagedTriangleMesh::IntersectP(const Ray& r) const {
+		if (!bounds.IntersectP(r)) return false;
+		std::shared_ptr<Primitive> geometry = cache->Get(*this);
+		return geometry && geometry->IntersectP(r);
+	}
+
+	std::shared_ptr<Primitive> PagedTriangleMesh::Load(size_t* bytes) const {
+		std::vector<uint64_t> offsets = TriangleMeshFileOffsets(nTriangles, nVertices, attributes);
+		std::vector<int> indices(3 * nTriangles);
+		std::vector<Point3f> p(nVertices);
+		std::vector<Vector3f> s((attributes & HasS) ? nVertices : 0);
+		std::vector<Normal3f> n((attributes & HasN) ? nVertices : 0);
+		std::vector<Point2f> uv((attributes & HasUV) ? nVertices : 0);
+		if (!file.Read(offsets[0], offsets[1] - offsets[0], indices.data()) ||
+			!file.Read(offsets[1], offsets[2] - offsets[1], p.data()) ||
+			!file.Read(offsets[2], offsets[3] - offsets[2], s.data()) ||
+			!file.Read(offsets[3], offsets[4] - offsets[3], n.data()) ||
+			!file.Read(offsets[4], offsets[5] - offsets[4], uv.data()))
+			return nullptr;
+		for (int index : indices)
+			if (index < 0 || index >= nVertices) {
+				LOG(ERROR) << "Paged triangle mesh has out-of-bounds vertex index " << index;
+				return nullptr;
+			}
+
+		std::shared_ptr<TriangleMesh> mesh = std::make_shared<TriangleMesh>(nTriangles, indices.data(),
+			nVertices, p.data(), s.empty() ? nullptr : s.data(), n.empty() ? nullptr : n.data(),
+			uv.empty() ? nullptr : uv.data(), storage);
+		std::vector<std::shared_ptr<Primitive>> prims;
+		prims.reserve(nTriangles);
+		for (int i = 0; i < nTriangles; ++i)
+			prims.push_back(std::make_shared<GeometricPrimitive>(
+				std::make_shared<Triangle>(mesh, i, reverseOrientation)));
+		std::shared_ptr<BVHAccel> bvh = std::make_shared<BVHAccel>(std::move(prims), maxPrimsInNode);
+		// Each triangle also costs its shape, primitive and their two
+		// shared_ptr control blocks
+		*bytes = mesh->BytesUsed() + bvh->TotalNodes() * sizeof(LinearBVHNode) +
+			nTriangles * (sizeof(Triangle) + sizeof(GeometricPrimitive) + 2 * sizeof(std::shared_ptr<Primitive>) + 32);
+		return bvh;
+	}
+
+	std::shared_ptr<Primitive> CreatePagedTriangleMesh(const ParamSet& ps, GeometryCache* cache) {
+		std::string filename = ps.FindOneString("filename", "");
+		bool reverseOrientation = ps.FindOneBool("reverseorientation", false);
+		TriangleMeshStorage storage = TriangleMeshStorageParams(ps);
+		int maxPrimsInNode = ps.FindOneInt("maxnodeprims", 4);
+		std::shared_ptr<Primitive> mesh =
+			PagedTriangleMesh::Open(filename, cache, reverseOrientation, storage, maxPrimsInNode);
+		if (!mesh) LOG(ERROR) << "Unable to open triangle mesh file \"" << filename << "\"";
+		return mesh;
+	}
+
+}  // namespace pbr
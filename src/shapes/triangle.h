@@ -0,0 +1,182 @@
+#ifndef SHAPES_TRIANGLE_H
+#define SHAPES_TRIANGLE_H
+
+#include "pbr.h"
+#include "shape.h"
+#include "primitive.h"
+#include "geometrycache.h"
+#include "fileutil.h"
+
+namespace pbr {
+
+	// How TriangleMesh stores uvs: as Point2f, as two halfs, or as two 16-bit
+	// unorms spanning the mesh's uv bounds. Unorm has uniform precision
+	// (1/65535 of the uv extent); half is exact near 0 but only 1/2048 at 1.
+	enum class UVEncoding { Float, Half, Unorm16 };
+
+	// Per-attribute storage precision of TriangleMesh vertex data. Positions
+	// are always full precision; normals and tangents may be octahedrally
+	// compressed to 4 bytes and uvs quantized to 4 bytes.
+	struct TriangleMeshStorage {
+		bool compressNormals = false;
+		bool compressTangents = false;
+		UVEncoding uvEncoding = UVEncoding::Float;
+	};
+
+	// Vertex data shared by all triangles of a mesh, stored in world space.
+	// Compressed attributes are decoded on demand by the accessors.
+	struct TriangleMesh {
+		// TriangleMesh Public Methods
+		TriangleMesh(int nTriangles, const int* vertexIndices, int nVertices, const Point3f* P,
+			const Vector3f* S, const Normal3f* N, const Point2f* UV,
+			const TriangleMeshStorage& storage = TriangleMeshStorage());
+
+		bool HasNormals() const { return n || cn; }
+		bool HasTangents() const { return s || cs; }
+		bool HasUVs() const { return uv || quv; }
+		Normal3f Normal(int vertex) const { return cn ? cn[vertex].Decode() : n[vertex]; }
+		Vector3f Tangent(int vertex) const { return cs ? Vector3f(cs[vertex].Decode()) : s[vertex]; }
+		Point2f UV(int vertex) const {
+			if (uv) return uv[vertex];
+			const uint16_t* q = &quv[2 * vertex];
+			if (uvEncoding == UVEncoding::Half) return Point2f(HalfToFloat(q[0]), HalfToFloat(q[1]));
+			return uvBounds.Lerp(Point2f(q[0] * (1 / Float(65535)), q[1] * (1 / Float(65535))));
+		}
+		// Bytes held by the index and vertex arrays
+		size_t BytesUsed() const;
+
+		// TriangleMesh Data
+		const int nTriangles, nVertices;
+		std::vector<int> vertexIndices;
+		std::unique_ptr<Point3f[]> p;
+		std::unique_ptr<Normal3f[]> n;
+		std::unique_ptr<CompressedNormal[]> cn;
+		std::unique_ptr<Vector3f[]> s;
+		std::unique_ptr<CompressedNormal[]> cs;
+		std::unique_ptr<Point2f[]> uv;
+		std::unique_ptr<uint16_t[]> quv;
+		UVEncoding uvEncoding = UVEncoding::Float;
+		Bounds2f uvBounds;
+	};
+
+	class Triangle : public Shape {
+	public:
+		// Triangle Public Methods
+		Triangle(const std::shared_ptr<TriangleMesh>& mesh, int triNumber, bool reverseOrientation = false)
+			: Shape(reverseOrientation), mesh(mesh), v(&mesh->vertexIndices[3 * triNumber]),
+			faceIndex(triNumber) {}
+		Bounds3f WorldBound() const;
+		bool Intersect(const Ray& ray, Float* tHit, SurfaceInteraction* isect) const;
+		bool IntersectP(const Ray& ray) const;
+		Float Area() const;
+
+	private:
+		// Triangle Private Methods
+		// The hit distance and barycentrics of ray's hit, if any
+		bool HitTest(const Ray& ray, Float* tHit, Float b[3]) const;
+		void GetUVs(Point2f uv[3]) const {
+			if (mesh->HasUVs()) {
+				uv[0] = mesh->UV(v[0]);
+				uv[1] = mesh->UV(v[1]);
+				uv[2] = mesh->UV(v[2]);
+			} else {
+				uv[0] = Point2f(0, 0);
+				uv[1] = Point2f(1, 0);
+				uv[2] = Point2f(1, 1);
+			}
+		}
+
+		// Triangle Private Data
+		std::shared_ptr<TriangleMesh> mesh;
+		const int* v;
+		int faceIndex;
+	};
+
+	// Supported parameters: "reverseorientation", "compressnormals" and
+	// "compresstangents" (bool), "uvencoding" ("float", "half" or "unorm16")
+	std::vector<std::shared_ptr<Shape>> CreateTriangleMesh(int nTriangles, const int* vertexIndices,
+		int nVertices, const Point3f* p, const Vector3f* s, const Normal3f* n, const Point2f* uv,
+		const ParamSet& ps);
+	// As above, with the vertices taken from object to world space first.
+	// reverseOrientation, as does a transform that swaps handedness, flips
+	// the "reverseorientation" parameter.
+	std::vector<std::shared_ptr<Shape>> CreateTriangleMesh(const Transform& objectToWorld,
+		bool reverseOrientation, int nTriangles, const int* vertexIndices, int nVertices, const Point3f* p,
+		const Vector3f* s, const Normal3f* n, const Point2f* uv, const ParamSet& ps);
+
+	// As above, for vertices already in world space
+	std::vector<std::shared_ptr<Shape>> CreateTriangleMesh(int nTriangles, const int* vertexIndices,
+		int nVertices, const Point3f* p, const Vector3f* s, const Normal3f* n, const Point2f* uv,
+		const TriangleMeshStorage& storage, bool reverseOrientation);
+	// The storage requested by the parameters of CreateTriangleMesh()
+	TriangleMeshStorage TriangleMeshStorageParams(const ParamSet& ps);
+
+	// Arrays of a mesh that are held elsewhere; s, n and uv may be nullptr
+	struct TriangleMeshArrays {
+		int nTriangles = 0, nVertices = 0;
+		const int* vertexIndices = nullptr;
+		const Point3f* p = nullptr;
+		const Vector3f* s = nullptr;
+		const Normal3f* n = nullptr;
+		const Point2f* uv = nullptr;
+		// Backs uv when it is given as float pairs
+		std::vector<Point2f> uvStorage;
+	};
+	// Finds the arrays of a "trianglemesh" shape's parameters, dropping
+	// those that don't match "P"; false, logged, if there is no mesh
+	bool TriangleMeshShapeArrays(const ParamSet& ps, TriangleMeshArrays* mesh);
+
+	// The "trianglemesh" shape of scene files. Supported parameters:
+	// "indices" (int), "P" (point3), "S" (vector3), "N" (normal3), "uv"
+	// (point2, or float pairs as "uv" or "st") and those of
+	// CreateTriangleMesh()
+	std::vector<std::shared_ptr<Shape>> CreateTriangleMeshShape(const Transform& objectToWorld,
+		bool reverseOrientation, const ParamSet& ps);
+
+	// Writes a mesh in the form read by PagedTriangleMesh: a header holding
+	// the counts and bounds, then the index and vertex arrays in Float
+	// precision. s, n and uv may be nullptr.
+	bool WriteTriangleMeshFile(const std::string& filename, int nTriangles, const int* vertexIndices,
+		int nVertices, const Point3f* p, const Vector3f* s, const Normal3f* n, const Point2f* uv);
+
+	// A triangle mesh that holds only its bounds until a ray enters them.
+	// Its triangles are then read from a mesh file and put behind a BVH,
+	// kept in a GeometryCache that evicts the least recently used meshes to
+	// stay within its budget. Interactions hold on to the loaded mesh they
+	// hit, so their primitive pointers stay valid.
+	class PagedTriangleMesh : public Primitive, private GeometrySource {
+	public:
+		// PagedTriangleMesh Public Methods
+		static std::shared_ptr<PagedTriangleMesh> Open(const std::string& filename, GeometryCache* cache,
+			bool reverseOrientation = false, const TriangleMeshStorage& storage = TriangleMeshStorage(),
+			int maxPrimsInNode = 4);
+		Bounds3f WorldBound() const { return bounds; }
+		bool Intersect(const Ray& r, SurfaceInteraction* isect) const;
+		bool IntersectP(const Ray& r) const;
+
+	private:
+		// PagedTriangleMesh Private Methods
+		PagedTriangleMesh(GeometryCache* cache, bool reverseOrientation, const TriangleMeshStorage& storage,
+			int maxPrimsInNode)
+			: cache(cache), reverseOrientation(reverseOrientation), storage(storage),
+			maxPrimsInNode(maxPrimsInNode) {}
+		std::shared_ptr<Primitive> Load(size_t* bytes) const;
+
+		// PagedTriangleMesh Private Data
+		GeometryCache* cache;
+		const bool reverseOrientation;
+		const TriangleMeshStorage storage;
+		const int maxPrimsInNode;
+		Bounds3f bounds;
+		int nTriangles = 0, nVertices = 0;
+		uint32_t attributes = 0;
+		RandomAccessFile file;
+	};
+
+	// Supported parameters: "filename" (string), "maxnodeprims" (int) and
+	// those of CreateTriangleMesh(); nullptr if the file can't be opened
+	std::shared_ptr<Primitive> CreatePagedTriangleMesh(const ParamSet& ps, GeometryCache* cache);
+
+}  // namespace pbr
+
+#endif  // SHAPES_TRIANGLE_H
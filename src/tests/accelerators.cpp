@@ -0,0 +1,246 @@
+#include "tests/gtest/gtest.h"
+#include "pbr.h"
+#include "geometry.h"
+#include "primitive.h"
+#include "accelerators/bvh.h"
+#include "accelerators/kdtreeaccel.h"
+#include "api.h"
+#include "paramset.h"
+#include <fstream>
+#include <random>
+
+using namespace pbr;
+
+// Axis-aligned box that only reports the entry distance through ray.tMax.
+class BoxPrimitive : public Primitive {
+public:
+	BoxPrimitive(const Bounds3f& b) : bounds(b) {}
+	Bounds3f WorldBound() const { return bounds; }
+	bool Intersect(const Ray& r, SurfaceInteraction*) const {
+		Float t0 = 0, t1 = r.tMax;
+		for (int i = 0; i < 3; ++i) {
+			Float invD = 1 / r.d[i];
+			Float tNear = (bounds.pMin[i] - r.o[i]) * invD;
+			Float tFar = (bounds.pMax[i] - r.o[i]) * invD;
+			if (tNear > tFar) std::swap(tNear, tFar);
+			t0 = tNear > t0 ? tNear : t0;
+			t1 = tFar < t1 ? tFar : t1;
+			if (t0 > t1) return false;
+		}
+		if (t0 >= r.tMax) return false;
+		r.tMax = t0;
+		return true;
+	}
+	bool IntersectP(const Ray& r) const {
+		Ray rr = r;
+		return Intersect(rr, nullptr);
+	}
+
+private:
+	Bounds3f bounds;
+};
+
+static std::vector<std::shared_ptr<Primitive>> RandomBoxes(int n, uint32_t seed) {
+	std::mt19937 rng(seed);
+	std::uniform_real_distribution<Float> pos(-10, 10), size(0.05f, 1);
+	std::vector<std::shared_ptr<Primitive>> prims;
+	for (int i = 0; i < n; ++i) {
+		Point3f p(pos(rng), pos(rng), pos(rng));
+		prims.push_back(std::make_shared<BoxPrimitive>(
+			Bounds3f(p, p + Vector3f(size(rng), size(rng), size(rng)))));
+	}
+	return prims;
+}
+
+// Axis-aligned quads, as produced by walls and floors of architectural scenes
+static std::vector<std::shared_ptr<Primitive>> RandomQuads(int n, uint32_t seed) {
+	std::mt19937 rng(seed);
+	std::uniform_real_distribution<Float> pos(-10, 10), size(0.5f, 4);
+	std::vector<std::shared_ptr<Primitive>> prims;
+	for (int i = 0; i < n; ++i) {
+		Point3f p(pos(rng), pos(rng), pos(rng));
+		Vector3f d(size(rng), size(rng), size(rng));
+		d[i % 3] = 0;
+		prims.push_back(std::make_shared<BoxPrimitive>(Bounds3f(p, p + d)));
+	}
+	return prims;
+}
+
+static Ray RandomRay(std::mt19937& rng) {
+	std::uniform_real_distribution<Float> pos(-12, 12), dir(-1, 1);
+	Vector3f d(dir(rng), dir(rng), dir(rng));
+	return Ray(Point3f(pos(rng), pos(rng), pos(rng)), d);
+}
+
+// Closest-hit distance found by testing every primitive
+static Float BruteForce(const std::vector<std::shared_ptr<Primitive>>& prims, Ray r) {
+	for (const auto& p : prims) p->Intersect(r, nullptr);
+	return r.tMax;
+}
+
+#pragma region BVHAccel
+
+TEST(TestBVHAccel, MatchesBruteForce) {
+	std::vector<std::shared_ptr<Primitive>> prims = RandomBoxes(500, 1);
+	for (auto method : { BVHAccel::SplitMethod::SAH, BVHAccel::SplitMethod::Middle,
+		BVHAccel::SplitMethod::EqualCounts }) {
+		BVHAccel bvh(prims, 4, method);
+		EXPECT_FALSE(bvh.LoadedFromCache());
+		std::mt19937 rng(2);
+		for (int i = 0; i < 1000; ++i) {
+			Ray r = RandomRay(rng);
+			Float expected = BruteForce(prims, r);
+			Ray r2 = r;
+			bool hit = bvh.Intersect(r2, nullptr);
+			EXPECT_EQ(expected < Infinity, hit);
+			EXPECT_EQ(expected, r2.tMax);
+			EXPECT_EQ(hit, bvh.IntersectP(r));
+		}
+	}
+}
+
+TEST(TestBVHAccel, Empty) {
+	BVHAccel bvh({});
+	Ray r(Point3f(0, 0, 0), Vector3f(1, 0, 0));
+	EXPECT_FALSE(bvh.Intersect(r, nullptr));
+	EXPECT_FALSE(bvh.IntersectP(r));
+}
+
+TEST(TestBVHAccel, CacheRoundTrip) {
+	std::vector<std::shared_ptr<Primitive>> prims = RandomBoxes(300, 3);
+	BVHAccel built(prims, 4, BVHAccel::SplitMethod::SAH, ".");
+	std::string filename = built.CacheFilename(".");
+	EXPECT_FALSE(built.LoadedFromCache());
+	ASSERT_TRUE(FileExists(filename));
+
+	BVHAccel cached(prims, 4, BVHAccel::SplitMethod::SAH, ".");
+	EXPECT_TRUE(cached.LoadedFromCache());
+	EXPECT_EQ(built.TotalNodes(), cached.TotalNodes());
+	EXPECT_EQ(built.WorldBound(), cached.WorldBound());
+
+	std::mt19937 rng(4);
+	for (int i = 0; i < 1000; ++i) {
+		Ray r1 = RandomRay(rng), r2 = r1;
+		EXPECT_EQ(built.Intersect(r1, nullptr), cached.Intersect(r2, nullptr));
+		EXPECT_EQ(r1.tMax, r2.tMax);
+	}
+
+	// Different build parameters or geometry must not reuse the file
+	BVHAccel otherParams(prims, 2, BVHAccel::SplitMethod::SAH, ".");
+	EXPECT_FALSE(otherParams.LoadedFromCache());
+	EXPECT_NE(filename, otherParams.CacheFilename("."));
+	std::remove(otherParams.CacheFilename(".").c_str());
+
+	std::vector<std::shared_ptr<Primitive>> moved = prims;
+	moved[0] = std::make_shared<BoxPrimitive>(Bounds3f(Point3f(0, 0, 0), Point3f(1, 1, 1)));
+	BVHAccel otherGeometry(moved, 4);
+	EXPECT_NE(built.GeometryHash(), otherGeometry.GeometryHash());
+
+	std::remove(filename.c_str());
+}
+
+TEST(TestBVHAccel, CorruptCacheIsRebuilt) {
+	std::vector<std::shared_ptr<Primitive>> prims = RandomBoxes(50, 5);
+	BVHAccel built(prims, 4);
+	std::string filename = built.CacheFilename(".");
+	const char garbage[] = "not a bvh";
+	ASSERT_TRUE(WriteFileAtomic(filename, garbage, sizeof(garbage)));
+
+	BVHAccel rebuilt(prims, 4, BVHAccel::SplitMethod::SAH, ".");
+	EXPECT_FALSE(rebuilt.LoadedFromCache());
+	EXPECT_EQ(built.TotalNodes(), rebuilt.TotalNodes());
+
+	// The rebuild replaced the corrupt file with a valid one
+	BVHAccel cached(prims, 4, BVHAccel::SplitMethod::SAH, ".");
+	EXPECT_TRUE(cached.LoadedFromCache());
+	std::remove(filename.c_str());
+}
+
+TEST(TestBVHAccel, CorruptCacheNodesAreRebuilt) {
+	std::vector<std::shared_ptr<Primitive>> prims = RandomBoxes(50, 6);
+	BVHAccel built(prims, 4, BVHAccel::SplitMethod::SAH, ".");
+	std::string filename = built.CacheFilename(".");
+	std::ifstream in(filename, std::ios::binary);
+	std::vector<char> file((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+	in.close();
+	ASSERT_GT(file.size(), sizeof(LinearBVHNode));
+
+	// The last node is a leaf; point it past the primitives and the root
+	// past the nodes, keeping the header and size intact
+	LinearBVHNode* nodes = (LinearBVHNode*)(file.data() + file.size()) - built.TotalNodes();
+	for (int corruptRoot = 0; corruptRoot < 2; ++corruptRoot) {
+		std::vector<char> corrupt = file;
+		LinearBVHNode* node = (LinearBVHNode*)(corrupt.data() + ((char*)nodes - file.data()));
+		if (corruptRoot) node[0].secondChildOffset = built.TotalNodes();
+		else node[built.TotalNodes() - 1].primitivesOffset = (int)prims.size();
+		ASSERT_TRUE(WriteFileAtomic(filename, corrupt.data(), corrupt.size()));
+
+		BVHAccel rebuilt(prims, 4, BVHAccel::SplitMethod::SAH, ".");
+		EXPECT_FALSE(rebuilt.LoadedFromCache());
+		Ray r(Point3f(-10, -10, -10), Vector3f(1, 1, 1));
+		EXPECT_EQ(built.IntersectP(r), rebuilt.IntersectP(r));
+	}
+	std::remove(filename.c_str());
+}
+
+#pragma endregion BVHAccel
+
+#pragma region KdTreeAccel
+
+TEST(TestKdTreeAccel, MatchesBruteForce) {
+	std::vector<std::shared_ptr<Primitive>> boxes = RandomBoxes(500, 1);
+	std::vector<std::shared_ptr<Primitive>> quads = RandomQuads(200, 6);
+	for (const auto& prims : { boxes, quads }) {
+		KdTreeAccel kdtree(prims);
+		EXPECT_GT(kdtree.TotalNodes(), 1);
+		std::mt19937 rng(2);
+		for (int i = 0; i < 1000; ++i) {
+			Ray r = RandomRay(rng);
+			Float expected = BruteForce(prims, r);
+			Ray r2 = r;
+			bool hit = kdtree.Intersect(r2, nullptr);
+			EXPECT_EQ(expected < Infinity, hit);
+			EXPECT_EQ(expected, r2.tMax);
+			EXPECT_EQ(hit, kdtree.IntersectP(r));
+		}
+	}
+}
+
+TEST(TestKdTreeAccel, Empty) {
+	KdTreeAccel kdtree({});
+	Ray r(Point3f(0, 0, 0), Vector3f(1, 0, 0));
+	EXPECT_FALSE(kdtree.Intersect(r, nullptr));
+	EXPECT_FALSE(kdtree.IntersectP(r));
+}
+
+TEST(TestKdTreeAccel, CoincidentPrimitives) {
+	// Identical bounds can't be separated; the builder must terminate with a leaf
+	std::vector<std::shared_ptr<Primitive>> prims;
+	for (int i = 0; i < 64; ++i)
+		prims.push_back(std::make_shared<BoxPrimitive>(Bounds3f(Point3f(0, 0, 0), Point3f(1, 1, 1))));
+	KdTreeAccel kdtree(prims);
+	Ray r(Point3f(-1, 0.5f, 0.5f), Vector3f(1, 0, 0));
+	EXPECT_TRUE(kdtree.Intersect(r, nullptr));
+	EXPECT_EQ(1, r.tMax);
+}
+
+#pragma endregion KdTreeAccel
+
+#pragma region MakeAccelerator
+
+TEST(TestMakeAccelerator, SelectsByName) {
+	std::vector<std::shared_ptr<Primitive>> prims = RandomBoxes(100, 7);
+	ParamSet ps;
+	EXPECT_TRUE(std::dynamic_pointer_cast<BVHAccel>(MakeAccelerator("bvh", prims, ps)) != nullptr);
+	EXPECT_TRUE(std::dynamic_pointer_cast<KdTreeAccel>(MakeAccelerator("kdtree", prims, ps)) != nullptr);
+	EXPECT_TRUE(std::dynamic_pointer_cast<BVHAccel>(MakeAccelerator("octree", prims, ps)) != nullptr);
+
+	std::unique_ptr<int[]> maxPrims(new int[1]);
+	maxPrims[0] = 8;
+	ps.AddInt("maxprims", std::move(maxPrims));
+	std::shared_ptr<Primitive> kdtree = MakeAccelerator("kdtree", prims, ps);
+	std::shared_ptr<Primitive> bvh = MakeAccelerator("bvh", prims, ParamSet());
+	EXPECT_EQ(bvh->WorldBound(), kdtree->WorldBound());
+}
+
+#pragma endregion MakeAccelerator
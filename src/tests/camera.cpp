@@ -0,0 +1,157 @@
+#include "tests/gtest/gtest.h"
+#include "pbr.h"
+#include "camera.h"
+#include "film.h"
+#include "cameras/orthographic.h"
+#include "cameras/perspective.h"
+#include "filters/box.h"
+#include <random>
+
+using namespace pbr;
+
+static std::unique_ptr<Film> MakeFilm(int xRes, int yRes) {
+	return std::unique_ptr<Film>(new Film(Point2i(xRes, yRes), Bounds2f(Point2f(0, 0), Point2f(1, 1)),
+		std::unique_ptr<Filter>(new BoxFilter(Vector2f(0.5f, 0.5f))), "camera.pfm"));
+}
+
+static void ExpectNear(const Vector3f& expected, const Vector3f& v, Float tolerance = 1e-4f) {
+	EXPECT_NEAR(expected.x, v.x, tolerance);
+	EXPECT_NEAR(expected.y, v.y, tolerance);
+	EXPECT_NEAR(expected.z, v.z, tolerance);
+}
+
+static CameraSample MakeSample(Float x, Float y) {
+	CameraSample sample;
+	sample.pFilm = Point2f(x, y);
+	sample.pLens = Point2f(0.5f, 0.5f);
+	sample.time = 0;
+	return sample;
+}
+
+static const Bounds2f ScreenWindow(Point2f(-2, -1), Point2f(2, 1));
+
+TEST(TestCamera, Perspective) {
+	// 90 degrees across the shorter axis of a 2:1 frame; raster y runs down
+	std::unique_ptr<Film> film = MakeFilm(64, 32);
+	PerspectiveCamera camera(Transform(), ScreenWindow, 0, 1, 0, 1e6, 90, film.get());
+	Ray ray;
+	EXPECT_EQ(1, camera.GenerateRay(MakeSample(32, 16), &ray));
+	ExpectNear(Vector3f(0, 0, 0), Vector3f(ray.o));
+	ExpectNear(Vector3f(0, 0, 1), ray.d);
+	camera.GenerateRay(MakeSample(32, 0), &ray);
+	ExpectNear(Normalize(Vector3f(0, 1, 1)), ray.d);
+	camera.GenerateRay(MakeSample(0, 16), &ray);
+	ExpectNear(Normalize(Vector3f(-2, 0, 1)), ray.d);
+
+	// Placed by its camera-to-world transform
+	Transform cameraToWorld = Inverse(LookAt(Point3f(1, 2, 3), Point3f(1, 2, 4), Vector3f(0, 1, 0)));
+	PerspectiveCamera placed(cameraToWorld, ScreenWindow, 0, 1, 0, 1e6, 90, film.get());
+	placed.GenerateRay(MakeSample(32, 16), &ray);
+	ExpectNear(Vector3f(1, 2, 3), Vector3f(ray.o));
+	ExpectNear(Vector3f(0, 0, 1), ray.d);
+}
+
+TEST(TestCamera, Orthographic) {
+	std::unique_ptr<Film> film = MakeFilm(64, 32);
+	OrthographicCamera camera(Transform(), ScreenWindow, 0, 1, 0, 1e6, film.get());
+	Ray ray;
+	camera.GenerateRay(MakeSample(0, 0), &ray);
+	ExpectNear(Vector3f(-2, 1, 0), Vector3f(ray.o));
+	ExpectNear(Vector3f(0, 0, 1), ray.d);
+	camera.GenerateRay(MakeSample(48, 24), &ray);
+	ExpectNear(Vector3f(1, -0.5f, 0), Vector3f(ray.o));
+}
+
+TEST(TestCamera, ThinLens) {
+	// Every ray through a pixel meets at the focal distance
+	std::unique_ptr<Film> film = MakeFilm(64, 32);
+	PerspectiveCamera perspective(Transform(), ScreenWindow, 0, 1, 0.5f, 10, 60, film.get());
+	OrthographicCamera orthographic(Transform(), ScreenWindow, 0, 1, 0.5f, 10, film.get());
+	for (const Camera* camera : { (const Camera*)&perspective, (const Camera*)&orthographic }) {
+		CameraSample sample = MakeSample(20.5f, 7.5f);
+		Ray center;
+		sample.pLens = Point2f(0.5f, 0.5f);
+		camera->GenerateRay(sample, &center);
+		Point3f focus = center((10 - center.o.z) / center.d.z);
+		for (Point2f u : { Point2f(0.1f, 0.2f), Point2f(0.9f, 0.4f) }) {
+			sample.pLens = u;
+			Ray ray;
+			camera->GenerateRay(sample, &ray);
+			EXPECT_GT(Distance(ray.o, center.o), 0.05f);
+			ExpectNear(Vector3f(focus), Vector3f(ray((10 - ray.o.z) / ray.d.z)), 1e-3f);
+		}
+	}
+}
+
+TEST(TestCamera, GenerateRays) {
+	// Packets match GenerateRay(), and their differentials match the rays
+	// one pixel over
+	std::unique_ptr<Film> film = MakeFilm(64, 32);
+	Transform cameraToWorld = Inverse(LookAt(Point3f(1, 2, 3), Point3f(-4, 0, 8), Vector3f(0, 1, 0)));
+	std::mt19937 rng(7);
+	std::uniform_real_distribution<Float> u(0, 1);
+	for (Float lensRadius : { Float(0), Float(0.2f) }) {
+		PerspectiveCamera perspective(cameraToWorld, ScreenWindow, 0, 2, lensRadius, 5, 60, film.get());
+		OrthographicCamera orthographic(cameraToWorld, ScreenWindow, 0, 2, lensRadius, 5, film.get());
+		for (const Camera* camera : { (const Camera*)&perspective, (const Camera*)&orthographic }) {
+			std::vector<CameraSample> samples(37);
+			for (CameraSample& s : samples) {
+				s.pFilm = Point2f(64 * u(rng), 32 * u(rng));
+				s.pLens = Point2f(u(rng), u(rng));
+				s.time = u(rng);
+			}
+			CameraRayPacket rays;
+			camera->GenerateRays(&samples[0], (int)samples.size(), &rays);
+			ASSERT_EQ((int)samples.size(), rays.Size());
+			for (size_t i = 0; i < samples.size(); ++i) {
+				Ray ray, rx, ry;
+				camera->GenerateRay(samples[i], &ray);
+				CameraSample sx = samples[i], sy = samples[i];
+				sx.pFilm.x += 1;
+				sy.pFilm.y += 1;
+				camera->GenerateRay(sx, &rx);
+				camera->GenerateRay(sy, &ry);
+
+				Ray packetRay = rays.GetRay((int)i);
+				ExpectNear(Vector3f(ray.o), Vector3f(packetRay.o));
+				ExpectNear(ray.d, packetRay.d);
+				EXPECT_FLOAT_EQ(ray.time, packetRay.time);
+				ExpectNear(Vector3f(rx.o), rays.rxOrigin[i]);
+				ExpectNear(rx.d, rays.rxDirection[i]);
+				ExpectNear(Vector3f(ry.o), rays.ryOrigin[i]);
+				ExpectNear(ry.d, rays.ryDirection[i]);
+			}
+		}
+	}
+}
+
+TEST(TestCamera, GenerateRayDifferential) {
+	// The specialized versions agree with the packets and with tracing the
+	// shifted samples through GenerateRay()
+	std::unique_ptr<Film> film = MakeFilm(64, 32);
+	Transform cameraToWorld = Inverse(LookAt(Point3f(1, 2, 3), Point3f(-4, 0, 8), Vector3f(0, 1, 0)));
+	for (Float lensRadius : { Float(0), Float(0.2f) }) {
+		PerspectiveCamera perspective(cameraToWorld, ScreenWindow, 0, 2, lensRadius, 5, 60, film.get());
+		OrthographicCamera orthographic(cameraToWorld, ScreenWindow, 0, 2, lensRadius, 5, film.get());
+		for (const Camera* camera : { (const Camera*)&perspective, (const Camera*)&orthographic }) {
+			CameraSample sample = MakeSample(13.25f, 27.5f);
+			sample.pLens = Point2f(0.3f, 0.8f);
+			sample.time = 0.4f;
+			CameraRayPacket rays;
+			camera->GenerateRays(&sample, 1, &rays);
+			RayDifferential packet = rays.GetRayDifferential(0), rd, traced;
+			EXPECT_EQ(1, camera->GenerateRayDifferential(sample, &rd));
+			EXPECT_EQ(1, camera->Camera::GenerateRayDifferential(sample, &traced));
+			for (const RayDifferential* r : { &packet, &traced }) {
+				EXPECT_TRUE(r->hasDifferentials);
+				ExpectNear(Vector3f(r->o), Vector3f(rd.o));
+				ExpectNear(r->d, rd.d);
+				ExpectNear(Vector3f(r->rxOrigin), Vector3f(rd.rxOrigin));
+				ExpectNear(r->rxDirection, rd.rxDirection);
+				ExpectNear(Vector3f(r->ryOrigin), Vector3f(rd.ryOrigin));
+				ExpectNear(r->ryDirection, rd.ryDirection);
+				EXPECT_FLOAT_EQ(r->time, rd.time);
+			}
+		}
+	}
+}
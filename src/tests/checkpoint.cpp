@@ -0,0 +1,138 @@
+#include "tests/gtest/gtest.h"
+#include "pbr.h"
+#include "checkpoint.h"
+#include "film.h"
+#include "filters/box.h"
+#include "filters/gaussian.h"
+#include <cstdio>
+#include <fstream>
+
+using namespace pbr;
+
+// Adds one sample per pixel of pass number pass, tile by tile
+static void RenderPass(Film& film, int pass) {
+	const int tileSize = 8;
+	Point2i nTiles = film.GetTileCount(tileSize);
+	for (int ty = 0; ty < nTiles.y; ++ty)
+		for (int tx = 0; tx < nTiles.x; ++tx) {
+			Bounds2i sampleBounds = film.GetTileSampleBounds(Point2i(tx, ty), tileSize);
+			std::unique_ptr<FilmTile> tile = film.GetFilmTile(sampleBounds);
+			for (int y = sampleBounds.pMin.y; y < sampleBounds.pMax.y; ++y)
+				for (int x = sampleBounds.pMin.x; x < sampleBounds.pMax.x; ++x) {
+					Float u = Float((x * 7 + y * 13 + pass * 5) % 16) / 16;
+					RGBSpectrum L(u, (Float)pass, (Float)(x + y));
+					tile->AddSample(Point2f(x + u, y + 1 - u), L);
+				}
+			film.MergeFilmTile(std::move(tile));
+		}
+	RGBSpectrum splat(0, 0, (Float)pass);
+	film.AddSplat(Point2f(3.5f, 2.5f), splat);
+}
+
+static std::unique_ptr<Film> MakeFilm() {
+	return std::unique_ptr<Film>(new Film(Point2i(37, 29), Bounds2f(Point2f(0, 0), Point2f(1, 1)),
+		std::unique_ptr<Filter>(new GaussianFilter(Vector2f(1.5f, 1.5f), 2)), "checkpoint.pfm"));
+}
+
+#pragma region Checkpoint
+
+TEST(TestCheckpoint, RoundTrip) {
+	RenderCheckpoint cp;
+	cp.samplesCompleted = 123456789012ll;
+	cp.pixelBounds = Bounds2i(Point2i(3, 4), Point2i(50, 60));
+	cp.filmState = { 1.5f, -2, 0, 1e30f };
+	cp.tileSamples = { 16, 64, 1ll << 40 };
+	ASSERT_TRUE(WriteCheckpoint("roundtrip.ckpt", cp));
+
+	RenderCheckpoint read;
+	ASSERT_TRUE(ReadCheckpoint("roundtrip.ckpt", &read));
+	EXPECT_EQ(cp.samplesCompleted, read.samplesCompleted);
+	EXPECT_EQ(cp.pixelBounds, read.pixelBounds);
+	EXPECT_EQ(cp.filmState, read.filmState);
+	EXPECT_EQ(cp.tileSamples, read.tileSamples);
+
+	// Truncation and foreign files are rejected
+	std::vector<char> bytes;
+	{
+		std::ifstream in("roundtrip.ckpt", std::ios::binary);
+		bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+	}
+	{
+		std::ofstream out("roundtrip.ckpt", std::ios::binary | std::ios::trunc);
+		out.write(bytes.data(), bytes.size() - 5);
+	}
+	EXPECT_FALSE(ReadCheckpoint("roundtrip.ckpt", &read));
+	{
+		std::ofstream out("roundtrip.ckpt", std::ios::binary | std::ios::trunc);
+		out.write(bytes.data(), bytes.size());
+		out << "extra";
+	}
+	EXPECT_FALSE(ReadCheckpoint("roundtrip.ckpt", &read));
+	{
+		std::ofstream out("roundtrip.ckpt", std::ios::binary | std::ios::trunc);
+		out << "PF\n1 1\n-1\n";
+	}
+	EXPECT_FALSE(ReadCheckpoint("roundtrip.ckpt", &read));
+	std::remove("roundtrip.ckpt");
+	EXPECT_FALSE(ReadCheckpoint("roundtrip.ckpt", &read));
+}
+
+TEST(TestCheckpoint, ResumeMatchesUninterrupted) {
+	const int nPasses = 4, interruptAfter = 2;
+	std::unique_ptr<Film> uninterrupted = MakeFilm();
+	for (int pass = 0; pass < nPasses; ++pass) RenderPass(*uninterrupted, pass);
+
+	{
+		// Render the first passes and checkpoint them in the background
+		std::unique_ptr<Film> film = MakeFilm();
+		CheckpointWriter writer("resume.ckpt", 0);
+		for (int pass = 0; pass < interruptAfter; ++pass) {
+			RenderPass(*film, pass);
+			ASSERT_TRUE(writer.Due());
+			RenderCheckpoint cp;
+			cp.samplesCompleted = pass + 1;
+			cp.pixelBounds = film->croppedPixelBounds;
+			ASSERT_TRUE(film->GetState(&cp.filmState));
+			writer.Submit(std::move(cp));
+		}
+		EXPECT_TRUE(writer.Flush());
+	}
+
+	RenderCheckpoint cp;
+	ASSERT_TRUE(ReadCheckpoint("resume.ckpt", &cp));
+	std::remove("resume.ckpt");
+	EXPECT_EQ(interruptAfter, cp.samplesCompleted);
+	std::unique_ptr<Film> resumed = MakeFilm();
+	ASSERT_EQ(resumed->croppedPixelBounds, cp.pixelBounds);
+	ASSERT_TRUE(resumed->SetState(cp.filmState));
+	for (int pass = (int)cp.samplesCompleted; pass < nPasses; ++pass) RenderPass(*resumed, pass);
+
+	// The same operations in the same order give bit-identical pixels
+	EXPECT_EQ(uninterrupted->GetImage(), resumed->GetImage());
+
+	// State from a film of another size is refused
+	Film other(Point2i(8, 8), Bounds2f(Point2f(0, 0), Point2f(1, 1)),
+		std::unique_ptr<Filter>(new BoxFilter(Vector2f(0.5f, 0.5f))), "other.pfm");
+	EXPECT_FALSE(other.SetState(cp.filmState));
+}
+
+TEST(TestCheckpoint, WriterKeepsLatest) {
+	{
+		CheckpointWriter writer("latest.ckpt", 3600);
+		EXPECT_FALSE(writer.Due());
+		for (int i = 1; i <= 50; ++i) {
+			RenderCheckpoint cp;
+			cp.samplesCompleted = i;
+			cp.filmState.assign(10000, (Float)i);
+			writer.Submit(std::move(cp));
+		}
+		// The destructor waits for the last checkpoint
+	}
+	RenderCheckpoint cp;
+	ASSERT_TRUE(ReadCheckpoint("latest.ckpt", &cp));
+	std::remove("latest.ckpt");
+	EXPECT_EQ(50, cp.samplesCompleted);
+	EXPECT_EQ(50, cp.filmState.back());
+}
+
+#pragma endregion Checkpoint
@@ -0,0 +1,345 @@
+#include "tests/gtest/gtest.h"
+#include "pbr.h"
+#include "film.h"
+#include "api.h"
+#include "filters/box.h"
+#include "imageio.h"
+#include "paramset.h"
+#include <cstdio>
+#include <random>
+#include <thread>
+
+using namespace pbr;
+
+// One pixel wide box, which reproduces unfiltered pixel averages
+static std::unique_ptr<Filter> PixelBox() {
+	return std::unique_ptr<Filter>(new BoxFilter(Vector2f(0.5f, 0.5f)));
+}
+
+#pragma region Filter
+
+TEST(TestFilter, Support) {
+	const char* names[] = { "box", "triangle", "gaussian", "mitchell", "sinc" };
+	for (const char* name : names) {
+		std::unique_ptr<Filter> filter = MakeFilter(name, ParamSet());
+		ASSERT_TRUE(filter != nullptr) << name;
+		EXPECT_GT(filter->Evaluate(Point2f(0, 0)), 0) << name;
+		for (Float t = 0; t <= 1; t += 0.125f) {
+			Point2f p(t * filter->radius.x, 0.3f * t * filter->radius.y);
+			// Separable filters are symmetric in each axis
+			EXPECT_FLOAT_EQ(filter->Evaluate(p), filter->Evaluate(Point2f(-p.x, p.y))) << name;
+			EXPECT_FLOAT_EQ(filter->Evaluate(p), filter->Evaluate(Point2f(p.x, -p.y))) << name;
+		}
+		if (std::string(name) != "box") {
+			EXPECT_NEAR(0, filter->Evaluate(Point2f(filter->radius.x, 0)), 1e-6f) << name;
+		}
+	}
+	EXPECT_TRUE(MakeFilter("nosuchfilter", ParamSet()) == nullptr);
+}
+
+TEST(TestFilter, TabulatedWeights) {
+	// The tabulated weight seen by each pixel is within half a table cell
+	// of the exact filter value
+	std::unique_ptr<Filter> gaussian = MakeFilter("gaussian", ParamSet());
+	const Filter* filter = gaussian.get();
+	Film film(Point2i(16, 16), Bounds2f(Point2f(0, 0), Point2f(1, 1)), std::move(gaussian), "filter.pfm");
+	std::unique_ptr<FilmTile> tile = film.GetFilmTile(film.GetSampleBounds());
+	Point2f pFilm(8.3f, 7.85f);
+	RGBSpectrum L(1);
+	tile->AddSample(pFilm, L);
+
+	// The steepest slope of exp(-2 x^2) is below 1 and cells are 1/8 wide
+	const Float tolerance = 1.f / 16;
+	int nonzero = 0;
+	for (int y = 4; y < 12; ++y)
+		for (int x = 4; x < 12; ++x) {
+			Vector2f d = Point2f(x + 0.5f, y + 0.5f) - pFilm;
+			Float exact = (std::abs(d.x) < 2 && std::abs(d.y) < 2) ? filter->Evaluate(Point2f(d.x, d.y)) : 0;
+			const FilmTilePixel& pixel = tile->GetPixel(Point2i(x, y));
+			EXPECT_NEAR(exact, pixel.filterWeightSum, tolerance) << x << ", " << y;
+			if (pixel.filterWeightSum > 0) ++nonzero;
+		}
+	EXPECT_EQ(16, nonzero);
+}
+
+TEST(TestFilter, ConstantImage) {
+	// Normalizing by the weight sum reproduces a constant signal, even
+	// with Mitchell's negative lobes
+	Film film(Point2i(24, 20), Bounds2f(Point2f(0, 0), Point2f(1, 1)), MakeFilter("mitchell", ParamSet()),
+		"constant.pfm");
+	Bounds2i sampleBounds = film.GetSampleBounds();
+	std::unique_ptr<FilmTile> tile = film.GetFilmTile(sampleBounds);
+	for (int y = sampleBounds.pMin.y; y < sampleBounds.pMax.y; ++y)
+		for (int x = sampleBounds.pMin.x; x < sampleBounds.pMax.x; ++x)
+			for (int s = 0; s < 9; ++s) {
+				RGBSpectrum L(0.25f, 1, 3);
+				tile->AddSample(Point2f(x + (s % 3 + 0.5f) / 3, y + (s / 3 + 0.5f) / 3), L);
+			}
+	film.MergeFilmTile(std::move(tile));
+	std::vector<Float> rgb = film.GetImage();
+	for (size_t i = 0; i < rgb.size(); i += 3) {
+		EXPECT_NEAR(0.25f, rgb[i], 1e-5f);
+		EXPECT_NEAR(1, rgb[i + 1], 1e-5f);
+		EXPECT_NEAR(3, rgb[i + 2], 1e-5f);
+	}
+}
+
+#pragma endregion Filter
+
+#pragma region Film
+
+TEST(TestFilm, CropWindow) {
+	// Crop fractions exact in binary so the pixel bounds match in float and double
+	Film film(Point2i(200, 80), Bounds2f(Point2f(0.25f, 0.125f), Point2f(0.75f, 0.5f)), PixelBox(), "crop.pfm");
+	EXPECT_EQ(Bounds2i(Point2i(50, 10), Point2i(150, 40)), film.croppedPixelBounds);
+	// Samples within the filter radius of the cropped pixels are needed
+	EXPECT_EQ(Bounds2i(Point2i(50, 10), Point2i(150, 40)), film.GetSampleBounds());
+
+	// Tiles are clipped to the cropped pixels, and include the pixels
+	// whose filter support reaches the far sample boundary
+	std::unique_ptr<FilmTile> tile = film.GetFilmTile(Bounds2i(Point2i(40, 0), Point2i(60, 20)));
+	EXPECT_EQ(Bounds2i(Point2i(50, 10), Point2i(61, 21)), tile->GetPixelBounds());
+	std::unique_ptr<FilmTile> outside = film.GetFilmTile(Bounds2i(Point2i(0, 0), Point2i(10, 10)));
+	EXPECT_EQ(0, outside->GetPixelBounds().SurfaceArea());
+	film.MergeFilmTile(std::move(outside));
+}
+
+TEST(TestFilm, ParallelTileMerge) {
+	Film film(Point2i(100, 70), Bounds2f(Point2f(0, 0), Point2f(1, 1)), PixelBox(), "merge.pfm");
+	Bounds2i sampleBounds = film.GetSampleBounds();
+	const int tileSize = 16, spp = 4;
+	Point2i nTiles((sampleBounds.pMax.x - sampleBounds.pMin.x + tileSize - 1) / tileSize,
+		(sampleBounds.pMax.y - sampleBounds.pMin.y + tileSize - 1) / tileSize);
+	ParallelFor2D([&](Point2i tile) {
+		Point2i p0 = sampleBounds.pMin + tile * tileSize;
+		Point2i p1 = Min(p0 + Point2i(tileSize, tileSize), sampleBounds.pMax);
+		std::unique_ptr<FilmTile> filmTile = film.GetFilmTile(Bounds2i(p0, p1));
+		for (int y = p0.y; y < p1.y; ++y)
+			for (int x = p0.x; x < p1.x; ++x)
+				for (int s = 0; s < spp; ++s) {
+					// Stratified positions strictly inside the pixel
+					Point2f pFilm(x + (s % 2 + 0.5f) / 2, y + (s / 2 + 0.5f) / 2);
+					RGBSpectrum L((Float)x, (Float)y, 1);
+					filmTile->AddSample(pFilm, L);
+				}
+		film.MergeFilmTile(std::move(filmTile));
+	}, nTiles);
+
+	std::vector<Float> rgb = film.GetImage();
+	ASSERT_EQ(3u * 100 * 70, rgb.size());
+	for (int y = 0; y < 70; ++y)
+		for (int x = 0; x < 100; ++x) {
+			const Float* pixel = &rgb[3 * (y * 100 + x)];
+			EXPECT_FLOAT_EQ(x, pixel[0]);
+			EXPECT_FLOAT_EQ(y, pixel[1]);
+			EXPECT_FLOAT_EQ(1, pixel[2]);
+		}
+}
+
+TEST(TestFilm, ConcurrentSplats) {
+	// Many more threads than pixels per cache line; every add must land
+	Film film(Point2i(8, 8), Bounds2f(Point2f(0, 0), Point2f(1, 1)), PixelBox(), "splat.pfm");
+	const int nThreads = 64, nSplats = 20000;
+	std::vector<std::thread> threads;
+	for (int t = 0; t < nThreads; ++t)
+		threads.push_back(std::thread([&film, t]() {
+			for (int i = 0; i < nSplats; ++i) {
+				int pixel = (t + i) % 64;
+				RGBSpectrum v(1, 2, 0.5f);
+				film.AddSplat(Point2f(pixel % 8 + 0.5f, pixel / 8 + 0.5f), v);
+			}
+		}));
+	for (std::thread& t : threads) t.join();
+
+	// Out-of-bounds and non-finite splats are dropped
+	RGBSpectrum v(1);
+	film.AddSplat(Point2f(-0.5f, 3), v);
+	film.AddSplat(Point2f(8, 3), v);
+	RGBSpectrum bad(1, std::numeric_limits<Float>::quiet_NaN(), 1);
+	film.AddSplat(Point2f(3, 3), bad);
+
+	std::vector<Float> rgb = film.GetImage(0.5f);
+	const Float perPixel = Float(nThreads) * nSplats / 64;
+	for (int i = 0; i < 64; ++i) {
+		EXPECT_EQ(0.5f * perPixel, rgb[3 * i]);
+		EXPECT_EQ(perPixel, rgb[3 * i + 1]);
+		EXPECT_EQ(0.25f * perPixel, rgb[3 * i + 2]);
+	}
+}
+
+TEST(TestFilm, WritePFM) {
+	ParamSet ps;
+	ps.AddInt("xresolution", std::unique_ptr<int[]>(new int[1]{ 7 }));
+	ps.AddInt("yresolution", std::unique_ptr<int[]>(new int[1]{ 5 }));
+	ps.AddString("filename", std::unique_ptr<std::string[]>(new std::string[1]{ "film_test.pfm" }));
+	ps.AddFloat("scale", std::unique_ptr<Float[]>(new Float[1]{ 2 }));
+	std::unique_ptr<Film> film = CreateFilm(ps, PixelBox());
+
+	std::unique_ptr<FilmTile> tile = film->GetFilmTile(film->GetSampleBounds());
+	for (int y = 0; y < 5; ++y)
+		for (int x = 0; x < 7; ++x) {
+			RGBSpectrum L((Float)x, (Float)y, (Float)(x * y));
+			tile->AddSample(Point2f(x + 0.5f, y + 0.5f), L);
+		}
+	film->MergeFilmTile(std::move(tile));
+	ASSERT_TRUE(film->WriteImage());
+
+	Point2i res;
+	std::unique_ptr<Float[]> rgb = ReadImage("film_test.pfm", &res);
+	std::remove("film_test.pfm");
+	ASSERT_TRUE(rgb != nullptr);
+	EXPECT_EQ(Point2i(7, 5), res);
+	for (int y = 0; y < 5; ++y)
+		for (int x = 0; x < 7; ++x) {
+			EXPECT_EQ(2 * x, rgb[3 * (y * 7 + x)]);
+			EXPECT_EQ(2 * y, rgb[3 * (y * 7 + x) + 1]);
+			EXPECT_EQ(2 * x * y, rgb[3 * (y * 7 + x) + 2]);
+		}
+}
+
+// Renders a deterministic pattern into film, tile by tile in row-major order;
+// the first tile is optionally held back until the end
+static void RenderTiles(Film& film, int tileSize, bool firstTileLast = false) {
+	Point2i nTiles = film.GetTileCount(tileSize);
+	int nTileCount = nTiles.x * nTiles.y;
+	for (int i = 0; i < nTileCount; ++i) {
+		int t = firstTileLast ? (i + 1) % nTileCount : i;
+		Bounds2i sampleBounds = film.GetTileSampleBounds(Point2i(t % nTiles.x, t / nTiles.x), tileSize);
+		std::unique_ptr<FilmTile> tile = film.GetFilmTile(sampleBounds);
+		for (int y = sampleBounds.pMin.y; y < sampleBounds.pMax.y; ++y)
+			for (int x = sampleBounds.pMin.x; x < sampleBounds.pMax.x; ++x) {
+				RGBSpectrum L((Float)(x % 7), (Float)(y % 5), (Float)((x * y) % 3));
+				tile->AddSample(Point2f(x + 0.3f, y + 0.7f), L);
+			}
+		film.MergeFilmTile(std::move(tile));
+	}
+}
+
+TEST(TestFilm, StreamingMatchesBuffered) {
+	const int tileSize = 16;
+	Point2i res(90, 75);
+	Bounds2f crop(Point2f(0, 0), Point2f(1, 1));
+	Film buffered(res, crop, MakeFilter("gaussian", ParamSet()), "buffered.pfm");
+	RenderTiles(buffered, tileSize);
+	std::vector<Float> expected = buffered.GetImage();
+
+	Film streamed(res, crop, MakeFilter("gaussian", ParamSet()), "streamed.pfm", 1, tileSize);
+	ASSERT_TRUE(streamed.IsStreaming());
+	RenderTiles(streamed, tileSize);
+	// Rows are freed once the tile row below them is merged: one tile row
+	// plus the rows the radius 2 filter spreads samples into
+	EXPECT_LE(streamed.PeakResidentRows(), tileSize + 2 * 2);
+	ASSERT_TRUE(streamed.WriteImage());
+
+	Point2i readRes;
+	std::unique_ptr<Float[]> rgb = ReadImage("streamed.pfm", &readRes);
+	std::remove("streamed.pfm");
+	ASSERT_TRUE(rgb != nullptr);
+	EXPECT_EQ(res, readRes);
+	for (size_t i = 0; i < expected.size(); ++i) EXPECT_EQ((float)expected[i], (float)rgb[i]) << i;
+}
+
+TEST(TestFilm, StreamingOutOfOrder) {
+	const int tileSize = 16;
+	Point2i res(90, 75);
+	Bounds2f crop(Point2f(0, 0), Point2f(1, 1));
+	Film buffered(res, crop, MakeFilter("gaussian", ParamSet()), "buffered.pfm");
+	RenderTiles(buffered, tileSize, true);
+	std::vector<Float> expected = buffered.GetImage();
+
+	Film streamed(res, crop, MakeFilter("gaussian", ParamSet()), "streamed.pfm", 1, tileSize);
+	ASSERT_TRUE(streamed.IsStreaming());
+	RenderTiles(streamed, tileSize, true);
+	// Only the rows the late first tile reaches wait for it; the bands
+	// below are written as they complete
+	EXPECT_LE(streamed.PeakResidentRows(), 2 * (tileSize + 2 * 2));
+	ASSERT_TRUE(streamed.WriteImage());
+
+	Point2i readRes;
+	std::unique_ptr<Float[]> rgb = ReadImage("streamed.pfm", &readRes);
+	std::remove("streamed.pfm");
+	ASSERT_TRUE(rgb != nullptr);
+	EXPECT_EQ(res, readRes);
+	for (size_t i = 0; i < expected.size(); ++i) EXPECT_EQ((float)expected[i], (float)rgb[i]) << i;
+}
+
+TEST(TestFilm, StreamingUnfinished) {
+	// Rows no tile reached are written black when the film is finished early
+	Film film(Point2i(20, 40), Bounds2f(Point2f(0, 0), Point2f(1, 1)), PixelBox(), "partial.pfm", 1, 8);
+	ASSERT_TRUE(film.IsStreaming());
+	Bounds2i sampleBounds = film.GetTileSampleBounds(Point2i(1, 0), 8);
+	std::unique_ptr<FilmTile> tile = film.GetFilmTile(sampleBounds);
+	RGBSpectrum L(1, 2, 3);
+	for (int y = sampleBounds.pMin.y; y < sampleBounds.pMax.y; ++y)
+		for (int x = sampleBounds.pMin.x; x < sampleBounds.pMax.x; ++x) tile->AddSample(Point2f(x + 0.5f, y + 0.5f), L);
+	film.MergeFilmTile(std::move(tile));
+	ASSERT_TRUE(film.WriteImage());
+
+	Point2i res;
+	std::unique_ptr<Float[]> rgb = ReadImage("partial.pfm", &res);
+	std::remove("partial.pfm");
+	ASSERT_TRUE(rgb != nullptr);
+	EXPECT_EQ(Point2i(20, 40), res);
+	for (int y = 0; y < 40; ++y)
+		for (int x = 0; x < 20; ++x) {
+			bool covered = InsideExclusive(Point2i(x, y), sampleBounds);
+			EXPECT_EQ(covered ? 2 : 0, rgb[3 * (y * 20 + x) + 1]) << x << ", " << y;
+		}
+}
+
+TEST(TestFilm, VarianceEstimator) {
+	std::mt19937 rng(7);
+	std::uniform_real_distribution<Float> value(-3, 5);
+	std::vector<Float> values;
+	VarianceEstimator all, a, b;
+	for (int i = 0; i < 1000; ++i) {
+		values.push_back(value(rng));
+		all.Add(values.back());
+		(i < 300 ? a : b).Add(values.back());
+	}
+	// Two-pass reference
+	double mean = 0, variance = 0;
+	for (Float v : values) mean += v;
+	mean /= values.size();
+	for (Float v : values) variance += (v - mean) * (v - mean);
+	variance /= values.size() - 1;
+	EXPECT_NEAR(mean, all.Mean(), 1e-4);
+	EXPECT_NEAR(variance, all.Variance(), 1e-3);
+
+	a.Merge(b);
+	a.Merge(VarianceEstimator());
+	EXPECT_EQ(1000, a.Count());
+	EXPECT_NEAR(mean, a.Mean(), 1e-4);
+	EXPECT_NEAR(variance, a.Variance(), 1e-3);
+}
+
+TEST(TestFilm, RelativeError) {
+	Film film(Point2i(32, 16), Bounds2f(Point2f(0, 0), Point2f(1, 1)), PixelBox(), "variance.pfm");
+	Bounds2i left(Point2i(0, 0), Point2i(16, 16)), right(Point2i(16, 0), Point2i(32, 16));
+	EXPECT_EQ(Infinity, film.GetRelativeError(left));
+
+	// Constant radiance on the left; on the right, alternating 0 and 2,
+	// whose luminance has sample variance n / (n - 1) around mean 1
+	const int n = 16;
+	std::unique_ptr<FilmTile> tile = film.GetFilmTile(film.GetSampleBounds());
+	for (int y = 0; y < 16; ++y)
+		for (int x = 0; x < 32; ++x)
+			for (int s = 0; s < n; ++s) {
+				Float v = x < 16 ? 1 : 2 * (s % 2);
+				RGBSpectrum L(v);
+				tile->AddSample(Point2f(x + 0.5f, y + 0.5f), L);
+			}
+	film.MergeFilmTile(std::move(tile));
+	EXPECT_NEAR(0, film.GetRelativeError(left), 1e-5f);
+	Float expected = std::sqrt(Float(n) / (n - 1) / n);
+	EXPECT_NEAR(expected, film.GetRelativeError(right), 1e-4f);
+
+	// The estimates survive a checkpoint round trip
+	std::vector<Float> state;
+	ASSERT_TRUE(film.GetState(&state));
+	Film restored(Point2i(32, 16), Bounds2f(Point2f(0, 0), Point2f(1, 1)), PixelBox(), "variance.pfm");
+	ASSERT_TRUE(restored.SetState(state));
+	EXPECT_FLOAT_EQ(film.GetRelativeError(right), restored.GetRelativeError(right));
+}
+
+#pragma endregion Film
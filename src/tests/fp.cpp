@@ -0,0 +1,191 @@
+#include "tests/gtest/gtest.h"
+#include "pbr.h"
+#include "geometry.h"
+#include "efloat.h"
+#include "interaction.h"
+#include <random>
+
+using namespace pbr;
+
+#pragma region NextFloat
+
+TEST(TestFloatingPoint, NextUpDownFloat) {
+	EXPECT_GT(NextFloatUp(-0.f), 0.f);
+	EXPECT_LT(NextFloatDown(0.f), 0.f);
+
+	EXPECT_EQ(NextFloatUp((float)Infinity), (float)Infinity);
+	EXPECT_EQ(NextFloatDown(-(float)Infinity), -(float)Infinity);
+
+	std::mt19937 rng(1);
+	std::uniform_int_distribution<uint32_t> bits;
+	for (int i = 0; i < 100000; ++i) {
+		float f = BitsToFloat(bits(rng));
+		if (std::isinf(f) || std::isnan(f)) continue;
+		// The neighbours are strictly ordered and one ulp away
+		EXPECT_LT(f, NextFloatUp(f));
+		EXPECT_GT(f, NextFloatDown(f));
+		if (f != 0) {
+			EXPECT_EQ(f, NextFloatDown(NextFloatUp(f)));
+			EXPECT_EQ(f, NextFloatUp(NextFloatDown(f)));
+		}
+	}
+}
+
+TEST(TestFloatingPoint, NextUpDownDouble) {
+	EXPECT_GT(NextFloatUp(-0.), 0.);
+	EXPECT_LT(NextFloatDown(0.), 0.);
+
+	std::mt19937_64 rng(2);
+	for (int i = 0; i < 100000; ++i) {
+		double d = BitsToFloat((uint64_t)rng());
+		if (std::isinf(d) || std::isnan(d)) continue;
+		EXPECT_LT(d, NextFloatUp(d));
+		EXPECT_GT(d, NextFloatDown(d));
+	}
+}
+
+TEST(TestFloatingPoint, Gamma) {
+	EXPECT_GT(gamma(1), MachineEpsilon);
+	EXPECT_LT(gamma(3), gamma(5));
+	EXPECT_LT(gamma(5), 1e-5f);
+}
+
+TEST(TestFloatingPoint, Half) {
+	// Every finite half converts to float and back exactly
+	for (uint32_t h = 0; h < 65536; ++h) {
+		float f = HalfToFloat((uint16_t)h);
+		if (std::isnan(f))
+			EXPECT_TRUE(std::isnan(HalfToFloat(FloatToHalf(f))));
+		else
+			EXPECT_EQ(h, FloatToHalf(f)) << f;
+	}
+
+	EXPECT_EQ(1.f, HalfToFloat(FloatToHalf(1.f)));
+	EXPECT_EQ(65504.f, HalfToFloat(FloatToHalf(65504.f)));
+	EXPECT_TRUE(std::isinf(HalfToFloat(FloatToHalf(65520.f))));
+	EXPECT_EQ(0x8000, FloatToHalf(-0.f));
+
+	// Ties round to even: 1 + 2^-11 lies halfway between 1 and 1 + 2^-10
+	EXPECT_EQ(1.f, HalfToFloat(FloatToHalf(1.f + 1.f / 2048)));
+	EXPECT_EQ(1.f + 2.f / 1024, HalfToFloat(FloatToHalf(1.f + 3.f / 2048)));
+
+	// Otherwise the result is within half an ulp
+	std::mt19937 rng(5);
+	std::uniform_real_distribution<float> value(-60000, 60000);
+	for (int i = 0; i < 10000; ++i) {
+		float f = value(rng);
+		EXPECT_LE(std::abs(HalfToFloat(FloatToHalf(f)) - f), std::abs(f) / 2048);
+	}
+}
+
+#pragma endregion NextFloat
+
+#pragma region EFloat
+
+// Builds a random expression and checks that the interval brackets the
+// same expression evaluated in long double precision.
+static EFloat RandomExpression(std::mt19937& rng, int depth, long double* precise) {
+	std::uniform_real_distribution<float> value(-100, 100);
+	std::uniform_int_distribution<int> op(0, depth > 0 ? 5 : 0);
+	switch (op(rng)) {
+	case 0: {
+		float v = value(rng);
+		*precise = v;
+		return EFloat(v);
+	}
+	case 1: {
+		long double a, b;
+		EFloat ea = RandomExpression(rng, depth - 1, &a), eb = RandomExpression(rng, depth - 1, &b);
+		*precise = a + b;
+		return ea + eb;
+	}
+	case 2: {
+		long double a, b;
+		EFloat ea = RandomExpression(rng, depth - 1, &a), eb = RandomExpression(rng, depth - 1, &b);
+		*precise = a - b;
+		return ea - eb;
+	}
+	case 3: {
+		long double a, b;
+		EFloat ea = RandomExpression(rng, depth - 1, &a), eb = RandomExpression(rng, depth - 1, &b);
+		*precise = a * b;
+		return ea * eb;
+	}
+	case 4: {
+		long double a, b;
+		EFloat ea = RandomExpression(rng, depth - 1, &a), eb = RandomExpression(rng, depth - 1, &b);
+		*precise = a / b;
+		return ea / eb;
+	}
+	default: {
+		long double a;
+		EFloat ea = abs(RandomExpression(rng, depth - 1, &a));
+		*precise = std::sqrt(std::abs(a));
+		return sqrt(ea);
+	}
+	}
+}
+
+TEST(TestEFloat, BoundsContainPreciseResult) {
+	std::mt19937 rng(3);
+	for (int i = 0; i < 10000; ++i) {
+		long double precise;
+		EFloat ef = RandomExpression(rng, 4, &precise);
+		if (std::isnan(precise) || std::isinf(precise)) continue;
+		EXPECT_LE(ef.LowerBound(), precise);
+		EXPECT_GE(ef.UpperBound(), precise);
+	}
+}
+
+TEST(TestEFloat, Quadratic) {
+	// (t - 2)(t - 3) = t^2 - 5t + 6
+	EFloat t0, t1;
+	ASSERT_TRUE(Quadratic(EFloat(1), EFloat(-5), EFloat(6), &t0, &t1));
+	EXPECT_LE(t0.LowerBound(), 2);
+	EXPECT_GE(t0.UpperBound(), 2);
+	EXPECT_LE(t1.LowerBound(), 3);
+	EXPECT_GE(t1.UpperBound(), 3);
+
+	EXPECT_FALSE(Quadratic(EFloat(1), EFloat(0), EFloat(1), &t0, &t1));
+}
+
+#pragma endregion EFloat
+
+#pragma region OffsetRayOrigin
+
+TEST(TestOffsetRayOrigin, LeavesSurfaceOnRaySide) {
+	std::mt19937 rng(4);
+	std::uniform_real_distribution<Float> pos(-1000, 1000), dir(-1, 1);
+	for (int i = 0; i < 10000; ++i) {
+		Point3f p(pos(rng), pos(rng), pos(rng));
+		Normal3f n = Normalize(Normal3f(dir(rng), dir(rng), dir(rng)));
+		Vector3f pError = gamma(7) * Vector3f(Abs(p));
+		Vector3f w(dir(rng), dir(rng), dir(rng));
+
+		Point3f po = OffsetRayOrigin(p, pError, n, w);
+		// Every point of the error box lies strictly behind the offset plane
+		Float offset = Dot(po - p, n);
+		Float extent = Dot(Abs(n), pError);
+		if (Dot(w, n) < 0)
+			EXPECT_LT(offset, -extent);
+		else
+			EXPECT_GT(offset, extent);
+	}
+}
+
+TEST(TestOffsetRayOrigin, SpawnRayTo) {
+	Interaction a(Point3f(0, 0, 0), Normal3f(0, 0, 1), Vector3f(1e-4f, 1e-4f, 1e-4f), Vector3f(0, 0, 1), 0);
+	Interaction b(Point3f(0, 0, 10), Normal3f(0, 0, -1), Vector3f(1e-4f, 1e-4f, 1e-4f), Vector3f(0, 0, -1), 0);
+
+	Ray r = a.SpawnRayTo(b);
+	EXPECT_GT(r.o.z, 0);
+	Point3f end = r.o + r.d * (1 - ShadowEpsilon);
+	EXPECT_LT(end.z, 10);
+	EXPECT_EQ(1 - ShadowEpsilon, r.tMax);
+
+	Ray away = a.SpawnRay(Vector3f(0, 0, -1));
+	EXPECT_LT(away.o.z, 0);
+	EXPECT_EQ(Infinity, away.tMax);
+}
+
+#pragma endregion OffsetRayOrigin
@@ -1,6 +1,9 @@
 #include "tests/gtest/gtest.h"
 #include "pbr.h"
 #include "geometry.h"
+#include "interaction.h"
+#include "transform.h"
+#include <random>
 
 using namespace pbr;
 
@@ -633,6 +636,56 @@ TEST(TestNormal3, Comparison) {
 
 #pragma endregion Normal3
 
+#pragma region CompressedNormal
+
+static std::vector<Normal3f> RandomNormals(int n, uint32_t seed) {
+	std::mt19937 rng(seed);
+	std::normal_distribution<Float> g;
+	std::vector<Normal3f> normals = {
+		Normal3f(1, 0, 0), Normal3f(-1, 0, 0), Normal3f(0, 1, 0), Normal3f(0, -1, 0),
+		Normal3f(0, 0, 1), Normal3f(0, 0, -1), Normalize(Normal3f(1, -1, 0)), Normalize(Normal3f(-1, 1, -1e-6f))
+	};
+	while ((int)normals.size() < n) normals.push_back(Normalize(Normal3f(g(rng), g(rng), g(rng))));
+	return normals;
+}
+
+TEST(TestCompressedNormal, AngularError) {
+	// 16 bits per octahedral coordinate keeps every decoded normal within
+	// 0.005 degrees of the input
+	const Float maxAngle = 0.005f * Float(3.14159265358979) / 180;
+	Float worst = 0;
+	for (const Normal3f& n : RandomNormals(200000, 1)) {
+		Normal3f d = CompressedNormal(n).Decode();
+		EXPECT_NEAR(1, d.Length(), 1e-5f);
+		// The chord length gives the angle accurately even for tiny errors
+		double chord = std::sqrt(double(n.x - d.x) * (n.x - d.x) + double(n.y - d.y) * (n.y - d.y) +
+			double(n.z - d.z) * (n.z - d.z));
+		worst = std::max(worst, Float(2 * std::asin(chord / 2)));
+	}
+	EXPECT_LT(worst, maxAngle);
+
+	// Decoding is stable: re-encoding gives back the same bits
+	for (const Normal3f& n : RandomNormals(1000, 2)) {
+		CompressedNormal c(n);
+		EXPECT_EQ(c, CompressedNormal(c.Decode()));
+	}
+}
+
+TEST(TestCompressedNormal, BatchMatchesScalar) {
+	// Odd count exercises the scalar tail after the SIMD loop
+	std::vector<Normal3f> normals = RandomNormals(1003, 3);
+	std::vector<CompressedNormal> encoded(normals.size());
+	EncodeNormals(normals.data(), normals.size(), encoded.data());
+	std::vector<Normal3f> decoded(normals.size());
+	DecodeNormals(encoded.data(), encoded.size(), decoded.data());
+	for (size_t i = 0; i < normals.size(); ++i) {
+		EXPECT_EQ(CompressedNormal(normals[i]), encoded[i]);
+		EXPECT_EQ(encoded[i].Decode(), decoded[i]);
+	}
+}
+
+#pragma endregion CompressedNormal
+
 #pragma region Bounds2
 
 TEST(TestBounds2, Initializer) {
@@ -690,7 +743,7 @@ TEST(TestBounds2, BoundingSphere) {
 	Bounds2f b1(p1, p2);
 
 	Point2f center;
-	float radius;
+	Float radius;
 	b1.BoundingSphere(&center, &radius);
 	EXPECT_EQ(Point2f(3.5, 4.5), center);
 }
@@ -760,7 +813,7 @@ TEST(TestBounds3, Measurements) {
 
 	EXPECT_EQ(Vector3i(6, 5, 4), b1.Diagonal());
 
-	EXPECT_EQ(120, b1.SurfaceArea());
+	EXPECT_EQ(148, b1.SurfaceArea());
 
 	EXPECT_EQ(0, b1.MaximumExtent());
 }
@@ -781,7 +834,7 @@ TEST(TestBounds3, BoundingSphere) {
 	Bounds3f b1(p1, p2);
 
 	Point3f center;
-	float radius;
+	Float radius;
 	b1.BoundingSphere(&center, &radius);
 	EXPECT_EQ(Point3f(3.5, 4.5, 5.5), center);
 }
@@ -813,4 +866,161 @@ TEST(TestBounds3, SetOperations) {
 	EXPECT_EQ(Point3f(7, 7, 7), b6.pMax);
 }
 
-#pragma endregion Bounds3
\ No newline at end of file
+#pragma endregion Bounds3
+
+#pragma region Transform
+
+static void ExpectNear(const Point3f& expected, const Point3f& p, Float tolerance = 1e-5f) {
+	EXPECT_NEAR(expected.x, p.x, tolerance);
+	EXPECT_NEAR(expected.y, p.y, tolerance);
+	EXPECT_NEAR(expected.z, p.z, tolerance);
+}
+
+TEST(TestTransform, Inverse) {
+	Transform t = Translate(Vector3f(1, 2, 3)) * Rotate(30, Vector3f(1, 1, 0)) * Scale(2, 3, 4);
+	Point3f p(5, -6, 7);
+	ExpectNear(p, Inverse(t)(t(p)));
+	ExpectNear(p, Transform(Inverse(t.GetMatrix()))(t(p)));
+	EXPECT_FALSE(t.SwapsHandedness());
+	EXPECT_TRUE(Scale(1, -1, 1).SwapsHandedness());
+}
+
+TEST(TestTransform, Rotate) {
+	Point3f p(1, 2, 3);
+	ExpectNear(RotateX(40)(p), Rotate(40, Vector3f(2, 0, 0))(p));
+	ExpectNear(RotateY(40)(p), Rotate(40, Vector3f(0, 1, 0))(p));
+	ExpectNear(RotateZ(40)(p), Rotate(40, Vector3f(0, 0, 3))(p));
+	ExpectNear(Point3f(-2, 1, 3), RotateZ(90)(p));
+}
+
+TEST(TestTransform, LookAt) {
+	// Camera space has the camera at the origin looking down +z with +y up
+	// and +x to the right (left-handed)
+	Transform worldToCamera = LookAt(Point3f(1, 2, 3), Point3f(1, 2, 10), Vector3f(0, 1, 0));
+	ExpectNear(Point3f(0, 0, 0), worldToCamera(Point3f(1, 2, 3)));
+	ExpectNear(Point3f(0, 0, 7), worldToCamera(Point3f(1, 2, 10)));
+	ExpectNear(Point3f(0, 1, 0), worldToCamera(Point3f(1, 3, 3)));
+	ExpectNear(Point3f(1, 0, 0), worldToCamera(Point3f(2, 2, 3)));
+}
+
+TEST(TestTransform, Projections) {
+	Transform persp = Perspective(90, 1, 100);
+	ExpectNear(Point3f(0, 0, 0), persp(Point3f(0, 0, 1)));
+	ExpectNear(Point3f(1, -1, 1), persp(Point3f(100, -100, 100)), 1e-4f);
+	ExpectNear(Point3f(0.5f, 0, Float(50) / 99), persp(Point3f(1, 0, 2)), 1e-4f);
+
+	Transform ortho = Orthographic(2, 6);
+	ExpectNear(Point3f(3, 4, 0), ortho(Point3f(3, 4, 2)));
+	ExpectNear(Point3f(3, 4, 1), ortho(Point3f(3, 4, 6)));
+}
+
+TEST(TestTransform, NormalsAndBounds) {
+	// Normals stay perpendicular to transformed tangents under a
+	// non-uniform scale
+	Transform t = Rotate(20, Vector3f(1, 2, 3)) * Scale(1, 5, 0.5f);
+	Vector3f v(1, -1, 0);
+	Normal3f n(1, 1, 0);
+	EXPECT_NEAR(0, Dot(t(v), t(n)), 1e-5f);
+
+	// Transformed bounds contain the transformed corners
+	Bounds3f b(Point3f(-1, 0, 2), Point3f(3, 4, 5));
+	Bounds3f tb = t(b);
+	for (int i = 0; i < 8; ++i) EXPECT_TRUE(Inside(t(b.Corner(i)), Expand(tb, 1e-4f)));
+}
+
+TEST(TestTransform, RayOriginError) {
+	// The transformed origin moves past its error bounds along the ray
+	Transform t = Translate(Vector3f(1000, 0, 0)) * RotateY(10);
+	Ray r = t(Ray(Point3f(1, 2, 3), Vector3f(0, 0, 1), 10));
+	Vector3f oError;
+	Point3f o = t(Point3f(1, 2, 3), &oError);
+	EXPECT_GT(oError.x, 0);
+	EXPECT_GE(Dot(r.o - o, t(Vector3f(0, 0, 1))), 0);
+	EXPECT_LE(r.tMax, 10);
+}
+
+#pragma endregion Transform
+
+#pragma region RayDifferential
+
+static void ExpectNear(const Vector3f& expected, const Vector3f& v, Float tolerance) {
+	EXPECT_NEAR(expected.x, v.x, tolerance);
+	EXPECT_NEAR(expected.y, v.y, tolerance);
+	EXPECT_NEAR(expected.z, v.z, tolerance);
+}
+
+TEST(TestRayDifferential, ScaleAndTransform) {
+	RayDifferential rd(Point3f(0, 0, 0), Vector3f(0, 0, 1));
+	EXPECT_FALSE(rd.hasDifferentials);
+	rd.hasDifferentials = true;
+	rd.rxOrigin = Point3f(1, 0, 0);
+	rd.ryOrigin = Point3f(0, 2, 0);
+	rd.rxDirection = Vector3f(0.5f, 0, 1);
+	rd.ryDirection = Vector3f(0, 0.5f, 1);
+	rd.ScaleDifferentials(0.25f);
+	ExpectNear(Point3f(0.25f, 0, 0), rd.rxOrigin);
+	ExpectNear(Point3f(0, 0.5f, 0), rd.ryOrigin);
+	ExpectNear(Vector3f(0.125f, 0, 1), rd.rxDirection, 1e-6f);
+
+	Transform t = Translate(Vector3f(1, 2, 3)) * RotateZ(90);
+	RayDifferential trd = t(rd);
+	EXPECT_TRUE(trd.hasDifferentials);
+	ExpectNear(t(rd.rxOrigin), trd.rxOrigin);
+	ExpectNear(t(rd.ryDirection), trd.ryDirection, 1e-6f);
+}
+
+// The unit sphere at its north pole, parameterized by x and y
+static SurfaceInteraction SpherePole() {
+	return SurfaceInteraction(Point3f(0, 0, 1), Vector3f(0, 0, 0), Point2f(0, 0), Vector3f(0, 0, 1),
+		Vector3f(1, 0, 0), Vector3f(0, 1, 0), Normal3f(1, 0, 0), Normal3f(0, 1, 0), 0);
+}
+
+TEST(TestRayDifferential, SpecularPropagation) {
+	// Rays straight down, the differentials offset by eps in x and y. The
+	// propagated differentials match the offset rays bounced off the sphere
+	// to first order.
+	const Float eps = 1e-3f;
+	RayDifferential ray(Point3f(0, 0, 3), Vector3f(0, 0, -1));
+	ray.hasDifferentials = true;
+	ray.rxOrigin = Point3f(eps, 0, 3);
+	ray.ryOrigin = Point3f(0, eps, 3);
+	ray.rxDirection = ray.ryDirection = ray.d;
+
+	SurfaceInteraction isect = SpherePole();
+	isect.ComputeDifferentials(ray);
+	ExpectNear(Vector3f(eps, 0, 0), isect.dpdx, 1e-6f);
+	EXPECT_NEAR(eps, isect.dudx, 1e-6f);
+	EXPECT_NEAR(0, isect.dvdx, 1e-6f);
+	EXPECT_NEAR(eps, isect.dvdy, 1e-6f);
+
+	Vector3f nx = Normalize(Vector3f(eps, 0, std::sqrt(1 - eps * eps)));
+	RayDifferential reflected = isect.SpawnReflectedRay(ray);
+	ASSERT_TRUE(reflected.hasDifferentials);
+	ExpectNear(Vector3f(0, 0, 1), reflected.d, 1e-6f);
+	ExpectNear(Vector3f(eps, 0, 1), Vector3f(reflected.rxOrigin), 1e-6f);
+	ExpectNear(Reflect(Vector3f(0, 0, 1), nx), reflected.rxDirection, 1e-5f);
+	EXPECT_GT(reflected.rxDirection.x, eps);
+
+	RayDifferential refracted;
+	ASSERT_TRUE(isect.SpawnRefractedRay(ray, 1.5f, &refracted));
+	Vector3f wt;
+	ASSERT_TRUE(Refract(Vector3f(0, 0, 1), Normal3f(nx), 1 / 1.5f, &wt));
+	ExpectNear(Vector3f(0, 0, -1), refracted.d, 1e-6f);
+	ExpectNear(wt, refracted.rxDirection, 1e-5f);
+	EXPECT_LT(refracted.rxDirection.x, 0);
+
+	// Leaving the sphere at a grazing angle reflects totally
+	RayDifferential inside(Point3f(0, 0, 0.5f), Normalize(Vector3f(1, 0, 0.1f)));
+	EXPECT_FALSE(isect.SpawnRefractedRay(inside, 1.5f, &refracted));
+}
+
+TEST(TestRayDifferential, NoDifferentials) {
+	SurfaceInteraction isect = SpherePole();
+	RayDifferential ray(Point3f(0, 0, 3), Vector3f(0, 0, -1));
+	isect.ComputeDifferentials(ray);
+	EXPECT_EQ(0, isect.dudx);
+	EXPECT_EQ(Vector3f(0, 0, 0), isect.dpdy);
+	EXPECT_FALSE(isect.SpawnReflectedRay(ray).hasDifferentials);
+}
+
+#pragma endregion RayDifferential
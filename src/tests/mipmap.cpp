@@ -0,0 +1,282 @@
+#include "tests/gtest/gtest.h"
+#include "pbr.h"
+#include "mipmap.h"
+#include "interaction.h"
+#include "parallel.h"
+#include "rng.h"
+#include <cstdio>
+
+using namespace pbr;
+
+// A 150x70 image spanning 3x2 tiles, texel (s, t) holding s + 1000 t
+static std::vector<Float> MakeImage(const Point2i& res) {
+	std::vector<Float> image(res.x * res.y);
+	for (int t = 0; t < res.y; ++t)
+		for (int s = 0; s < res.x; ++s) image[t * res.x + s] = Float(s + 1000 * t);
+	return image;
+}
+
+static const Point2i ImageRes(150, 70);
+static const size_t TileBytes = MIPMapTileSize * MIPMapTileSize * sizeof(Float);
+
+TEST(TestMIPMap, TiledRoundTrip) {
+	std::vector<Float> image = MakeImage(ImageRes);
+	ASSERT_TRUE(WriteTiledMIPMap("roundtrip.tiles", ImageRes, image.data()));
+	TileCache cache(64 * TileBytes, 4);
+	std::unique_ptr<MIPMap<Float>> mipmap = MIPMap<Float>::Open("roundtrip.tiles", &cache);
+	ASSERT_TRUE(mipmap != nullptr);
+	EXPECT_EQ(150, mipmap->Width());
+	EXPECT_EQ(70, mipmap->Height());
+	// 150x70, 75x35, 38x18, 19x9, 10x5, 5x3, 3x2, 2x1, 1x1
+	EXPECT_EQ(9, mipmap->Levels());
+
+	for (int t = 0; t < ImageRes.y; ++t)
+		for (int s = 0; s < ImageRes.x; ++s) ASSERT_EQ(image[t * ImageRes.x + s], mipmap->Texel(0, s, t));
+	EXPECT_EQ(Float(0.25) * (2 + 3 + 1002 + 1003), mipmap->Texel(1, 1, 0));
+	// Level 1 is 75 wide, so its last column stands in for its missing
+	// neighbour: 0.25 * (2 * 648.5 + 2 * 2648.5)
+	EXPECT_EQ(Float(1648.5), mipmap->Texel(2, 37, 0));
+
+	// Wrap modes
+	EXPECT_EQ(mipmap->Texel(0, 149, 69), mipmap->Texel(0, -1, -1));
+	std::unique_ptr<MIPMap<Float>> clamped = MIPMap<Float>::Open("roundtrip.tiles", &cache, ImageWrap::Clamp);
+	EXPECT_EQ(image[0], clamped->Texel(0, -5, -1));
+	std::unique_ptr<MIPMap<Float>> black = MIPMap<Float>::Open("roundtrip.tiles", &cache, ImageWrap::Black);
+	EXPECT_EQ(0, black->Texel(0, 150, 3));
+	EXPECT_EQ(image[3 * 150 + 149], black->Texel(0, 149, 3));
+
+	// Bilinear interpolation halfway between texel centers, and the 1x1
+	// level for footprints as large as the image
+	EXPECT_NEAR(10.5, clamped->Bilerp(0, Point2f(11.f / 150, 0.5f / 70)), 1e-3f);
+	EXPECT_EQ(mipmap->Texel(8, 0, 0), mipmap->Lookup(Point2f(0.3f, 0.6f), 1));
+	std::remove("roundtrip.tiles");
+}
+
+TEST(TestMIPMap, Bilerp) {
+	// Lookups within a tile take a single-fetch path; they match the
+	// interpolated texels everywhere, including across tile edges and wraps
+	std::vector<Float> image = MakeImage(ImageRes);
+	ASSERT_TRUE(WriteTiledMIPMap("bilerp.tiles", ImageRes, image.data()));
+	TileCache cache(64 * TileBytes, 4);
+	std::unique_ptr<MIPMap<Float>> mipmap = MIPMap<Float>::Open("bilerp.tiles", &cache);
+	ASSERT_TRUE(mipmap != nullptr);
+	RNG rng;
+	for (int i = 0; i < 10000; ++i) {
+		Point2f st(-0.2f + 1.4f * rng.UniformFloat(), -0.2f + 1.4f * rng.UniformFloat());
+		int level = i % 3;
+		Float s = st.x * (level == 0 ? 150 : level == 1 ? 75 : 38) - 0.5f;
+		Float t = st.y * (level == 0 ? 70 : level == 1 ? 35 : 18) - 0.5f;
+		int s0 = (int)std::floor(s), t0 = (int)std::floor(t);
+		Float ds = s - s0, dt = t - t0;
+		Float expected = (1 - ds) * (1 - dt) * mipmap->Texel(level, s0, t0) +
+			(1 - ds) * dt * mipmap->Texel(level, s0, t0 + 1) + ds * (1 - dt) * mipmap->Texel(level, s0 + 1, t0) +
+			ds * dt * mipmap->Texel(level, s0 + 1, t0 + 1);
+		ASSERT_NEAR(expected, mipmap->Bilerp(level, st), 1e-6f * std::abs(expected) + 1e-4f) << st << " " << level;
+	}
+	std::remove("bilerp.tiles");
+}
+
+TEST(TestMIPMap, EWAConstant) {
+	// Normalized weights reproduce a constant image for any footprint
+	Point2i res(100, 60);
+	std::vector<Float> image(res.x * res.y, Float(3.5));
+	ASSERT_TRUE(WriteTiledMIPMap("constant.tiles", res, image.data()));
+	TileCache cache(64 * TileBytes, 4);
+	std::unique_ptr<MIPMap<Float>> mipmap = MIPMap<Float>::Open("constant.tiles", &cache);
+	ASSERT_TRUE(mipmap != nullptr);
+	RNG rng;
+	for (int i = 0; i < 1000; ++i) {
+		Point2f st(rng.UniformFloat(), rng.UniformFloat());
+		Vector2f dst0(0.1f * (rng.UniformFloat() - 0.5f), 0.1f * (rng.UniformFloat() - 0.5f));
+		Vector2f dst1(0.01f * (rng.UniformFloat() - 0.5f), 0.01f * (rng.UniformFloat() - 0.5f));
+		ASSERT_NEAR(3.5, mipmap->Lookup(st, dst0, dst1), 1e-4f);
+	}
+	EXPECT_NEAR(3.5, mipmap->Lookup(Point2f(0.5f, 0.5f), Vector2f(0, 0), Vector2f(0, 0)), 1e-4f);
+	EXPECT_NEAR(3.5, mipmap->Lookup(Point2f(0.5f, 0.5f), Vector2f(5, 5), Vector2f(0, 1e-8f)), 1e-4f);
+	std::remove("constant.tiles");
+}
+
+TEST(TestMIPMap, EWATexelBound) {
+	// Each lookup filters two levels, so it reads at most twice the bound
+	std::vector<Float> image = MakeImage(Point2i(1024, 1024));
+	ASSERT_TRUE(WriteTiledMIPMap("bound.tiles", Point2i(1024, 1024), image.data()));
+	TileCache cache(512 * TileBytes, 4);
+	std::unique_ptr<MIPMap<Float>> mipmap =
+		MIPMap<Float>::Open("bound.tiles", &cache, ImageWrap::Repeat, MIPFilter::EWA, 4);
+	ASSERT_TRUE(mipmap != nullptr);
+	EXPECT_EQ(400, mipmap->EWATexelBound());
+	const Vector2f footprints[][2] = {
+		{ Vector2f(0.3f, 0.3f), Vector2f(1e-6f, -1e-6f) },
+		{ Vector2f(0.01f, 0), Vector2f(0, 0.01f) },
+		{ Vector2f(4, 0), Vector2f(0, 4) },
+		{ Vector2f(0.02f, 0.001f), Vector2f(-0.0004f, 0.01f) },
+	};
+	for (const auto& footprint : footprints) {
+		TileCache::Stats before = cache.GetStats();
+		mipmap->Lookup(Point2f(0.3f, 0.7f), footprint[0], footprint[1]);
+		TileCache::Stats after = cache.GetStats();
+		int64_t reads = after.microHits + after.hits + after.misses - (before.microHits + before.hits + before.misses);
+		EXPECT_GT(reads, 0);
+		EXPECT_LE(reads, 2 * mipmap->EWATexelBound());
+	}
+	std::remove("bound.tiles");
+}
+
+TEST(TestMIPMap, EWAGrazing) {
+	// Stripes 4 texels wide along u on the z = 0 plane, seen at a grazing
+	// angle down +y, so the footprint is 20 times longer in v than in u.
+	// EWA keeps the stripe's value, while trilinear filtering blurs it
+	// towards the mean.
+	Point2i res(256, 256);
+	std::vector<Float> image(res.x * res.y);
+	for (int t = 0; t < res.y; ++t)
+		for (int s = 0; s < res.x; ++s) image[t * res.x + s] = Float((s / 4) & 1);
+	ASSERT_TRUE(WriteTiledMIPMap("grazing.tiles", res, image.data()));
+	TileCache cache(64 * TileBytes, 4);
+	std::unique_ptr<MIPMap<Float>> ewa = MIPMap<Float>::Open("grazing.tiles", &cache);
+	std::unique_ptr<MIPMap<Float>> trilinear =
+		MIPMap<Float>::Open("grazing.tiles", &cache, ImageWrap::Repeat, MIPFilter::Trilinear);
+	ASSERT_TRUE(ewa != nullptr && trilinear != nullptr);
+
+	// The center of stripe 33 at v = 0.5
+	Float u = 134.f / 256;
+	Vector3f d(0, 1, -0.05f);
+	RayDifferential ray(Point3f(u, -0.5f, 0.05f), d);
+	ray.hasDifferentials = true;
+	ray.rxOrigin = ray.ryOrigin = ray.o;
+	ray.rxDirection = d + Vector3f(1e-3f, 0, 0);
+	ray.ryDirection = d + Vector3f(0, 0, 1e-3f);
+	SurfaceInteraction isect(Point3f(u, 0.5f, 0), Vector3f(0, 0, 0), Point2f(u, 0.5f), -d, Vector3f(1, 0, 0),
+		Vector3f(0, 1, 0), Normal3f(0, 0, 0), Normal3f(0, 0, 0), 0);
+	isect.ComputeDifferentials(ray);
+	Vector2f dst0(isect.dudx, isect.dvdx), dst1(isect.dudy, isect.dvdy);
+	EXPECT_GT(std::abs(isect.dvdy), 15 * std::abs(isect.dudx));
+
+	EXPECT_GT(ewa->Lookup(isect.uv, dst0, dst1), 0.9f);
+	Float blurred = trilinear->Lookup(isect.uv, dst0, dst1);
+	EXPECT_GT(blurred, 0.2f);
+	EXPECT_LT(blurred, 0.8f);
+	std::remove("grazing.tiles");
+}
+
+TEST(TestMIPMap, RejectsMismatchedFiles) {
+	std::vector<Float> image = MakeImage(ImageRes);
+	ASSERT_TRUE(WriteTiledMIPMap("mismatch.tiles", ImageRes, image.data()));
+	TileCache cache(16 * TileBytes);
+	EXPECT_TRUE(MIPMap<Point2f>::Open("mismatch.tiles", &cache) == nullptr);
+	EXPECT_TRUE(MIPMap<Float>::Open("missing.tiles", &cache) == nullptr);
+
+	// Truncated
+	std::vector<char> bytes(100);
+	ASSERT_TRUE(WriteFileAtomic("mismatch.tiles", bytes.data(), bytes.size()));
+	EXPECT_TRUE(MIPMap<Float>::Open("mismatch.tiles", &cache) == nullptr);
+	std::remove("mismatch.tiles");
+}
+
+TEST(TestTileCache, BoundedResidency) {
+	// A 1024x1024 image has 256 tiles at level 0; the cache holds 8
+	Point2i res(1024, 1024);
+	std::vector<Float> image = MakeImage(res);
+	ASSERT_TRUE(WriteTiledMIPMap("bounded.tiles", res, image.data()));
+	TileCache cache(8 * TileBytes, 2);
+	std::unique_ptr<MIPMap<Float>> mipmap = MIPMap<Float>::Open("bounded.tiles", &cache);
+	ASSERT_TRUE(mipmap != nullptr);
+
+	for (int pass = 0; pass < 2; ++pass)
+		for (int t = 0; t < res.y; t += 32)
+			for (int s = 0; s < res.x; s += 32) ASSERT_EQ(image[t * res.x + s], mipmap->Texel(0, s, t));
+	TileCache::Stats stats = cache.GetStats();
+	EXPECT_EQ(2 * 32 * 32, stats.microHits + stats.hits + stats.misses);
+	// Consecutive lookups in one tile hit the thread's micro-cache
+	EXPECT_GE(stats.microHits, 2 * 32 * 16);
+	EXPECT_GE(stats.misses, 256);
+	EXPECT_EQ(stats.misses - 8, stats.evictions);
+	EXPECT_LE(stats.peakResidentBytes, cache.Capacity());
+	EXPECT_EQ(8 * TileBytes, stats.residentBytes);
+
+	// Repeated lookups of a few tiles stay resident
+	TileCache::Stats before = cache.GetStats();
+	for (int i = 0; i < 1000; ++i) mipmap->Texel(0, (i % 4) * 64, 0);
+	TileCache::Stats after = cache.GetStats();
+	EXPECT_LE(after.misses - before.misses, 4);
+	EXPECT_GT(after.HitRate(), before.HitRate());
+	std::remove("bounded.tiles");
+}
+
+TEST(TestTileCache, SmallCapacity) {
+	// Three tiles' worth split over 64 shards: each shard's share is
+	// smaller than a tile, but the shards together keep to the capacity
+	Point2i res(1024, 1024);
+	std::vector<Float> image = MakeImage(res);
+	ASSERT_TRUE(WriteTiledMIPMap("small.tiles", res, image.data()));
+	TileCache cache(3 * TileBytes, 64);
+	std::unique_ptr<MIPMap<Float>> mipmap = MIPMap<Float>::Open("small.tiles", &cache);
+	ASSERT_TRUE(mipmap != nullptr);
+
+	for (int pass = 0; pass < 2; ++pass)
+		for (int t = 0; t < res.y; t += 32)
+			for (int s = 0; s < res.x; s += 32) ASSERT_EQ(image[t * res.x + s], mipmap->Texel(0, s, t));
+	TileCache::Stats stats = cache.GetStats();
+	EXPECT_GE(stats.misses, 2 * 256);
+	EXPECT_LE(stats.peakResidentBytes, cache.Capacity());
+	EXPECT_GT(stats.residentBytes, 0u);
+	std::remove("small.tiles");
+}
+
+TEST(TestTileCache, Concurrent) {
+	Point2i res(512, 512);
+	std::vector<Float> image = MakeImage(res);
+	ASSERT_TRUE(WriteTiledMIPMap("concurrent.tiles", res, image.data()));
+	TileCache cache(16 * TileBytes, 4);
+	std::unique_ptr<MIPMap<Float>> mipmap = MIPMap<Float>::Open("concurrent.tiles", &cache);
+	ASSERT_TRUE(mipmap != nullptr);
+
+	std::atomic<int> mismatches{ 0 };
+	const int nLookups = 20000;
+	ParallelFor([&](int64_t i) {
+		int s = int((i * 7919) % res.x), t = int((i * 104729 / res.x) % res.y);
+		if (mipmap->Texel(0, s, t) != image[t * res.x + s]) ++mismatches;
+	}, nLookups, 256);
+	EXPECT_EQ(0, mismatches);
+	TileCache::Stats stats = cache.GetStats();
+	EXPECT_EQ(nLookups, stats.microHits + stats.hits + stats.misses);
+	EXPECT_LE(stats.peakResidentBytes, cache.Capacity());
+	std::remove("concurrent.tiles");
+}
+
+TEST(TestBlockedArray, Layout) {
+	// 10x7 elements padded to 12x8 in 4x4 blocks
+	std::vector<int> linear(70);
+	for (int i = 0; i < 70; ++i) linear[i] = i;
+	BlockedArray<int> a(Point2i(10, 7), linear.data());
+	EXPECT_EQ(Point2i(10, 7), a.Resolution());
+	for (int v = 0; v < 7; ++v)
+		for (int u = 0; u < 10; ++u) ASSERT_EQ(v * 10 + u, a(u, v));
+	EXPECT_EQ(23, a[Point2i(3, 2)]);
+
+	// A 4x4 block is contiguous, and the next block in u follows it
+	EXPECT_EQ(&a(0, 0) + 15, &a(3, 3));
+	EXPECT_EQ(&a(0, 0) + 16, &a(4, 0));
+	EXPECT_EQ(&a(0, 0) + 3 * 16, &a(0, 4));
+	EXPECT_EQ(0u, (uintptr_t)a.Data() % PBR_L1_CACHE_LINE_SIZE);
+	for (int v = 0; v + 1 < 7; ++v)
+		for (int u = 0; u + 1 < 10; ++u) {
+			EXPECT_EQ(&a(u + 1, v), &a(u, v) + BlockedArray<int>::UStep(u));
+			EXPECT_EQ(&a(u, v + 1), &a(u, v) + BlockedArray<int>::VStep(v, 3));
+		}
+
+	std::vector<int> sub(6);
+	Bounds2i b(Point2i(8, 4), Point2i(10, 7));
+	a.GetLinearArray(b, sub.data());
+	EXPECT_EQ(48, sub[0]);
+	EXPECT_EQ(59, sub[3]);
+	EXPECT_EQ(69, sub[5]);
+	std::vector<int> ones(6, 1);
+	a.SetLinearArray(b, ones.data());
+	EXPECT_EQ(1, a(9, 6));
+	EXPECT_EQ(57, a(7, 5));
+	std::vector<int> all(70);
+	a.GetLinearArray(all.data());
+	EXPECT_EQ(1, all[58]);
+	EXPECT_EQ(57, all[57]);
+}
@@ -0,0 +1,37 @@
+#include "tests/gtest/gtest.h"
+#include "pbr.h"
+#include "parallel.h"
+#include <mutex>
+#include <set>
+#include <thread>
+
+using namespace pbr;
+
+#pragma region ParallelFor
+
+TEST(TestParallelFor, CallsEachIndexOnce) {
+	std::vector<std::atomic<int>> calls(10007);
+	for (std::atomic<int>& c : calls) c = 0;
+	for (int chunkSize : { 1, 64, 20000 })
+		ParallelFor([&](int64_t i) { ++calls[i]; }, (int64_t)calls.size(), chunkSize);
+	for (size_t i = 0; i < calls.size(); ++i) EXPECT_EQ(3, calls[i]) << i;
+}
+
+TEST(TestParallelFor, Nested) {
+	// Inner loops run on the pool's threads rather than new ones
+	std::mutex mutex;
+	std::set<std::thread::id> threads;
+	std::atomic<int64_t> sum{ 0 };
+	for (int pass = 0; pass < 4; ++pass)
+		ParallelFor([&](int64_t i) {
+			ParallelFor([&](int64_t j) {
+				sum += i * 100 + j;
+				std::lock_guard<std::mutex> lock(mutex);
+				threads.insert(std::this_thread::get_id());
+			}, 100);
+		}, 50);
+	EXPECT_EQ(4 * (100 * 100 * 49 * 50 / 2 + 50 * 99 * 100 / 2), sum);
+	EXPECT_LE((int)threads.size(), MaxThreadCount());
+}
+
+#pragma endregion ParallelFor
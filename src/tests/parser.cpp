@@ -0,0 +1,380 @@
+#include "tests/gtest/gtest.h"
+#include "pbr.h"
+#include "api.h"
+#include "binaryscene.h"
+#include "film.h"
+#include "interaction.h"
+#include "paramset.h"
+#include "parser.h"
+#include "primitive.h"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+using namespace pbr;
+
+// Records the statements it's given as text, and the parameters of shapes
+class RecordingTarget : public ParserTarget {
+public:
+	void pbrtIdentity() { log << "Identity;"; }
+	void pbrtTranslate(Float dx, Float dy, Float dz) { log << "Translate " << dx << " " << dy << " " << dz << ";"; }
+	void pbrtRotate(Float angle, Float ax, Float ay, Float az) {
+		log << "Rotate " << angle << " " << ax << " " << ay << " " << az << ";";
+	}
+	void pbrtScale(Float sx, Float sy, Float sz) { log << "Scale " << sx << " " << sy << " " << sz << ";"; }
+	void pbrtLookAt(Float ex, Float ey, Float ez, Float lx, Float ly, Float lz, Float ux, Float uy, Float uz) {
+		log << "LookAt " << ex << " " << ey << " " << ez << " " << lx << " " << ly << " " << lz << " " << ux << " " <<
+			uy << " " << uz << ";";
+	}
+	void pbrtConcatTransform(const Float tr[16]) { log << "ConcatTransform " << tr[0] << " " << tr[15] << ";"; }
+	void pbrtTransform(const Float tr[16]) { log << "Transform " << tr[0] << " " << tr[15] << ";"; }
+	void pbrtCoordinateSystem(const std::string& name) { log << "CoordinateSystem " << name << ";"; }
+	void pbrtCoordSysTransform(const std::string& name) { log << "CoordSysTransform " << name << ";"; }
+	void pbrtReverseOrientation() { log << "ReverseOrientation;"; }
+	void pbrtPixelFilter(const std::string& name, const ParamSet&) { log << "PixelFilter " << name << ";"; }
+	void pbrtFilm(const std::string& type, const ParamSet&) { log << "Film " << type << ";"; }
+	void pbrtSampler(const std::string& name, const ParamSet&) { log << "Sampler " << name << ";"; }
+	void pbrtAccelerator(const std::string& name, const ParamSet&) { log << "Accelerator " << name << ";"; }
+	void pbrtCamera(const std::string& name, const ParamSet&) { log << "Camera " << name << ";"; }
+	void pbrtWorldBegin() { log << "WorldBegin;"; }
+	void pbrtAttributeBegin() { log << "AttributeBegin;"; }
+	void pbrtAttributeEnd() { log << "AttributeEnd;"; }
+	void pbrtTransformBegin() { log << "TransformBegin;"; }
+	void pbrtTransformEnd() { log << "TransformEnd;"; }
+	void pbrtMaterial(const std::string& name, const ParamSet&) { log << "Material " << name << ";"; }
+	void pbrtMakeNamedMaterial(const std::string& name, const ParamSet&) {
+		log << "MakeNamedMaterial " << name << ";";
+	}
+	void pbrtNamedMaterial(const std::string& name) { log << "NamedMaterial " << name << ";"; }
+	void pbrtShape(const std::string& name, const ParamSet& params) {
+		log << "Shape " << name << ";";
+		shapes.push_back(params);
+	}
+	void pbrtObjectBegin(const std::string& name) { log << "ObjectBegin " << name << ";"; }
+	void pbrtObjectEnd() { log << "ObjectEnd;"; }
+	void pbrtObjectInstance(const std::string& name) { log << "ObjectInstance " << name << ";"; }
+	void pbrtWorldEnd() { log << "WorldEnd;"; }
+
+	std::ostringstream log;
+	std::vector<ParamSet> shapes;
+};
+
+static void WriteText(const std::string& filename, const std::string& text) {
+	std::ofstream out(filename, std::ios::binary);
+	out << text;
+}
+
+#pragma region Tokenizer
+
+TEST(TestTokenizer, Tokens) {
+	std::string text = "Shape \"trianglemesh\"# comment [ \"\n\"float fov\"[45 -1.5e2]\"a \\\"b\\\"\\n\"\n  WorldEnd";
+	Tokenizer t(text.data(), text.data() + text.size(), "test.pbrt");
+	const char* expected[] = { "Shape", "\"trianglemesh\"", "\"float fov\"", "[", "45", "-1.5e2", "]",
+		"\"a \\\"b\\\"\\n\"", "WorldEnd" };
+	std::vector<Token> tokens;
+	for (Token tok = t.Next(); tok.size > 0; tok = t.Next()) tokens.push_back(tok);
+	ASSERT_EQ(9u, tokens.size());
+	for (int i = 0; i < 9; ++i) EXPECT_TRUE(tokens[i] == expected[i]) << i;
+	EXPECT_FALSE(t.Failed());
+
+	// Tokens point into the text
+	EXPECT_EQ(text.data(), tokens[0].data);
+	EXPECT_EQ("trianglemesh", tokens[1].ToString());
+	EXPECT_EQ("a \"b\"\n", tokens[7].ToString());
+	EXPECT_EQ("test.pbrt:1", t.Location(tokens[1]));
+	EXPECT_EQ("test.pbrt:2", t.Location(tokens[2]));
+	EXPECT_EQ("test.pbrt:3", t.Location(tokens[8]));
+
+	t.Unget(tokens[8]);
+	EXPECT_TRUE(t.Next() == "WorldEnd");
+	EXPECT_EQ(0u, t.Next().size);
+}
+
+TEST(TestTokenizer, UnterminatedString) {
+	std::string text = "Shape \"trianglemesh\n\"";
+	Tokenizer t(text.data(), text.data() + text.size(), "test.pbrt");
+	EXPECT_TRUE(t.Next() == "Shape");
+	EXPECT_EQ(0u, t.Next().size);
+	EXPECT_TRUE(t.Failed());
+}
+
+#pragma endregion Tokenizer
+
+#pragma region Parser
+
+TEST(TestParser, Statements) {
+	RecordingTarget target;
+	ASSERT_TRUE(ParseString(
+		"LookAt 0 0 -5  0 0 0  0 1 0\n"
+		"Camera \"perspective\" \"float fov\" 45\n"
+		"Film \"image\" \"integer xresolution\" [ 64 ]\n"
+		"Sampler \"halton\" PixelFilter \"box\" Accelerator \"bvh\"\n"
+		"ConcatTransform [ 1 0 0 0 0 1 0 0 0 0 1 0 0 0 0 2 ]\n"
+		"WorldBegin\n"
+		"Material \"matte\" \"rgb Kd\" [ .5 .5 .5 ] \"texture bump\" \"b\"\n"
+		"MakeNamedMaterial \"m\" \"string type\" \"matte\" NamedMaterial \"m\"\n"
+		"Texture \"b\" \"float\" \"imagemap\" \"string filename\" \"b.exr\"\n"
+		"LightSource \"point\" \"spectrum I\" [ 400 1 700 1 ]\n"
+		"ActiveTransform StartTime TransformTimes 0 1\n"
+		"AttributeBegin Translate 1 2 3 Rotate 90 0 0 1 Scale 2 2 2 ReverseOrientation AttributeEnd\n"
+		"TransformBegin Identity Transform [ 3 0 0 0 0 1 0 0 0 0 1 0 0 0 0 1 ] TransformEnd\n"
+		"CoordinateSystem \"here\" CoordSysTransform \"here\"\n"
+		"ObjectBegin \"o\" ObjectEnd ObjectInstance \"o\"\n"
+		"WorldEnd\n", &target));
+	EXPECT_EQ("LookAt 0 0 -5 0 0 0 0 1 0;Camera perspective;Film image;Sampler halton;PixelFilter box;"
+		"Accelerator bvh;ConcatTransform 1 2;WorldBegin;Material matte;MakeNamedMaterial m;NamedMaterial m;"
+		"AttributeBegin;Translate 1 2 3;Rotate 90 0 0 1;"
+		"Scale 2 2 2;ReverseOrientation;AttributeEnd;TransformBegin;Identity;Transform 3 1;TransformEnd;"
+		"CoordinateSystem here;CoordSysTransform here;ObjectBegin o;ObjectEnd;ObjectInstance o;WorldEnd;",
+		target.log.str());
+}
+
+TEST(TestParser, ParameterTypes) {
+	RecordingTarget target;
+	ASSERT_TRUE(ParseString(
+		"Shape \"test\" \"float f\" [ 1.5 -2 3e-1 ] \"integer i\" [ -7 8 ] \"bool b\" [ \"true\" \"false\" ]\n"
+		"  \"string s\" \"name\" \"point2 uv\" [ 0 1 2 3 ] \"point P\" [ 1 2 3  4 5 6 ]\n"
+		"  \"point3 P3\" [ 7 8 9 ] \"vector S\" [ 0 0 1 ] \"normal N\" [ 0 1 0 ] \"normal3 N3\" [ 1 0 0 ]\n"
+		"  \"float commented\" [ 1 # 2 ] \n 3 ]  \"integer lone\" 42 \"rgb Kd\" [ .1 .2 .3 ]\n"
+		"  \"color Ks\" [ 1 1 1 ] \"texture bump\" \"bumpmap\" \"spectrum eta\" [ 400 1.5 700 1.4 ]\n", &target));
+	ASSERT_EQ(1u, target.shapes.size());
+	const ParamSet& ps = target.shapes[0];
+	int n;
+	const Float* f = ps.FindFloat("f", &n);
+	ASSERT_EQ(3, n);
+	EXPECT_EQ(1.5f, f[0]);
+	EXPECT_EQ(-2.f, f[1]);
+	EXPECT_EQ(Float(3e-1), f[2]);
+	const int* i = ps.FindInt("i", &n);
+	ASSERT_EQ(2, n);
+	EXPECT_EQ(-7, i[0]);
+	EXPECT_EQ(8, i[1]);
+	const bool* b = ps.FindBool("b", &n);
+	ASSERT_EQ(2, n);
+	EXPECT_TRUE(b[0]);
+	EXPECT_FALSE(b[1]);
+	EXPECT_EQ("name", ps.FindOneString("s", ""));
+	const Point2f* uv = ps.FindPoint2f("uv", &n);
+	ASSERT_EQ(2, n);
+	EXPECT_EQ(Point2f(2, 3), uv[1]);
+	const Point3f* P = ps.FindPoint3f("P", &n);
+	ASSERT_EQ(2, n);
+	EXPECT_EQ(Point3f(4, 5, 6), P[1]);
+	EXPECT_EQ(Point3f(7, 8, 9), ps.FindOnePoint3f("P3", Point3f()));
+	EXPECT_EQ(Vector3f(0, 0, 1), ps.FindOneVector3f("S", Vector3f()));
+	ASSERT_NE(nullptr, ps.FindNormal3f("N", &n));
+	EXPECT_EQ(Normal3f(0, 1, 0), ps.FindNormal3f("N", &n)[0]);
+	EXPECT_EQ(Normal3f(1, 0, 0), ps.FindNormal3f("N3", &n)[0]);
+	const Float* commented = ps.FindFloat("commented", &n);
+	ASSERT_EQ(2, n);
+	EXPECT_EQ(3.f, commented[1]);
+	EXPECT_EQ(42, ps.FindOneInt("lone", 0));
+	EXPECT_EQ(RGBSpectrum(Float(.1), Float(.2), Float(.3)), ps.FindOneRGBSpectrum("Kd", RGBSpectrum()));
+	EXPECT_EQ(RGBSpectrum(1), ps.FindOneRGBSpectrum("Ks", RGBSpectrum()));
+	EXPECT_EQ("bumpmap", ps.FindTexture("bump"));
+	EXPECT_EQ(nullptr, ps.FindFloat("eta", &n));
+}
+
+TEST(TestParser, LargeArrays) {
+	// Several parallel chunks' worth of numbers
+	const int nPoints = 200000;
+	std::string text = "Shape \"trianglemesh\" \"point P\" [";
+	for (int i = 0; i < nPoints; ++i)
+		text += " " + std::to_string(i) + ".25 " + std::to_string(-i) + " 1e" + std::to_string(i % 10);
+	text += " ] \"integer indices\" [";
+	for (int i = 0; i < 3 * nPoints; ++i) text += " " + std::to_string(i);
+	text += " ]";
+	RecordingTarget target;
+	ASSERT_TRUE(ParseString(text, &target));
+	ASSERT_EQ(1u, target.shapes.size());
+	int n;
+	const Point3f* P = target.shapes[0].FindPoint3f("P", &n);
+	ASSERT_EQ(nPoints, n);
+	for (int i = 0; i < nPoints; ++i)
+		ASSERT_EQ(Point3f(Float(i + 0.25), Float(-i), Float(std::pow(10., i % 10))), P[i]) << i;
+	const int* indices = target.shapes[0].FindInt("indices", &n);
+	ASSERT_EQ(3 * nPoints, n);
+	for (int i = 0; i < n; ++i) ASSERT_EQ(i, indices[i]);
+}
+
+TEST(TestParser, Errors) {
+	const char* bad[] = {
+		"Shape \"test\" \"float f\" [ 1 2",
+		"Shape \"test\" \"float f\" [ 1 x 2 ]",
+		"Shape \"test\" \"point P\" [ 1 2 ]",
+		"Shape \"test\" \"integer i\" [ 1.5 ]",
+		"Shape \"test\" \"integer i\" [ 99999999999 ]",
+		"Shape \"test\" \"bool b\" \"yes\"",
+		"Shape \"test\" \"float\" 1",
+		"Shape test",
+		"Translate 1 2",
+		"Transform [ 1 0 0 1 ]",
+		"Shape \"test\" \"string s\" \"unterminated",
+		"NoSuchDirective",
+		"Include \"no/such/file.pbrt\"",
+	};
+	for (const char* text : bad) {
+		RecordingTarget target;
+		EXPECT_FALSE(ParseString(std::string("WorldBegin\n") + text, &target)) << text;
+		// Nothing is handed on from a scene that doesn't parse
+		EXPECT_EQ("", target.log.str()) << text;
+	}
+}
+
+TEST(TestParser, Include) {
+	// Includes are replayed in place, with relative paths taken from the
+	// including file
+	WriteText("parser_test_main.pbrt", "WorldBegin\nInclude \"parser_test_a.pbrt\"\n"
+		"AttributeBegin Include \"parser_test_b.pbrt\" AttributeEnd\nWorldEnd\n");
+	WriteText("parser_test_a.pbrt", "Shape \"a\" \"string filename\" \"mesh.ply\"\n");
+	WriteText("parser_test_b.pbrt", "Translate 1 2 3 Include \"parser_test_c.pbrt\" Shape \"b\"\n");
+	WriteText("parser_test_c.pbrt", "");
+	RecordingTarget target;
+	EXPECT_TRUE(ParseFile("./parser_test_main.pbrt", &target));
+	EXPECT_EQ("WorldBegin;Shape a;AttributeBegin;Translate 1 2 3;Shape b;AttributeEnd;WorldEnd;",
+		target.log.str());
+	ASSERT_EQ(2u, target.shapes.size());
+	EXPECT_EQ("./mesh.ply", target.shapes[0].FindOneString("filename", ""));
+
+	// A file including itself
+	WriteText("parser_test_c.pbrt", "Include \"parser_test_c.pbrt\"\n");
+	RecordingTarget recursive;
+	EXPECT_FALSE(ParseFile("parser_test_main.pbrt", &recursive));
+	EXPECT_EQ("", recursive.log.str());
+	for (const char* f : { "parser_test_main.pbrt", "parser_test_a.pbrt", "parser_test_b.pbrt", "parser_test_c.pbrt" })
+		std::remove(f);
+}
+
+#pragma endregion Parser
+
+#pragma region SceneBuilder
+
+static const char* quadScene =
+	"LookAt 0 0 -5  0 0 0  0 1 0\n"
+	"Camera \"perspective\" \"float fov\" [ 30 ]\n"
+	"Film \"image\" \"integer xresolution\" 8 \"integer yresolution\" 8 \"string filename\" \"parser_test.pfm\"\n"
+	"Sampler \"random\" \"integer pixelsamples\" 2\n"
+	"WorldBegin\n"
+	"ObjectBegin \"quad\"\n"
+	"  Shape \"trianglemesh\" \"point P\" [ -1 -1 0  1 -1 0  1 1 0  -1 1 0 ] \"integer indices\" [ 0 1 2  0 2 3 ]\n"
+	"ObjectEnd\n"
+	"AttributeBegin Translate 0 0 1 ObjectInstance \"quad\" AttributeEnd\n"
+	"AttributeBegin Translate 10 0 0 Scale 2 2 2 ObjectInstance \"quad\" AttributeEnd\n"
+	"AttributeBegin\n"
+	"  Translate 0 10 0\n"
+	"  Shape \"trianglemesh\" \"point P\" [ -1 -1 0  1 -1 0  0 1 0 ]\n"
+	"AttributeEnd\n"
+	"WorldEnd\n";
+
+// Checks the aggregate built from quadScene
+static void ExpectQuadScene(const Primitive* aggregate) {
+	ASSERT_NE(nullptr, aggregate);
+
+	// The instanced quad at z = 1 and its scaled copy at x = 10
+	SurfaceInteraction isect;
+	Ray ray(Point3f(0.5f, 0.5f, -5), Vector3f(0, 0, 1));
+	ASSERT_TRUE(aggregate->Intersect(ray, &isect));
+	EXPECT_NEAR(1, isect.p.z, 1e-4);
+	EXPECT_NEAR(1, std::abs(isect.n.z), 1e-4);
+	ray = Ray(Point3f(11.5f, 1.5f, -5), Vector3f(0, 0, 1));
+	ASSERT_TRUE(aggregate->Intersect(ray, &isect));
+	EXPECT_NEAR(0, isect.p.z, 1e-4);
+	EXPECT_NEAR(11.5f, isect.p.x, 1e-4);
+	EXPECT_FALSE(aggregate->IntersectP(Ray(Point3f(12.5f, 0, -5), Vector3f(0, 0, 1))));
+
+	// The triangle, moved up in world space
+	ray = Ray(Point3f(0, 10, -5), Vector3f(0, 0, 1));
+	ASSERT_TRUE(aggregate->Intersect(ray, &isect));
+	EXPECT_NEAR(10, isect.p.y, 1e-4);
+	EXPECT_NEAR(11, aggregate->WorldBound().pMax.y, 1e-4);
+}
+
+TEST(TestSceneBuilder, Geometry) {
+	SceneBuilder builder(false);
+	ASSERT_TRUE(ParseString(quadScene, &builder));
+	ASSERT_NE(nullptr, builder.GetCamera());
+	EXPECT_EQ(Point2i(8, 8), builder.GetFilm()->fullResolution);
+	ExpectQuadScene(builder.GetAggregate());
+}
+
+TEST(TestSceneBuilder, Render) {
+	SceneBuilder builder;
+	ASSERT_TRUE(ParseString(quadScene, &builder));
+	std::ifstream image("parser_test.pfm", std::ios::binary);
+	EXPECT_TRUE(image.good());
+	image.close();
+	std::remove("parser_test.pfm");
+}
+
+TEST(TestSceneBuilder, UnknownFilter) {
+	// The scene is built but not rendered
+	std::string scene = std::string("PixelFilter \"nosuch\"\n") + quadScene;
+	SceneBuilder builder;
+	ASSERT_TRUE(ParseString(scene, &builder));
+	EXPECT_EQ(nullptr, builder.GetFilm());
+	EXPECT_EQ(nullptr, builder.GetCamera());
+	ExpectQuadScene(builder.GetAggregate());
+	std::ifstream image("parser_test.pfm", std::ios::binary);
+	EXPECT_FALSE(image.good());
+}
+
+#pragma endregion SceneBuilder
+
+#pragma region BinaryScene
+
+TEST(TestBinaryScene, RoundTrip) {
+	std::string scene = quadScene;
+	scene.insert(scene.find("WorldBegin\n") + 11,
+		"MakeNamedMaterial \"red\" \"string type\" \"matte\" \"rgb Kd\" [ 1 0 0 ]\n"
+		"Material \"plastic\" \"float roughness\" 0.25 \"texture bump\" \"b\"\n");
+	scene.insert(scene.find("AttributeBegin\n"), "NamedMaterial \"red\"\n");
+	BinarySceneWriter writer;
+	SceneBuilder converter(&writer);
+	ASSERT_TRUE(ParseString(scene, &converter));
+	EXPECT_EQ(nullptr, converter.GetAggregate());
+	ASSERT_TRUE(writer.Write("parser_test.pbrb"));
+
+	SceneBuilder builder(false);
+	ASSERT_TRUE(ReadBinaryScene("parser_test.pbrb", &builder));
+	std::remove("parser_test.pbrb");
+	ASSERT_NE(nullptr, builder.GetCamera());
+	EXPECT_EQ(Point2i(8, 8), builder.GetFilm()->fullResolution);
+	ExpectQuadScene(builder.GetAggregate());
+
+	// The named material, and the plastic the quad was defined with, used
+	// before the triangle's NamedMaterial
+	const std::vector<SceneMaterial>& materials = builder.GetMaterials();
+	ASSERT_EQ(2u, materials.size());
+	EXPECT_EQ("red", materials[0].name);
+	EXPECT_EQ("matte", materials[0].type);
+	EXPECT_EQ(RGBSpectrum(1, 0, 0), materials[0].params.FindOneRGBSpectrum("Kd", RGBSpectrum(0.f)));
+	EXPECT_EQ("", materials[1].name);
+	EXPECT_EQ("plastic", materials[1].type);
+	EXPECT_EQ(0.25f, materials[1].params.FindOneFloat("roughness", 0));
+	EXPECT_EQ("b", materials[1].params.FindTexture("bump"));
+}
+
+TEST(TestBinaryScene, Corrupt) {
+	BinarySceneWriter writer;
+	SceneBuilder converter(&writer);
+	ASSERT_TRUE(ParseString(quadScene, &converter));
+	ASSERT_TRUE(writer.Write("parser_test.pbrb"));
+	std::ifstream in("parser_test.pbrb", std::ios::binary);
+	std::string file((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+	in.close();
+
+	// Truncated, and with a mesh's positions pointing past the end
+	std::ofstream("parser_test.pbrb", std::ios::binary).write(file.data(), file.size() / 2);
+	SceneBuilder builder(false);
+	EXPECT_FALSE(ReadBinaryScene("parser_test.pbrb", &builder));
+	const BinarySceneHeader* header = (const BinarySceneHeader*)file.data();
+	BinaryMeshRecord* mesh = (BinaryMeshRecord*)&file[header->sections[(int)BinarySceneSection::Meshes].offset];
+	mesh->p = header->fileSize - sizeof(Point3f);
+	std::ofstream("parser_test.pbrb", std::ios::binary).write(file.data(), file.size());
+	EXPECT_FALSE(ReadBinaryScene("parser_test.pbrb", &builder));
+	EXPECT_EQ(nullptr, builder.GetAggregate());
+	EXPECT_FALSE(ReadBinaryScene("parser_test_missing.pbrb", &builder));
+	std::remove("parser_test.pbrb");
+}
+
+#pragma endregion BinaryScene
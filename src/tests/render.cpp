@@ -0,0 +1,213 @@
+#include "tests/gtest/gtest.h"
+#include "pbr.h"
+#include "checkpoint.h"
+#include "film.h"
+#include "imageio.h"
+#include "render.h"
+#include "filters/box.h"
+#include "filters/gaussian.h"
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+using namespace pbr;
+
+static std::unique_ptr<Film> MakeFilm(const char* filename, int res = 16) {
+	return std::unique_ptr<Film>(new Film(Point2i(res, res), Bounds2f(Point2f(0, 0), Point2f(1, 1)),
+		std::unique_ptr<Filter>(new BoxFilter(Vector2f(0.5f, 0.5f))), filename));
+}
+
+// Uniform value in [0, 1) determined by pixel, sample and dimension
+static Float Hash01(const Point2i& p, int64_t sample, int dim) {
+	uint64_t h = ((uint64_t)p.x * 73856093u) ^ ((uint64_t)p.y * 19349663u) ^ ((uint64_t)sample * 83492791u) ^
+		((uint64_t)dim << 56);
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdull;
+	h ^= h >> 33;
+	h *= 0xc4ceb9fe1a85ec53ull;
+	h ^= h >> 33;
+	return Float(h >> 40) / Float(1 << 24);
+}
+
+// Radiance 1 with uniform noise of standard deviation 1/sqrt(3)
+static void NoisySample(FilmTile* tile, const Point2i& p, int64_t s) {
+	Float v = 2 * Hash01(p, s, 0);
+	RGBSpectrum L(v);
+	tile->AddSample(Point2f(p.x + Hash01(p, s, 1), p.y + Hash01(p, s, 2)), L);
+}
+
+#pragma region Progressive
+
+TEST(TestProgressive, SampleBudget) {
+	std::unique_ptr<Film> film = MakeFilm("budget.pfm");
+	ProgressiveOptions options;
+	options.samplesPerPass = 3;
+	options.maxSamples = 10;
+	ProgressiveResult result = RenderProgressive(*film, NoisySample, options);
+	EXPECT_EQ(10, result.samplesCompleted);
+	EXPECT_EQ(4, result.passes);
+
+	// The image written after the last pass is the final one
+	Point2i res;
+	std::unique_ptr<Float[]> rgb = ReadImage("budget.pfm", &res);
+	std::remove("budget.pfm");
+	ASSERT_TRUE(rgb != nullptr);
+	std::vector<Float> expected = film->GetImage();
+	for (size_t i = 0; i < expected.size(); ++i) EXPECT_EQ((float)expected[i], (float)rgb[i]);
+}
+
+TEST(TestProgressive, TargetNoise) {
+	std::unique_ptr<Film> film = MakeFilm("noise.pfm", 24);
+	ProgressiveOptions options;
+	options.samplesPerPass = 4;
+	options.targetNoise = 0.05f;
+	options.maxSamples = 4096;
+	options.writeEachPass = false;
+	ProgressiveResult result = RenderProgressive(*film, NoisySample, options);
+	std::remove("noise.pfm");
+
+	// About (1/sqrt(3) / 0.05)^2 = 133 samples are needed
+	EXPECT_LE(result.noise, options.targetNoise);
+	EXPECT_GT(result.samplesCompleted, 80);
+	EXPECT_LT(result.samplesCompleted, 250);
+
+	// The estimate agrees with the actual error of the mean
+	std::vector<Float> rgb = film->GetImage();
+	double sumSq = 0;
+	for (Float v : rgb) sumSq += (v - 1) * (v - 1);
+	double actual = std::sqrt(sumSq / rgb.size());
+	EXPECT_NEAR(actual, result.noise, 0.3 * actual);
+}
+
+TEST(TestProgressive, TimeLimit) {
+	// One pixel makes every pass take at least 20ms
+	std::unique_ptr<Film> film = MakeFilm("time.pfm");
+	ProgressiveOptions options;
+	options.samplesPerPass = 1;
+	options.timeLimit = 0.1f;
+	options.writeEachPass = false;
+	ProgressiveResult result = RenderProgressive(*film, [](FilmTile* tile, const Point2i& p, int64_t s) {
+		if (p == Point2i(0, 0)) std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		NoisySample(tile, p, s);
+	}, options);
+	std::remove("time.pfm");
+	EXPECT_GE(result.passes, 2);
+	EXPECT_LE(result.passes, 5);
+	EXPECT_LT(result.seconds, 0.5);
+}
+
+TEST(TestProgressive, ResumeFromCheckpoint) {
+	std::unique_ptr<Film> uninterrupted = MakeFilm("full.pfm");
+	ProgressiveOptions options;
+	options.samplesPerPass = 2;
+	options.maxSamples = 12;
+	options.writeEachPass = false;
+	RenderProgressive(*uninterrupted, NoisySample, options);
+	std::remove("full.pfm");
+
+	{
+		std::unique_ptr<Film> film = MakeFilm("part.pfm");
+		CheckpointWriter writer("progressive.ckpt", 0);
+		ProgressiveOptions partial = options;
+		partial.maxSamples = 6;
+		partial.checkpointWriter = &writer;
+		RenderProgressive(*film, NoisySample, partial);
+	}
+	RenderCheckpoint checkpoint;
+	ASSERT_TRUE(ReadCheckpoint("progressive.ckpt", &checkpoint));
+	std::remove("progressive.ckpt");
+	EXPECT_EQ(6, checkpoint.samplesCompleted);
+
+	std::unique_ptr<Film> resumed = MakeFilm("part.pfm");
+	ProgressiveOptions resume = options;
+	resume.resumeFrom = &checkpoint;
+	ProgressiveResult result = RenderProgressive(*resumed, NoisySample, resume);
+	std::remove("part.pfm");
+	EXPECT_EQ(3, result.passes);
+	EXPECT_EQ(12, result.samplesCompleted);
+	EXPECT_EQ(uninterrupted->GetImage(), resumed->GetImage());
+}
+
+TEST(TestProgressive, Adaptive) {
+	// The left half is noise-free; the right half needs about
+	// (1/sqrt(3) / 0.05)^2 = 133 samples per pixel
+	std::unique_ptr<Film> film = MakeFilm("adaptive.pfm", 64);
+	ProgressiveOptions options;
+	options.adaptive = true;
+	options.targetNoise = 0.05f;
+	options.minSamples = 8;
+	options.maxSamples = 1024;
+	options.writeEachPass = false;
+	ProgressiveResult result = RenderProgressive(*film, [](FilmTile* tile, const Point2i& p, int64_t s) {
+		if (p.x < 32) {
+			RGBSpectrum L(1);
+			tile->AddSample(Point2f(p.x + Hash01(p, s, 1), p.y + Hash01(p, s, 2)), L);
+		} else
+			NoisySample(tile, p, s);
+	}, options);
+	std::remove("adaptive.pfm");
+
+	EXPECT_LE(result.noise, options.targetNoise);
+	EXPECT_EQ(0, film->GetRelativeError(Bounds2i(Point2i(0, 0), Point2i(32, 64))));
+	EXPECT_LE(film->GetRelativeError(Bounds2i(Point2i(32, 0), Point2i(64, 64))), options.targetNoise);
+	// Left tiles stop at minSamples, so the average is about (8 + 136) / 2
+	EXPECT_GT(result.samplesCompleted, 55);
+	EXPECT_LT(result.samplesCompleted, 90);
+
+	// The noisy half is actually as clean as estimated
+	std::vector<Float> rgb = film->GetImage();
+	double sumSq = 0;
+	for (int y = 0; y < 64; ++y)
+		for (int x = 32; x < 64; ++x) sumSq += (rgb[3 * (y * 64 + x)] - 1) * (rgb[3 * (y * 64 + x)] - 1);
+	EXPECT_LT(std::sqrt(sumSq / (32 * 64)), 1.3 * options.targetNoise);
+}
+
+TEST(TestProgressive, AdaptiveBudget) {
+	// Noise everywhere and an unreachable target: the per-pixel budget caps
+	// the average, and resuming restores each tile's count
+	std::unique_ptr<Film> film = MakeFilm("budget.pfm", 32);
+	CheckpointWriter writer("adaptive.ckpt", 3600);
+	ProgressiveOptions options;
+	options.adaptive = true;
+	options.targetNoise = 1e-4f;
+	options.samplesPerPass = 4;
+	options.maxSamples = 10;
+	options.writeEachPass = false;
+	options.checkpointWriter = &writer;
+	ProgressiveResult result = RenderProgressive(*film, NoisySample, options);
+	EXPECT_TRUE(writer.Flush());
+	std::remove("budget.pfm");
+	EXPECT_EQ(10, result.samplesCompleted);
+
+	RenderCheckpoint checkpoint;
+	ASSERT_TRUE(ReadCheckpoint("adaptive.ckpt", &checkpoint));
+	std::remove("adaptive.ckpt");
+	EXPECT_EQ(std::vector<int64_t>(4, 10), checkpoint.tileSamples);
+}
+
+TEST(TestProgressive, IndependentOfThreadCount) {
+	// A filter wider than a pixel makes neighbouring tiles share pixels;
+	// yielding in some pixels varies the order tiles finish in
+	auto render = [](int nThreads) {
+		int savedThreads = PbrOptions.nThreads;
+		PbrOptions.nThreads = nThreads;
+		Film film(Point2i(48, 48), Bounds2f(Point2f(0, 0), Point2f(1, 1)),
+			std::unique_ptr<Filter>(new GaussianFilter(Vector2f(2, 2), 2)), "threads.pfm");
+		ProgressiveOptions options;
+		options.samplesPerPass = 2;
+		options.maxSamples = 4;
+		options.tileSize = 4;
+		options.writeEachPass = false;
+		RenderProgressive(film, [](FilmTile* tile, const Point2i& p, int64_t s) {
+			if ((p.x * 7 + p.y * 3 + s) % 11 == 0) std::this_thread::yield();
+			NoisySample(tile, p, s);
+		}, options);
+		std::remove("threads.pfm");
+		PbrOptions.nThreads = savedThreads;
+		return film.GetImage();
+	};
+	std::vector<Float> serial = render(1);
+	for (int i = 0; i < 4; ++i) EXPECT_EQ(serial, render(8));
+}
+
+#pragma endregion Progressive
@@ -0,0 +1,240 @@
+#include "tests/gtest/gtest.h"
+#include "pbr.h"
+#include "lowdiscrepancy.h"
+#include "parallel.h"
+#include "sampler.h"
+#include "samplers/halton.h"
+#include "samplers/random.h"
+#include "samplers/sobol.h"
+#include "samplers/stratified.h"
+
+using namespace pbr;
+
+#pragma region LowDiscrepancy
+
+TEST(TestLowDiscrepancy, RadicalInverse) {
+	EXPECT_EQ(0.5f, RadicalInverse(0, 1));
+	EXPECT_EQ(0.75f, RadicalInverse(0, 3));
+	EXPECT_FLOAT_EQ(1.f / 3.f, RadicalInverse(1, 1));
+	EXPECT_FLOAT_EQ(2.f / 3.f + 1.f / 9.f, RadicalInverse(1, 5));
+	EXPECT_FLOAT_EQ(1.f / 1619.f, RadicalInverse(PrimeTableSize - 1, 1));
+
+	// The identity permutation leaves the digits alone
+	std::vector<uint16_t> identity(Primes[PrimeTableSize - 1]);
+	for (size_t i = 0; i < identity.size(); ++i) identity[i] = (uint16_t)i;
+	for (int b = 0; b < PrimeTableSize; b += 17)
+		for (uint64_t a = 0; a < 1000; a += 7) EXPECT_FLOAT_EQ(RadicalInverse(b, a), ScrambledRadicalInverse(b, a, &identity[0]));
+
+	// Inverting the first digits recovers the index
+	for (uint64_t a = 0; a < 243; ++a) {
+		uint64_t digits = (uint64_t)std::round(RadicalInverse(1, a) * 243);
+		EXPECT_EQ(a, InverseRadicalInverse<3>(digits, 5));
+	}
+
+	// Each base's permutation is a permutation
+	RNG rng;
+	std::vector<uint16_t> perms = ComputeRadicalInversePermutations(rng);
+	for (int b = 0; b < PrimeTableSize; b += 31) {
+		std::vector<uint16_t> p(&perms[PrimeSums[b]], &perms[PrimeSums[b]] + Primes[b]);
+		std::sort(p.begin(), p.end());
+		for (int i = 0; i < Primes[b]; ++i) EXPECT_EQ(i, p[i]);
+	}
+}
+
+TEST(TestLowDiscrepancy, Sobol) {
+	// The first points of the three-dimensional sequence
+	const Float expected[8][3] = { { 0, 0, 0 }, { 0.5f, 0.5f, 0.5f }, { 0.25f, 0.75f, 0.75f },
+		{ 0.75f, 0.25f, 0.25f }, { 0.125f, 0.625f, 0.375f }, { 0.625f, 0.125f, 0.875f },
+		{ 0.375f, 0.375f, 0.625f }, { 0.875f, 0.875f, 0.125f } };
+	for (int i = 0; i < 8; ++i)
+		for (int d = 0; d < 3; ++d) EXPECT_EQ(expected[i][d], UInt32ToUnitFloat(SobolSampleBits(i, d)));
+
+	// Scrambled or not, the first 2^k values of every dimension fall one in
+	// each interval of width 2^-k
+	for (int d = 0; d < NSobolDimensions; ++d)
+		for (uint32_t seed : { 0u, 0x9e3779b9u })
+			for (int k = 1; k <= 10; ++k) {
+				std::vector<int> count(1 << k, 0);
+				for (uint32_t i = 0; i < (1u << k); ++i) {
+					uint32_t v = SobolSampleBits(i, d);
+					if (seed) v = OwenScramble(v, seed);
+					++count[v >> (32 - k)];
+				}
+				EXPECT_EQ(std::vector<int>(1 << k, 1), count) << "dimension " << d << ", 2^" << k;
+			}
+}
+
+#pragma endregion LowDiscrepancy
+
+#pragma region Sampler
+
+// One sampler of each kind, with samplesPerPixel samples for 16x16 pixels
+static std::vector<std::unique_ptr<Sampler>> AllSamplers(int samplesPerPixel) {
+	int sqrtSamples = (int)std::sqrt((double)samplesPerPixel);
+	CHECK_EQ(sqrtSamples * sqrtSamples, samplesPerPixel);
+	std::vector<std::unique_ptr<Sampler>> samplers;
+	samplers.emplace_back(new StratifiedSampler(sqrtSamples, sqrtSamples, true, 4));
+	samplers.emplace_back(new HaltonSampler(samplesPerPixel, Bounds2i(Point2i(0, 0), Point2i(16, 16))));
+	samplers.emplace_back(new SobolSampler(samplesPerPixel));
+	samplers.emplace_back(new RandomSampler(samplesPerPixel));
+	return samplers;
+}
+
+static const char* SamplerNames[] = { "stratified", "halton", "sobol", "random" };
+
+TEST(TestSampler, BatchMatchesGet2D) {
+	std::vector<std::unique_ptr<Sampler>> samplers = AllSamplers(64);
+	for (int s = 0; s < 4; ++s) {
+		Sampler& sampler = *samplers[s];
+		for (Point2i p : { Point2i(0, 0), Point2i(5, 11), Point2i(200, 3) }) {
+			sampler.StartPixel(p);
+			// Past the sampled dimensions of the stratified sampler and
+			// Sobol's 2D dimension 7, values are hashed
+			int nDims = 10;
+			std::vector<Point2f> expected(64 * nDims);
+			for (int i = 0; i < 64; ++i, sampler.StartNextSample())
+				for (int d = 0; d < nDims; ++d) expected[d * 64 + i] = sampler.Get2D();
+
+			for (int d = 0; d < nDims; ++d) {
+				// An unaligned first sample and a partial last group
+				Point2f batch[64];
+				sampler.Get2DBatch(d, 3, 58, batch);
+				for (int i = 0; i < 58; ++i)
+					EXPECT_EQ(expected[d * 64 + 3 + i], batch[i]) << SamplerNames[s] << " dimension " << d << " sample " << 3 + i;
+			}
+		}
+	}
+}
+
+// Get1D() and Get2D() values of 8 alternating dimensions for a sample
+static void SampleVector(Sampler& sampler, Float* v) {
+	for (int d = 0; d < 4; ++d) {
+		v[3 * d] = sampler.Get1D();
+		Point2f u = sampler.Get2D();
+		v[3 * d + 1] = u.x;
+		v[3 * d + 2] = u.y;
+	}
+}
+
+TEST(TestSampler, ScheduleIndependent) {
+	// Generating 16x16 pixels in scanline order, or from clones on all
+	// threads in 4x4 tiles and passes of 4 samples, gives identical values
+	const int nValues = 12;
+	std::vector<std::unique_ptr<Sampler>> samplers = AllSamplers(16);
+	for (int s = 0; s < 4; ++s) {
+		std::vector<Float> expected(16 * 16 * 16 * nValues), values(expected.size());
+		Sampler& sampler = *samplers[s];
+		for (int y = 0; y < 16; ++y)
+			for (int x = 0; x < 16; ++x) {
+				sampler.StartPixel(Point2i(x, y));
+				do
+					SampleVector(sampler, &expected[((y * 16 + x) * 16 + sampler.CurrentSampleNumber()) * nValues]);
+				while (sampler.StartNextSample());
+			}
+
+		ParallelFor([&](int64_t task) {
+			int tile = int(task % 16), pass = int(task / 16);
+			std::unique_ptr<Sampler> clone = sampler.Clone();
+			for (int y = 4 * (tile / 4); y < 4 * (tile / 4) + 4; ++y)
+				for (int x = 4 * (tile % 4); x < 4 * (tile % 4) + 4; ++x) {
+					clone->StartPixel(Point2i(x, y));
+					for (int i = 4 * pass; i < 4 * pass + 4; ++i) {
+						clone->SetSampleNumber(i);
+						SampleVector(*clone, &values[((y * 16 + x) * 16 + i) * nValues]);
+					}
+				}
+		}, 16 * 4);
+		EXPECT_TRUE(expected == values) << SamplerNames[s];
+	}
+
+	// The seed selects different streams
+	RandomSampler a(16, 1), b(16, 2);
+	a.StartPixel(Point2i(3, 3));
+	b.StartPixel(Point2i(3, 3));
+	EXPECT_NE(a.Get1D(), b.Get1D());
+}
+
+TEST(TestSampler, SobolIsNet) {
+	// Owen scrambling preserves the (0, 2) property of the first two
+	// dimensions: every elementary interval of area 1/256 holds one point
+	SobolSampler sampler(256);
+	sampler.StartPixel(Point2i(7, 3));
+	Point2f samples[256];
+	sampler.Get2DBatch(0, 0, 256, samples);
+	for (int xBits = 0; xBits <= 8; ++xBits) {
+		std::vector<int> count(256, 0);
+		for (const Point2f& s : samples)
+			++count[(int(s.x * (1 << xBits)) << (8 - xBits)) + int(s.y * (1 << (8 - xBits)))];
+		EXPECT_EQ(std::vector<int>(256, 1), count) << xBits;
+	}
+
+	// Pixels are scrambled independently
+	Point2f other[256];
+	sampler.StartPixel(Point2i(8, 3));
+	sampler.Get2DBatch(0, 0, 256, other);
+	int same = 0;
+	for (int i = 0; i < 256; ++i) same += samples[i] == other[i];
+	EXPECT_LT(same, 4);
+}
+
+TEST(TestSampler, HaltonCoversImage) {
+	// Offsetting each pixel's first dimensions by the pixel reproduces the
+	// first points of the Halton sequence scaled to 16x27
+	HaltonSampler sampler(4, Bounds2i(Point2i(0, 0), Point2i(16, 16)));
+	std::vector<int> found(4 * 16 * 27, 0);
+	for (int y = 0; y < 16; ++y)
+		for (int x = 0; x < 16; ++x) {
+			sampler.StartPixel(Point2i(x, y));
+			do {
+				int64_t index = sampler.GetIndexForSample(sampler.CurrentSampleNumber());
+				ASSERT_LT(index, (int64_t)found.size());
+				++found[index];
+				Point2f s = sampler.Get2D();
+				EXPECT_FLOAT_EQ(RadicalInverse(0, index) * 16, x + s.x);
+				EXPECT_NEAR(RadicalInverse(1, index) * 27, y + s.y, 1e-4);
+			} while (sampler.StartNextSample());
+		}
+	// Only the 16 rows of the 27 that are in the image are visited
+	EXPECT_EQ(4 * 16 * 16, std::count(found.begin(), found.end(), 1));
+}
+
+// Mean squared error of per-pixel estimates of the integrals of a smooth
+// function and of a disc's indicator over the second 2D dimension
+static void IntegrationError(Sampler& sampler, double* smoothError, double* discError) {
+	*smoothError = *discError = 0;
+	const int nPixels = 64;
+	for (int p = 0; p < nPixels; ++p) {
+		sampler.StartPixel(Point2i(p % 8, p / 8));
+		double smooth = 0, disc = 0;
+		do {
+			sampler.Get2D();
+			Point2f u = sampler.Get2D();
+			smooth += u.x * u.y * u.y;
+			disc += (u.x * u.x + u.y * u.y < 1) ? 1 : 0;
+		} while (sampler.StartNextSample());
+		smooth = smooth / sampler.samplesPerPixel - 1. / 6.;
+		disc = disc / sampler.samplesPerPixel - Pi / 4;
+		*smoothError += smooth * smooth / nPixels;
+		*discError += disc * disc / nPixels;
+	}
+}
+
+TEST(TestSampler, Convergence) {
+	std::vector<std::unique_ptr<Sampler>> samplers = AllSamplers(256);
+	double randomSmooth, randomDisc;
+	IntegrationError(*samplers[3], &randomSmooth, &randomDisc);
+	// Monte Carlo: the variances over 256 samples
+	EXPECT_NEAR(randomSmooth, (1. / 15. - 1. / 36.) / 256, 0.5 * (1. / 15. - 1. / 36.) / 256);
+	EXPECT_NEAR(randomDisc, Pi / 4 * (1 - Pi / 4) / 256, 0.5 * Pi / 4 * (1 - Pi / 4) / 256);
+
+	for (int s = 0; s < 3; ++s) {
+		double smooth, disc;
+		IntegrationError(*samplers[s], &smooth, &disc);
+		LOG(INFO) << SamplerNames[s] << ": smooth " << smooth / randomSmooth << ", disc " << disc / randomDisc
+			<< " of random's mean squared error";
+		EXPECT_LT(smooth, 0.05 * randomSmooth) << SamplerNames[s];
+		EXPECT_LT(disc, 0.2 * randomDisc) << SamplerNames[s];
+	}
+}
+
+#pragma endregion Sampler
@@ -0,0 +1,569 @@
+#include "tests/gtest/gtest.h"
+#include "pbr.h"
+#include "geometry.h"
+#include "geometrycache.h"
+#include "interaction.h"
+#include "parallel.h"
+#include "paramset.h"
+#include "primitive.h"
+#include "shapes/objmesh.h"
+#include "shapes/plymesh.h"
+#include "shapes/triangle.h"
+#include "accelerators/bvh.h"
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <random>
+
+using namespace pbr;
+
+// Unit sphere approximated by a latitude/longitude grid, with per-vertex
+// normals and uvs
+struct SphereMesh {
+	SphereMesh(int nTheta, int nPhi) {
+		const Float Pi = 3.14159265358979f;
+		for (int i = 0; i <= nTheta; ++i)
+			for (int j = 0; j <= nPhi; ++j) {
+				Float theta = Pi * i / nTheta, phi = 2 * Pi * j / nPhi;
+				Point3f pt(std::sin(theta) * std::cos(phi), std::sin(theta) * std::sin(phi), std::cos(theta));
+				p.push_back(pt);
+				n.push_back(Normal3f(Vector3f(pt)));
+				uv.push_back(Point2f(Float(j) / nPhi, Float(i) / nTheta));
+			}
+		for (int i = 0; i < nTheta; ++i)
+			for (int j = 0; j < nPhi; ++j) {
+				int v00 = i * (nPhi + 1) + j, v01 = v00 + 1, v10 = v00 + nPhi + 1, v11 = v10 + 1;
+				int quad[6] = { v00, v10, v11, v00, v11, v01 };
+				indices.insert(indices.end(), quad, quad + 6);
+			}
+	}
+	int nTriangles() const { return (int)indices.size() / 3; }
+
+	std::vector<Point3f> p;
+	std::vector<Normal3f> n;
+	std::vector<Point2f> uv;
+	std::vector<int> indices;
+};
+
+static std::vector<std::shared_ptr<Primitive>> MakePrimitives(const std::vector<std::shared_ptr<Shape>>& shapes) {
+	std::vector<std::shared_ptr<Primitive>> prims;
+	for (const auto& s : shapes) prims.push_back(std::make_shared<GeometricPrimitive>(s));
+	return prims;
+}
+
+#pragma region Triangle
+
+TEST(TestTriangle, Watertight) {
+	// Rays from inside a closed mesh must hit it, including along shared
+	// edges and through vertices
+	SphereMesh sphere(16, 32);
+	ParamSet ps;
+	BVHAccel bvh(MakePrimitives(CreateTriangleMesh(sphere.nTriangles(), sphere.indices.data(),
+		(int)sphere.p.size(), sphere.p.data(), nullptr, nullptr, nullptr, ps)), 4);
+
+	std::mt19937 rng(1);
+	std::normal_distribution<Float> g;
+	for (int i = 0; i < 20000; ++i) {
+		Vector3f d = i < (int)sphere.p.size() ? Vector3f(sphere.p[i]) : Vector3f(g(rng), g(rng), g(rng));
+		Ray r(Point3f(0, 0, 0), d);
+		SurfaceInteraction isect;
+		ASSERT_TRUE(bvh.Intersect(r, &isect)) << "ray " << i << " escaped along " << d;
+		EXPECT_NEAR(1, Distance(isect.p, Point3f(0, 0, 0)), 0.01f);
+		// Spawned rays never hit the surface they leave
+		Ray out = isect.SpawnRay(isect.p - Point3f(0, 0, 0));
+		EXPECT_FALSE(bvh.IntersectP(out));
+	}
+}
+
+TEST(TestTriangle, Interaction) {
+	Point3f p[3] = { Point3f(0, 0, 0), Point3f(1, 0, 0), Point3f(0, 1, 0) };
+	Point2f uv[3] = { Point2f(0, 0), Point2f(1, 0), Point2f(0, 1) };
+	int indices[3] = { 0, 1, 2 };
+	ParamSet ps;
+	std::vector<std::shared_ptr<Shape>> tris = CreateTriangleMesh(1, indices, 3, p, nullptr, nullptr, uv, ps);
+	ASSERT_EQ(1u, tris.size());
+	EXPECT_FLOAT_EQ(0.5f, tris[0]->Area());
+
+	Ray r(Point3f(0.25f, 0.5f, 2), Vector3f(0, 0, -1));
+	Float tHit;
+	SurfaceInteraction isect;
+	ASSERT_TRUE(tris[0]->Intersect(r, &tHit, &isect));
+	EXPECT_FLOAT_EQ(2, tHit);
+	EXPECT_FLOAT_EQ(0.25f, isect.uv.x);
+	EXPECT_FLOAT_EQ(0.5f, isect.uv.y);
+	EXPECT_EQ(Vector3f(1, 0, 0), isect.dpdu);
+	EXPECT_EQ(Vector3f(0, 1, 0), isect.dpdv);
+	EXPECT_EQ(Normal3f(0, 0, 1), isect.n);
+
+	// Misses outside the edges and beyond tMax
+	EXPECT_FALSE(tris[0]->IntersectP(Ray(Point3f(0.75f, 0.5f, 2), Vector3f(0, 0, -1))));
+	EXPECT_FALSE(tris[0]->IntersectP(Ray(Point3f(0.25f, 0.5f, 2), Vector3f(0, 0, -1), 1.5f)));
+
+	// Out-of-range indices are rejected
+	int bad[3] = { 0, 1, 3 };
+	EXPECT_TRUE(CreateTriangleMesh(1, bad, 3, p, nullptr, nullptr, nullptr, ps).empty());
+}
+
+TEST(TestTriangle, CompressedNormals) {
+	SphereMesh sphere(8, 16);
+	ParamSet plain, compressed;
+	compressed.AddBool("compressnormals", std::unique_ptr<bool[]>(new bool[1]{ true }));
+	std::vector<std::shared_ptr<Shape>> a = CreateTriangleMesh(sphere.nTriangles(), sphere.indices.data(),
+		(int)sphere.p.size(), sphere.p.data(), nullptr, sphere.n.data(), sphere.uv.data(), plain);
+	std::vector<std::shared_ptr<Shape>> b = CreateTriangleMesh(sphere.nTriangles(), sphere.indices.data(),
+		(int)sphere.p.size(), sphere.p.data(), nullptr, sphere.n.data(), sphere.uv.data(), compressed);
+
+	TriangleMeshStorage storage;
+	TriangleMesh plainMesh(sphere.nTriangles(), sphere.indices.data(), (int)sphere.p.size(), sphere.p.data(),
+		nullptr, sphere.n.data(), nullptr, storage);
+	storage.compressNormals = true;
+	TriangleMesh compressedMesh(sphere.nTriangles(), sphere.indices.data(), (int)sphere.p.size(), sphere.p.data(),
+		nullptr, sphere.n.data(), nullptr, storage);
+	EXPECT_EQ(plainMesh.BytesUsed() - sphere.p.size() * (sizeof(Normal3f) - sizeof(CompressedNormal)),
+		compressedMesh.BytesUsed());
+
+	// Shading normals agree closely; the geometry is unchanged
+	std::mt19937 rng(2);
+	std::normal_distribution<Float> g;
+	for (int i = 0; i < 1000; ++i) {
+		Ray r(Point3f(0, 0, 0), Vector3f(g(rng), g(rng), g(rng)));
+		for (size_t t = 0; t < a.size(); ++t) {
+			Float tA, tB;
+			SurfaceInteraction ia, ib;
+			bool hitA = a[t]->Intersect(r, &tA, &ia), hitB = b[t]->Intersect(r, &tB, &ib);
+			ASSERT_EQ(hitA, hitB);
+			if (!hitA) continue;
+			EXPECT_EQ(tA, tB);
+			EXPECT_EQ(ia.n, ib.n);
+			EXPECT_GT(Dot(ia.shading.n, ib.shading.n), 0.99999f);
+		}
+	}
+}
+
+TEST(TestTriangle, QuantizedVertexStreams) {
+	SphereMesh sphere(32, 64);
+	int nv = (int)sphere.p.size();
+	// Tiled uvs outside [0, 1] and unit tangents along the parametric direction
+	std::vector<Point2f> uv;
+	std::vector<Vector3f> s;
+	for (int i = 0; i < nv; ++i) {
+		uv.push_back(Point2f(4 * sphere.uv[i].x - 1, 2 * sphere.uv[i].y));
+		const Point3f& p = sphere.p[i];
+		s.push_back(p.x == 0 && p.y == 0 ? Vector3f(1, 0, 0) : Normalize(Vector3f(-p.y, p.x, 0)));
+	}
+
+	TriangleMeshStorage full, half, unorm;
+	half.compressNormals = half.compressTangents = true;
+	half.uvEncoding = UVEncoding::Half;
+	unorm = half;
+	unorm.uvEncoding = UVEncoding::Unorm16;
+	auto makeMesh = [&](const TriangleMeshStorage& storage) {
+		return std::make_shared<TriangleMesh>(sphere.nTriangles(), sphere.indices.data(), nv,
+			sphere.p.data(), s.data(), sphere.n.data(), uv.data(), storage);
+	};
+	std::shared_ptr<TriangleMesh> meshes[3] = { makeMesh(full), makeMesh(half), makeMesh(unorm) };
+
+	// Vertex streams (everything but the index buffer) shrink by over 40%
+	size_t indexBytes = meshes[0]->vertexIndices.size() * sizeof(int);
+	size_t fullBytes = meshes[0]->BytesUsed() - indexBytes;
+	EXPECT_LT(meshes[1]->BytesUsed() - indexBytes, 0.6 * fullBytes);
+	EXPECT_EQ(meshes[1]->BytesUsed(), meshes[2]->BytesUsed());
+
+	for (int i = 0; i < nv; ++i) {
+		// Half keeps 11 significant bits; unorm spans the 4x2 uv bounds in 65535 steps
+		EXPECT_NEAR(uv[i].x, meshes[1]->UV(i).x, std::abs(uv[i].x) / 2048);
+		EXPECT_NEAR(uv[i].y, meshes[1]->UV(i).y, std::abs(uv[i].y) / 2048);
+		EXPECT_NEAR(uv[i].x, meshes[2]->UV(i).x, 4.f / 65535);
+		EXPECT_NEAR(uv[i].y, meshes[2]->UV(i).y, 2.f / 65535);
+		EXPECT_GT(Dot(s[i], meshes[1]->Tangent(i)), 0.99999f);
+	}
+
+	// Hits see the same geometry and nearly the same shading frame
+	std::vector<std::shared_ptr<Shape>> tris[3];
+	for (int m = 0; m < 3; ++m)
+		for (int t = 0; t < sphere.nTriangles(); ++t) tris[m].push_back(std::make_shared<Triangle>(meshes[m], t));
+	BVHAccel bvh(MakePrimitives(tris[0]), 4);
+	std::mt19937 rng(3);
+	std::normal_distribution<Float> g;
+	for (int i = 0; i < 1000; ++i) {
+		Ray r(Point3f(0, 0, 0), Vector3f(g(rng), g(rng), g(rng)));
+		SurfaceInteraction ref;
+		ASSERT_TRUE(bvh.Intersect(r, &ref));
+		for (int m = 1; m < 3; ++m) {
+			Float tHit;
+			SurfaceInteraction isect;
+			ASSERT_TRUE(tris[m][ref.faceIndex]->Intersect(Ray(r.o, r.d), &tHit, &isect));
+			EXPECT_EQ(ref.p, isect.p);
+			EXPECT_NEAR(ref.uv.x, isect.uv.x, 1e-3f);
+			EXPECT_NEAR(ref.uv.y, isect.uv.y, 1e-3f);
+			EXPECT_GT(Dot(ref.shading.n, isect.shading.n), 0.99999f);
+			EXPECT_GT(Dot(Normalize(ref.shading.dpdu), Normalize(isect.shading.dpdu)), 0.999f);
+		}
+	}
+}
+
+#pragma endregion Triangle
+
+#pragma region PagedTriangleMesh
+
+TEST(TestPagedTriangleMesh, LoadsOnDemand) {
+	SphereMesh sphere(16, 32);
+	ASSERT_TRUE(WriteTriangleMeshFile("paged.mesh", sphere.nTriangles(), sphere.indices.data(),
+		(int)sphere.p.size(), sphere.p.data(), nullptr, sphere.n.data(), sphere.uv.data()));
+	ParamSet ps;
+	BVHAccel resident(MakePrimitives(CreateTriangleMesh(sphere.nTriangles(), sphere.indices.data(),
+		(int)sphere.p.size(), sphere.p.data(), nullptr, sphere.n.data(), sphere.uv.data(), ps)), 4);
+
+	GeometryCache cache(64 << 20);
+	std::shared_ptr<PagedTriangleMesh> paged = PagedTriangleMesh::Open("paged.mesh", &cache);
+	ASSERT_TRUE(paged != nullptr);
+	EXPECT_EQ(resident.WorldBound(), paged->WorldBound());
+	EXPECT_EQ(0, cache.GetStats().misses);
+
+	// Rays that pass the bounds by leave the mesh on disk
+	SurfaceInteraction isect;
+	EXPECT_FALSE(paged->Intersect(Ray(Point3f(0, 0, 5), Vector3f(1, 0, 0)), &isect));
+	EXPECT_FALSE(paged->IntersectP(Ray(Point3f(2, 2, 2), Vector3f(1, 1, 1))));
+	EXPECT_EQ(0, cache.GetStats().misses);
+
+	std::mt19937 rng(4);
+	std::normal_distribution<Float> g;
+	for (int i = 0; i < 1000; ++i) {
+		Vector3f d(g(rng), g(rng), g(rng));
+		Ray a(Point3f(0, 0, 0), d), b(Point3f(0, 0, 0), d);
+		SurfaceInteraction ia, ib;
+		ASSERT_TRUE(resident.Intersect(a, &ia));
+		ASSERT_TRUE(paged->Intersect(b, &ib));
+		EXPECT_EQ(a.tMax, b.tMax);
+		EXPECT_EQ(ia.faceIndex, ib.faceIndex);
+		EXPECT_EQ(ia.shading.n, ib.shading.n);
+	}
+	GeometryCache::Stats stats = cache.GetStats();
+	EXPECT_EQ(1, stats.misses);
+	EXPECT_GT(stats.residentBytes, sphere.p.size() * sizeof(Point3f));
+
+	EXPECT_TRUE(PagedTriangleMesh::Open("missing.mesh", &cache) == nullptr);
+	std::remove("paged.mesh");
+}
+
+TEST(TestPagedTriangleMesh, EvictsWithinBudget) {
+	// Six spheres along x, more than a thread's micro-cache holds, in a
+	// cache with room for two and a half of them
+	SphereMesh sphere(8, 16);
+	const int nMeshes = 6;
+	for (int m = 0; m < nMeshes; ++m) {
+		std::vector<Point3f> p;
+		for (const Point3f& v : sphere.p) p.push_back(v + Vector3f(Float(3 * m), 0, 0));
+		ASSERT_TRUE(WriteTriangleMeshFile("evict" + std::to_string(m) + ".mesh", sphere.nTriangles(),
+			sphere.indices.data(), (int)p.size(), p.data(), nullptr, nullptr, nullptr));
+	}
+	size_t meshBytes;
+	{
+		GeometryCache probe(64 << 20);
+		std::shared_ptr<PagedTriangleMesh> mesh = PagedTriangleMesh::Open("evict0.mesh", &probe);
+		EXPECT_TRUE(mesh->IntersectP(Ray(Point3f(0, 0, 0), Vector3f(0, 0, 1))));
+		meshBytes = probe.GetStats().residentBytes;
+	}
+	GeometryCache cache(meshBytes * 5 / 2);
+	std::vector<std::shared_ptr<PagedTriangleMesh>> meshes;
+	for (int m = 0; m < nMeshes; ++m)
+		meshes.push_back(PagedTriangleMesh::Open("evict" + std::to_string(m) + ".mesh", &cache));
+
+	// The first hit keeps its mesh loaded while the others evict it
+	SurfaceInteraction first;
+	for (int pass = 0; pass < 3; ++pass)
+		for (int m = 0; m < nMeshes; ++m) {
+			Ray r(Point3f(Float(3 * m) + 0.1f, 0.2f, 5), Vector3f(0, 0, -1));
+			SurfaceInteraction isect;
+			ASSERT_TRUE(meshes[m]->Intersect(r, &isect)) << "mesh " << m << ", pass " << pass;
+			EXPECT_NEAR(4, r.tMax, 0.1f);
+			if (pass == 0 && m == 0) first = isect;
+		}
+	GeometryCache::Stats stats = cache.GetStats();
+	EXPECT_GT(stats.evictions, 0);
+	EXPECT_LE(stats.peakResidentBytes, cache.Capacity());
+	ASSERT_TRUE(first.geometry != nullptr);
+	EXPECT_TRUE(Inside(first.p, Expand(first.primitive->WorldBound(), 1e-3f)));
+	for (int m = 0; m < nMeshes; ++m) std::remove(("evict" + std::to_string(m) + ".mesh").c_str());
+}
+
+#pragma endregion PagedTriangleMesh
+
+#pragma region GeometryCache
+
+// Geometry that claims the given size, remembering the last it loaded
+class SizedGeometrySource : public GeometrySource {
+public:
+	SizedGeometrySource(size_t bytes) : bytes(bytes) {}
+	std::shared_ptr<Primitive> Load(size_t* size) const {
+		++loads;
+		*size = bytes;
+		std::shared_ptr<Primitive> geometry = std::make_shared<TransformedPrimitive>(nullptr, Transform());
+		last = geometry;
+		return geometry;
+	}
+
+	const size_t bytes;
+	mutable std::atomic<int> loads{ 0 };
+	mutable std::weak_ptr<Primitive> last;
+};
+
+TEST(TestGeometryCache, Budget) {
+	GeometryCache cache(250);
+	SizedGeometrySource a(100), b(100), c(100), large(300);
+	EXPECT_TRUE(cache.Get(a) != nullptr);
+	std::weak_ptr<Primitive> firstA = a.last;
+	EXPECT_TRUE(cache.Get(b) != nullptr);
+	std::shared_ptr<Primitive> pinned = cache.Get(b);
+	EXPECT_TRUE(cache.Get(c) != nullptr);
+	EXPECT_TRUE(cache.Get(a) != nullptr);
+
+	// Evicted geometry is freed unless it is held, although it was in the
+	// thread's micro-cache
+	GeometryCache::Stats stats = cache.GetStats();
+	EXPECT_EQ(2, stats.evictions);
+	EXPECT_EQ(2, a.loads);
+	EXPECT_TRUE(firstA.expired());
+	EXPECT_TRUE(b.last.lock() == pinned);
+
+	// Geometry that can't fit is loaded once and rejected
+	EXPECT_TRUE(cache.Get(large) == nullptr);
+	EXPECT_TRUE(cache.Get(large) == nullptr);
+	EXPECT_EQ(1, large.loads);
+	EXPECT_TRUE(large.last.expired());
+	stats = cache.GetStats();
+	EXPECT_EQ(1, stats.rejections);
+	EXPECT_LE(stats.peakResidentBytes, cache.Capacity());
+}
+
+TEST(TestGeometryCache, LoadsOnce) {
+	int savedThreads = PbrOptions.nThreads;
+	PbrOptions.nThreads = 4;
+	GeometryCache cache(1000);
+	SizedGeometrySource source(100);
+	ParallelFor([&](int64_t) { EXPECT_TRUE(cache.Get(source) != nullptr); }, 64);
+	PbrOptions.nThreads = savedThreads;
+	EXPECT_EQ(1, source.loads);
+}
+
+#pragma endregion GeometryCache
+
+#pragma region PLYMesh
+
+// Writes the sphere as a PLY file with positions, normals and uvs in the
+// given format, or positions alone; binary values are little-endian
+// floats and faces uchar-counted int lists
+static void WritePLY(const std::string& filename, const SphereMesh& sphere, const std::string& format,
+	bool positionsOnly) {
+	std::ofstream out(filename, std::ios::binary);
+	out << "ply\nformat " << format << " 1.0\ncomment written by the shapes test\nelement vertex " <<
+		sphere.p.size() << "\nproperty float x\nproperty float y\nproperty float z\n";
+	if (!positionsOnly)
+		out << "property float nx\nproperty float ny\nproperty float nz\nproperty float u\nproperty float v\n";
+	out << "element face " << sphere.nTriangles() << "\nproperty list uchar int vertex_indices\n";
+	// Pad the header so that binary vertices are Float aligned
+	std::string header = "end_header\n";
+	while ((out.tellp() + (std::streamoff)header.size()) % 4) out << ' ';
+	out << header;
+	for (size_t i = 0; i < sphere.p.size(); ++i) {
+		float v[8] = { (float)sphere.p[i].x, (float)sphere.p[i].y, (float)sphere.p[i].z, (float)sphere.n[i].x,
+			(float)sphere.n[i].y, (float)sphere.n[i].z, (float)sphere.uv[i].x, (float)sphere.uv[i].y };
+		int n = positionsOnly ? 3 : 8;
+		if (format == "ascii") {
+			char line[256];
+			int len = 0;
+			for (int k = 0; k < n; ++k) len += sprintf(line + len, k ? " %.9g" : "%.9g", v[k]);
+			out << line << "\n";
+		} else
+			out.write((const char*)v, n * sizeof(float));
+	}
+	for (int t = 0; t < sphere.nTriangles(); ++t) {
+		const int* v = &sphere.indices[3 * t];
+		if (format == "ascii")
+			out << "3 " << v[0] << " " << v[1] << " " << v[2] << "\n";
+		else {
+			out.put(3);
+			out.write((const char*)v, 3 * sizeof(int));
+		}
+	}
+}
+
+// Compares at float precision, which the file has whatever Float is
+static void ExpectSphere(const SphereMesh& sphere, const PLYMesh& mesh, bool positionsOnly) {
+	ASSERT_EQ((int)sphere.p.size(), mesh.nVertices);
+	ASSERT_EQ(sphere.nTriangles(), mesh.nTriangles);
+	EXPECT_EQ(positionsOnly, mesh.n == nullptr);
+	EXPECT_EQ(positionsOnly, mesh.uv == nullptr);
+	for (int i = 0; i < mesh.nVertices; ++i)
+		for (int c = 0; c < 3; ++c) {
+			ASSERT_EQ((float)sphere.p[i][c], (float)mesh.p[i][c]);
+			if (positionsOnly) continue;
+			ASSERT_EQ((float)sphere.n[i][c], (float)mesh.n[i][c]);
+			if (c < 2) {
+				ASSERT_EQ((float)sphere.uv[i][c], (float)mesh.uv[i][c]);
+			}
+		}
+	for (int i = 0; i < 3 * mesh.nTriangles; ++i) ASSERT_EQ(sphere.indices[i], mesh.vertexIndices[i]);
+}
+
+TEST(TestPLYMesh, RoundTrip) {
+	// Large enough to be parsed in several chunks
+	SphereMesh sphere(200, 400);
+	for (const char* format : { "ascii", "binary_little_endian" })
+		for (bool positionsOnly : { false, true }) {
+			WritePLY("sphere.ply", sphere, format, positionsOnly);
+			std::unique_ptr<PLYMesh> mesh = PLYMesh::Read("sphere.ply");
+			ASSERT_TRUE(mesh != nullptr) << format;
+			ExpectSphere(sphere, *mesh, positionsOnly);
+			// Positions alone in binary match Point3f when Float is float
+			EXPECT_EQ(sizeof(Float) == sizeof(float) && positionsOnly && std::string(format) != "ascii",
+				mesh->PositionsMapped());
+		}
+	std::remove("sphere.ply");
+}
+
+TEST(TestPLYMesh, PolygonsAndTypes) {
+	// A unit square as a quad and a pentagon beside it, with big-endian
+	// double positions, an extra face property and a trailing element
+	const double p[7][3] = { { 0, 0, 0 }, { 1, 0, 0 }, { 1, 1, 0 }, { 0, 1, 0 }, { 2, 0, 0 }, { 2, 1, 0 }, { 1.5, 2, 0 } };
+	const unsigned char faces[] = { 7, 4, 0, 1, 2, 3, 9, 5, 1, 4, 5, 6, 2 };
+	std::string header = "ply\nformat binary_big_endian 1.0\nelement vertex 7\nproperty double x\n"
+		"property double y\nproperty double z\nelement face 2\nproperty uchar flags\n"
+		"property list uchar ushort vertex_index\nelement edge 1\nproperty int a\nend_header\n";
+	std::string data = header;
+	for (const auto& v : p)
+		for (double c : v) {
+			char bytes[8];
+			memcpy(bytes, &c, 8);
+			for (int i = 7; i >= 0; --i) data += bytes[i];
+		}
+	for (size_t i = 0; i < sizeof(faces); ++i) {
+		// Flags and counts are bytes; indices 2-byte big-endian
+		bool isIndex = i != 0 && i != 1 && i != 6 && i != 7;
+		if (isIndex) data += '\0';
+		data += (char)faces[i];
+	}
+	data += std::string(4, '\0');
+	std::ofstream("polygons.ply", std::ios::binary) << data;
+
+	std::unique_ptr<PLYMesh> mesh = PLYMesh::Read("polygons.ply");
+	ASSERT_TRUE(mesh != nullptr);
+	EXPECT_EQ(7, mesh->nVertices);
+	EXPECT_EQ(Point3f(1.5f, 2, 0), mesh->p[6]);
+	// Fans of 2 and 3 triangles
+	const int expected[] = { 0, 1, 2, 0, 2, 3, 1, 4, 5, 1, 5, 6, 1, 6, 2 };
+	ASSERT_EQ(5, mesh->nTriangles);
+	for (int i = 0; i < 15; ++i) EXPECT_EQ(expected[i], mesh->vertexIndices[i]);
+
+	ParamSet ps;
+	ps.AddString("filename", std::unique_ptr<std::string[]>(new std::string[1]{ "polygons.ply" }));
+	std::vector<std::shared_ptr<Shape>> tris = CreatePLYMesh(ps);
+	ASSERT_EQ(5u, tris.size());
+	Float area = 0;
+	for (const auto& tri : tris) area += tri->Area();
+	EXPECT_FLOAT_EQ(2.5f, area);
+
+	// Truncated files are rejected
+	std::ofstream("polygons.ply", std::ios::binary) << data.substr(0, data.size() - 8);
+	EXPECT_TRUE(PLYMesh::Read("polygons.ply") == nullptr);
+	std::remove("polygons.ply");
+}
+
+#pragma endregion PLYMesh
+
+#pragma region OBJMesh
+
+TEST(TestOBJMesh, Sphere) {
+	// Quads whose corners index positions, uvs and normals separately,
+	// large enough to be parsed and deduplicated in several chunks
+	SphereMesh sphere(200, 400);
+	{
+		std::ofstream out("sphere.obj");
+		char line[128];
+		out << "# written by the shapes test\no sphere\n";
+		for (const Point3f& p : sphere.p) {
+			sprintf(line, "v %.9g %.9g %.9g\n", (float)p.x, (float)p.y, (float)p.z);
+			out << line;
+		}
+		for (const Point2f& uv : sphere.uv) {
+			sprintf(line, "vt %.9g %.9g\n", (float)uv.x, (float)uv.y);
+			out << line;
+		}
+		for (const Normal3f& n : sphere.n) {
+			sprintf(line, "vn %.9g %.9g %.9g\n", (float)n.x, (float)n.y, (float)n.z);
+			out << line;
+		}
+		out << "usemtl default\ns 1\n";
+		for (int t = 0; t < sphere.nTriangles(); t += 2) {
+			// The quad's two triangles share their first corner
+			const int* v = &sphere.indices[3 * t];
+			int quad[4] = { v[0] + 1, v[1] + 1, v[2] + 1, v[5] + 1 };
+			out << "f";
+			for (int k : quad) out << " " << k << "/" << k << "/" << k;
+			out << "\n";
+		}
+	}
+	std::unique_ptr<OBJMesh> mesh = OBJMesh::Read("sphere.obj");
+	std::remove("sphere.obj");
+	ASSERT_TRUE(mesh != nullptr);
+	ASSERT_EQ(sphere.nTriangles(), mesh->nTriangles);
+	EXPECT_EQ((int)sphere.p.size(), mesh->nVertices);
+	ASSERT_TRUE(mesh->n && mesh->uv);
+	for (int i = 0; i < 3 * mesh->nTriangles; ++i) {
+		int v = mesh->vertexIndices[i], expected = sphere.indices[i];
+		ASSERT_TRUE(v >= 0 && v < mesh->nVertices);
+		for (int c = 0; c < 3; ++c) {
+			ASSERT_EQ((float)sphere.p[expected][c], (float)mesh->p[v][c]);
+			ASSERT_EQ((float)sphere.n[expected][c], (float)mesh->n[v][c]);
+			if (c < 2) {
+				ASSERT_EQ((float)sphere.uv[expected][c], (float)mesh->uv[v][c]);
+			}
+		}
+	}
+	// Vertices are numbered in order of first use
+	EXPECT_EQ(0, mesh->vertexIndices[0]);
+	EXPECT_EQ(1, mesh->vertexIndices[1]);
+	EXPECT_EQ(2, mesh->vertexIndices[2]);
+}
+
+TEST(TestOBJMesh, Deduplication) {
+	// A quad, a triangle over it with relative indices and one whose first
+	// corner has another uv
+	std::ofstream("square.obj") << "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\n"
+		"vt 0 0\nvt 1 0\nvt 1 1\nvt 0 1\nvn 0 0 1\n"
+		"f 1/1/1 2/2/1 3/3/1 4/4/1\n"
+		"g top\n  f\t-4/-4/-1 -2/-2/-1 -1/-1/-1\r\n"
+		"f 1/2/1 2/2/1 3/3/1\n";
+	std::unique_ptr<OBJMesh> mesh = OBJMesh::Read("square.obj");
+	ASSERT_TRUE(mesh != nullptr);
+	const int expected[] = { 0, 1, 2, 0, 2, 3, 0, 2, 3, 4, 1, 2 };
+	ASSERT_EQ(4, mesh->nTriangles);
+	ASSERT_EQ(5, mesh->nVertices);
+	for (int i = 0; i < 12; ++i) EXPECT_EQ(expected[i], mesh->vertexIndices[i]);
+	EXPECT_EQ(Point3f(0, 0, 0), mesh->p[4]);
+	EXPECT_EQ(Point2f(1, 0), mesh->uv[4]);
+	EXPECT_EQ(Normal3f(0, 0, 1), mesh->n[4]);
+
+	// Without normals on every corner, vertices are told apart by position
+	// and uv alone
+	std::ofstream("square.obj") << "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nvn 0 0 1\n"
+		"f 1//1 2//1 3//1\nf 1 3 4\n";
+	mesh = OBJMesh::Read("square.obj");
+	ASSERT_TRUE(mesh != nullptr);
+	EXPECT_EQ(4, mesh->nVertices);
+	EXPECT_TRUE(mesh->n == nullptr && mesh->uv == nullptr);
+	ParamSet ps;
+	ps.AddString("filename", std::unique_ptr<std::string[]>(new std::string[1]{ "square.obj" }));
+	std::vector<std::shared_ptr<Shape>> tris = CreateOBJMesh(Scale(2, 2, 2), false, ps);
+	ASSERT_EQ(2u, tris.size());
+	EXPECT_FLOAT_EQ(4, tris[0]->Area() + tris[1]->Area());
+
+	// Indices out of range and malformed corners are rejected
+	std::ofstream("square.obj") << "v 0 0 0\nv 1 0 0\nv 1 1 0\nf 1 2 4\n";
+	EXPECT_TRUE(OBJMesh::Read("square.obj") == nullptr);
+	std::ofstream("square.obj") << "v 0 0 0\nv 1 0 0\nv 1 1 0\nf 1 2 3x\n";
+	EXPECT_TRUE(OBJMesh::Read("square.obj") == nullptr);
+	std::remove("square.obj");
+}
+
+#pragma endregion OBJMesh
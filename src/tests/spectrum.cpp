@@ -0,0 +1,138 @@
+#include "tests/gtest/gtest.h"
+#include "pbr.h"
+#include "spectrum.h"
+
+using namespace pbr;
+
+static void ExpectNear(const RGBSpectrum& expected, const RGBSpectrum& actual, Float tolerance) {
+	for (int c = 0; c < 3; ++c) EXPECT_NEAR(expected[c], actual[c], tolerance) << expected << " vs " << actual;
+}
+
+#pragma region RGBSpectrum
+
+TEST(TestSpectrum, RGBArithmetic) {
+	// One SSE register with float
+	EXPECT_EQ(4 * sizeof(Float), sizeof(RGBSpectrum));
+	EXPECT_EQ(16u, alignof(RGBSpectrum));
+
+	RGBSpectrum a(1, 2, 3), b(0.5f, 0.25f, 2);
+	EXPECT_EQ(RGBSpectrum(1.5f, 2.25f, 5), a + b);
+	EXPECT_EQ(RGBSpectrum(0.5f, 1.75f, 1), a - b);
+	EXPECT_EQ(RGBSpectrum(0.5f, 0.5f, 6), a * b);
+	EXPECT_EQ(RGBSpectrum(2, 8, 1.5f), a / b);
+	EXPECT_EQ(RGBSpectrum(2, 4, 6), 2 * a);
+	EXPECT_EQ(RGBSpectrum(0.5f, 1, 1.5f), a / 2);
+	EXPECT_EQ(RGBSpectrum(-1, -2, -3), -a);
+	EXPECT_EQ(RGBSpectrum(0.75f, 1.125f, 2.5f), Lerp(0.5f, a, b));
+	EXPECT_EQ(RGBSpectrum(2, 3, 4), Sqrt(RGBSpectrum(4, 9, 16)));
+	EXPECT_EQ(RGBSpectrum(0.5f, 0.25f, 2), Min(a, b));
+	EXPECT_EQ(RGBSpectrum(0, 0.5f, 2), ClampZero(RGBSpectrum(-1, 0.5f, 2)));
+	EXPECT_EQ(RGBSpectrum(0.5f, 0, 3), SafeDiv(a, RGBSpectrum(2, 0, 1)));
+	EXPECT_EQ(3, a.MaxComponentValue());
+	EXPECT_EQ(2, a.Average());
+	EXPECT_FLOAT_EQ(0.212671f + 2 * 0.715160f + 3 * 0.072169f, a.y());
+
+	RGBSpectrum c = a;
+	c += b;
+	c *= 2;
+	c -= a;
+	EXPECT_EQ(RGBSpectrum(2, 2.5f, 7), c);
+	EXPECT_TRUE(RGBSpectrum(0).IsBlack());
+	EXPECT_FALSE(RGBSpectrum(0, 0, 1e-20f).IsBlack());
+
+	// The padding lane's 0 / 0 is never seen
+	RGBSpectrum d = RGBSpectrum(1, 2, 3) / RGBSpectrum(2, 2, 2);
+	EXPECT_FALSE(d.HasNaNs());
+	EXPECT_EQ(RGBSpectrum(0.5f, 1, 1.5f), d);
+	EXPECT_TRUE(RGBSpectrum(1, std::numeric_limits<Float>::quiet_NaN(), 1).HasNaNs());
+}
+
+#pragma endregion
+
+#pragma region SampledSpectrum
+
+TEST(TestSpectrum, SampledWavelengths) {
+	SampledWavelengths uniform = SampledWavelengths::SampleUniform(0.25f);
+	Float delta = (LambdaMax - LambdaMin) / NSpectrumSamples;
+	EXPECT_FLOAT_EQ(LambdaMin + 0.25f * (LambdaMax - LambdaMin), uniform[0]);
+	for (int i = 1; i < NSpectrumSamples; ++i) {
+		Float expected = uniform[0] + i * delta;
+		if (expected > LambdaMax) expected -= LambdaMax - LambdaMin;
+		EXPECT_NEAR(expected, uniform[i], 1e-3f);
+		EXPECT_FLOAT_EQ(1 / (LambdaMax - LambdaMin), uniform.PDF()[i]);
+	}
+
+	// Visible sampling covers the range: E[1 / pdf] is its length
+	const int n = 10000;
+	double sumInvPdf = 0;
+	for (int k = 0; k < n; ++k) {
+		SampledWavelengths lambda = SampledWavelengths::SampleVisible((k + 0.5f) / n);
+		for (int i = 0; i < NSpectrumSamples; ++i) {
+			ASSERT_GT(lambda.PDF()[i], 0);
+			ASSERT_TRUE(lambda[i] >= LambdaMin && lambda[i] <= LambdaMax);
+			sumInvPdf += 1 / lambda.PDF()[i];
+		}
+	}
+	EXPECT_NEAR(LambdaMax - LambdaMin, sumInvPdf / (n * NSpectrumSamples), 5);
+
+	SampledWavelengths terminated = SampledWavelengths::SampleVisible(0.3f);
+	Float pdf0 = terminated.PDF()[0];
+	EXPECT_FALSE(terminated.SecondaryTerminated());
+	terminated.TerminateSecondary();
+	EXPECT_TRUE(terminated.SecondaryTerminated());
+	EXPECT_FLOAT_EQ(pdf0 / NSpectrumSamples, terminated.PDF()[0]);
+	for (int i = 1; i < NSpectrumSamples; ++i) EXPECT_EQ(0, terminated.PDF()[i]);
+}
+
+// Mean RGB of the product of spectra made from rgb and lit by light over
+// stratified visible wavelengths
+static RGBSpectrum RoundTrip(const RGBSpectrum& rgb, SpectrumType type, const RGBSpectrum& light) {
+	const int n = 4096;
+	RGBSpectrum sum;
+	for (int k = 0; k < n; ++k) {
+		SampledWavelengths lambda = SampledWavelengths::SampleVisible((k + 0.5f) / n);
+		SampledSpectrum s = SampledSpectrum::FromRGB(rgb, lambda, type);
+		if (!light.IsBlack()) s *= SampledSpectrum::FromRGB(light, lambda, SpectrumType::Illuminant);
+		sum += s.ToRGB(lambda);
+	}
+	return sum / n;
+}
+
+TEST(TestSpectrum, RGBRoundTrip) {
+	// Reflectances under the reference illuminant
+	const RGBSpectrum reflectances[] = {
+		RGBSpectrum(0.2f, 0.5f, 0.8f), RGBSpectrum(0.9f, 0.1f, 0.1f), RGBSpectrum(0.05f, 0.6f, 0.3f),
+		RGBSpectrum(0.7f, 0.7f, 0.2f), RGBSpectrum(0.5f, 0.5f, 0.5f), RGBSpectrum(0.01f, 0.02f, 0.015f),
+	};
+	for (const RGBSpectrum& rgb : reflectances)
+		ExpectNear(rgb, RoundTrip(rgb, SpectrumType::Reflectance, RGBSpectrum(1)), 0.01f);
+	// Reflectances are clamped to [0, 1]
+	ExpectNear(RGBSpectrum(1, 0, 0.5f),
+		RoundTrip(RGBSpectrum(2, -1, 0.5f), SpectrumType::Reflectance, RGBSpectrum(1)), 0.05f);
+	ExpectNear(RGBSpectrum(3, 1.5f, 0.3f), RoundTrip(RGBSpectrum(3, 1.5f, 0.3f), SpectrumType::Unbounded,
+		RGBSpectrum(1)), 0.03f);
+	// Illuminants alone
+	ExpectNear(RGBSpectrum(1), RoundTrip(RGBSpectrum(1), SpectrumType::Illuminant, RGBSpectrum(0)), 0.01f);
+	ExpectNear(RGBSpectrum(2, 1, 0.5f), RoundTrip(RGBSpectrum(2, 1, 0.5f), SpectrumType::Illuminant,
+		RGBSpectrum(0)), 0.02f);
+}
+
+TEST(TestSpectrum, GreyIsConstant) {
+	SampledWavelengths lambda = SampledWavelengths::SampleUniform(0.1f);
+	EXPECT_EQ(SampledSpectrum(0.3f), SampledSpectrum::FromRGB(RGBSpectrum(0.3f), lambda));
+	EXPECT_EQ(SampledSpectrum(0), SampledSpectrum::FromRGB(RGBSpectrum(0), lambda));
+	EXPECT_EQ(SampledSpectrum(1), SampledSpectrum::FromRGB(RGBSpectrum(1), lambda));
+	RGBSigmoidPolynomial grey = sRGBToSpectrumTable(RGBSpectrum(0.3f));
+	EXPECT_NEAR(0.3f, grey(400), 1e-6f);
+	EXPECT_NEAR(0.3f, grey(700), 1e-6f);
+	// Reflectances stay in [0, 1]
+	RGBSigmoidPolynomial red = sRGBToSpectrumTable(RGBSpectrum(1, 0, 0));
+	for (Float l = LambdaMin; l <= LambdaMax; l += 10) {
+		EXPECT_GE(red(l), 0);
+		EXPECT_LE(red(l), 1);
+	}
+	EXPECT_GT(red(700), 0.9f);
+	EXPECT_LT(red(450), 0.1f);
+}
+
+#pragma endregion
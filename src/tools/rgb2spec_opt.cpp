@@ -0,0 +1,273 @@
+// Build-time generator of the RGB to spectrum tables of spectrum.h, after
+// Jakob and Hanika, "A Low-Dimensional Function Space for Efficient
+// Spectral Upsampling" (2019).
+//
+// For every cell of a res^3 grid over the sRGB cube, Gauss-Newton
+// iteration finds the coefficients of a sigmoid of a quadratic whose
+// reflectance, lit by the reference illuminant, has the cell's RGB. The
+// table and the spectral data it was fitted against are written as C++
+// source to be compiled into the renderer.
+//
+// Usage: rgb2spec_opt <res> <output.cpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+static const int LambdaMin = 360, LambdaMax = 830;
+static const int CIESamples = LambdaMax - LambdaMin + 1;
+
+// The CIE 1931 2-degree standard observer and the CIE standard illuminant
+// D65, tabulated at 5nm steps as published by the CIE (CIE 015:2004 and
+// ISO 11664-2). The observer covers LambdaMin to LambdaMax, D65 300nm to
+// 830nm; both are linearly interpolated to 1nm.
+static const int CIETableSamples = (LambdaMax - LambdaMin) / 5 + 1, D65TableSamples = (830 - 300) / 5 + 1;
+
+static const double cieX[CIETableSamples] = {
+	0.0001299, 0.0002321, 0.0004149, 0.0007416, 0.001368, 0.002236, 0.004243, 0.00765, 0.01431, 0.02319, 0.04351,
+	0.07763, 0.13438, 0.21477, 0.2839, 0.3285, 0.34828, 0.34806, 0.3362, 0.3187, 0.2908, 0.2511, 0.19536, 0.1421,
+	0.09564, 0.05795001, 0.03201, 0.0147, 0.0049, 0.0024, 0.0093, 0.0291, 0.06327, 0.1096, 0.1655, 0.2257499,
+	0.2904, 0.3597, 0.4334499, 0.5120501, 0.5945, 0.6784, 0.7621, 0.8425, 0.9163, 0.9786, 1.0263, 1.0567, 1.0622,
+	1.0456, 1.0026, 0.9384, 0.8544499, 0.7514, 0.6424, 0.5419, 0.4479, 0.3608, 0.2835, 0.2187, 0.1649, 0.1212,
+	0.0874, 0.0636, 0.04677, 0.0329, 0.0227, 0.01584, 0.01135916, 0.008110916, 0.005790346, 0.004109457,
+	0.002899327, 0.00204919, 0.001439971, 0.0009999493, 0.0006900786, 0.0004760213, 0.0003323011, 0.0002348261,
+	0.0001661505, 0.000117413, 8.307527e-05, 5.870652e-05, 4.150994e-05, 2.935326e-05, 2.067383e-05, 1.455977e-05,
+	1.025398e-05, 7.221456e-06, 5.085868e-06, 3.581652e-06, 2.522525e-06, 1.776509e-06, 1.251141e-06,
+};
+
+static const double cieY[CIETableSamples] = {
+	3.917e-06, 6.965e-06, 1.239e-05, 2.202e-05, 3.9e-05, 6.4e-05, 0.00012, 0.000217, 0.000396, 0.00064, 0.00121,
+	0.00218, 0.004, 0.0073, 0.0116, 0.01684, 0.023, 0.0298, 0.038, 0.048, 0.06, 0.0739, 0.09098, 0.1126, 0.13902,
+	0.1693, 0.20802, 0.2586, 0.323, 0.4073, 0.503, 0.6082, 0.71, 0.7932, 0.862, 0.9148501, 0.954, 0.9803,
+	0.9949501, 1, 0.995, 0.9786, 0.952, 0.9154, 0.87, 0.8163, 0.757, 0.6949, 0.631, 0.5668, 0.503, 0.4412, 0.381,
+	0.321, 0.265, 0.217, 0.175, 0.1382, 0.107, 0.0816, 0.061, 0.04458, 0.032, 0.0232, 0.017, 0.01192, 0.00821,
+	0.005723, 0.004102, 0.002929, 0.002091, 0.001484, 0.001047, 0.00074, 0.00052, 0.0003611, 0.0002492, 0.0001719,
+	0.00012, 8.48e-05, 6e-05, 4.24e-05, 3e-05, 2.12e-05, 1.4989e-05, 1.0584e-05, 7.4656e-06, 5.2592e-06,
+	3.7028e-06, 2.6076e-06, 1.8365e-06, 1.295e-06, 9.1092e-07, 6.4153e-07, 4.5181e-07,
+};
+
+static const double cieZ[CIETableSamples] = {
+	0.0006061, 0.001086, 0.001946, 0.003486, 0.006450001, 0.01054999, 0.02005001, 0.03621, 0.06785001, 0.1102,
+	0.2074, 0.3713, 0.6456, 1.0390501, 1.3856, 1.62296, 1.74706, 1.7826, 1.77211, 1.7441, 1.6692, 1.5281, 1.28764,
+	1.0419, 0.8129501, 0.6162, 0.46518, 0.3533, 0.272, 0.2123, 0.1582, 0.1117, 0.07824999, 0.05725001, 0.04216,
+	0.02984, 0.0203, 0.0134, 0.008749999, 0.005749999, 0.0039, 0.002749999, 0.0021, 0.0018, 0.001650001, 0.0014,
+	0.0011, 0.001, 0.0008, 0.0006, 0.00034, 0.00024, 0.00019, 0.0001, 4.999999e-05, 3e-05, 2e-05, 1e-05, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+};
+
+static const double d65[D65TableSamples] = {
+	0.0341, 1.6643, 3.2945, 11.7652, 20.236, 28.6447, 37.0535, 38.5011, 39.9488, 42.4302, 44.9117, 45.775, 46.6383,
+	49.3637, 52.0891, 51.0323, 49.9755, 52.3118, 54.6482, 68.7015, 82.7549, 87.1204, 91.486, 92.4589, 93.4318,
+	90.057, 86.6823, 95.7736, 104.865, 110.936, 117.008, 117.41, 117.812, 116.336, 114.861, 115.392, 115.923,
+	112.367, 108.811, 109.082, 109.354, 108.578, 107.802, 106.296, 104.79, 106.239, 107.689, 106.047, 104.405,
+	104.225, 104.046, 102.023, 100, 98.1671, 96.3342, 96.0611, 95.788, 92.2368, 88.6856, 89.3459, 90.0062, 89.8026,
+	89.5991, 88.6489, 87.6987, 85.4936, 83.2886, 83.4939, 83.6992, 81.863, 80.0268, 80.1207, 80.2146, 81.2462,
+	82.2778, 80.281, 78.2842, 74.0027, 69.7213, 70.6652, 71.6091, 72.979, 74.349, 67.9765, 61.604, 65.7448,
+	69.8856, 72.4863, 75.087, 69.3398, 63.5927, 55.0054, 46.4182, 56.6118, 66.8054, 65.0941, 63.3828, 63.8434,
+	64.304, 61.8779, 59.4519, 55.7054, 51.9589, 54.6998, 57.4406, 58.8765, 60.3125,
+};
+
+// Linear interpolation of a table at 5nm steps from firstLambda
+static double Interpolate5nm(const double* table, int nSamples, int firstLambda, double lambda) {
+	double t = (lambda - firstLambda) / 5;
+	int i = std::min((int)t, nSamples - 2);
+	return table[i] + (t - i) * (table[i + 1] - table[i]);
+}
+
+static void CIEXYZ(double lambda, double xyz[3]) {
+	xyz[0] = Interpolate5nm(cieX, CIETableSamples, LambdaMin, lambda);
+	xyz[1] = Interpolate5nm(cieY, CIETableSamples, LambdaMin, lambda);
+	xyz[2] = Interpolate5nm(cieZ, CIETableSamples, LambdaMin, lambda);
+}
+
+// The reference illuminant, up to scale
+static double Illuminant(double lambda) { return Interpolate5nm(d65, D65TableSamples, 300, lambda); }
+
+// sRGB's XYZ to linear RGB matrix, for a D65 white
+static const double xyzToRGB[3][3] = {
+	{ 3.2404542, -1.5371385, -0.4985314 },
+	{ -0.9692660, 1.8760108, 0.0415560 },
+	{ 0.0556434, -0.2040259, 1.0572252 },
+};
+
+// Spectral data at 1nm steps: the color matching functions, the
+// illuminant normalized to unit luminance, and the RGB of each
+// wavelength's share of the illuminant, weighted for integration
+static double cie[3][CIESamples], illuminant[CIESamples], rgbWeights[3][CIESamples];
+static double cieYIntegral;
+
+static void InitSpectralData() {
+	cieYIntegral = 0;
+	for (int i = 0; i < CIESamples; ++i) {
+		double xyz[3];
+		CIEXYZ(LambdaMin + i, xyz);
+		for (int c = 0; c < 3; ++c) cie[c][i] = xyz[c];
+		illuminant[i] = Illuminant(LambdaMin + i);
+		cieYIntegral += cie[1][i];
+	}
+	double illumY = 0;
+	for (int i = 0; i < CIESamples; ++i) illumY += illuminant[i] * cie[1][i];
+	for (int i = 0; i < CIESamples; ++i) illuminant[i] *= cieYIntegral / illumY;
+	for (int i = 0; i < CIESamples; ++i)
+		for (int r = 0; r < 3; ++r) {
+			double v = 0;
+			for (int c = 0; c < 3; ++c) v += xyzToRGB[r][c] * cie[c][i];
+			rgbWeights[r][i] = v * illuminant[i] / cieYIntegral;
+		}
+}
+
+static double Sigmoid(double x) { return 0.5 + x / (2 * std::sqrt(1 + x * x)); }
+
+// RGB of the reflectance given by coefficients over normalized wavelength,
+// minus the target
+static void Residual(const double coeffs[3], const double rgb[3], double residual[3]) {
+	double out[3] = { 0, 0, 0 };
+	for (int i = 0; i < CIESamples; ++i) {
+		double x = double(i) / double(CIESamples - 1);
+		double s = Sigmoid((coeffs[0] * x + coeffs[1]) * x + coeffs[2]);
+		for (int c = 0; c < 3; ++c) out[c] += rgbWeights[c][i] * s;
+	}
+	for (int c = 0; c < 3; ++c) residual[c] = out[c] - rgb[c];
+}
+
+// Solves A x = b by Gaussian elimination with partial pivoting
+static bool Solve3x3(double A[3][3], double b[3], double x[3]) {
+	for (int col = 0; col < 3; ++col) {
+		int pivot = col;
+		for (int r = col + 1; r < 3; ++r)
+			if (std::abs(A[r][col]) > std::abs(A[pivot][col])) pivot = r;
+		if (std::abs(A[pivot][col]) < 1e-15) return false;
+		std::swap(A[col], A[pivot]);
+		std::swap(b[col], b[pivot]);
+		for (int r = col + 1; r < 3; ++r) {
+			double f = A[r][col] / A[col][col];
+			for (int c = col; c < 3; ++c) A[r][c] -= f * A[col][c];
+			b[r] -= f * b[col];
+		}
+	}
+	for (int r = 2; r >= 0; --r) {
+		x[r] = b[r];
+		for (int c = r + 1; c < 3; ++c) x[r] -= A[r][c] * x[c];
+		x[r] /= A[r][r];
+	}
+	return true;
+}
+
+static void GaussNewton(const double rgb[3], double coeffs[3]) {
+	for (int it = 0; it < 15; ++it) {
+		double r[3];
+		Residual(coeffs, rgb, r);
+		if (std::sqrt(r[0] * r[0] + r[1] * r[1] + r[2] * r[2]) < 1e-6) break;
+		double J[3][3];
+		for (int j = 0; j < 3; ++j) {
+			const double eps = 1e-5;
+			double c[3] = { coeffs[0], coeffs[1], coeffs[2] }, rj[3];
+			c[j] += eps;
+			Residual(c, rgb, rj);
+			for (int i = 0; i < 3; ++i) J[i][j] = (rj[i] - r[i]) / eps;
+		}
+		double delta[3];
+		if (!Solve3x3(J, r, delta)) break;
+		for (int j = 0; j < 3; ++j) coeffs[j] -= delta[j];
+		// Keep the polynomial in a range where the table interpolates well
+		double maxCoeff = std::max(std::max(std::abs(coeffs[0]), std::abs(coeffs[1])), std::abs(coeffs[2]));
+		if (maxCoeff > 200)
+			for (int j = 0; j < 3; ++j) coeffs[j] *= 200 / maxCoeff;
+	}
+}
+
+static double Smoothstep(double x) { return x * x * (3 - 2 * x); }
+
+int main(int argc, char* argv[]) {
+	if (argc != 3) {
+		fprintf(stderr, "usage: rgb2spec_opt <res> <output.cpp>\n");
+		return 1;
+	}
+	const int res = atoi(argv[1]);
+	if (res < 2) {
+		fprintf(stderr, "rgb2spec_opt: resolution must be at least 2\n");
+		return 1;
+	}
+	InitSpectralData();
+
+	// Brightness nodes are denser near black and white
+	std::vector<double> scale(res);
+	for (int k = 0; k < res; ++k) scale[k] = Smoothstep(Smoothstep(double(k) / double(res - 1)));
+
+	// Coefficients of cell (l, k, j, i): l is the largest component, k
+	// indexes its value, and j and i the other two relative to it. Each
+	// cell starts from the solution of its neighbour in k, working out from
+	// a middle brightness.
+	std::vector<float> data((size_t)3 * res * res * res * 3);
+	unsigned nThreads = std::max(1u, std::thread::hardware_concurrency());
+	std::vector<std::thread> threads;
+	for (unsigned t = 0; t < nThreads; ++t)
+		threads.push_back(std::thread([&, t]() {
+			for (int row = (int)t; row < 3 * res; row += (int)nThreads) {
+				int l = row / res, j = row % res;
+				double y = double(j) / double(res - 1);
+				for (int i = 0; i < res; ++i) {
+					double x = double(i) / double(res - 1);
+					const int start = res / 5;
+					double coeffs[3] = { 0, 0, 0 };
+					for (int pass = 0; pass < 2; ++pass) {
+						if (pass == 1) coeffs[0] = coeffs[1] = coeffs[2] = 0;
+						for (int k = pass == 0 ? start : start - 1; k >= 0 && k < res; k += pass == 0 ? 1 : -1) {
+							double b = scale[k], rgb[3];
+							rgb[l] = b;
+							rgb[(l + 1) % 3] = x * b;
+							rgb[(l + 2) % 3] = y * b;
+							GaussNewton(rgb, coeffs);
+
+							// Convert to coefficients over wavelength in nm
+							double c0 = LambdaMin, c1 = 1.0 / (LambdaMax - LambdaMin);
+							double A = coeffs[0], B = coeffs[1], C = coeffs[2];
+							float* out = &data[((((size_t)l * res + k) * res + j) * res + i) * 3];
+							out[0] = float(A * c1 * c1);
+							out[1] = float(B * c1 - 2 * A * c0 * c1 * c1);
+							out[2] = float(C - B * c0 * c1 + A * c0 * c0 * c1 * c1);
+						}
+					}
+				}
+			}
+		}));
+	for (std::thread& thread : threads) thread.join();
+
+	// Written under a temporary name and renamed, so that builds sharing
+	// the output never see part of it
+	std::string tempName = std::string(argv[2]) + ".tmp";
+	FILE* f = fopen(tempName.c_str(), "w");
+	if (!f) {
+		fprintf(stderr, "rgb2spec_opt: unable to open %s\n", tempName.c_str());
+		return 1;
+	}
+	fprintf(f, "// Generated by rgb2spec_opt; do not edit\n\n#include \"spectrum.h\"\n\nnamespace pbr {\n\n");
+	const char* cieNames[3] = { "CIE_X", "CIE_Y", "CIE_Z" };
+	for (int c = 0; c < 3; ++c) {
+		fprintf(f, "\tconst float %s[CIESamples] = {", cieNames[c]);
+		for (int i = 0; i < CIESamples; ++i) fprintf(f, "%s%.9g,", i % 8 ? " " : "\n\t\t", cie[c][i]);
+		fprintf(f, "\n\t};\n\n");
+	}
+	fprintf(f, "\tconst float CIE_Y_integral = %.9g;\n\n", cieYIntegral);
+	fprintf(f, "\tconst float RGBIlluminant[CIESamples] = {");
+	for (int i = 0; i < CIESamples; ++i) fprintf(f, "%s%.9g,", i % 8 ? " " : "\n\t\t", illuminant[i]);
+	fprintf(f, "\n\t};\n\n\tconst float XYZToRGB[3][3] = {\n");
+	for (int r = 0; r < 3; ++r)
+		fprintf(f, "\t\t{ %.9g, %.9g, %.9g },\n", xyzToRGB[r][0], xyzToRGB[r][1], xyzToRGB[r][2]);
+	fprintf(f, "\t};\n\n\tstatic const float scale[%d] = {", res);
+	for (int k = 0; k < res; ++k) fprintf(f, "%s%.9g,", k % 8 ? " " : "\n\t\t", scale[k]);
+	fprintf(f, "\n\t};\n\n\tstatic const float data[%d] = {", (int)data.size());
+	for (size_t i = 0; i < data.size(); ++i) fprintf(f, "%s%.9g,", i % 8 ? " " : "\n\t\t", data[i]);
+	fprintf(f, "\n\t};\n\n\tconst RGBToSpectrumTable sRGBToSpectrumTable(%d, scale, data);\n\n}  // namespace pbr\n", res);
+	if (fclose(f) != 0) return 1;
+	std::remove(argv[2]);
+	if (std::rename(tempName.c_str(), argv[2]) != 0) {
+		fprintf(stderr, "rgb2spec_opt: unable to rename %s to %s\n", tempName.c_str(), argv[2]);
+		return 1;
+	}
+	return 0;
+}